@@ -0,0 +1,402 @@
+#include "BenchmarkHarness.h"
+#include "JsonWriter.h"
+#include "JsonReader.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <regex>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+namespace {
+    constexpr uint64_t MAX_ITERATIONS = 1000000000;
+
+    struct Options {
+        std::string filter;              // ECMAScript regex over "Function/arg"
+        double minTimeSeconds = 0.2;
+        size_t repetitions = 1;
+        std::string format = "console"; // console, json or csv
+        std::string outPath;             // Report destination; stdout when empty
+        std::string baselinePath;        // Earlier JSON report to compare against
+        uint32_t seed = 42;
+        bool listOnly = false;
+    };
+
+    void printUsage(const char* program) {
+        std::cerr << "Usage: " << program << " [--filter=<regex>] [--min-time=<seconds>] [--repetitions=<n>]\n"
+                  << "       [--format=console|json|csv] [--out=<file>] [--baseline=<json>] [--seed=<n>] [--list]\n";
+    }
+
+    bool parseArguments(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            std::string argument = argv[i];
+            size_t equals = argument.find('=');
+            std::string name = argument.substr(0, equals);
+            std::string value = equals == std::string::npos ? std::string() : argument.substr(equals + 1);
+            try {
+                if (name == "--filter") {
+                    options.filter = value;
+                } else if (name == "--min-time") {
+                    options.minTimeSeconds = std::stod(value);
+                } else if (name == "--repetitions") {
+                    options.repetitions = std::max<size_t>(1, std::stoul(value));
+                } else if (name == "--format" && (value == "console" || value == "json" || value == "csv")) {
+                    options.format = value;
+                } else if (name == "--out") {
+                    options.outPath = value;
+                } else if (name == "--baseline") {
+                    options.baselinePath = value;
+                } else if (name == "--seed") {
+                    options.seed = static_cast<uint32_t>(std::stoul(value));
+                } else if (name == "--list") {
+                    options.listOnly = true;
+                } else {
+                    return false;
+                }
+            } catch (const std::exception&) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Grows the iteration count until one run lasts minTime, then measures `repetitions` runs
+    BenchmarkResult runBenchmark(const Benchmark& benchmark, const std::string& name, int64_t arg,
+                                 const Options& options) {
+        const double minNanos = options.minTimeSeconds * 1.0e9;
+        uint64_t iterations = 1;
+        std::unique_ptr<BenchmarkState> last;
+        while (true) {
+            last = std::make_unique<BenchmarkState>(iterations, arg, options.seed);
+            benchmark.getFunction()(*last);
+            double elapsed = last->getElapsedNanos();
+            if (elapsed >= minNanos || iterations >= MAX_ITERATIONS || last->iterations() < iterations) {
+                break;
+            }
+            double multiplier = elapsed > 0.0 ? std::min(10.0, 1.4 * minNanos / elapsed) : 10.0;
+            iterations = std::min(MAX_ITERATIONS,
+                                  std::max(iterations + 1, static_cast<uint64_t>(iterations * multiplier)));
+        }
+
+        // The calibrated run counts as the first repetition
+        std::vector<std::unique_ptr<BenchmarkState>> runs;
+        runs.push_back(std::move(last));
+        while (runs.size() < options.repetitions) {
+            runs.push_back(std::make_unique<BenchmarkState>(iterations, arg, options.seed));
+            benchmark.getFunction()(*runs.back());
+        }
+
+        auto perIteration = [](const BenchmarkState& run) {
+            return run.getElapsedNanos() / std::max<uint64_t>(1, run.iterations());
+        };
+        std::sort(runs.begin(), runs.end(), [&](const auto& a, const auto& b) {
+            return perIteration(*a) < perIteration(*b);
+        });
+        const BenchmarkState& median = *runs[runs.size() / 2];
+
+        double mean = 0.0;
+        for (const auto& run : runs) {
+            mean += perIteration(*run) / runs.size();
+        }
+        double variance = 0.0;
+        for (const auto& run : runs) {
+            variance += (perIteration(*run) - mean) * (perIteration(*run) - mean) / runs.size();
+        }
+
+        BenchmarkResult result;
+        result.name = name;
+        result.arg = arg;
+        result.iterations = median.iterations();
+        result.repetitions = runs.size();
+        result.realNanos = perIteration(median);
+        result.cpuNanos = median.getCpuNanos() / std::max<uint64_t>(1, median.iterations());
+        result.stddevNanos = std::sqrt(variance);
+        if (median.getElapsedNanos() > 0.0) {
+            result.itemsPerSecond = median.getItemsProcessed() * 1.0e9 / median.getElapsedNanos();
+        }
+        result.counters = median.getCounters();
+        return result;
+    }
+
+    std::string formatNanos(double nanos) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(nanos < 10.0 ? 2 : 1);
+        if (nanos < 1.0e3) {
+            out << nanos << " ns";
+        } else if (nanos < 1.0e6) {
+            out << nanos / 1.0e3 << " us";
+        } else if (nanos < 1.0e9) {
+            out << nanos / 1.0e6 << " ms";
+        } else {
+            out << nanos / 1.0e9 << " s";
+        }
+        return out.str();
+    }
+
+    std::string formatConsole(const std::vector<BenchmarkResult>& results) {
+        std::ostringstream out;
+        out << std::left << std::setw(44) << "Benchmark" << std::right << std::setw(14) << "Time" << std::setw(14)
+            << "CPU" << std::setw(12) << "Iterations" << std::setw(14) << "Items/s" << "  Counters\n";
+        out << std::string(110, '-') << "\n";
+        for (const BenchmarkResult& result : results) {
+            out << std::left << std::setw(44) << result.name << std::right << std::setw(14)
+                << formatNanos(result.realNanos) << std::setw(14) << formatNanos(result.cpuNanos) << std::setw(12)
+                << result.iterations << std::setw(14);
+            if (result.itemsPerSecond > 0.0) {
+                std::ostringstream items;
+                items << std::setprecision(3) << result.itemsPerSecond;
+                out << items.str();
+            } else {
+                out << "";
+            }
+            out << " ";
+            for (const auto& counter : result.counters) {
+                out << " " << counter.first << "=" << counter.second;
+            }
+            out << "\n";
+        }
+        return out.str();
+    }
+
+    // One benchmark per line so reports diff line by line
+    std::string formatJson(const std::vector<BenchmarkResult>& results,
+                           const std::map<std::string, std::string>& context, const Options& options) {
+        std::string header;
+        JsonWriter contextWriter(header);
+        contextWriter.beginObject();
+        for (const auto& entry : context) {
+            contextWriter.field(entry.first, std::string_view(entry.second));
+        }
+        contextWriter.field("min_time_s", options.minTimeSeconds);
+        contextWriter.field("repetitions", static_cast<uint64_t>(options.repetitions));
+        contextWriter.field("seed", static_cast<uint64_t>(options.seed));
+        contextWriter.endObject();
+
+        std::string out = "{\"context\":" + header + ",\n\"benchmarks\":[";
+        std::string line;
+        for (size_t i = 0; i < results.size(); ++i) {
+            const BenchmarkResult& result = results[i];
+            line.clear();
+            JsonWriter writer(line);
+            writer.beginObject();
+            writer.field("name", std::string_view(result.name));
+            writer.field("arg", result.arg);
+            writer.field("iterations", result.iterations);
+            writer.field("repetitions", static_cast<uint64_t>(result.repetitions));
+            writer.field("real_time_ns", result.realNanos);
+            writer.field("cpu_time_ns", result.cpuNanos);
+            writer.field("stddev_ns", result.stddevNanos);
+            writer.field("items_per_second", result.itemsPerSecond);
+            writer.key("counters");
+            writer.beginObject();
+            for (const auto& counter : result.counters) {
+                writer.field(counter.first, counter.second);
+            }
+            writer.endObject();
+            writer.endObject();
+            out += i ? ",\n" : "\n";
+            out += line;
+        }
+        out += "\n]}\n";
+        return out;
+    }
+
+    std::string formatCsv(const std::vector<BenchmarkResult>& results) {
+        std::ostringstream out;
+        out << std::setprecision(10);
+        out << "name,arg,iterations,repetitions,real_time_ns,cpu_time_ns,stddev_ns,items_per_second\n";
+        for (const BenchmarkResult& result : results) {
+            out << result.name << "," << result.arg << "," << result.iterations << "," << result.repetitions << ","
+                << result.realNanos << "," << result.cpuNanos << "," << result.stddevNanos << ","
+                << result.itemsPerSecond << "\n";
+        }
+        return out.str();
+    }
+
+    // Reads name -> real_time_ns from an earlier JSON report
+    bool loadBaseline(const std::string& path, std::map<std::string, double>& times) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        std::string text = buffer.str();
+
+        JsonReader reader(text);
+        return reader.readObject([&](std::string_view key) {
+            if (key != "benchmarks") {
+                return reader.skipValue();
+            }
+            if (reader.next() != JsonReader::Token::BEGIN_ARRAY) {
+                return false;
+            }
+            JsonReader::Token token;
+            while ((token = reader.next()) == JsonReader::Token::BEGIN_OBJECT) {
+                std::string name;
+                double realNanos = 0.0;
+                while ((token = reader.next()) == JsonReader::Token::KEY) {
+                    std::string_view member = reader.getString();
+                    bool ok = member == "name" ? reader.readString(name)
+                              : member == "real_time_ns" ? reader.readDouble(realNanos)
+                              : reader.skipValue();
+                    if (!ok) {
+                        return false;
+                    }
+                }
+                if (token != JsonReader::Token::END_OBJECT) {
+                    return false;
+                }
+                times[name] = realNanos;
+            }
+            return token == JsonReader::Token::END_ARRAY;
+        });
+    }
+
+    std::string formatComparison(const std::vector<BenchmarkResult>& results,
+                                 const std::map<std::string, double>& baseline) {
+        std::ostringstream out;
+        out << std::left << std::setw(44) << "Benchmark" << std::right << std::setw(14) << "Baseline"
+            << std::setw(14) << "Current" << std::setw(10) << "Change" << "\n";
+        for (const BenchmarkResult& result : results) {
+            auto it = baseline.find(result.name);
+            out << std::left << std::setw(44) << result.name << std::right << std::setw(14)
+                << (it == baseline.end() ? std::string("-") : formatNanos(it->second)) << std::setw(14)
+                << formatNanos(result.realNanos) << std::setw(10);
+            if (it != baseline.end() && it->second > 0.0) {
+                std::ostringstream change;
+                change << std::showpos << std::fixed << std::setprecision(1)
+                       << 100.0 * (result.realNanos - it->second) / it->second << "%";
+                out << change.str();
+            } else {
+                out << "new";
+            }
+            out << "\n";
+        }
+        return out.str();
+    }
+}
+
+// BenchmarkState
+BenchmarkState::BenchmarkState(uint64_t maxIterations, int64_t arg, uint32_t seed)
+    : m_maxIterations(maxIterations), m_iterations(0), m_arg(arg), m_seed(seed), m_started(false),
+      m_elapsed(0), m_paused(0), m_cpuStart(0), m_cpuElapsed(0), m_itemsProcessed(0) {
+}
+
+void BenchmarkState::start() {
+    m_started = true;
+    m_cpuStart = std::clock();
+    m_start = Clock::now();
+}
+
+void BenchmarkState::finish() {
+    if (m_started && m_elapsed == Clock::duration(0)) {
+        m_elapsed = Clock::now() - m_start - m_paused;
+        m_cpuElapsed = std::clock() - m_cpuStart;
+    }
+}
+
+void BenchmarkState::pauseTiming() {
+    m_pausedAt = Clock::now();
+}
+
+void BenchmarkState::resumeTiming() {
+    m_paused += Clock::now() - m_pausedAt;
+}
+
+double BenchmarkState::getElapsedNanos() const {
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(m_elapsed).count());
+}
+
+double BenchmarkState::getCpuNanos() const {
+    // std::clock() has no way to exclude paused time; CPU time includes setup
+    return m_cpuElapsed * 1.0e9 / CLOCKS_PER_SEC;
+}
+
+// Benchmark registry
+Benchmark* Benchmark::range(int64_t lo, int64_t hi, int64_t multiplier) {
+    for (int64_t value = lo; value <= hi; value *= std::max<int64_t>(2, multiplier)) {
+        m_args.push_back(value);
+    }
+    return this;
+}
+
+Benchmark* Benchmark::registerBenchmark(const std::string& name, Function function) {
+    // Registered during static initialization, so leaked rather than destroyed at exit
+    Benchmark* benchmark = new Benchmark(name, std::move(function));
+    registry().push_back(benchmark);
+    return benchmark;
+}
+
+std::vector<Benchmark*>& Benchmark::registry() {
+    static std::vector<Benchmark*> benchmarks;
+    return benchmarks;
+}
+
+// Runner
+int runBenchmarks(int argc, char** argv, const std::map<std::string, std::string>& context) {
+    Options options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    std::regex filter;
+    try {
+        filter = std::regex(options.filter.empty() ? std::string(".*") : options.filter);
+    } catch (const std::regex_error&) {
+        std::cerr << "Invalid --filter regex: " << options.filter << std::endl;
+        return 2;
+    }
+
+    std::vector<BenchmarkResult> results;
+    for (const Benchmark* benchmark : Benchmark::registry()) {
+        std::vector<int64_t> args = benchmark->getArgs();
+        bool hasArgs = !args.empty();
+        if (!hasArgs) {
+            args.push_back(0);
+        }
+        for (int64_t arg : args) {
+            std::string name = hasArgs ? benchmark->getName() + "/" + std::to_string(arg) : benchmark->getName();
+            if (!std::regex_search(name, filter)) {
+                continue;
+            }
+            if (options.listOnly) {
+                std::cout << name << "\n";
+                continue;
+            }
+            std::cerr << "Running " << name << "..." << std::endl;
+            results.push_back(runBenchmark(*benchmark, name, arg, options));
+        }
+    }
+    if (options.listOnly) {
+        return 0;
+    }
+
+    std::string report = options.format == "json" ? formatJson(results, context, options)
+                         : options.format == "csv" ? formatCsv(results)
+                         : formatConsole(results);
+    if (options.outPath.empty()) {
+        std::cout << report;
+    } else {
+        std::ofstream out(options.outPath, std::ios::binary | std::ios::trunc);
+        if (!(out << report)) {
+            std::cerr << "Could not write " << options.outPath << std::endl;
+            return 1;
+        }
+    }
+
+    if (!options.baselinePath.empty()) {
+        std::map<std::string, double> baseline;
+        if (!loadBaseline(options.baselinePath, baseline)) {
+            std::cerr << "Could not read baseline " << options.baselinePath << std::endl;
+            return 1;
+        }
+        // Keeps a JSON/CSV report on stdout machine-readable
+        bool humanOnStdout = options.format == "console" || !options.outPath.empty();
+        (humanOnStdout ? std::cout : std::cerr) << "\n" << formatComparison(results, baseline);
+    }
+    return 0;
+}
@@ -0,0 +1,138 @@
+#ifndef BENCHMARK_HARNESS_H
+#define BENCHMARK_HARNESS_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <chrono>
+#include <ctime>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Minimal Google-Benchmark-style runner for UberFavoriteDriverBench
+ *
+ * A benchmark is a function that takes a BenchmarkState and wraps its
+ * measured body in `while (state.keepRunning())`. It registers itself with
+ * BENCHMARK(fn), optionally followed by ->arg(n) or ->range(lo, hi) for
+ * one run per parameter. The runner grows the iteration count until a run
+ * lasts at least --min-time. It then repeats --repetitions times and
+ * reports the median time per iteration.
+ *
+ * Output can be a console table, JSON or CSV. Names and fields are
+ * stable, and the JSON carries no timestamps, so two runs can be diffed
+ * directly. --baseline=<json> also prints the change against an earlier
+ * run. Benchmarks seed their data from BenchmarkState::seed() so every
+ * run measures the same inputs.
+ */
+class BenchmarkState {
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    uint64_t m_maxIterations;
+    uint64_t m_iterations;
+    int64_t m_arg;
+    uint32_t m_seed;
+    bool m_started;
+    Clock::time_point m_start;
+    Clock::time_point m_pausedAt;
+    Clock::duration m_elapsed;
+    Clock::duration m_paused;
+    std::clock_t m_cpuStart;
+    std::clock_t m_cpuElapsed;
+    uint64_t m_itemsProcessed;
+    std::map<std::string, double> m_counters;
+
+public:
+    BenchmarkState(uint64_t maxIterations, int64_t arg, uint32_t seed);
+
+    // Loop condition for the measured body; the clock starts on the first call
+    bool keepRunning() {
+        if (m_iterations < m_maxIterations) {
+            if (!m_started) {
+                start();
+            }
+            ++m_iterations;
+            return true;
+        }
+        finish();
+        return false;
+    }
+
+    // Excludes per-iteration setup from the measurement
+    void pauseTiming();
+    void resumeTiming();
+
+    int64_t arg() const { return m_arg; }
+    uint32_t seed() const { return m_seed; }
+    uint64_t iterations() const { return m_iterations; }
+
+    // Reported as items_per_second
+    void setItemsProcessed(uint64_t items) { m_itemsProcessed = items; }
+    // Free-form values (e.g. allocations per op); reported as-is
+    void setCounter(const std::string& name, double value) { m_counters[name] = value; }
+
+    double getElapsedNanos() const;
+    double getCpuNanos() const;
+    uint64_t getItemsProcessed() const { return m_itemsProcessed; }
+    const std::map<std::string, double>& getCounters() const { return m_counters; }
+
+private:
+    void start();
+    void finish();
+};
+
+class Benchmark {
+public:
+    using Function = std::function<void(BenchmarkState&)>;
+
+private:
+    std::string m_name;
+    Function m_function;
+    std::vector<int64_t> m_args;
+
+public:
+    Benchmark(std::string name, Function function) : m_name(std::move(name)), m_function(std::move(function)) {}
+
+    // One run per argument; chainable after BENCHMARK()
+    Benchmark* arg(int64_t value) {
+        m_args.push_back(value);
+        return this;
+    }
+    // lo, lo * multiplier, ... up to and including hi
+    Benchmark* range(int64_t lo, int64_t hi, int64_t multiplier = 10);
+
+    const std::string& getName() const { return m_name; }
+    const Function& getFunction() const { return m_function; }
+    const std::vector<int64_t>& getArgs() const { return m_args; }
+
+    static Benchmark* registerBenchmark(const std::string& name, Function function);
+    static std::vector<Benchmark*>& registry();
+};
+
+struct BenchmarkResult {
+    std::string name; // "Function/arg", or "Function" when there are no arguments
+    int64_t arg = 0;
+    uint64_t iterations = 0;
+    size_t repetitions = 0;
+    double realNanos = 0.0;   // Median per iteration
+    double cpuNanos = 0.0;    // Median per iteration
+    double stddevNanos = 0.0; // Across repetitions
+    double itemsPerSecond = 0.0;
+    std::map<std::string, double> counters;
+};
+
+// Parses the command line, runs the selected benchmarks and writes the report;
+// `context` (build flags, instruction set, ...) is copied into the JSON header.
+// Returns the process exit code.
+int runBenchmarks(int argc, char** argv, const std::map<std::string, std::string>& context);
+
+#define BENCHMARK_CONCAT_INNER(a, b) a##b
+#define BENCHMARK_CONCAT(a, b) BENCHMARK_CONCAT_INNER(a, b)
+#define BENCHMARK(function)                                                   \
+    static Benchmark* BENCHMARK_CONCAT(benchmark_, __LINE__) [[maybe_unused]] = \
+        Benchmark::registerBenchmark(#function, function)
+
+#endif // BENCHMARK_HARNESS_H
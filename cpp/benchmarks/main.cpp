@@ -0,0 +1,1449 @@
+#include "BenchmarkHarness.h"
+#include "Driver.h"
+#include "FavoriteDriverManager.h"
+#include "RideRequest.h"
+#include "RideRequestPool.h"
+#include "SpatialIndex.h"
+#include "DistanceKernel.h"
+#include "MetricsRegistry.h"
+#include "ShardedMap.h"
+#include "DriverPositionStore.h"
+#include "BinarySnapshot.h"
+#include "WriteAheadLog.h"
+#include "JsonWriter.h"
+#include "JsonReader.h"
+#include "IdInterner.h"
+#include "SmallSortedSet.h"
+#include "FavoriteReverseIndex.h"
+#include "SpeedGridEtaProvider.h"
+#include "EtaCache.h"
+#include "RequestIdGenerator.h"
+#include "AssignmentSolver.h"
+#include "PriorityScoreCache.h"
+#include "NotificationPipeline.h"
+#include <random>
+#include <vector>
+#include <memory>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+#include <cstdio>
+
+namespace {
+    // San Francisco, roughly 13 x 13 km
+    constexpr double MIN_LATITUDE = 37.70;
+    constexpr double MAX_LATITUDE = 37.82;
+    constexpr double MIN_LONGITUDE = -122.52;
+    constexpr double MAX_LONGITUDE = -122.37;
+    constexpr double SEARCH_RADIUS_KM = 3.0;
+    constexpr int OPS_PER_THREAD = 10000; // Per thread per iteration in the concurrency benchmarks
+
+    Driver::Location randomLocation(std::mt19937& rng) {
+        std::uniform_real_distribution<double> latitude(MIN_LATITUDE, MAX_LATITUDE);
+        std::uniform_real_distribution<double> longitude(MIN_LONGITUDE, MAX_LONGITUDE);
+        return Driver::Location(latitude(rng), longitude(rng));
+    }
+
+    // Online drivers spread uniformly over the city; identical for a given seed
+    std::vector<std::shared_ptr<Driver>> makeFleet(size_t count, uint32_t seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> rating(4.0, 5.0);
+        std::vector<std::shared_ptr<Driver>> fleet;
+        fleet.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            auto driver = std::make_shared<Driver>("driver_" + std::to_string(i), "Driver " + std::to_string(i),
+                                                   "+1555" + std::to_string(1000000 + i));
+            Driver::Location location = randomLocation(rng);
+            driver->updateLocation(location.latitude, location.longitude);
+            driver->setRating(rating(rng));
+            driver->goOnline();
+            fleet.push_back(driver);
+        }
+        return fleet;
+    }
+
+    std::vector<Driver::Location> makeQueries(size_t count, uint32_t seed) {
+        std::mt19937 rng(seed ^ 0x9E3779B9u);
+        std::vector<Driver::Location> queries;
+        for (size_t i = 0; i < count; ++i) {
+            queries.push_back(randomLocation(rng));
+        }
+        return queries;
+    }
+
+    // Structure-of-arrays columns, as DriverPositionStore keeps them
+    struct PositionColumns {
+        std::vector<double> latitudes;
+        std::vector<double> longitudes;
+        std::vector<double> cosLatitudes;
+
+        explicit PositionColumns(const std::vector<Driver::Location>& points) {
+            for (const Driver::Location& point : points) {
+                latitudes.push_back(point.latitude);
+                longitudes.push_back(point.longitude);
+                cosLatitudes.push_back(std::cos(point.latitude * M_PI / 180.0));
+            }
+        }
+        size_t size() const { return latitudes.size(); }
+    };
+
+    // Runs body(thread) on `threads` threads and waits for all of them
+    template <typename Body>
+    void runOnThreads(int threads, Body&& body) {
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&body, t]() { body(t); });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    // Production-style IDs (UUID length), long enough to defeat the small-string buffer
+    std::string uuidDriverId(size_t i) { return "drv-" + std::to_string(10000000 + i) + "-4c1a-9f3e-5b7d2e8a0c6f"; }
+    std::string uuidUserId(size_t i) { return "usr-" + std::to_string(10000000 + i) + "-8d2b-4e6f-a1c3-7f9e0b5d"; }
+
+    // Up to 10 favorites per user in forward sets plus the reverse index built from them
+    struct FavoriteGraph {
+        std::unordered_map<uint32_t, SmallSortedSet<uint32_t, 10>> forward;
+        FavoriteReverseIndex reverse;
+
+        FavoriteGraph(uint32_t users, uint32_t drivers, uint32_t seed) {
+            std::mt19937 rng(seed);
+            for (uint32_t user = 0; user < users; ++user) {
+                for (int k = 0; k < 10; ++k) {
+                    uint32_t driver = rng() % drivers;
+                    if (forward[user].insert(driver)) {
+                        reverse.add(user, driver);
+                    }
+                }
+            }
+        }
+    };
+
+    // Favorite add/remove churn on the reverse index and leaderboard, serialized
+    // behind one lock as a single global leaderboard lock did, and sharded
+    void runFavoriteIndexChurn(BenchmarkState& state, std::mutex* globalLock) {
+        const uint32_t users = 20000, drivers = 5000;
+        int threads = static_cast<int>(state.arg());
+        FavoriteReverseIndex index;
+        while (state.keepRunning()) {
+            runOnThreads(threads, [&](int t) {
+                std::mt19937 rng(state.seed() + t);
+                for (int i = 0; i < OPS_PER_THREAD; ++i) {
+                    uint32_t user = rng() % users, driver = rng() % drivers;
+                    std::unique_lock<std::mutex> lock;
+                    if (globalLock) {
+                        lock = std::unique_lock<std::mutex>(*globalLock);
+                    }
+                    if (!index.add(user, driver)) {
+                        index.remove(user, driver);
+                    }
+                }
+            });
+        }
+        state.setItemsProcessed(state.iterations() * threads * OPS_PER_THREAD);
+        state.setCounter("edges", static_cast<double>(index.getEdgeCount()));
+    }
+
+    // The ostringstream serializer Driver::toJson used before JsonWriter
+    std::string legacyDriverJson(const Driver& driver) {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(6);
+        oss << "{\n";
+        oss << "  \"id\": \"" << driver.getId() << "\",\n";
+        oss << "  \"name\": \"" << driver.getName() << "\",\n";
+        oss << "  \"phoneNumber\": \"" << driver.getPhoneNumber() << "\",\n";
+        oss << "  \"email\": \"" << driver.getEmail() << "\",\n";
+        oss << "  \"profilePhoto\": \"" << driver.getProfilePhoto() << "\",\n";
+        oss << "  \"rating\": " << driver.getRating() << ",\n";
+        oss << "  \"completedTrips\": " << driver.getCompletedTrips() << ",\n";
+        oss << "  \"status\": \"" << driver.getStatusString() << "\",\n";
+        oss << "  \"currentLocation\": {\n";
+        oss << "    \"latitude\": " << driver.getCurrentLocation().latitude << ",\n";
+        oss << "    \"longitude\": " << driver.getCurrentLocation().longitude << "\n";
+        oss << "  },\n";
+        oss << "  \"vehicle\": {\n";
+        oss << "    \"make\": \"" << driver.getVehicle().make << "\",\n";
+        oss << "    \"model\": \"" << driver.getVehicle().model << "\",\n";
+        oss << "    \"color\": \"" << driver.getVehicle().color << "\",\n";
+        oss << "    \"plateNumber\": \"" << driver.getVehicle().plateNumber << "\",\n";
+        oss << "    \"year\": " << driver.getVehicle().year << "\n";
+        oss << "  },\n";
+        oss << "  \"isVerified\": " << (driver.isVerified() ? "true" : "false") << "\n";
+        oss << "}";
+        return oss.str();
+    }
+
+    // Substring-search parsing of the legacy format, the usual hand-rolled fromJson
+    Driver legacyDriverFromJson(const std::string& json) {
+        auto stringField = [&json](const std::string& name) {
+            size_t start = json.find("\"" + name + "\": \"") + name.size() + 5;
+            return json.substr(start, json.find('"', start) - start);
+        };
+        auto numberField = [&json](const std::string& name) {
+            return std::stod(json.substr(json.find("\"" + name + "\": ") + name.size() + 4));
+        };
+        Driver driver(stringField("id"), stringField("name"), stringField("phoneNumber"));
+        driver.setEmail(stringField("email"));
+        driver.setRating(numberField("rating"));
+        driver.setCompletedTrips(static_cast<int>(numberField("completedTrips")));
+        driver.setVehicle(Driver::Vehicle(stringField("make"), stringField("model"), stringField("color"),
+                                          stringField("plateNumber"), static_cast<int>(numberField("year"))));
+        driver.setCurrentLocation(Driver::Location(numberField("latitude"), numberField("longitude")));
+        return driver;
+    }
+
+    // Fully populated drivers for the JSON benchmarks
+    std::vector<Driver> makeJsonDrivers(size_t count, uint32_t seed) {
+        std::mt19937 rng(seed);
+        std::vector<Driver> drivers;
+        for (size_t i = 0; i < count; ++i) {
+            Driver driver("driver_" + std::to_string(i), "Driver " + std::to_string(i),
+                          "+1555" + std::to_string(1000000 + i));
+            driver.setEmail("driver" + std::to_string(i) + "@example.com");
+            driver.setRating(4.0 + (rng() % 1000) / 1000.0);
+            driver.setVehicle(Driver::Vehicle("Toyota", "Camry", "Silver", "P-" + std::to_string(i), 2020));
+            driver.updateLocation(37.0 + (rng() % 100000) / 100000.0, -122.0 - (rng() % 100000) / 100000.0);
+            drivers.push_back(driver);
+        }
+        return drivers;
+    }
+
+    // One user per driver, each with 10 favorites
+    std::vector<BinarySnapshot::FavoriteList> makeSnapshotFavorites(size_t drivers, uint32_t seed) {
+        std::mt19937 rng(seed);
+        std::vector<BinarySnapshot::FavoriteList> favorites(drivers);
+        for (size_t user = 0; user < drivers; ++user) {
+            favorites[user].first = "user_" + std::to_string(user);
+            for (int k = 0; k < 10; ++k) {
+                favorites[user].second.push_back("driver_" + std::to_string(rng() % drivers));
+            }
+        }
+        return favorites;
+    }
+
+    // 200x200 cells of ~250 m over San Francisco with rush-hour dips
+    bool writeSpeedGrid(const std::string& filename, uint32_t seed) {
+        SpeedGridEtaProvider::GridSpec spec{37.60, -122.60, 0.0025, 200, 200, -480};
+        std::vector<float> speeds(SpeedGridEtaProvider::HOURS_PER_DAY * 200 * 200);
+        std::mt19937 rng(seed);
+        for (uint32_t hour = 0; hour < SpeedGridEtaProvider::HOURS_PER_DAY; ++hour) {
+            float peak = (hour >= 7 && hour <= 9) || (hour >= 16 && hour <= 18) ? 0.5f : 1.0f;
+            for (uint32_t cell = 0; cell < 200 * 200; ++cell) {
+                speeds[hour * 200 * 200 + cell] = peak * (15.0f + rng() % 50);
+            }
+        }
+        return SpeedGridEtaProvider::write(filename, spec, speeds);
+    }
+
+    // The manager's location wiring: a driver map, the grid and the SoA store
+    // behind one lock, plus three pings per driver in random order
+    struct GpsFleet {
+        std::shared_mutex indexMutex;
+        SpatialIndex spatialIndex;
+        DriverPositionStore positionStore;
+        std::unordered_map<std::string, std::shared_ptr<Driver>> drivers;
+        std::vector<Driver::LocationUpdate> pings;
+
+        GpsFleet(size_t count, uint32_t seed) {
+            std::mt19937 rng(seed);
+            for (const auto& driver : makeFleet(count, seed)) {
+                spatialIndex.insert(driver);
+                positionStore.add(*driver);
+                driver->setLocationListener([this](const Driver& moved) {
+                    std::unique_lock<std::shared_mutex> lock(indexMutex);
+                    spatialIndex.update(moved);
+                    positionStore.updateLocation(moved.getId(), moved.getCurrentLocation().latitude,
+                                                 moved.getCurrentLocation().longitude);
+                });
+                drivers.emplace(driver->getId(), driver);
+            }
+            for (size_t i = 0; i < 3 * count; ++i) {
+                Driver::Location location = randomLocation(rng);
+                pings.push_back({"driver_" + std::to_string(rng() % count), location.latitude, location.longitude, {}});
+            }
+        }
+    };
+
+#if defined(FAVORITE_DRIVER_MANAGER_BENCHMARKS)
+    // A manager holding `drivers` online drivers and `users` riders with
+    // `favoritesPerUser` favorites each, picked from drivers near the rider's home
+    struct City {
+        FavoriteDriverManager manager;
+        std::vector<std::shared_ptr<Driver>> fleet;
+        std::vector<std::string> users;
+        std::vector<Driver::Location> homes;
+
+        City(size_t drivers, size_t userCount, size_t favoritesPerUser, uint32_t seed) : fleet(makeFleet(drivers, seed)) {
+            for (const auto& driver : fleet) {
+                manager.addDriver(driver);
+            }
+            std::mt19937 rng(seed + 1);
+            homes = makeQueries(userCount, seed + 2);
+            for (size_t i = 0; i < userCount; ++i) {
+                users.push_back("user_" + std::to_string(i));
+                std::vector<std::shared_ptr<Driver>> nearby = manager.getNearbyDrivers(homes[i], SEARCH_RADIUS_KM);
+                for (size_t f = 0; f < favoritesPerUser && !nearby.empty(); ++f) {
+                    manager.addFavoriteDriver(users[i], nearby[rng() % nearby.size()]->getId());
+                }
+            }
+        }
+    };
+#endif
+
+    // 200 riders around 20 hotspots of 500 drivers; each request ranks 200 of its hotspot's
+    // drivers three times (any-favorite, preference sort, distance filter)
+    struct EtaWorkload {
+        struct Request {
+            Driver::Location pickup;
+            std::vector<EtaCache::Handle> candidates;
+        };
+        std::vector<Driver::Location> drivers;
+        std::vector<Request> requests;
+
+        explicit EtaWorkload(uint32_t seed) {
+            const int hotspots = 20, driversPerHotspot = 500, riders = 200, candidates = 200;
+            std::mt19937 rng(seed);
+            std::uniform_int_distribution<int> spread(-1000, 1000), jitter(-50, 50); // 1e-5 degree steps
+            std::vector<Driver::Location> centers;
+            for (int h = 0; h < hotspots; ++h) {
+                centers.emplace_back(37.65 + (rng() % 30000) / 100000.0, -122.55 + (rng() % 30000) / 100000.0);
+                for (int d = 0; d < driversPerHotspot; ++d) {
+                    drivers.emplace_back(centers.back().latitude + spread(rng) / 100000.0,
+                                         centers.back().longitude + spread(rng) / 100000.0);
+                }
+            }
+            for (int r = 0; r < riders; ++r) {
+                int h = rng() % hotspots;
+                Request request{Driver::Location(centers[h].latitude + jitter(rng) / 100000.0,
+                                                 centers[h].longitude + jitter(rng) / 100000.0), {}};
+                for (int c = 0; c < candidates; ++c) {
+                    request.candidates.push_back(h * driversPerHotspot + rng() % driversPerHotspot);
+                }
+                requests.push_back(std::move(request));
+            }
+        }
+        uint64_t lookups() const { return requests.size() * requests[0].candidates.size() * PASSES; }
+
+        static constexpr int PASSES = 3;
+    };
+
+    // Top 5 of 10 favorites + 500 nearby drivers, over 64 users and rotating distances
+    struct RankingWorkload {
+        using Handle = PriorityScoreCache::Handle;
+        static constexpr size_t LIMIT = 5;
+        static constexpr Handle USERS = 64;
+
+        std::vector<std::shared_ptr<Driver>> drivers;
+        std::vector<Handle> handles;
+        std::unordered_map<std::string, double> acceptanceRates;
+        std::vector<SmallSortedSet<Handle, 10>> favorites;
+        std::vector<std::vector<double>> distances;
+
+        explicit RankingWorkload(uint32_t seed) : favorites(USERS), distances(97) {
+            const int nearbyCount = 500, favoriteCount = 10;
+            std::mt19937 rng(seed);
+            std::uniform_real_distribution<double> rating(3.5, 5.0);
+            std::uniform_real_distribution<double> acceptance(0.5, 1.0);
+            std::uniform_real_distribution<double> distance(0.0, 5.0);
+            for (int i = 0; i < nearbyCount + favoriteCount; ++i) {
+                auto driver = std::make_shared<Driver>("driver_" + std::to_string(i), "Driver", "+1000000000");
+                driver->setRating(rating(rng));
+                acceptanceRates[driver->getId()] = acceptance(rng);
+                drivers.push_back(driver);
+                handles.push_back(static_cast<Handle>(i));
+            }
+            for (auto& set : favorites) {
+                for (int i = 0; i < favoriteCount; ++i) {
+                    set.insert(static_cast<Handle>(nearbyCount + i));
+                }
+            }
+            for (auto& round : distances) {
+                round.resize(drivers.size());
+                for (double& km : round) {
+                    km = distance(rng);
+                }
+            }
+        }
+
+        // Favorite bonus, rating and acceptance: what the per-request path reads
+        double staticScore(Handle user, size_t i) const {
+            const Driver& driver = *drivers[i];
+            double score = favorites[user].contains(handles[i]) ? 1000.0 : 0.0;
+            score += driver.getRating() * 100.0;
+            score += acceptanceRates.find(driver.getId())->second * 50.0;
+            return score;
+        }
+    };
+
+    using NotifyFunction = std::function<void(const std::string&, const std::string&)>;
+
+    // A push gateway taking ~200 us a message
+    void slowSend(const std::string&, const std::string&) {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+
+    // Per-request latencies in microseconds, sorted
+    std::vector<double> runNotifyingRequests(const NotifyFunction& notify) {
+        const int threads = 4, requestsPerThread = 250;
+        using Clock = std::chrono::steady_clock;
+        std::mutex stateMutex;
+        std::unordered_map<std::string, int> rides;
+        std::vector<std::vector<double>> latencies(threads);
+        runOnThreads(threads, [&](int t) {
+            for (int i = 0; i < requestsPerThread; ++i) {
+                std::string rider = "rider_" + std::to_string(t * requestsPerThread + i);
+                std::string driver = "driver_" + std::to_string(i % 40);
+                auto start = Clock::now();
+                {
+                    std::lock_guard<std::mutex> lock(stateMutex);
+                    rides[driver]++;
+                    notify(rider, "Your driver is on the way");
+                    notify(driver, "New ride for " + rider);
+                }
+                latencies[t].push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+            }
+        });
+        std::vector<double> all;
+        for (const auto& perThread : latencies) {
+            all.insert(all.end(), perThread.begin(), perThread.end());
+        }
+        std::sort(all.begin(), all.end());
+        return all;
+    }
+
+    void setLatencyCounters(BenchmarkState& state, const std::vector<double>& latencies) {
+        state.setItemsProcessed(state.iterations() * latencies.size());
+        state.setCounter("p50_us", latencies[latencies.size() / 2]);
+        state.setCounter("p99_us", latencies[latencies.size() * 99 / 100]);
+    }
+}
+
+// Micro: distance
+
+void DistanceHaversine(BenchmarkState& state) {
+    std::vector<Driver::Location> points = makeQueries(static_cast<size_t>(state.arg()), state.seed());
+    Driver::Location origin(37.7749, -122.4194);
+    double total = 0.0;
+    while (state.keepRunning()) {
+        for (const Driver::Location& point : points) {
+            total += DistanceKernel::haversine(origin, point);
+        }
+    }
+    state.setItemsProcessed(state.iterations() * points.size());
+    state.setCounter("checksum_km", std::floor(total / std::max<uint64_t>(1, state.iterations())));
+}
+BENCHMARK(DistanceHaversine)->arg(1000)->arg(100000);
+
+// Vector kernel over every point, no prefilter
+void DistanceHaversineBatch(BenchmarkState& state) {
+    PositionColumns columns(makeQueries(static_cast<size_t>(state.arg()), state.seed()));
+    Driver::Location origin(37.7749, -122.4194);
+    std::vector<double> distances(columns.size());
+    while (state.keepRunning()) {
+        DistanceKernel::haversineBatch(origin, columns.latitudes.data(), columns.longitudes.data(),
+                                       columns.cosLatitudes.data(), columns.size(), distances.data());
+    }
+    state.setItemsProcessed(state.iterations() * columns.size());
+}
+BENCHMARK(DistanceHaversineBatch)->arg(1000)->arg(100000);
+
+void DistanceFilterWithinDistance(BenchmarkState& state) {
+    PositionColumns columns(makeQueries(static_cast<size_t>(state.arg()), state.seed()));
+    Driver::Location origin(37.7749, -122.4194);
+    std::vector<uint32_t> indexes;
+    std::vector<double> distances;
+    while (state.keepRunning()) {
+        DistanceKernel::filterWithinDistance(origin, columns.latitudes.data(), columns.longitudes.data(),
+                                             columns.cosLatitudes.data(), columns.size(), SEARCH_RADIUS_KM,
+                                             indexes, distances);
+    }
+    state.setItemsProcessed(state.iterations() * columns.size());
+    state.setCounter("matches", static_cast<double>(indexes.size()));
+}
+BENCHMARK(DistanceFilterWithinDistance)->arg(1000)->arg(100000);
+
+// Micro: nearby drivers
+
+void SpatialIndexQueryRadius(BenchmarkState& state) {
+    std::vector<std::shared_ptr<Driver>> fleet = makeFleet(static_cast<size_t>(state.arg()), state.seed());
+    SpatialIndex index;
+    for (const auto& driver : fleet) {
+        index.insert(driver);
+    }
+    std::vector<Driver::Location> queries = makeQueries(1024, state.seed());
+    size_t found = 0;
+    size_t next = 0;
+    while (state.keepRunning()) {
+        found += index.queryRadius(queries[next++ & 1023], SEARCH_RADIUS_KM).size();
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setCounter("drivers_per_query", static_cast<double>(found) / std::max<uint64_t>(1, state.iterations()));
+}
+BENCHMARK(SpatialIndexQueryRadius)->range(1000, 100000);
+
+// What getNearbyDrivers did before the grid
+void SpatialIndexLinearScan(BenchmarkState& state) {
+    std::vector<std::shared_ptr<Driver>> fleet = makeFleet(static_cast<size_t>(state.arg()), state.seed());
+    std::vector<Driver::Location> queries = makeQueries(1024, state.seed());
+    size_t found = 0;
+    size_t next = 0;
+    while (state.keepRunning()) {
+        const Driver::Location& query = queries[next++ & 1023];
+        for (const auto& driver : fleet) {
+            found += driver->calculateDistanceFrom(query) <= SEARCH_RADIUS_KM;
+        }
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setCounter("drivers_per_query", static_cast<double>(found) / std::max<uint64_t>(1, state.iterations()));
+}
+BENCHMARK(SpatialIndexLinearScan)->range(1000, 100000);
+
+void SpatialIndexFindNearestAvailable(BenchmarkState& state) {
+    std::vector<std::shared_ptr<Driver>> fleet = makeFleet(static_cast<size_t>(state.arg()), state.seed());
+    SpatialIndex index;
+    for (const auto& driver : fleet) {
+        index.insert(driver);
+    }
+    std::vector<Driver::Location> queries = makeQueries(1024, state.seed());
+    size_t found = 0;
+    size_t next = 0;
+    while (state.keepRunning()) {
+        found += index.findNearestAvailable(queries[next++ & 1023], 10, 15.0).size();
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setCounter("drivers_per_query", static_cast<double>(found) / std::max<uint64_t>(1, state.iterations()));
+}
+BENCHMARK(SpatialIndexFindNearestAvailable)->range(1000, 100000);
+
+#if defined(FAVORITE_DRIVER_MANAGER_BENCHMARKS)
+void ManagerGetNearbyDrivers(BenchmarkState& state) {
+    City city(static_cast<size_t>(state.arg()), 0, 0, state.seed());
+    std::vector<Driver::Location> queries = makeQueries(1024, state.seed());
+    size_t found = 0;
+    size_t next = 0;
+    while (state.keepRunning()) {
+        found += city.manager.getNearbyDrivers(queries[next++ & 1023], SEARCH_RADIUS_KM).size();
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setCounter("drivers_per_query", static_cast<double>(found) / std::max<uint64_t>(1, state.iterations()));
+}
+BENCHMARK(ManagerGetNearbyDrivers)->range(1000, 100000);
+#endif
+
+// Micro: favorites
+
+#if defined(FAVORITE_DRIVER_MANAGER_BENCHMARKS)
+void FavoriteAddRemove(BenchmarkState& state) {
+    City city(10000, 1000, 0, state.seed());
+    std::mt19937 rng(state.seed());
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for (size_t i = 0; i < 4096; ++i) {
+        pairs.emplace_back(rng() % city.users.size(), rng() % city.fleet.size());
+    }
+    size_t next = 0;
+    while (state.keepRunning()) {
+        const auto& pair = pairs[next++ & 4095];
+        const std::string& driverId = city.fleet[pair.second]->getId();
+        city.manager.addFavoriteDriver(city.users[pair.first], driverId);
+        city.manager.removeFavoriteDriver(city.users[pair.first], driverId);
+    }
+    state.setItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(FavoriteAddRemove);
+
+void FavoriteLookup(BenchmarkState& state) {
+    City city(10000, 1000, 10, state.seed());
+    std::mt19937 rng(state.seed());
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for (size_t i = 0; i < 4096; ++i) {
+        pairs.emplace_back(rng() % city.users.size(), rng() % city.fleet.size());
+    }
+    size_t hits = 0;
+    size_t next = 0;
+    while (state.keepRunning()) {
+        const auto& pair = pairs[next++ & 4095];
+        hits += city.manager.isFavoriteDriver(city.users[pair.first], city.fleet[pair.second]->getId());
+        hits += city.manager.getAvailableFavoriteDrivers(city.users[pair.first]).size();
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setCounter("hits_per_op", static_cast<double>(hits) / std::max<uint64_t>(1, state.iterations()));
+}
+BENCHMARK(FavoriteLookup);
+#endif
+
+// isFavoriteDriver plus resolving the user's favorites to drivers, with string
+// IDs in node-based sets (before interning) and with interned handles
+
+void FavoriteSetStringKeys(BenchmarkState& state) {
+    size_t users = static_cast<size_t>(state.arg());
+    std::mt19937 rng(state.seed());
+    std::unordered_map<std::string, std::unordered_set<std::string>> favorites;
+    for (size_t user = 0; user < users; ++user) {
+        for (int k = 0; k < 10; ++k) {
+            favorites[uuidUserId(user)].insert(uuidDriverId(rng() % users));
+        }
+    }
+    std::unordered_map<std::string, std::shared_ptr<Driver>> driversById;
+    auto sharedDriver = std::make_shared<Driver>();
+    for (size_t driver = 0; driver < users; ++driver) {
+        driversById.emplace(uuidDriverId(driver), sharedDriver);
+    }
+    std::vector<std::pair<std::string, std::string>> queries;
+    for (size_t i = 0; i < 1024; ++i) {
+        queries.emplace_back(uuidUserId(rng() % users), uuidDriverId(rng() % users));
+    }
+    size_t hits = 0;
+    size_t next = 0;
+    while (state.keepRunning()) {
+        const auto& query = queries[next++ & 1023];
+        auto it = favorites.find(query.first);
+        hits += it->second.count(query.second);
+        for (const std::string& driverId : it->second) {
+            hits += driversById.count(driverId);
+        }
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setCounter("hits_per_op", static_cast<double>(hits) / std::max<uint64_t>(1, state.iterations()));
+}
+BENCHMARK(FavoriteSetStringKeys)->arg(10000)->arg(100000);
+
+void FavoriteSetInterned(BenchmarkState& state) {
+    size_t users = static_cast<size_t>(state.arg());
+    std::mt19937 rng(state.seed());
+    IdInterner userIds, driverIds;
+    for (size_t driver = 0; driver < users; ++driver) {
+        driverIds.intern(uuidDriverId(driver));
+    }
+    std::unordered_map<uint32_t, std::unordered_set<uint32_t>> favorites;
+    for (size_t user = 0; user < users; ++user) {
+        for (int k = 0; k < 10; ++k) {
+            favorites[userIds.intern(uuidUserId(user))].insert(static_cast<uint32_t>(rng() % users));
+        }
+    }
+    std::unordered_map<uint32_t, std::shared_ptr<Driver>> driversByHandle;
+    auto sharedDriver = std::make_shared<Driver>();
+    for (size_t driver = 0; driver < users; ++driver) {
+        driversByHandle.emplace(static_cast<uint32_t>(driver), sharedDriver);
+    }
+    std::vector<std::pair<std::string, std::string>> queries;
+    for (size_t i = 0; i < 1024; ++i) {
+        queries.emplace_back(uuidUserId(rng() % users), uuidDriverId(rng() % users));
+    }
+    size_t hits = 0;
+    size_t next = 0;
+    while (state.keepRunning()) {
+        const auto& query = queries[next++ & 1023];
+        auto it = favorites.find(userIds.find(query.first));
+        hits += it->second.count(driverIds.find(query.second));
+        for (uint32_t handle : it->second) {
+            hits += driversByHandle.count(handle);
+        }
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setCounter("hits_per_op", static_cast<double>(hits) / std::max<uint64_t>(1, state.iterations()));
+}
+BENCHMARK(FavoriteSetInterned)->arg(10000)->arg(100000);
+
+// Top 10 most favorited: recount every forward set, or read the leaderboard
+
+void PopularityTopScan(BenchmarkState& state) {
+    uint32_t users = static_cast<uint32_t>(state.arg());
+    FavoriteGraph graph(users, users / 4, state.seed());
+    size_t leader = 0;
+    while (state.keepRunning()) {
+        std::unordered_map<uint32_t, size_t> counts;
+        for (const auto& entry : graph.forward) {
+            for (uint32_t driver : entry.second) {
+                ++counts[driver];
+            }
+        }
+        std::vector<std::pair<uint32_t, size_t>> top(counts.begin(), counts.end());
+        std::partial_sort(top.begin(), top.begin() + 10, top.end(), [](const auto& a, const auto& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+        leader = top[0].second;
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setCounter("leader_favorites", static_cast<double>(leader));
+}
+BENCHMARK(PopularityTopScan)->arg(20000)->arg(200000);
+
+void PopularityTopIndex(BenchmarkState& state) {
+    uint32_t users = static_cast<uint32_t>(state.arg());
+    FavoriteGraph graph(users, users / 4, state.seed());
+    size_t leader = 0;
+    while (state.keepRunning()) {
+        leader = graph.reverse.getMostFavorited(10)[0].second;
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setCounter("leader_favorites", static_cast<double>(leader));
+}
+BENCHMARK(PopularityTopIndex)->arg(20000)->arg(200000);
+
+// "Favorite driver is online" fan-out for one driver
+
+void FollowerFanoutScan(BenchmarkState& state) {
+    uint32_t users = static_cast<uint32_t>(state.arg());
+    FavoriteGraph graph(users, users / 4, state.seed());
+    size_t notified = 0;
+    uint32_t driver = 0;
+    while (state.keepRunning()) {
+        for (const auto& entry : graph.forward) {
+            notified += entry.second.contains(driver);
+        }
+        driver = (driver + 1) % 64;
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setCounter("followers", static_cast<double>(notified) / std::max<uint64_t>(1, state.iterations()));
+}
+BENCHMARK(FollowerFanoutScan)->arg(20000)->arg(200000);
+
+void FollowerFanoutIndex(BenchmarkState& state) {
+    uint32_t users = static_cast<uint32_t>(state.arg());
+    FavoriteGraph graph(users, users / 4, state.seed());
+    size_t notified = 0;
+    uint32_t driver = 0;
+    while (state.keepRunning()) {
+        graph.reverse.forEachFollower(driver, [&notified](uint32_t) { ++notified; });
+        driver = (driver + 1) % 64;
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setCounter("followers", static_cast<double>(notified) / std::max<uint64_t>(1, state.iterations()));
+}
+BENCHMARK(FollowerFanoutIndex)->arg(20000)->arg(200000);
+
+// One favorite toggled, keeping the reverse index and leaderboard in step
+void PopularityLeaderboardChurn(BenchmarkState& state) {
+    uint32_t users = static_cast<uint32_t>(state.arg());
+    FavoriteGraph graph(users, users / 4, state.seed());
+    std::mt19937 rng(state.seed());
+    while (state.keepRunning()) {
+        uint32_t user = rng() % users, driver = rng() % (users / 4);
+        if (!graph.reverse.add(user, driver)) {
+            graph.reverse.remove(user, driver);
+        }
+    }
+    state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(PopularityLeaderboardChurn)->arg(20000)->arg(200000);
+
+// Micro: concurrency. The argument is the thread count; each iteration runs
+// every thread through its share of operations
+
+// 90% reads on 10k users' favorite sets: one map behind one mutex, as
+// FavoriteDriverManager used to be, against ShardedMap
+void FavoriteMapSingleMutex(BenchmarkState& state) {
+    int threads = static_cast<int>(state.arg());
+    std::vector<std::string> keys;
+    std::unordered_map<std::string, std::unordered_set<std::string>> map;
+    std::mutex mutex;
+    for (int i = 0; i < 10000; ++i) {
+        keys.push_back("user_" + std::to_string(i));
+        map[keys.back()] = {"driver_1", "driver_2"};
+    }
+    std::atomic<size_t> hits{0};
+    while (state.keepRunning()) {
+        runOnThreads(threads, [&](int t) {
+            std::mt19937 rng(state.seed() + t);
+            size_t found = 0;
+            for (int i = 0; i < OPS_PER_THREAD; ++i) {
+                const std::string& key = keys[rng() % keys.size()];
+                std::lock_guard<std::mutex> lock(mutex);
+                if (rng() % 10 == 0) {
+                    map[key].insert("driver_3");
+                } else {
+                    found += map[key].count("driver_1");
+                }
+            }
+            hits += found;
+        });
+    }
+    state.setItemsProcessed(state.iterations() * threads * OPS_PER_THREAD);
+}
+BENCHMARK(FavoriteMapSingleMutex)->arg(1)->arg(2)->arg(4)->arg(8)->arg(16);
+
+void FavoriteMapSharded(BenchmarkState& state) {
+    int threads = static_cast<int>(state.arg());
+    std::vector<std::string> keys;
+    ShardedMap<std::string, std::unordered_set<std::string>> map;
+    for (int i = 0; i < 10000; ++i) {
+        keys.push_back("user_" + std::to_string(i));
+        map.insert(keys.back(), {"driver_1", "driver_2"});
+    }
+    std::atomic<size_t> hits{0};
+    while (state.keepRunning()) {
+        runOnThreads(threads, [&](int t) {
+            std::mt19937 rng(state.seed() + t);
+            size_t found = 0;
+            for (int i = 0; i < OPS_PER_THREAD; ++i) {
+                const std::string& key = keys[rng() % keys.size()];
+                if (rng() % 10 == 0) {
+                    map.upsert(key, [](std::unordered_set<std::string>& set) { set.insert("driver_3"); });
+                } else {
+                    map.read(key, [&found](const std::unordered_set<std::string>& set) { found += set.count("driver_1"); });
+                }
+            }
+            hits += found;
+        });
+    }
+    state.setItemsProcessed(state.iterations() * threads * OPS_PER_THREAD);
+}
+BENCHMARK(FavoriteMapSharded)->arg(1)->arg(2)->arg(4)->arg(8)->arg(16);
+
+void FavoriteIndexChurnSerialized(BenchmarkState& state) {
+    std::mutex globalLock;
+    runFavoriteIndexChurn(state, &globalLock);
+}
+BENCHMARK(FavoriteIndexChurnSerialized)->arg(1)->arg(2)->arg(4)->arg(8)->arg(16);
+
+void FavoriteIndexChurnSharded(BenchmarkState& state) {
+    runFavoriteIndexChurn(state, nullptr);
+}
+BENCHMARK(FavoriteIndexChurnSharded)->arg(1)->arg(2)->arg(4)->arg(8)->arg(16);
+
+// Micro: persistence
+
+#if defined(FAVORITE_DRIVER_MANAGER_BENCHMARKS)
+void JsonRoundTrip(BenchmarkState& state) {
+    City city(static_cast<size_t>(state.arg()), static_cast<size_t>(state.arg()) / 10, 5, state.seed());
+    FavoriteDriverManager restored;
+    size_t bytes = 0;
+    while (state.keepRunning()) {
+        std::string json = city.manager.toJson();
+        restored.fromJson(json);
+        bytes = json.size();
+    }
+    state.setItemsProcessed(state.iterations() * bytes);
+    state.setCounter("json_bytes", static_cast<double>(bytes));
+}
+BENCHMARK(JsonRoundTrip)->arg(1000)->arg(10000);
+#endif
+
+void JsonDriverWriteOstringstream(BenchmarkState& state) {
+    std::vector<Driver> drivers = makeJsonDrivers(1024, state.seed());
+    size_t bytes = 0;
+    size_t next = 0;
+    while (state.keepRunning()) {
+        bytes += legacyDriverJson(drivers[next++ & 1023]).size();
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setCounter("bytes_per_driver", static_cast<double>(bytes) / std::max<uint64_t>(1, state.iterations()));
+}
+BENCHMARK(JsonDriverWriteOstringstream);
+
+void JsonDriverWrite(BenchmarkState& state) {
+    std::vector<Driver> drivers = makeJsonDrivers(1024, state.seed());
+    std::string buffer;
+    size_t bytes = 0;
+    size_t next = 0;
+    while (state.keepRunning()) {
+        buffer.clear(); // Reused: no allocation once grown
+        JsonWriter writer(buffer);
+        drivers[next++ & 1023].writeJson(writer);
+        bytes += buffer.size();
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setCounter("bytes_per_driver", static_cast<double>(bytes) / std::max<uint64_t>(1, state.iterations()));
+}
+BENCHMARK(JsonDriverWrite);
+
+void JsonDriverParseSubstring(BenchmarkState& state) {
+    std::vector<std::string> documents;
+    for (const Driver& driver : makeJsonDrivers(1024, state.seed())) {
+        documents.push_back(legacyDriverJson(driver));
+    }
+    double checksum = 0.0;
+    size_t next = 0;
+    while (state.keepRunning()) {
+        checksum += legacyDriverFromJson(documents[next++ & 1023]).getRating();
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setCounter("mean_rating", checksum / std::max<uint64_t>(1, state.iterations()));
+}
+BENCHMARK(JsonDriverParseSubstring);
+
+void JsonDriverRead(BenchmarkState& state) {
+    std::vector<std::string> documents;
+    for (const Driver& driver : makeJsonDrivers(1024, state.seed())) {
+        documents.push_back(driver.toJson());
+    }
+    Driver parsed;
+    double checksum = 0.0;
+    size_t next = 0;
+    while (state.keepRunning()) {
+        JsonReader reader(documents[next++ & 1023]);
+        if (Driver::readJson(reader, parsed)) {
+            checksum += parsed.getRating();
+        }
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setCounter("mean_rating", checksum / std::max<uint64_t>(1, state.iterations()));
+}
+BENCHMARK(JsonDriverRead);
+
+// Cold start from a snapshot of `arg` drivers and as many users x 10 favorites
+
+void BinarySnapshotWrite(BenchmarkState& state) {
+    const std::string filename = "bench_snapshot.bin";
+    size_t drivers = static_cast<size_t>(state.arg());
+    std::vector<BinarySnapshot::FavoriteList> favorites = makeSnapshotFavorites(drivers, state.seed());
+    std::vector<std::shared_ptr<Driver>> fleet = makeFleet(drivers, state.seed());
+    bool written = true;
+    while (state.keepRunning()) {
+        written = BinarySnapshot::write(filename, fleet, favorites) && written;
+    }
+    state.setItemsProcessed(state.iterations() * drivers);
+    state.setCounter("ok", written ? 1.0 : 0.0);
+    std::remove(filename.c_str());
+}
+BENCHMARK(BinarySnapshotWrite)->arg(10000)->arg(100000);
+
+void BinarySnapshotOpen(BenchmarkState& state) {
+    const std::string filename = "bench_snapshot.bin";
+    size_t drivers = static_cast<size_t>(state.arg());
+    if (!BinarySnapshot::write(filename, makeFleet(drivers, state.seed()), makeSnapshotFavorites(drivers, state.seed()))) {
+        return; // Reported with no iterations
+    }
+    BinarySnapshot snapshot;
+    size_t users = 0;
+    while (state.keepRunning()) {
+        snapshot.open(filename, false);
+        users = snapshot.getUserCount();
+        snapshot.close();
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setCounter("users", static_cast<double>(users));
+    std::remove(filename.c_str());
+}
+BENCHMARK(BinarySnapshotOpen)->arg(10000)->arg(100000);
+
+// Checksum verification plus a walk over every favorite edge
+void BinarySnapshotOpenVerify(BenchmarkState& state) {
+    const std::string filename = "bench_snapshot.bin";
+    size_t drivers = static_cast<size_t>(state.arg());
+    if (!BinarySnapshot::write(filename, makeFleet(drivers, state.seed()), makeSnapshotFavorites(drivers, state.seed()))) {
+        return;
+    }
+    BinarySnapshot snapshot;
+    uint64_t edges = 0;
+    while (state.keepRunning()) {
+        edges = 0;
+        if (snapshot.open(filename, true)) {
+            for (uint32_t user = 0; user < snapshot.getUserCount(); ++user) {
+                auto range = snapshot.getFavorites(user);
+                edges += range.second - range.first;
+            }
+        }
+        snapshot.close();
+    }
+    state.setItemsProcessed(state.iterations() * edges);
+    state.setCounter("edges", static_cast<double>(edges));
+    std::remove(filename.c_str());
+}
+BENCHMARK(BinarySnapshotOpenVerify)->arg(10000)->arg(100000);
+
+// Durable appends with fsync from `arg` threads; group commit shares each fsync
+void WriteAheadLogGroupCommit(BenchmarkState& state) {
+    const std::string directory = "bench_wal";
+    const int appendsPerThread = 64;
+    int threads = static_cast<int>(state.arg());
+    std::filesystem::remove_all(directory);
+    WriteAheadLog wal;
+    if (!wal.open(directory)) {
+        return;
+    }
+    while (state.keepRunning()) {
+        runOnThreads(threads, [&wal](int t) {
+            for (int i = 0; i < appendsPerThread; ++i) {
+                wal.append(WriteAheadLog::Record(WriteAheadLog::RecordType::ADD_FAVORITE, "user_" + std::to_string(t),
+                                                 "driver_" + std::to_string(i)));
+            }
+        });
+    }
+    WriteAheadLog::Stats stats = wal.getStats();
+    wal.close();
+    std::filesystem::remove_all(directory);
+    state.setItemsProcessed(stats.durableLsn);
+    state.setCounter("records_per_fsync", static_cast<double>(stats.appendedRecords) / std::max<uint64_t>(1, stats.syncs));
+}
+BENCHMARK(WriteAheadLogGroupCommit)->arg(1)->arg(8);
+
+void WriteAheadLogRecover(BenchmarkState& state) {
+    const std::string directory = "bench_wal";
+    std::filesystem::remove_all(directory);
+    {
+        WriteAheadLog::Options options;
+        options.syncOnCommit = false;
+        WriteAheadLog wal;
+        if (!wal.open(directory, options)) {
+            return;
+        }
+        for (int64_t i = 0; i < state.arg(); ++i) {
+            wal.append(WriteAheadLog::Record(WriteAheadLog::RecordType::ADD_FAVORITE, "user_" + std::to_string(i % 1000),
+                                             "driver_" + std::to_string(i)));
+        }
+    }
+    uint64_t replayed = 0;
+    while (state.keepRunning()) {
+        WriteAheadLog replay;
+        replayed = replay.recover(directory, nullptr, [](const WriteAheadLog::Record&) {}).replayedRecords;
+    }
+    std::filesystem::remove_all(directory);
+    state.setItemsProcessed(state.iterations() * replayed);
+    state.setCounter("records", static_cast<double>(replayed));
+}
+BENCHMARK(WriteAheadLogRecover)->arg(10000);
+
+// Micro: requests
+
+void RideRequestMakeShared(BenchmarkState& state) {
+    std::vector<Driver::Location> points = makeQueries(1024, state.seed());
+    std::string userId = "user_42";
+    size_t next = 0;
+    while (state.keepRunning()) {
+        auto request = std::make_shared<RideRequest>(userId, points[next & 1023], points[(next + 1) & 1023]);
+        ++next;
+    }
+    state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(RideRequestMakeShared);
+
+void RideRequestPooled(BenchmarkState& state) {
+    std::vector<Driver::Location> points = makeQueries(1024, state.seed());
+    std::string userId = "user_42";
+    RideRequestPool pool;
+    size_t next = 0;
+    while (state.keepRunning()) {
+        auto request = pool.acquire(userId, points[next & 1023], points[(next + 1) & 1023],
+                                    RideRequest::RideType::STANDARD);
+        ++next;
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setCounter("slabs", static_cast<double>(pool.getStats().slabs));
+}
+BENCHMARK(RideRequestPooled);
+
+// What a per-call generator cost: seed an engine, draw, format with a prefix
+void RequestIdStringstream(BenchmarkState& state) {
+    size_t length = 0;
+    while (state.keepRunning()) {
+        std::random_device device;
+        std::mt19937 generator(device());
+        std::uniform_int_distribution<int> distribution(100000, 999999);
+        auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        std::stringstream id;
+        id << "req_" << millis << "_" << distribution(generator);
+        length += id.str().size();
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setCounter("id_length", static_cast<double>(length) / std::max<uint64_t>(1, state.iterations()));
+}
+BENCHMARK(RequestIdStringstream);
+
+void RequestIdGeneratorNext(BenchmarkState& state) {
+    RequestIdGenerator::next(); // Lease this thread's slot outside the timed loop
+    size_t length = 0;
+    while (state.keepRunning()) {
+        length += RequestIdGenerator::next().size();
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setCounter("id_length", static_cast<double>(length) / std::max<uint64_t>(1, state.iterations()));
+}
+BENCHMARK(RequestIdGeneratorNext);
+
+// Every thread generating at once; the argument is the thread count
+void RequestIdGeneratorContended(BenchmarkState& state) {
+    int threads = static_cast<int>(state.arg());
+    while (state.keepRunning()) {
+        runOnThreads(threads, [](int) {
+            for (int i = 0; i < OPS_PER_THREAD; ++i) {
+                RequestIdGenerator::next();
+            }
+        });
+    }
+    state.setItemsProcessed(state.iterations() * threads * OPS_PER_THREAD);
+}
+BENCHMARK(RequestIdGeneratorContended)->arg(1)->arg(4);
+
+// Micro: location ingestion. 100k drivers, three pings each per iteration
+
+// One clock read and one lock round-trip per ping
+void LocationIngestPerPing(BenchmarkState& state) {
+    GpsFleet fleet(static_cast<size_t>(state.arg()), state.seed());
+    while (state.keepRunning()) {
+        for (const Driver::LocationUpdate& ping : fleet.pings) {
+            fleet.drivers[ping.driverId]->updateLocation(ping.latitude, ping.longitude);
+        }
+    }
+    state.setItemsProcessed(state.iterations() * fleet.pings.size());
+}
+BENCHMARK(LocationIngestPerPing)->arg(100000);
+
+// One clock read and one lock per batch of 1000, as updateDriverLocations does
+void LocationIngestBatched(BenchmarkState& state) {
+    const size_t batchSize = 1000;
+    GpsFleet fleet(static_cast<size_t>(state.arg()), state.seed());
+    std::vector<Driver*> moved;
+    moved.reserve(batchSize);
+    size_t applied = 0;
+    while (state.keepRunning()) {
+        for (size_t offset = 0; offset < fleet.pings.size(); offset += batchSize) {
+            size_t count = std::min(batchSize, fleet.pings.size() - offset);
+            const Driver::LocationUpdate* batch = fleet.pings.data() + offset;
+            auto now = std::chrono::system_clock::now();
+            moved.clear();
+            for (size_t i = 0; i < count; ++i) {
+                auto it = fleet.drivers.find(batch[i].driverId);
+                if (it == fleet.drivers.end()) continue;
+                it->second->updateLocation(batch[i].latitude, batch[i].longitude, now, false);
+                moved.push_back(it->second.get());
+            }
+            std::unique_lock<std::shared_mutex> lock(fleet.indexMutex);
+            for (Driver* driver : moved) {
+                fleet.spatialIndex.update(*driver);
+            }
+            applied += fleet.positionStore.updateLocations(batch, count);
+        }
+    }
+    state.setItemsProcessed(applied);
+}
+BENCHMARK(LocationIngestBatched)->arg(100000);
+
+// Micro: ETA. Speed-grid ETAs from every driver to one pickup
+
+void EtaPerDriver(BenchmarkState& state) {
+    const std::string filename = "bench_speed_grid.bin";
+    SpeedGridEtaProvider grid;
+    if (!writeSpeedGrid(filename, state.seed()) || !grid.open(filename)) {
+        return;
+    }
+    std::vector<Driver::Location> locations = makeQueries(static_cast<size_t>(state.arg()), state.seed());
+    std::vector<double> etas(locations.size());
+    Driver::Location pickup(37.7749, -122.4194);
+    auto departure = std::chrono::system_clock::now();
+    while (state.keepRunning()) {
+        for (size_t i = 0; i < locations.size(); ++i) {
+            etas[i] = grid.estimateMinutes(locations[i], pickup, departure);
+        }
+    }
+    state.setItemsProcessed(state.iterations() * locations.size());
+    grid.close();
+    std::remove(filename.c_str());
+}
+BENCHMARK(EtaPerDriver)->arg(100000);
+
+// Kernel distances plus one batch call over the position columns
+void EtaComputeBatch(BenchmarkState& state) {
+    const std::string filename = "bench_speed_grid.bin";
+    SpeedGridEtaProvider grid;
+    if (!writeSpeedGrid(filename, state.seed()) || !grid.open(filename)) {
+        return;
+    }
+    DriverPositionStore store;
+    for (const auto& driver : makeFleet(static_cast<size_t>(state.arg()), state.seed())) {
+        store.add(*driver);
+    }
+    std::vector<double> distances, etas;
+    Driver::Location pickup(37.7749, -122.4194);
+    auto departure = std::chrono::system_clock::now();
+    while (state.keepRunning()) {
+        store.computeEtas(pickup, grid, departure, distances, etas);
+    }
+    state.setItemsProcessed(state.iterations() * static_cast<uint64_t>(state.arg()));
+    grid.close();
+    std::remove(filename.c_str());
+}
+BENCHMARK(EtaComputeBatch)->arg(100000);
+
+// A dispatch cycle's ETA lookups, with and without EtaCache
+void EtaUncached(BenchmarkState& state) {
+    const std::string filename = "bench_speed_grid.bin";
+    SpeedGridEtaProvider grid;
+    if (!writeSpeedGrid(filename, state.seed()) || !grid.open(filename)) {
+        return;
+    }
+    EtaWorkload workload(state.seed());
+    auto departure = std::chrono::system_clock::now();
+    double checksum = 0.0;
+    while (state.keepRunning()) {
+        for (const auto& request : workload.requests) {
+            for (int pass = 0; pass < EtaWorkload::PASSES; ++pass) {
+                for (EtaCache::Handle driver : request.candidates) {
+                    checksum += grid.estimateMinutes(workload.drivers[driver], request.pickup, departure);
+                }
+            }
+        }
+    }
+    state.setItemsProcessed(state.iterations() * workload.lookups());
+    state.setCounter("mean_eta_min", checksum / std::max<uint64_t>(1, state.iterations() * workload.lookups()));
+    grid.close();
+    std::remove(filename.c_str());
+}
+BENCHMARK(EtaUncached);
+
+void EtaCached(BenchmarkState& state) {
+    const std::string filename = "bench_speed_grid.bin";
+    SpeedGridEtaProvider grid;
+    if (!writeSpeedGrid(filename, state.seed()) || !grid.open(filename)) {
+        return;
+    }
+    EtaWorkload workload(state.seed());
+    auto departure = std::chrono::system_clock::now();
+    EtaCache cache;
+    double checksum = 0.0;
+    while (state.keepRunning()) {
+        for (const auto& request : workload.requests) {
+            for (int pass = 0; pass < EtaWorkload::PASSES; ++pass) {
+                for (EtaCache::Handle driver : request.candidates) {
+                    checksum += cache.estimate(grid, driver, workload.drivers[driver], request.pickup, departure)
+                                    .etaMinutes;
+                }
+            }
+        }
+    }
+    state.setItemsProcessed(state.iterations() * workload.lookups());
+    state.setCounter("mean_eta_min", checksum / std::max<uint64_t>(1, state.iterations() * workload.lookups()));
+    state.setCounter("hit_rate", cache.getStats().hitRate());
+    grid.close();
+    std::remove(filename.c_str());
+}
+BENCHMARK(EtaCached);
+
+// Micro: dispatch ranking
+
+// Worst case for the batch solver: 256 riders sharing 300 drivers in one component
+void AssignmentSolverStadium(BenchmarkState& state) {
+    std::mt19937 rng(state.seed());
+    std::uniform_int_distribution<uint32_t> nearbyDriver(0, 299);
+    std::uniform_real_distribution<double> pickupMinutes(1.0, 30.0);
+    std::vector<std::vector<AssignmentSolver::Edge>> stadium(256);
+    for (auto& row : stadium) {
+        for (int i = 0; i < 30; ++i) {
+            row.push_back(AssignmentSolver::Edge{nearbyDriver(rng), pickupMinutes(rng)});
+        }
+    }
+    size_t matched = 0;
+    while (state.keepRunning()) {
+        auto assignment = AssignmentSolver::solve(stadium, 1.0e6);
+        matched = std::count_if(assignment.begin(), assignment.end(),
+                                [](uint32_t column) { return column != AssignmentSolver::UNASSIGNED; });
+    }
+    state.setItemsProcessed(state.iterations() * stadium.size());
+    state.setCounter("matched", static_cast<double>(matched));
+}
+BENCHMARK(AssignmentSolverStadium);
+
+// Full priority per driver, then sort everything
+void DriverRankingFullSort(BenchmarkState& state) {
+    RankingWorkload workload(state.seed());
+    std::vector<std::pair<int, std::shared_ptr<Driver>>> scored;
+    size_t round = 0;
+    while (state.keepRunning()) {
+        RankingWorkload::Handle user = static_cast<RankingWorkload::Handle>(round % RankingWorkload::USERS);
+        const std::vector<double>& km = workload.distances[round++ % workload.distances.size()];
+        scored.clear();
+        for (size_t i = 0; i < workload.drivers.size(); ++i) {
+            scored.emplace_back(static_cast<int>(workload.staticScore(user, i) - 10.0 * km[i]), workload.drivers[i]);
+        }
+        std::sort(scored.begin(), scored.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    }
+    state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(DriverRankingFullSort);
+
+// Cached static part, distance term only, nth_element for the top 5
+void DriverRankingCached(BenchmarkState& state) {
+    RankingWorkload workload(state.seed());
+    PriorityScoreCache cache;
+    std::vector<PriorityScoreCache::Ranked> ranked;
+    size_t round = 0;
+    while (state.keepRunning()) {
+        RankingWorkload::Handle user = static_cast<RankingWorkload::Handle>(round % RankingWorkload::USERS);
+        const std::vector<double>& km = workload.distances[round++ % workload.distances.size()];
+        cache.rank(user, workload.handles.data(), km.data(), workload.handles.size(), RankingWorkload::LIMIT,
+                   [&](RankingWorkload::Handle driver) { return workload.staticScore(user, driver); }, ranked);
+    }
+    auto stats = cache.getStats();
+    state.setItemsProcessed(state.iterations());
+    state.setCounter("hit_rate", static_cast<double>(stats.hits) / std::max<uint64_t>(1, stats.hits + stats.misses));
+}
+BENCHMARK(DriverRankingCached);
+
+// Micro: notifications. Four threads each run 250 requests that update shared
+// state under a lock and notify rider and driver, as acceptRideRequest does;
+// the gateway takes ~200 us a message
+
+// Synchronous callback: the gateway's latency lands on every request, and on
+// every request queued behind the lock
+void NotificationSlowSinkSync(BenchmarkState& state) {
+    std::vector<double> latencies;
+    while (state.keepRunning()) {
+        latencies = runNotifyingRequests(slowSend);
+    }
+    setLatencyCounters(state, latencies);
+}
+BENCHMARK(NotificationSlowSinkSync);
+
+// NotificationPipeline: requests only pay for the post; draining is untimed
+void NotificationSlowSinkPipeline(BenchmarkState& state) {
+    NotificationPipeline pipeline([](const std::string& recipient, const std::vector<std::string>& messages) {
+        for (const std::string& message : messages) {
+            slowSend(recipient, message);
+        }
+    });
+    std::vector<double> latencies;
+    while (state.keepRunning()) {
+        latencies = runNotifyingRequests([&pipeline](const std::string& recipient, const std::string& message) {
+            pipeline.post(recipient, message);
+        });
+        state.pauseTiming();
+        pipeline.flush();
+        state.resumeTiming();
+    }
+    setLatencyCounters(state, latencies);
+    state.setCounter("sink_calls", static_cast<double>(pipeline.getStats().sinkCalls));
+}
+BENCHMARK(NotificationSlowSinkPipeline);
+
+// Micro: instrumentation. Cost per operation of METRICS_SCOPE and
+// MetricsRegistry::lockExclusive against the bare operation; the argument is
+// the thread count. With ENABLE_METRICS=OFF the pairs should match
+
+void MetricsBareOp(BenchmarkState& state) {
+    int threads = static_cast<int>(state.arg());
+    std::atomic<uint64_t> sink{0};
+    while (state.keepRunning()) {
+        runOnThreads(threads, [&sink](int) {
+            for (int i = 0; i < OPS_PER_THREAD; ++i) {
+                sink.fetch_add(i & 1, std::memory_order_relaxed);
+            }
+        });
+    }
+    state.setItemsProcessed(state.iterations() * threads * OPS_PER_THREAD);
+}
+BENCHMARK(MetricsBareOp)->arg(1)->arg(4);
+
+void MetricsScopedOp(BenchmarkState& state) {
+    int threads = static_cast<int>(state.arg());
+    MetricsRegistry registry({"operation"}, {});
+    std::atomic<uint64_t> sink{0};
+    while (state.keepRunning()) {
+        runOnThreads(threads, [&](int) {
+            for (int i = 0; i < OPS_PER_THREAD; ++i) {
+                METRICS_SCOPE(registry, 0);
+                sink.fetch_add(i & 1, std::memory_order_relaxed);
+            }
+        });
+    }
+    state.setItemsProcessed(state.iterations() * threads * OPS_PER_THREAD);
+}
+BENCHMARK(MetricsScopedOp)->arg(1)->arg(4);
+
+// One steady_clock read, the floor under METRICS_SCOPE
+void MetricsClockRead(BenchmarkState& state) {
+    int threads = static_cast<int>(state.arg());
+    std::atomic<uint64_t> sink{0};
+    while (state.keepRunning()) {
+        runOnThreads(threads, [&sink](int) {
+            for (int i = 0; i < OPS_PER_THREAD; ++i) {
+                sink.fetch_add(std::chrono::steady_clock::now().time_since_epoch().count() & 1,
+                               std::memory_order_relaxed);
+            }
+        });
+    }
+    state.setItemsProcessed(state.iterations() * threads * OPS_PER_THREAD);
+}
+BENCHMARK(MetricsClockRead)->arg(1)->arg(4);
+
+void MetricsLockPlain(BenchmarkState& state) {
+    int threads = static_cast<int>(state.arg());
+    std::mutex mutex;
+    std::atomic<uint64_t> sink{0};
+    while (state.keepRunning()) {
+        runOnThreads(threads, [&](int) {
+            for (int i = 0; i < OPS_PER_THREAD; ++i) {
+                std::unique_lock<std::mutex> lock(mutex);
+                sink.fetch_add(i & 1, std::memory_order_relaxed);
+            }
+        });
+    }
+    state.setItemsProcessed(state.iterations() * threads * OPS_PER_THREAD);
+}
+BENCHMARK(MetricsLockPlain)->arg(1)->arg(4);
+
+void MetricsLockTimed(BenchmarkState& state) {
+    int threads = static_cast<int>(state.arg());
+    MetricsRegistry registry({}, {"mutex"});
+    std::mutex mutex;
+    std::atomic<uint64_t> sink{0};
+    while (state.keepRunning()) {
+        runOnThreads(threads, [&](int) {
+            for (int i = 0; i < OPS_PER_THREAD; ++i) {
+                auto lock = registry.lockExclusive(mutex, 0);
+                sink.fetch_add(i & 1, std::memory_order_relaxed);
+            }
+        });
+    }
+    state.setItemsProcessed(state.iterations() * threads * OPS_PER_THREAD);
+}
+BENCHMARK(MetricsLockTimed)->arg(1)->arg(4);
+
+#if defined(FAVORITE_DRIVER_MANAGER_BENCHMARKS)
+// Macro: one rider requests any favorite, the offered driver accepts, and the
+// driver is returned to the online fleet so every iteration sees the same city
+
+void DispatchCycle(BenchmarkState& state) {
+    size_t drivers = static_cast<size_t>(state.arg());
+    City city(drivers, 1000, 5, state.seed());
+    std::mt19937 rng(state.seed());
+    std::uniform_real_distribution<double> offset(-0.01, 0.01);
+    uint64_t accepted = 0;
+    size_t next = 0;
+    while (state.keepRunning()) {
+        size_t user = next++ % city.users.size();
+        const Driver::Location& home = city.homes[user];
+        RideRequest request(city.users[user], home,
+                            Driver::Location(home.latitude + offset(rng), home.longitude + offset(rng)));
+        std::string requestId = city.manager.requestAnyFavoriteDriver(city.users[user], request,
+                                                                      [](bool, const std::string&) {});
+        std::shared_ptr<RideRequest> stored = requestId.empty() ? nullptr : city.manager.getRideRequest(requestId);
+        if (stored && !stored->getAssignedDriverId().empty()) {
+            std::string driverId = stored->getAssignedDriverId();
+            accepted += city.manager.acceptRideRequest(driverId, requestId);
+            city.manager.cancelRideRequest(requestId);
+            if (std::shared_ptr<Driver> driver = city.manager.getDriver(driverId)) {
+                driver->goOnline();
+            }
+        }
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setCounter("accept_rate", static_cast<double>(accepted) / std::max<uint64_t>(1, state.iterations()));
+}
+BENCHMARK(DispatchCycle)->range(1000, 100000);
+#endif
+
+int main(int argc, char** argv) {
+    std::map<std::string, std::string> context;
+    context["distance_kernel"] = DistanceKernel::getInstructionSet();
+    context["metrics"] = MetricsRegistry::enabled() ? "on" : "off";
+#if defined(NDEBUG)
+    context["build"] = "release";
+#else
+    context["build"] = "debug";
+#endif
+    return runBenchmarks(argc, argv, context);
+}
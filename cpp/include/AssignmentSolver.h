@@ -0,0 +1,42 @@
+#ifndef ASSIGNMENT_SOLVER_H
+#define ASSIGNMENT_SOLVER_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Minimum-cost rider-to-driver assignment (Hungarian algorithm)
+ *
+ * Rows are riders and columns are drivers. Each row lists the columns it
+ * may take and the cost of each. solve() returns one column per row, or
+ * UNASSIGNED, so that no column is used twice. Edges costing
+ * unassignedCost or more are never worth taking and are ignored. Among the
+ * rest the solver first maximizes the number of matches and then minimizes
+ * their total cost, so it never strands a rider to save on the others; a
+ * row left unmatched counts unassignedCost in totalCost().
+ *
+ * Rows are first split into connected components: riders linked through
+ * shared candidate drivers. Each component is solved separately with the
+ * O(n^2 m) shortest-augmenting-path Hungarian method, padded with one
+ * "no driver" column per row, after every real edge in the component is
+ * discounted by a bonus larger than its total cost range. Riders in
+ * different parts of a city therefore never enter the same matrix.
+ */
+class AssignmentSolver {
+public:
+    static constexpr uint32_t UNASSIGNED = UINT32_MAX;
+
+    struct Edge {
+        uint32_t column;
+        double cost;
+    };
+
+    static std::vector<uint32_t> solve(const std::vector<std::vector<Edge>>& rows, double unassignedCost);
+
+    // Sum of the chosen edge costs plus unassignedCost per unmatched row
+    static double totalCost(const std::vector<std::vector<Edge>>& rows, const std::vector<uint32_t>& assignment,
+                            double unassignedCost);
+};
+
+#endif // ASSIGNMENT_SOLVER_H
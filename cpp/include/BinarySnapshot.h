@@ -0,0 +1,130 @@
+#ifndef BINARY_SNAPSHOT_H
+#define BINARY_SNAPSHOT_H
+
+#include "Driver.h"
+#include "MappedFile.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Versioned, checksummed binary snapshot of drivers and favorites
+ *
+ * File layout (little-endian, every section 8-byte aligned):
+ *   - fixed header: magic, version, counts, section offsets, checksum
+ *   - string table: raw UTF-8 bytes referenced by (offset, length) pairs
+ *   - driver block: one column per field (ids, names, ..., lat, lng, rating)
+ *   - user block: user ID refs plus CSR row offsets (userCount + 1 entries)
+ *   - edge block: driver indexes, one per favorite edge
+ *
+ * open() maps the file read-only and only validates the header and
+ * checksum; columns and favorites are then read in place, so cold start is
+ * bounded by page-in rather than parsing. Drivers are materialized lazily
+ * with materializeDriver() when a full Driver object is needed.
+ */
+class BinarySnapshot {
+public:
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+    using FavoriteList = std::pair<std::string, std::vector<std::string>>;
+
+    struct StringRef {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t headerSize;
+        uint32_t driverCount;
+        uint32_t userCount;
+        uint64_t edgeCount;
+        uint64_t stringTableOffset;
+        uint64_t stringTableSize;
+        uint64_t driverBlockOffset;
+        uint64_t userBlockOffset;
+        uint64_t edgeBlockOffset;
+        uint64_t fileSize;
+        uint64_t checksum; // Over every byte after the header
+    };
+
+private:
+    // Pointers into the mapped file, valid while open
+    struct Columns {
+        const StringRef* ids = nullptr;
+        const StringRef* names = nullptr;
+        const StringRef* phoneNumbers = nullptr;
+        const StringRef* emails = nullptr;
+        const StringRef* profilePhotos = nullptr;
+        const StringRef* vehicleMakes = nullptr;
+        const StringRef* vehicleModels = nullptr;
+        const StringRef* vehicleColors = nullptr;
+        const StringRef* vehiclePlates = nullptr;
+        const double* latitudes = nullptr;
+        const double* longitudes = nullptr;
+        const double* ratings = nullptr;
+        const int32_t* completedTrips = nullptr;
+        const int32_t* vehicleYears = nullptr;
+        const uint8_t* statuses = nullptr;
+        const uint8_t* verified = nullptr;
+        const StringRef* userIds = nullptr;
+        const uint32_t* userOffsets = nullptr;
+        const uint32_t* edges = nullptr;
+    };
+
+    std::unique_ptr<MappedFile> m_file;
+    const Header* m_header;
+    const char* m_strings;
+    Columns m_columns;
+    std::string m_lastError;
+
+public:
+    // Constructor and Destructor
+    BinarySnapshot();
+    ~BinarySnapshot();
+
+    BinarySnapshot(const BinarySnapshot&) = delete;
+    BinarySnapshot& operator=(const BinarySnapshot&) = delete;
+    BinarySnapshot(BinarySnapshot&& other) noexcept;
+    BinarySnapshot& operator=(BinarySnapshot&& other) noexcept;
+
+    // Writing; favorites naming drivers absent from `drivers` are dropped
+    static bool write(const std::string& filename, const std::vector<std::shared_ptr<Driver>>& drivers,
+                      const std::vector<FavoriteList>& favorites, std::string* error = nullptr);
+
+    // Reading
+    bool open(const std::string& filename, bool verifyChecksum = true);
+    void close();
+    bool isOpen() const { return m_header != nullptr; }
+    const std::string& getLastError() const { return m_lastError; }
+
+    // Driver columns
+    uint32_t getDriverCount() const { return m_header ? m_header->driverCount : 0; }
+    std::string_view getDriverId(uint32_t index) const { return view(m_columns.ids[index]); }
+    double getLatitude(uint32_t index) const { return m_columns.latitudes[index]; }
+    double getLongitude(uint32_t index) const { return m_columns.longitudes[index]; }
+    double getRating(uint32_t index) const { return m_columns.ratings[index]; }
+    Driver::Status getStatus(uint32_t index) const { return static_cast<Driver::Status>(m_columns.statuses[index]); }
+    const double* getLatitudes() const { return m_columns.latitudes; }
+    const double* getLongitudes() const { return m_columns.longitudes; }
+    Driver materializeDriver(uint32_t index) const;
+
+    // Favorites adjacency (CSR)
+    uint32_t getUserCount() const { return m_header ? m_header->userCount : 0; }
+    uint64_t getEdgeCount() const { return m_header ? m_header->edgeCount : 0; }
+    std::string_view getUserId(uint32_t user) const { return view(m_columns.userIds[user]); }
+    std::pair<const uint32_t*, const uint32_t*> getFavorites(uint32_t user) const;
+
+    static uint64_t checksum(const void* data, size_t size);
+
+private:
+    std::string_view view(const StringRef& ref) const { return std::string_view(m_strings + ref.offset, ref.length); }
+    bool fail(const std::string& message);
+};
+
+#endif // BINARY_SNAPSHOT_H
@@ -0,0 +1,104 @@
+#ifndef BOUNDED_MPMC_QUEUE_H
+#define BOUNDED_MPMC_QUEUE_H
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <utility>
+#include <cstddef>
+
+/**
+ * @brief Lock-free bounded multi-producer multi-consumer queue
+ *
+ * Classic sequence-numbered ring buffer (Vyukov): every cell carries a
+ * sequence counter that tells producers and consumers whether it is free
+ * or filled for their lap, so tryPush/tryPop are a single CAS on the
+ * enqueue or dequeue cursor. Capacity is rounded up to a power of two.
+ * tryPush fails instead of blocking when the ring is full, which is what
+ * gives callers their backpressure signal.
+ */
+template <typename T>
+class BoundedMpmcQueue {
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static constexpr size_t CACHE_LINE = 64;
+
+    std::unique_ptr<Cell[]> m_cells;
+    size_t m_mask;
+    alignas(CACHE_LINE) std::atomic<size_t> m_enqueuePos;
+    alignas(CACHE_LINE) std::atomic<size_t> m_dequeuePos;
+
+public:
+    // Constructor
+    explicit BoundedMpmcQueue(size_t capacity) : m_enqueuePos(0), m_dequeuePos(0) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        m_cells.reset(new Cell[size]);
+        m_mask = size - 1;
+        for (size_t i = 0; i < size; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedMpmcQueue(const BoundedMpmcQueue&) = delete;
+    BoundedMpmcQueue& operator=(const BoundedMpmcQueue&) = delete;
+
+    bool tryPush(T&& value) {
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = m_cells[pos & m_mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // Full
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool tryPop(T& value) {
+        size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = m_cells[pos & m_mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = std::move(cell.value);
+                    cell.value = T();
+                    cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // Empty
+            } else {
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Approximate under concurrency
+    size_t sizeApprox() const {
+        size_t enqueued = m_enqueuePos.load(std::memory_order_relaxed);
+        size_t dequeued = m_dequeuePos.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    bool emptyApprox() const { return sizeApprox() == 0; }
+    size_t capacity() const { return m_mask + 1; }
+};
+
+#endif // BOUNDED_MPMC_QUEUE_H
@@ -0,0 +1,111 @@
+#ifndef DISPATCH_BATCHER_H
+#define DISPATCH_BATCHER_H
+
+#include "AssignmentSolver.h"
+#include "IdInterner.h"
+#include "TimerWheel.h"
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Micro-batches concurrent ride requests into one global assignment
+ *
+ * Dispatching one request at a time lets riders who ask at the same moment
+ * all pick the same popular favorite, and every rider but one is rejected
+ * and retried. The batcher instead holds requests for up to `window`,
+ * measured from the first request in the batch, or until maxBatchSize are
+ * queued. It then runs AssignmentSolver over every rider's candidate
+ * drivers and hands the result to the dispatch callback in a single call.
+ * No driver is offered to two riders in the same batch.
+ *
+ * Candidate costs are lower-is-better (e.g. ETA minus a favorite bonus
+ * derived from calculateDriverPriority); candidates at or above
+ * unassignedCost are dropped. The solver maximizes matches first and then
+ * minimizes total cost. The window timer runs on the caller's TimerWheel.
+ * flush() solves and dispatches on the calling thread, and the dispatch
+ * callback runs without the batcher's lock held, so it may submit again.
+ * The owner must stop the wheel, or flush, before destroying the batcher.
+ */
+class DispatchBatcher {
+public:
+    using Handle = IdInterner::Handle;
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr Handle NO_DRIVER = IdInterner::INVALID_HANDLE;
+
+    struct Options {
+        std::chrono::milliseconds window{200};
+        size_t maxBatchSize = 256;      // Flushes early once this many are queued
+        double unassignedCost = 1.0e6;  // Candidates costing this or more are dropped
+    };
+
+    struct Candidate {
+        Handle driver;
+        double cost;
+    };
+
+    struct Request {
+        std::string requestId;
+        Handle user;
+        std::vector<Candidate> candidates;
+        Clock::time_point enqueuedAt; // Stamped by submit() when left default
+    };
+
+    struct Assignment {
+        std::string requestId;
+        Handle user;
+        Handle driver; // NO_DRIVER when nothing was left for this rider
+        double cost;
+        Clock::time_point enqueuedAt;
+    };
+
+    using DispatchCallback = std::function<void(std::vector<Assignment>& assignments)>;
+
+    struct Stats {
+        uint64_t batches = 0;
+        uint64_t requests = 0;
+        uint64_t assigned = 0;
+        uint64_t unassigned = 0;
+        size_t largestBatch = 0;
+        uint64_t solveMicros = 0; // Total time spent in AssignmentSolver
+        size_t queued = 0;
+    };
+
+private:
+    TimerWheel& m_wheel;
+    DispatchCallback m_dispatch;
+    Options m_options;
+
+    mutable std::mutex m_mutex;
+    std::vector<Request> m_pending;
+    TimerWheel::TimerId m_windowTimer;
+    uint64_t m_generation; // Bumped per batch so a late window timer cannot flush the next one
+    Stats m_stats;
+
+public:
+    DispatchBatcher(TimerWheel& wheel, DispatchCallback dispatch);
+    DispatchBatcher(TimerWheel& wheel, DispatchCallback dispatch, const Options& options);
+    ~DispatchBatcher();
+
+    DispatchBatcher(const DispatchBatcher&) = delete;
+    DispatchBatcher& operator=(const DispatchBatcher&) = delete;
+
+    void submit(Request request);
+
+    // Solves and dispatches whatever is queued; returns the batch size
+    size_t flush();
+
+    Stats getStats() const;
+    const Options& getOptions() const { return m_options; }
+
+private:
+    size_t flushGeneration(uint64_t generation);
+    std::vector<Request> takeBatch(uint64_t generation);
+};
+
+#endif // DISPATCH_BATCHER_H
@@ -0,0 +1,72 @@
+#ifndef DISTANCE_KERNEL_H
+#define DISTANCE_KERNEL_H
+
+#include "Driver.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Great-circle distance: one exact formula plus batch and prefilter tiers
+ *
+ * haversine() is the single scalar formula behind Driver and RideRequest.
+ * haversineBatch() computes the distance from one origin to N points stored
+ * as parallel latitude/longitude/cos(latitude) arrays; it uses AVX2 or SSE2
+ * when the compiler targets them and falls back to a scalar loop. All
+ * paths share the same polynomial approximations and agree with haversine()
+ * to within BATCH_TOLERANCE_KM for any pair at least 0.1 degrees from
+ * antipodal. Past a quarter circle the batch paths switch to the complement
+ * of the haversine term and stay exact up to the antipode, while
+ * haversine() computes 1 - a by subtraction and loses precision there, so
+ * the two may differ by up to ANTIPODAL_TOLERANCE_KM.
+ *
+ * For radius searches the equirectangular tier rejects far candidates with
+ * a handful of multiplies (no trig, no sqrt) before the exact tier runs on
+ * the survivors. Within PREFILTER_MAX_RADIUS_KM and PREFILTER_MAX_LATITUDE
+ * it overestimates Haversine by under 1%, so the PREFILTER_TOLERANCE margin
+ * never rejects a point that is actually in range; outside those limits
+ * every point survives the prefilter.
+ */
+class DistanceKernel {
+public:
+    static constexpr double EARTH_RADIUS_KM = 6371.0;
+    static constexpr double PREFILTER_TOLERANCE = 0.02;    // Relative slack on the cheap tier
+    static constexpr double PREFILTER_MAX_RADIUS_KM = 500.0;
+    static constexpr double PREFILTER_MAX_LATITUDE = 80.0; // |origin latitude|
+    static constexpr double BATCH_TOLERANCE_KM = 1e-8;     // haversineBatch() vs haversine()
+    static constexpr double ANTIPODAL_TOLERANCE_KM = 1e-3; // Same, within 0.1 degrees of the antipode
+
+    // Exact distance in km between two points (libm trig)
+    static double haversine(const Driver::Location& from, const Driver::Location& to);
+
+    // Equirectangular approximation in km; cosLatitudes are cos(latitude in radians)
+    static double equirectangular(double fromLatitude, double fromLongitude, double fromCosLatitude,
+                                  double toLatitude, double toLongitude, double toCosLatitude);
+
+    // Two-tier radius test for a single pair
+    static bool withinDistance(const Driver::Location& from, const Driver::Location& to, double maxDistanceKm);
+
+    // Distances in km from origin to each point; cosLatitudes[i] must hold
+    // cos(latitudes[i]) in radians (precomputed by the caller's store)
+    static void haversineBatch(const Driver::Location& origin,
+                               const double* latitudes, const double* longitudes,
+                               const double* cosLatitudes, size_t count, double* distancesKm);
+
+    // Cheap tier: writes the indexes of points that may lie within maxDistanceKm
+    // to survivors (room for `count`) and returns how many there are
+    static size_t prefilter(const Driver::Location& origin,
+                            const double* latitudes, const double* longitudes, const double* cosLatitudes,
+                            size_t count, double maxDistanceKm, uint32_t* survivors);
+
+    // Both tiers: indexes of the points within maxDistanceKm, in input order,
+    // and their exact distances
+    static void filterWithinDistance(const Driver::Location& origin,
+                                     const double* latitudes, const double* longitudes,
+                                     const double* cosLatitudes, size_t count, double maxDistanceKm,
+                                     std::vector<uint32_t>& indexes, std::vector<double>& distancesKm);
+
+    // Name of the instruction set selected at compile time ("AVX2", "SSE2" or "scalar")
+    static const char* getInstructionSet();
+};
+
+#endif // DISTANCE_KERNEL_H
@@ -0,0 +1,87 @@
+#ifndef DRIVER_POSITION_STORE_H
+#define DRIVER_POSITION_STORE_H
+
+#include "Driver.h"
+#include "EtaProvider.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Structure-of-arrays copy of the driver fields used for matching
+ *
+ * Keeps latitude, longitude, cos(latitude), status and rating for every
+ * driver in contiguous arrays addressed by a dense index, so distance
+ * sweeps stream through memory and feed DistanceKernel directly instead of
+ * chasing shared_ptr<Driver>. Indexes are reassigned on removal (the last
+ * driver is swapped into the hole). Not synchronized; the owner locks.
+ */
+class DriverPositionStore {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    // Assumed average city speed when no EtaProvider is given, kept in line
+    // with Driver::getEstimatedArrivalTime
+    static constexpr double AVERAGE_SPEED_KMH = ConstantSpeedEtaProvider::DEFAULT_SPEED_KMH;
+
+    struct EtaEntry {
+        size_t index;
+        double distanceKm;
+        int etaMinutes;
+    };
+
+private:
+    std::vector<std::string> m_driverIds;
+    std::vector<double> m_latitudes;
+    std::vector<double> m_longitudes;
+    std::vector<double> m_cosLatitudes;
+    std::vector<uint8_t> m_statuses;
+    std::vector<double> m_ratings;
+
+    // Driver ID -> dense index
+    std::unordered_map<std::string, size_t> m_indexById;
+
+public:
+    // Maintenance
+    size_t add(const Driver& driver); // Inserts or refreshes, returns the dense index
+    bool remove(const std::string& driverId);
+    bool update(const Driver& driver);
+    bool updateLocation(const std::string& driverId, double latitude, double longitude);
+    size_t updateLocations(const Driver::LocationUpdate* updates, size_t count); // Returns updates applied
+    bool updateStatus(const std::string& driverId, Driver::Status status);
+    void clear();
+    void reserve(size_t capacity);
+
+    // Lookup
+    size_t indexOf(const std::string& driverId) const;
+    const std::string& getDriverId(size_t index) const { return m_driverIds[index]; }
+    Driver::Status getStatus(size_t index) const { return static_cast<Driver::Status>(m_statuses[index]); }
+    double getRating(size_t index) const { return m_ratings[index]; }
+    double getLatitude(size_t index) const { return m_latitudes[index]; }
+    double getLongitude(size_t index) const { return m_longitudes[index]; }
+    size_t size() const { return m_driverIds.size(); }
+    bool empty() const { return m_driverIds.empty(); }
+
+    // Batch queries
+    void computeDistances(const Driver::Location& origin, std::vector<double>& distancesKm) const;
+    void computeEtas(const Driver::Location& pickup, const EtaProvider& provider, EtaProvider::TimePoint departure,
+                     std::vector<double>& distancesKm, std::vector<double>& etaMinutes) const;
+    // Radius queries reject far drivers with DistanceKernel's equirectangular
+    // prefilter and compute exact distances only for the rest
+    void withinDistance(const Driver::Location& origin, double maxDistanceKm,
+                        std::vector<uint32_t>& indexes, std::vector<double>& distancesKm) const;
+    std::vector<size_t> filterByDistance(const Driver::Location& origin, double maxDistanceKm,
+                                         bool availableOnly = false) const;
+    std::vector<size_t> filterByDistance(const std::vector<size_t>& candidates, const Driver::Location& origin,
+                                         double maxDistanceKm) const;
+    std::vector<EtaEntry> rankByEta(const Driver::Location& origin, size_t count, double maxDistanceKm) const;
+    std::vector<EtaEntry> rankByEta(const Driver::Location& origin, size_t count, double maxDistanceKm,
+                                    const EtaProvider& provider, EtaProvider::TimePoint departure) const;
+
+    static int distanceToEtaMinutes(double distanceKm);
+};
+
+#endif // DRIVER_POSITION_STORE_H
@@ -0,0 +1,135 @@
+#ifndef ETA_CACHE_H
+#define ETA_CACHE_H
+
+#include "EtaProvider.h"
+#include "IdInterner.h"
+#include <unordered_map>
+#include <shared_mutex>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Bounded, sharded CLOCK cache of driver-to-pickup distance and ETA
+ *
+ * One dispatch cycle asks for the same driver/pickup pair several times
+ * (requestAnyFavoriteDriver, sortDriversByPreference, filterByDistance),
+ * and riders waiting near each other ask for nearly the same pairs. Entries
+ * are keyed by (driver, pickup cell) and remember the driver's cell and the
+ * departure hour they were computed for, on the provider's clock
+ * (EtaProvider::getDepartureHour): a lookup after the driver has crossed
+ * into another cell, or in a later hour, is an invalidation and a miss, and
+ * the next store replaces the entry in place. Positions are quantized to
+ * cells of about cellSizeKm on each side (longitude widths are scaled by the
+ * cosine of the cell row's latitude), so a hit can be off by up to the cell
+ * diagonal at each end.
+ *
+ * Each shard is a fixed slot array plus a key -> slot map under its own
+ * reader-writer lock. Hits take the shared lock and set the slot's
+ * reference bit; a full shard evicts with the CLOCK sweep. All entries for
+ * one driver live in the same shard.
+ */
+class EtaCache {
+public:
+    using Handle = IdInterner::Handle;
+    using TimePoint = EtaProvider::TimePoint;
+
+    static constexpr size_t DEFAULT_SHARD_COUNT = 16;
+
+    struct Options {
+        double cellSizeKm = 0.25;  // Quantization of driver and pickup positions
+        size_t capacity = 1 << 18; // Entries across all shards
+        size_t shardCount = DEFAULT_SHARD_COUNT;
+    };
+
+    struct Estimate {
+        double distanceKm;
+        double etaMinutes;
+    };
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t invalidations = 0; // Misses caused by a driver changing cells or the hour rolling over
+        uint64_t evictions = 0;
+        size_t size = 0;
+        size_t capacity = 0;
+
+        double hitRate() const { return hits + misses ? static_cast<double>(hits) / (hits + misses) : 0.0; }
+    };
+
+private:
+    struct Key {
+        Handle driver;
+        int64_t pickupCell;
+
+        bool operator==(const Key& other) const {
+            return driver == other.driver && pickupCell == other.pickupCell;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            uint64_t hash = (static_cast<uint64_t>(key.pickupCell) ^ key.driver) * 0x9E3779B97F4A7C15ull;
+            return static_cast<size_t>(hash ^ (hash >> 32));
+        }
+    };
+
+    struct Slot {
+        Key key;
+        int64_t driverCell;
+        int64_t hour; // EtaProvider::getDepartureHour at departure
+        Estimate estimate;
+        std::atomic<bool> referenced{false};
+    };
+
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        std::unique_ptr<Slot[]> slots;
+        std::unordered_map<Key, uint32_t, KeyHash> index;
+        size_t capacity = 0;
+        size_t used = 0;
+        size_t hand = 0;
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+        std::atomic<uint64_t> invalidations{0};
+        std::atomic<uint64_t> evictions{0};
+    };
+
+    std::unique_ptr<Shard[]> m_shards;
+    size_t m_shardMask;
+    double m_inverseCellSize; // Rows per degree of latitude
+
+public:
+    // Constructors
+    EtaCache();
+    explicit EtaCache(const Options& options);
+
+    EtaCache(const EtaCache&) = delete;
+    EtaCache& operator=(const EtaCache&) = delete;
+
+    // Cached estimate, or one computed with `provider` (and stored) on a miss
+    Estimate estimate(const EtaProvider& provider, Handle driver, const Driver::Location& driverLocation,
+                      const Driver::Location& pickup, TimePoint departure);
+
+    // Lower-level access for callers that compute estimates in batches
+    bool lookup(const EtaProvider& provider, Handle driver, const Driver::Location& driverLocation,
+                const Driver::Location& pickup, TimePoint departure, Estimate& result);
+    void store(const EtaProvider& provider, Handle driver, const Driver::Location& driverLocation,
+               const Driver::Location& pickup, TimePoint departure, const Estimate& estimate);
+
+    // Drop every entry, e.g. after the ETA provider or its speed data changes
+    void clear();
+
+    // Statistics
+    Stats getStats() const;
+    void resetStats();
+
+    int64_t cellFor(const Driver::Location& location) const;
+
+private:
+    Shard& shardFor(Handle driver) const { return m_shards[KeyHash()(Key{driver, 0}) & m_shardMask]; }
+};
+
+#endif // ETA_CACHE_H
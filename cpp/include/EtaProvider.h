@@ -0,0 +1,65 @@
+#ifndef ETA_PROVIDER_H
+#define ETA_PROVIDER_H
+
+#include "Driver.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Source of driver-to-pickup travel time estimates
+ *
+ * Ranking and dispatch ask an EtaProvider instead of dividing distance by a
+ * fixed speed, so a road-speed model can be swapped in without touching the
+ * callers. The batch form takes the great-circle distances the caller has
+ * already computed with DistanceKernel (DriverPositionStore::computeEtas
+ * does both), so one sweep over the position columns yields N ETAs.
+ * Implementations must be safe to call from several threads at once.
+ */
+class EtaProvider {
+public:
+    using TimePoint = std::chrono::system_clock::time_point;
+
+    virtual ~EtaProvider() = default;
+
+    // Minutes to drive from `from` to `to`, leaving at `departure`
+    virtual double estimateMinutes(const Driver::Location& from, const Driver::Location& to,
+                                   TimePoint departure) const = 0;
+
+    // Minutes from each of `count` origins to one destination; distancesKm[i]
+    // is the great-circle distance of origin i, and etaMinutes may alias it
+    virtual void estimateBatch(const Driver::Location& destination, const double* latitudes,
+                               const double* longitudes, const double* distancesKm, size_t count,
+                               TimePoint departure, double* etaMinutes) const = 0;
+
+    virtual const char* getName() const = 0;
+
+    // Hours since the epoch on the clock the provider's speeds follow; two
+    // departures in the same hour get the same estimate. UTC by default
+    virtual int64_t getDepartureHour(TimePoint departure) const;
+};
+
+/**
+ * @brief Distance over one average speed; the behaviour before ETA providers
+ */
+class ConstantSpeedEtaProvider : public EtaProvider {
+public:
+    static constexpr double DEFAULT_SPEED_KMH = 30.0;
+
+private:
+    double m_speedKmh;
+
+public:
+    explicit ConstantSpeedEtaProvider(double speedKmh = DEFAULT_SPEED_KMH);
+
+    double estimateMinutes(const Driver::Location& from, const Driver::Location& to,
+                           TimePoint departure) const override;
+    void estimateBatch(const Driver::Location& destination, const double* latitudes,
+                       const double* longitudes, const double* distancesKm, size_t count,
+                       TimePoint departure, double* etaMinutes) const override;
+    const char* getName() const override { return "constant-speed"; }
+
+    double getSpeedKmh() const { return m_speedKmh; }
+};
+
+#endif // ETA_PROVIDER_H
@@ -0,0 +1,68 @@
+#ifndef FAVORITE_REVERSE_INDEX_H
+#define FAVORITE_REVERSE_INDEX_H
+
+#include "IdInterner.h"
+#include "ShardedMap.h"
+#include "PopularityLeaderboard.h"
+#include <unordered_set>
+#include <vector>
+#include <utility>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @brief Driver -> users who favorited them, maintained edge by edge
+ *
+ * The forward favorites map answers "whose favorites is this user", this
+ * answers the reverse: followers of a driver and how many there are.
+ * FavoriteDriverManager mirrors every addFavoriteDriver/removeFavoriteDriver
+ * here and calls removeDriver() when a driver leaves, so popularity counts
+ * and "your favorite driver is online" fan-out cost O(followers) instead of
+ * a scan over every user. Drivers without followers have no entry.
+ * Counts also feed a PopularityLeaderboard, updated under the driver's
+ * shard lock so it never sees an edge's removal before its addition. The
+ * leaderboard is sharded the same way, so favorite writes to different
+ * shards never share a lock.
+ */
+class FavoriteReverseIndex {
+public:
+    using Handle = IdInterner::Handle;
+    using DriverCount = std::pair<Handle, size_t>; // Driver handle, follower count
+
+private:
+    ShardedMap<Handle, std::unordered_set<Handle>> m_followers;
+    std::atomic<size_t> m_edgeCount;
+    PopularityLeaderboard m_leaderboard;
+
+public:
+    FavoriteReverseIndex();
+
+    // Edge maintenance; each returns whether the index changed
+    bool add(Handle user, Handle driver);
+    bool remove(Handle user, Handle driver);
+
+    // Drops the driver's entry and returns its former followers so the caller
+    // can remove the matching forward edges
+    std::vector<Handle> removeDriver(Handle driver);
+    void clear();
+
+    // Queries
+    size_t getFavoriteCount(Handle driver) const;
+    std::vector<Handle> getFollowers(Handle driver) const;
+    std::vector<DriverCount> getFavoriteCounts() const; // Drivers with at least one follower
+    std::vector<DriverCount> getMostFavorited(size_t limit) const { return m_leaderboard.top(limit); } // O(limit)
+    size_t getEdgeCount() const { return m_edgeCount.load(std::memory_order_relaxed); }
+
+    // Calls fn(userHandle) for each follower under the driver's shard lock;
+    // fn must not call back into this index
+    template <typename Fn>
+    void forEachFollower(Handle driver, Fn&& fn) const {
+        m_followers.read(driver, [&fn](const std::unordered_set<Handle>& users) {
+            for (Handle user : users) {
+                fn(user);
+            }
+        });
+    }
+};
+
+#endif // FAVORITE_REVERSE_INDEX_H
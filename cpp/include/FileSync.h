@@ -0,0 +1,31 @@
+#ifndef FILE_SYNC_H
+#define FILE_SYNC_H
+
+#include <string>
+#include <cstdio>
+
+/**
+ * @brief fsync helpers for the write-temp-then-rename pattern
+ *
+ * A rename is only crash-safe once the new file's contents are on disk
+ * (syncFile/syncPath before the rename) and the directory entry is too
+ * (syncDirectory after it). replaceFile does the rename and the directory
+ * sync together. Used by BinarySnapshot::write and WriteAheadLog. Where
+ * directories cannot be opened (Windows) syncDirectory is a no-op.
+ */
+class FileSync {
+public:
+    // Flushes stdio buffers and the OS page cache for an open file
+    static bool syncFile(std::FILE* file);
+
+    // Same for a file the caller has already closed (e.g. written by a callback)
+    static bool syncPath(const std::string& path);
+
+    // Makes creates, renames and deletes in `directory` durable
+    static bool syncDirectory(const std::string& directory);
+
+    // rename(from, to), then syncDirectory on the parent of `to`
+    static bool replaceFile(const std::string& from, const std::string& to);
+};
+
+#endif // FILE_SYNC_H
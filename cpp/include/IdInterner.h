@@ -0,0 +1,50 @@
+#ifndef ID_INTERNER_H
+#define ID_INTERNER_H
+
+#include <string>
+#include <string_view>
+#include <deque>
+#include <unordered_map>
+#include <shared_mutex>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Thread-safe table mapping string IDs to dense 32-bit handles
+ *
+ * The first intern() of an ID assigns the next handle (0, 1, 2, ...), so
+ * handles can index vectors directly and cost 4 bytes wherever they are
+ * stored, instead of a std::string per reference. Handles are never freed:
+ * a driver that is removed and re-added gets its old handle back. Strings
+ * live in a deque, so references returned by getId() stay valid for the
+ * table's lifetime.
+ */
+class IdInterner {
+public:
+    using Handle = uint32_t;
+    static constexpr Handle INVALID_HANDLE = UINT32_MAX;
+
+private:
+    mutable std::shared_mutex m_mutex;
+    std::deque<std::string> m_ids;                         // Handle -> ID
+    std::unordered_map<std::string_view, Handle> m_handles; // Views into m_ids
+
+public:
+    IdInterner() = default;
+    IdInterner(const IdInterner&) = delete;
+    IdInterner& operator=(const IdInterner&) = delete;
+
+    // Returns the ID's handle, assigning one on first use
+    Handle intern(std::string_view id);
+
+    // Returns INVALID_HANDLE for IDs never interned; never allocates
+    Handle find(std::string_view id) const;
+
+    // Empty string for handles not issued by this table
+    const std::string& getId(Handle handle) const;
+
+    size_t size() const;
+    void reserve(size_t count);
+};
+
+#endif // ID_INTERNER_H
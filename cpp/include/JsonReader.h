@@ -0,0 +1,106 @@
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Single-pass pull parser for JSON text
+ *
+ * next() returns one token at a time; object member names come back as
+ * KEY tokens, so a caller reads an object with a loop over next() and a
+ * switch on getString(). Strings without escapes are returned as views
+ * into the input. Escaped strings are decoded into one scratch buffer that
+ * is reused, so parsing allocates nothing per field once that buffer has
+ * grown. A view stays valid until the next call to next(). The input must
+ * outlive the reader.
+ */
+class JsonReader {
+public:
+    enum class Token {
+        BEGIN_OBJECT,
+        END_OBJECT,
+        BEGIN_ARRAY,
+        END_ARRAY,
+        KEY,
+        STRING,
+        NUMBER,
+        BOOLEAN,
+        NULL_VALUE,
+        END,    // Complete document consumed
+        ERROR   // Malformed input; see getErrorOffset()
+    };
+
+    static constexpr size_t MAX_DEPTH = 64;
+
+private:
+    std::string_view m_input;
+    size_t m_position;
+    uint64_t m_isObject;  // Bit n set when level n is an object
+    size_t m_depth;
+    bool m_expectKey;
+    bool m_afterValue;
+    bool m_allowClose;    // Just opened a container, so it may close immediately
+    bool m_done;
+    bool m_failed;
+    size_t m_errorOffset;
+
+    std::string_view m_string;
+    std::string_view m_number;
+    bool m_boolean;
+    std::string m_scratch;
+
+public:
+    explicit JsonReader(std::string_view input);
+
+    Token next();
+
+    // Current token's value
+    std::string_view getString() const { return m_string; }  // KEY or STRING
+    bool getBoolean() const { return m_boolean; }
+    double getDouble() const;
+    int64_t getInt() const;
+
+    // Skips the value that follows a KEY (including nested containers)
+    bool skipValue();
+
+    // Typed reads of the next value; false on a type mismatch or bad input
+    bool readString(std::string& target);
+    bool readDouble(double& target);
+    bool readInt(int& target);
+    bool readInt64(int64_t& target);
+    bool readBool(bool& target);
+
+    // Reads an object, calling onMember(name) after each KEY; onMember must
+    // consume the member's value (skipValue() for unknown names)
+    template <typename MemberHandler>
+    bool readObject(MemberHandler&& onMember) {
+        if (next() != Token::BEGIN_OBJECT) {
+            return false;
+        }
+        Token token;
+        while ((token = next()) == Token::KEY) {
+            if (!onMember(getString())) {
+                return false;
+            }
+        }
+        return token == Token::END_OBJECT;
+    }
+
+    bool failed() const { return m_failed; }
+    size_t getErrorOffset() const { return m_errorOffset; }
+
+private:
+    Token parseValue();
+    bool parseString();
+    bool parseNumber();
+    bool parseLiteral(std::string_view literal);
+    void skipWhitespace();
+    Token fail();
+    bool inObject() const { return m_depth > 0 && (m_isObject >> (m_depth - 1)) & 1; }
+    void valueCompleted();
+};
+
+#endif // JSON_READER_H
@@ -0,0 +1,69 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Streaming JSON writer that appends to a caller-supplied buffer
+ *
+ * Emits compact JSON directly into a std::string the caller owns, so a
+ * buffer that is cleared and reused between objects stops allocating once
+ * it has grown to the working size. Strings are escaped per RFC 8259 and
+ * doubles use std::to_chars (shortest round-trip form); NaN and infinity
+ * are written as null. Commas are tracked with a bit per nesting level, so
+ * nesting is limited to MAX_DEPTH; nesting deeper, or closing a container
+ * that was never opened, sets failed() and the output must be discarded.
+ */
+class JsonWriter {
+public:
+    static constexpr size_t MAX_DEPTH = 64;
+
+private:
+    std::string& m_out;
+    uint64_t m_hasElements; // Bit n set once level n has an element
+    size_t m_depth;
+    bool m_afterKey;
+    bool m_failed;
+
+public:
+    explicit JsonWriter(std::string& out) : m_out(out), m_hasElements(0), m_depth(0), m_afterKey(false), m_failed(false) {}
+
+    // Structure
+    void beginObject() { separate(); m_out += '{'; push(); }
+    void endObject() { pop(); m_out += '}'; }
+    void beginArray() { separate(); m_out += '['; push(); }
+    void endArray() { pop(); m_out += ']'; }
+    void key(std::string_view name);
+
+    // Values
+    void value(std::string_view text);
+    void value(const char* text) { value(std::string_view(text)); }
+    void value(bool flag) { separate(); m_out += flag ? "true" : "false"; }
+    void value(int number) { value(static_cast<int64_t>(number)); }
+    void value(int64_t number);
+    void value(uint64_t number);
+    void value(double number);
+    void nullValue() { separate(); m_out += "null"; }
+
+    // By reference, so string fields are appended without a copy
+    template <typename T>
+    void field(std::string_view name, const T& fieldValue) {
+        key(name);
+        value(fieldValue);
+    }
+
+    std::string& buffer() { return m_out; }
+    bool failed() const { return m_failed; }
+
+    static void appendEscaped(std::string& out, std::string_view text);
+
+private:
+    void separate();
+    void push();
+    void pop();
+};
+
+#endif // JSON_WRITER_H
@@ -0,0 +1,84 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ * @brief HDR-style log-linear histogram of nanosecond latencies
+ *
+ * Values below SUB_BUCKETS each get an exact bucket. Above that, each
+ * power of two is split into SUB_BUCKETS / 2 equal buckets. Any recorded
+ * value is therefore known to within 1/32 (about 3%) at every scale, from
+ * nanoseconds up to the 2^40 ns (about 18 minute) ceiling, using 1152
+ * counters. bucketFor() is a count-leading-zeros and a shift, so the
+ * bucketing can also back the per-thread atomic counters in
+ * MetricsRegistry. Exact count, sum, min and max are kept next to the
+ * buckets.
+ */
+class LatencyHistogram {
+public:
+    static constexpr unsigned SUB_BUCKET_BITS = 6;
+    static constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BUCKET_BITS;
+    static constexpr unsigned MAX_EXPONENT = 40; // Values clamp just below 2^40 ns
+    static constexpr size_t BUCKET_COUNT = SUB_BUCKETS + (MAX_EXPONENT - SUB_BUCKET_BITS) * (SUB_BUCKETS / 2);
+
+private:
+    std::vector<uint64_t> m_counts;
+    uint64_t m_count;
+    uint64_t m_sum;
+    uint64_t m_min;
+    uint64_t m_max;
+
+public:
+    // Constructor
+    LatencyHistogram();
+
+    void record(uint64_t value);
+    // Adds pre-bucketed counts, as kept by a per-thread recorder
+    void addBucket(size_t bucket, uint64_t count);
+    void addTotals(uint64_t count, uint64_t sum, uint64_t min, uint64_t max);
+    void merge(const LatencyHistogram& other);
+    void clear();
+
+    uint64_t getCount() const { return m_count; }
+    uint64_t getSum() const { return m_sum; }
+    uint64_t getMin() const { return m_count ? m_min : 0; }
+    uint64_t getMax() const { return m_max; }
+    double getMean() const { return m_count ? static_cast<double>(m_sum) / m_count : 0.0; }
+    // Midpoint of the bucket holding the given percentile (0-100), clamped to [min, max]
+    uint64_t valueAtPercentile(double percentile) const;
+
+    // Bucketing
+    static size_t bucketFor(uint64_t value) {
+        if (value < SUB_BUCKETS) {
+            return static_cast<size_t>(value);
+        }
+        if (value >> MAX_EXPONENT) {
+            value = (uint64_t(1) << MAX_EXPONENT) - 1;
+        }
+        unsigned msb = highestBit(value);
+        unsigned shift = msb - (SUB_BUCKET_BITS - 1);
+        return SUB_BUCKETS + (msb - SUB_BUCKET_BITS) * (SUB_BUCKETS / 2) +
+               static_cast<size_t>((value >> shift) - SUB_BUCKETS / 2);
+    }
+    static uint64_t bucketLow(size_t bucket);
+    static uint64_t bucketWidth(size_t bucket);
+
+private:
+    static unsigned highestBit(uint64_t value) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return static_cast<unsigned>(index);
+#else
+        return 63u - static_cast<unsigned>(__builtin_clzll(value));
+#endif
+    }
+};
+
+#endif // LATENCY_HISTOGRAM_H
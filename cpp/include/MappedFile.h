@@ -0,0 +1,37 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+/**
+ * @brief Read-only view of a whole file: mmap on POSIX, a heap copy elsewhere
+ *
+ * Shared by the binary formats that are read in place (BinarySnapshot,
+ * SpeedGridEtaProvider). The view stays valid until close() or destruction.
+ */
+class MappedFile {
+private:
+    const char* m_data;
+    size_t m_size;
+#if defined(_WIN32)
+    std::vector<char> m_buffer;
+#endif
+
+public:
+    MappedFile() : m_data(nullptr), m_size(0) {}
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& filename); // False if missing, empty or unmappable
+    void close();
+
+    const char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool isOpen() const { return m_data != nullptr; }
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,192 @@
+#ifndef METRICS_REGISTRY_H
+#define METRICS_REGISTRY_H
+
+#include "LatencyHistogram.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <thread>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Per-operation latency histograms and lock-wait counters
+ *
+ * Every thread records into its own shard, with no shared writes and no
+ * locks; the shard's counters are atomics written only by their owner.
+ * snapshot() merges the shards into one LatencyHistogram per operation
+ * on read. Shards outlive their threads, so short-lived threads keep
+ * their samples. Operation and lock names are fixed at construction, so
+ * ids are plain indices.
+ *
+ * Instrumentation compiles in when FAVORITE_DRIVER_METRICS is defined
+ * (CMake option ENABLE_METRICS). Without it METRICS_SCOPE expands to
+ * nothing and lockExclusive/lockShared are plain locks. The registry
+ * still exists but stays empty, so callers need no #ifdefs of their own.
+ * Queue depths are sampled at snapshot time and not recorded; owners
+ * append them to Snapshot::gauges.
+ */
+class MetricsRegistry {
+public:
+    using Clock = std::chrono::steady_clock;
+    using OperationId = uint32_t;
+    using LockId = uint32_t;
+
+    static constexpr size_t MAX_OPERATIONS = 32;
+    static constexpr size_t MAX_LOCKS = 8;
+
+    struct OperationSnapshot {
+        std::string name;
+        uint64_t count = 0;
+        double meanNs = 0.0;
+        uint64_t p50Ns = 0;
+        uint64_t p90Ns = 0;
+        uint64_t p99Ns = 0;
+        uint64_t p999Ns = 0;
+        uint64_t maxNs = 0;
+    };
+
+    struct LockSnapshot {
+        std::string name;
+        uint64_t acquisitions = 0;
+        uint64_t contended = 0;   // Acquisitions that had to wait
+        uint64_t waitNs = 0;      // Total time spent waiting
+        uint64_t p99WaitNs = 0;   // Over contended acquisitions
+        uint64_t maxWaitNs = 0;
+    };
+
+    struct GaugeSnapshot {
+        std::string name;
+        int64_t value = 0;
+    };
+
+    struct Snapshot {
+        std::vector<OperationSnapshot> operations;
+        std::vector<LockSnapshot> locks;
+        std::vector<GaugeSnapshot> gauges;
+        size_t threads = 0; // Threads that have recorded anything
+    };
+
+    // Records the lifetime of a scope into an operation's histogram
+    class ScopedLatency {
+    private:
+        MetricsRegistry& m_registry;
+        OperationId m_operation;
+        Clock::time_point m_start;
+
+    public:
+        ScopedLatency(MetricsRegistry& registry, OperationId operation)
+            : m_registry(registry), m_operation(operation), m_start(Clock::now()) {}
+        ~ScopedLatency() {
+            m_registry.record(m_operation, static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_start).count()));
+        }
+
+        ScopedLatency(const ScopedLatency&) = delete;
+        ScopedLatency& operator=(const ScopedLatency&) = delete;
+    };
+
+    static constexpr bool enabled() {
+#if defined(FAVORITE_DRIVER_METRICS)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+private:
+    struct Shard; // Defined in MetricsRegistry.cpp
+
+    std::vector<std::string> m_operationNames;
+    std::vector<std::string> m_lockNames;
+    uint64_t m_instance; // Unique per registry; keys each thread's shard cache
+
+    mutable std::mutex m_shardMutex;
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    std::unordered_map<std::thread::id, Shard*> m_threadShards;
+
+public:
+    // Constructor and Destructor; names beyond MAX_OPERATIONS / MAX_LOCKS are ignored
+    MetricsRegistry(std::vector<std::string> operations, std::vector<std::string> locks);
+    ~MetricsRegistry();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    // Recording; out-of-range ids are ignored
+    void record(OperationId operation, uint64_t nanos);
+    void recordLock(LockId lock, bool contended, uint64_t waitNanos);
+
+    // Lock acquisition that counts contention and wait time on `lock`
+    template <typename Mutex>
+    std::unique_lock<Mutex> lockExclusive(Mutex& mutex, LockId lock);
+    template <typename Mutex>
+    std::shared_lock<Mutex> lockShared(Mutex& mutex, LockId lock);
+
+    // Merged across threads
+    LatencyHistogram getHistogram(OperationId operation) const;
+    Snapshot snapshot() const;
+
+    // Fixed-width text table, one row per operation, lock and gauge
+    static std::string format(const Snapshot& snapshot);
+    std::string dump() const { return format(snapshot()); }
+
+private:
+    Shard& localShard();
+    LatencyHistogram mergeSlot(size_t slot) const; // Caller holds m_shardMutex
+};
+
+#if defined(FAVORITE_DRIVER_METRICS)
+#define METRICS_CONCAT_INNER(a, b) a##b
+#define METRICS_CONCAT(a, b) METRICS_CONCAT_INNER(a, b)
+#define METRICS_SCOPE(registry, operation) \
+    MetricsRegistry::ScopedLatency METRICS_CONCAT(metricsScope_, __LINE__)((registry), (operation))
+#else
+#define METRICS_SCOPE(registry, operation) static_cast<void>(0)
+#endif
+
+// Template implementations
+template <typename Mutex>
+std::unique_lock<Mutex> MetricsRegistry::lockExclusive(Mutex& mutex, LockId lock) {
+#if defined(FAVORITE_DRIVER_METRICS)
+    // Uncontended acquisitions skip the clock entirely
+    std::unique_lock<Mutex> guard(mutex, std::try_to_lock);
+    if (guard.owns_lock()) {
+        recordLock(lock, false, 0);
+        return guard;
+    }
+    Clock::time_point start = Clock::now();
+    guard.lock();
+    recordLock(lock, true, static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()));
+    return guard;
+#else
+    static_cast<void>(lock);
+    return std::unique_lock<Mutex>(mutex);
+#endif
+}
+
+template <typename Mutex>
+std::shared_lock<Mutex> MetricsRegistry::lockShared(Mutex& mutex, LockId lock) {
+#if defined(FAVORITE_DRIVER_METRICS)
+    std::shared_lock<Mutex> guard(mutex, std::try_to_lock);
+    if (guard.owns_lock()) {
+        recordLock(lock, false, 0);
+        return guard;
+    }
+    Clock::time_point start = Clock::now();
+    guard.lock();
+    recordLock(lock, true, static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()));
+    return guard;
+#else
+    static_cast<void>(lock);
+    return std::shared_lock<Mutex>(mutex);
+#endif
+}
+
+#endif // METRICS_REGISTRY_H
@@ -0,0 +1,133 @@
+#ifndef NOTIFICATION_PIPELINE_H
+#define NOTIFICATION_PIPELINE_H
+
+#include "BoundedMpmcQueue.h"
+#include <string>
+#include <vector>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Asynchronous notification fan-out with per-recipient batching
+ *
+ * post() pushes onto a lock-free bounded ring and returns at once. It never
+ * waits on the sink, so a slow push gateway cannot stall the request that
+ * raised the notification. A single delivery thread drains the ring in
+ * rounds of up to maxBatch messages and groups them by recipient. Each
+ * recipient then gets one sink call per round, with messages in posting
+ * order.
+ *
+ * Within a round, two kinds of message are coalesced: exact repeats of the
+ * same text, and messages that share a non-empty coalesceKey. With a shared
+ * key the latest text wins, in the slot of the first. This suits status
+ * updates such as "driver 3 min away", where only the newest one matters.
+ * When the ring is full post() drops the message and counts it, so
+ * overload is shed and never turns into blocking. shutdown(), which the
+ * destructor also runs, stops intake, delivers what is queued and joins
+ * the thread.
+ *
+ * The sink can be replaced at any time with setSink(); each round uses the
+ * sink current when it starts. Rounds that run with no sink discard their
+ * messages and count them.
+ */
+class NotificationPipeline {
+public:
+    // One call per recipient per delivery round
+    using BatchSink = std::function<void(const std::string& recipient, const std::vector<std::string>& messages)>;
+
+    static constexpr size_t DEFAULT_QUEUE_CAPACITY = 8192;
+
+    struct Options {
+        size_t queueCapacity = DEFAULT_QUEUE_CAPACITY;
+        size_t maxBatch = 512; // Messages drained per delivery round
+    };
+
+    struct Stats {
+        uint64_t posted = 0;
+        uint64_t dropped = 0;      // Ring full
+        uint64_t rejected = 0;     // Posted after shutdown()
+        uint64_t coalesced = 0;    // Superseded or repeated within a round
+        uint64_t delivered = 0;
+        uint64_t sinkCalls = 0;
+        uint64_t sinkFailures = 0; // Sink calls that threw
+        uint64_t discarded = 0;    // Drained while no sink was set
+        size_t queued = 0;
+    };
+
+private:
+    struct Message {
+        std::string recipient;
+        std::string text;
+        std::string coalesceKey;
+    };
+
+    // Swapped by setSink(); the delivery thread takes a reference per round
+    std::mutex m_sinkMutex;
+    std::shared_ptr<const BatchSink> m_sink;
+    Options m_options;
+    BoundedMpmcQueue<Message> m_queue;
+
+    std::atomic<bool> m_accepting;
+    std::atomic<bool> m_stopping;
+    std::atomic<int> m_activePosters; // post() calls past the intake check
+
+    // Parking for the delivery thread
+    std::mutex m_idleMutex;
+    std::condition_variable m_idleCondition;
+    std::atomic<bool> m_sleeping;
+
+    // flush() waits here for the delivery thread to catch up
+    std::mutex m_progressMutex;
+    std::condition_variable m_progressCondition;
+
+    // Counters
+    std::atomic<uint64_t> m_posted;
+    std::atomic<uint64_t> m_dropped;
+    std::atomic<uint64_t> m_rejected;
+    std::atomic<uint64_t> m_coalesced;
+    std::atomic<uint64_t> m_delivered;
+    std::atomic<uint64_t> m_sinkCalls;
+    std::atomic<uint64_t> m_sinkFailures;
+    std::atomic<uint64_t> m_discarded;
+
+    std::thread m_deliveryThread; // Started last, once every member above exists
+
+public:
+    // Constructors and Destructor; a null sink discards until setSink()
+    explicit NotificationPipeline(BatchSink sink);
+    NotificationPipeline(BatchSink sink, const Options& options);
+    ~NotificationPipeline();
+
+    NotificationPipeline(const NotificationPipeline&) = delete;
+    NotificationPipeline& operator=(const NotificationPipeline&) = delete;
+
+    // Safe to call while other threads post; takes effect from the next round
+    void setSink(BatchSink sink);
+
+    // Never blocks; false when the message was dropped (ring full) or rejected (shut down)
+    bool post(std::string recipient, std::string text);
+    bool post(std::string recipient, std::string text, std::string coalesceKey);
+
+    // Waits until every message accepted before the call is delivered or coalesced
+    void flush();
+
+    // Stops intake, delivers everything queued, joins the delivery thread
+    void shutdown();
+
+    Stats getStats() const;
+    const Options& getOptions() const { return m_options; }
+
+private:
+    void deliveryLoop();
+    void deliver(std::vector<Message>& round);
+    void publishProgress();
+    uint64_t settled() const;
+};
+
+#endif // NOTIFICATION_PIPELINE_H
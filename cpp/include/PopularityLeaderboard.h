@@ -0,0 +1,80 @@
+#ifndef POPULARITY_LEADERBOARD_H
+#define POPULARITY_LEADERBOARD_H
+
+#include "IdInterner.h"
+#include <set>
+#include <unordered_map>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <shared_mutex>
+#include <cstddef>
+
+/**
+ * @brief Drivers ranked by favorite count, updated one edge at a time
+ *
+ * Drivers are hash-partitioned over SHARD_COUNT shards, each holding an
+ * ordered set of (count, driver) plus a driver -> position map under its
+ * own reader-writer lock. An increment or decrement locks one shard and
+ * re-keys one node in O(log n), reusing the node so steady-state updates
+ * do not allocate. Shards are picked exactly as ShardedMap picks them for
+ * the same handle, so FavoriteReverseIndex's updates, made under its own
+ * shard lock, only meet writers that already share that shard.
+ *
+ * top(limit) takes the first `limit` entries of every shard and merges
+ * them, O(SHARD_COUNT * limit). Counts are exact; like ShardedMap::forEach
+ * the merged ranking visits one shard at a time rather than a global
+ * snapshot. Drivers whose count drops to zero leave the ranking. Ties are
+ * ordered by driver handle so results are stable.
+ */
+class PopularityLeaderboard {
+public:
+    using Handle = IdInterner::Handle;
+    using RankedDriver = std::pair<Handle, size_t>; // Driver handle, favorite count
+
+    static constexpr size_t SHARD_COUNT = 16; // Power of two; matches ShardedMap::DEFAULT_SHARD_COUNT
+
+private:
+    struct Entry {
+        size_t count;
+        Handle driver;
+    };
+
+    struct MorePopular {
+        bool operator()(const Entry& a, const Entry& b) const {
+            return a.count != b.count ? a.count > b.count : a.driver < b.driver;
+        }
+    };
+
+    using Ranking = std::set<Entry, MorePopular>;
+
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        Ranking ranking;
+        std::unordered_map<Handle, Ranking::iterator> positions;
+    };
+
+    std::unique_ptr<Shard[]> m_shards;
+
+public:
+    PopularityLeaderboard() : m_shards(new Shard[SHARD_COUNT]) {}
+    PopularityLeaderboard(const PopularityLeaderboard&) = delete;
+    PopularityLeaderboard& operator=(const PopularityLeaderboard&) = delete;
+
+    // Updates; O(log n) under one shard lock
+    void increment(Handle driver) { adjust(driver, 1); }
+    void decrement(Handle driver) { adjust(driver, -1); }
+    void remove(Handle driver);
+    void clear();
+
+    // Queries; top() is O(SHARD_COUNT * limit)
+    std::vector<RankedDriver> top(size_t limit) const;
+    size_t getCount(Handle driver) const;
+    size_t size() const;
+
+private:
+    void adjust(Handle driver, long delta);
+    Shard& shardFor(Handle driver) const;
+};
+
+#endif // POPULARITY_LEADERBOARD_H
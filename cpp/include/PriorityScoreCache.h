@@ -0,0 +1,169 @@
+#ifndef PRIORITY_SCORE_CACHE_H
+#define PRIORITY_SCORE_CACHE_H
+
+#include "IdInterner.h"
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Cached distance-free driver priority per (user, driver), plus top-N selection
+ *
+ * Most of calculateDriverPriority moves slowly: favorite status, rating and
+ * acceptance rate. That static part is computed once per (user, driver)
+ * and reused. Only the distance term is recomputed at request time, as
+ * score = static - distancePenaltyPerKm * distanceKm.
+ *
+ * Invalidation uses versions. invalidateDriver() (rating or acceptance
+ * change) bumps the driver's version, and invalidateUser() (favorites
+ * change) bumps the user's version. An entry stored under older versions
+ * is a miss. Versions live in fixed tables indexed by handle bits, so two
+ * handles can share a slot. That costs an extra recompute, never a stale
+ * hit.
+ *
+ * All of a user's entries live in one shard. rank() therefore takes a
+ * single shared lock for the whole candidate list and one exclusive lock
+ * to store its misses. A shard that reaches capacity is cleared; entries
+ * are cheap to recompute. Selection uses nth_element, so ranking n
+ * candidates for the top k costs O(n + k log k) rather than a full sort.
+ */
+class PriorityScoreCache {
+public:
+    using Handle = IdInterner::Handle;
+
+    static constexpr size_t DEFAULT_SHARD_COUNT = 16;
+    static constexpr size_t VERSION_SLOTS = 1 << 16;
+
+    struct Options {
+        size_t capacity = 1 << 20; // Entries across all shards
+        size_t shardCount = DEFAULT_SHARD_COUNT;
+        double distancePenaltyPerKm = 10.0;
+    };
+
+    struct Ranked {
+        Handle driver;
+        double score;
+        double distanceKm;
+    };
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t invalidations = 0; // Misses on an entry whose user or driver changed since
+        uint64_t resets = 0;        // Shards cleared on reaching capacity
+        size_t size = 0;
+    };
+
+private:
+    struct Entry {
+        double score;
+        uint32_t driverVersion;
+        uint32_t userVersion;
+    };
+
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<uint64_t, Entry> entries;
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+        std::atomic<uint64_t> invalidations{0};
+        std::atomic<uint64_t> resets{0};
+    };
+
+    std::unique_ptr<Shard[]> m_shards;
+    size_t m_shardMask;
+    size_t m_shardCapacity;
+    double m_distancePenaltyPerKm;
+    std::unique_ptr<std::atomic<uint32_t>[]> m_driverVersions;
+    std::unique_ptr<std::atomic<uint32_t>[]> m_userVersions;
+
+public:
+    // Constructors
+    PriorityScoreCache();
+    explicit PriorityScoreCache(const Options& options);
+
+    PriorityScoreCache(const PriorityScoreCache&) = delete;
+    PriorityScoreCache& operator=(const PriorityScoreCache&) = delete;
+
+    // Ranks `count` candidate drivers for `user` and writes the best `limit`,
+    // highest score first (ties by driver handle), to `ranked`.
+    // staticScore(driver) supplies the distance-free priority on a miss.
+    template <typename StaticScoreFn>
+    void rank(Handle user, const Handle* drivers, const double* distancesKm, size_t count, size_t limit,
+              StaticScoreFn&& staticScore, std::vector<Ranked>& ranked);
+
+    // Cached static part for one pair
+    template <typename StaticScoreFn>
+    double getStaticScore(Handle user, Handle driver, StaticScoreFn&& staticScore);
+
+    // Invalidation
+    void invalidateDriver(Handle driver); // Rating or acceptance rate changed
+    void invalidateUser(Handle user);     // Favorites changed
+    void clear();
+
+    // Keeps the best `limit` of `candidates`, sorted best first
+    static void selectTop(std::vector<Ranked>& candidates, size_t limit);
+
+    double getDistancePenaltyPerKm() const { return m_distancePenaltyPerKm; }
+    Stats getStats() const;
+
+private:
+    static uint64_t keyFor(Handle user, Handle driver) { return (static_cast<uint64_t>(user) << 32) | driver; }
+    Shard& shardFor(Handle user) const {
+        return m_shards[(static_cast<uint64_t>(user) * 0x9E3779B97F4A7C15ull >> 32) & m_shardMask];
+    }
+    uint32_t driverVersion(Handle driver) const {
+        return m_driverVersions[driver & (VERSION_SLOTS - 1)].load(std::memory_order_acquire);
+    }
+    uint32_t userVersion(Handle user) const {
+        return m_userVersions[user & (VERSION_SLOTS - 1)].load(std::memory_order_acquire);
+    }
+
+    // Looks each driver up under one shared lock; misses get their index pushed to `missing`
+    void lookupAll(Shard& shard, Handle user, uint32_t userVersionNow, const Handle* drivers, size_t count,
+                   double* scores, uint32_t* driverVersions, std::vector<size_t>& missing) const;
+    void storeAll(Shard& shard, Handle user, uint32_t userVersionNow, const Handle* drivers,
+                  const double* scores, const uint32_t* driverVersions, const std::vector<size_t>& missing);
+};
+
+// Template implementations
+template <typename StaticScoreFn>
+void PriorityScoreCache::rank(Handle user, const Handle* drivers, const double* distancesKm, size_t count,
+                              size_t limit, StaticScoreFn&& staticScore, std::vector<Ranked>& ranked) {
+    // Versions are read before any score is computed, so a change that lands
+    // mid-computation leaves the stored entry stale rather than wrong
+    Shard& shard = shardFor(user);
+    uint32_t userVersionNow = userVersion(user);
+    std::vector<double> scores(count);
+    std::vector<uint32_t> versions(count);
+    std::vector<size_t> missing;
+    lookupAll(shard, user, userVersionNow, drivers, count, scores.data(), versions.data(), missing);
+    for (size_t i : missing) {
+        scores[i] = staticScore(drivers[i]);
+    }
+    if (!missing.empty()) {
+        storeAll(shard, user, userVersionNow, drivers, scores.data(), versions.data(), missing);
+    }
+
+    ranked.clear();
+    ranked.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        ranked.push_back(Ranked{drivers[i], scores[i] - m_distancePenaltyPerKm * distancesKm[i], distancesKm[i]});
+    }
+    selectTop(ranked, limit);
+}
+
+template <typename StaticScoreFn>
+double PriorityScoreCache::getStaticScore(Handle user, Handle driver, StaticScoreFn&& staticScore) {
+    double distanceKm = 0.0;
+    std::vector<Ranked> ranked;
+    rank(user, &driver, &distanceKm, 1, 1, std::forward<StaticScoreFn>(staticScore), ranked);
+    return ranked[0].score;
+}
+
+#endif // PRIORITY_SCORE_CACHE_H
@@ -0,0 +1,56 @@
+#ifndef REQUEST_ID_GENERATOR_H
+#define REQUEST_ID_GENERATOR_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Lock-free, time-ordered, fixed-width ride request IDs
+ *
+ * IDs are Snowflake-style:
+ *   42 bits  milliseconds since EPOCH_MILLIS (good until 2163)
+ *   10 bits  node ID, set once per process with setNodeId()
+ *   10 bits  thread slot
+ *   13 bits  sequence within the millisecond
+ * The 75 bits are written as 15 Crockford base-32 characters, so every ID
+ * fits the small-string buffer and sorts lexicographically by creation time.
+ *
+ * A thread leases a slot on its first call and returns it when the thread
+ * exits; that is the only point where a lock is taken. The slot's
+ * last-millisecond and sequence state is owned by the leaseholder, so
+ * next() is one clock read plus arithmetic. The state stays with the slot
+ * after the thread exits, so the next leaseholder continues from it. A
+ * sequence overflow, or a clock that steps backwards, advances the slot's
+ * logical millisecond instead of repeating an ID. Threads beyond the slot
+ * count share one mutex-guarded overflow slot.
+ */
+class RequestIdGenerator {
+public:
+    static constexpr size_t ID_LENGTH = 15;
+    static constexpr unsigned TIMESTAMP_BITS = 42;
+    static constexpr unsigned NODE_BITS = 10;
+    static constexpr unsigned SLOT_BITS = 10;
+    static constexpr unsigned SEQUENCE_BITS = 13;
+    static constexpr int64_t EPOCH_MILLIS = 1704067200000; // 2024-01-01T00:00:00Z
+
+    struct Parts {
+        int64_t unixMillis; // Logical creation time, ms since the Unix epoch
+        uint32_t node;
+        uint32_t slot;
+        uint32_t sequence;
+    };
+
+    static std::string next();
+
+    // Splits an ID produced by next(); false if `id` is not one
+    static bool decode(std::string_view id, Parts& parts);
+
+    // Distinguishes processes sharing an ID space; masked to NODE_BITS.
+    // Set before the first request is created.
+    static void setNodeId(uint32_t node);
+    static uint32_t getNodeId();
+};
+
+#endif // REQUEST_ID_GENERATOR_H
@@ -0,0 +1,62 @@
+#ifndef RIDE_REQUEST_POOL_H
+#define RIDE_REQUEST_POOL_H
+
+#include "RideRequest.h"
+#include <memory>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Slab-backed recycling pool for RideRequest objects
+ *
+ * acquire() hands out an ordinary std::shared_ptr<RideRequest>. The object
+ * and the shared_ptr control block both come from slabs owned by the pool.
+ * When the last reference drops, the request goes back on the free list
+ * still constructed, so its string members keep their heap buffers. The
+ * next acquire() assigns into those buffers. Once the pool has grown to
+ * the peak number of live requests, creating and retiring a request
+ * performs no heap allocation (RideRequest::reset() frees any string that
+ * grew past its retained capacity).
+ *
+ * Pointers may outlive the pool: each control block keeps the slabs alive
+ * until its request has been returned.
+ */
+class RideRequestPool {
+public:
+    static constexpr size_t DEFAULT_SLAB_SIZE = 256;
+
+    struct Stats {
+        size_t slabs = 0;     // Request slabs allocated
+        size_t capacity = 0;  // Request slots across all slabs
+        size_t inUse = 0;     // Requests currently handed out
+        uint64_t acquired = 0;
+        uint64_t reused = 0;  // acquire() calls served by a recycled request
+    };
+
+private:
+    struct State;
+    std::shared_ptr<State> m_state;
+
+public:
+    RideRequestPool();
+    explicit RideRequestPool(size_t slabSize);
+
+    RideRequestPool(const RideRequestPool&) = delete;
+    RideRequestPool& operator=(const RideRequestPool&) = delete;
+
+    // Copy of `prototype`, ID included
+    std::shared_ptr<RideRequest> acquire(const RideRequest& prototype);
+
+    // Fresh request with a new ID, as the matching RideRequest constructor would build
+    std::shared_ptr<RideRequest> acquire(const std::string& userId, const Driver::Location& pickup,
+                                         const Driver::Location& dropoff,
+                                         RideRequest::RideType type = RideRequest::RideType::STANDARD);
+
+    // Grows the slabs to hold `count` live requests so warm-up does not allocate
+    void reserve(size_t count);
+
+    Stats getStats() const;
+};
+
+#endif // RIDE_REQUEST_POOL_H
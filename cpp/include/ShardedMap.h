@@ -0,0 +1,190 @@
+#ifndef SHARDED_MAP_H
+#define SHARDED_MAP_H
+
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Hash-partitioned map with a reader-writer lock per shard
+ *
+ * Keys are spread over a fixed, power-of-two number of shards, each an
+ * unordered_map guarded by its own std::shared_mutex. Lookups take a shared
+ * lock on one shard only, so readers never wait on each other and writers
+ * only contend when they hit the same shard. Callbacks passed to read(),
+ * modify() and forEach() run while the shard lock is held and must not
+ * call back into the same map.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class ShardedMap {
+public:
+    static constexpr size_t DEFAULT_SHARD_COUNT = 16;
+
+private:
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<Key, Value, Hash> entries;
+    };
+
+    std::unique_ptr<Shard[]> m_shards;
+    size_t m_shardMask;
+    Hash m_hash;
+
+public:
+    // Constructor; shardCount is rounded up to a power of two
+    explicit ShardedMap(size_t shardCount = DEFAULT_SHARD_COUNT) {
+        size_t count = 1;
+        while (count < shardCount) {
+            count <<= 1;
+        }
+        m_shards.reset(new Shard[count]);
+        m_shardMask = count - 1;
+    }
+
+    ShardedMap(const ShardedMap&) = delete;
+    ShardedMap& operator=(const ShardedMap&) = delete;
+
+    // Single-key writes
+    bool insert(const Key& key, Value value) {
+        Shard& shard = shardFor(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        return shard.entries.emplace(key, std::move(value)).second;
+    }
+
+    void insertOrAssign(const Key& key, Value value) {
+        Shard& shard = shardFor(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.entries[key] = std::move(value);
+    }
+
+    bool erase(const Key& key) {
+        Shard& shard = shardFor(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        return shard.entries.erase(key) > 0;
+    }
+
+    // Runs fn(Value&) under the shard's exclusive lock; false if key is absent
+    template <typename Fn>
+    bool modify(const Key& key, Fn&& fn) {
+        Shard& shard = shardFor(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        if (it == shard.entries.end()) {
+            return false;
+        }
+        fn(it->second);
+        return true;
+    }
+
+    // Like modify(), but erases the entry when fn returns false (e.g. it became empty)
+    template <typename Fn>
+    bool modifyOrErase(const Key& key, Fn&& fn) {
+        Shard& shard = shardFor(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        if (it == shard.entries.end()) {
+            return false;
+        }
+        if (!fn(it->second)) {
+            shard.entries.erase(it);
+        }
+        return true;
+    }
+
+    // Removes the entry and hands back its value
+    std::optional<Value> take(const Key& key) {
+        Shard& shard = shardFor(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        if (it == shard.entries.end()) {
+            return std::nullopt;
+        }
+        std::optional<Value> value(std::move(it->second));
+        shard.entries.erase(it);
+        return value;
+    }
+
+    // Runs fn(Value&) on the existing or default-constructed value and returns its result
+    template <typename Fn>
+    decltype(auto) upsert(const Key& key, Fn&& fn) {
+        Shard& shard = shardFor(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        return fn(shard.entries[key]);
+    }
+
+    // Single-key reads
+    bool contains(const Key& key) const {
+        const Shard& shard = shardFor(key);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        return shard.entries.count(key) > 0;
+    }
+
+    std::optional<Value> find(const Key& key) const {
+        const Shard& shard = shardFor(key);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        if (it == shard.entries.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    // Runs fn(const Value&) under the shard's shared lock; false if key is absent
+    template <typename Fn>
+    bool read(const Key& key, Fn&& fn) const {
+        const Shard& shard = shardFor(key);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        if (it == shard.entries.end()) {
+            return false;
+        }
+        fn(it->second);
+        return true;
+    }
+
+    // Whole-map operations visit one shard at a time; they are not a global snapshot
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (size_t i = 0; i <= m_shardMask; ++i) {
+            std::shared_lock<std::shared_mutex> lock(m_shards[i].mutex);
+            for (const auto& entry : m_shards[i].entries) {
+                fn(entry.first, entry.second);
+            }
+        }
+    }
+
+    size_t size() const {
+        size_t total = 0;
+        for (size_t i = 0; i <= m_shardMask; ++i) {
+            std::shared_lock<std::shared_mutex> lock(m_shards[i].mutex);
+            total += m_shards[i].entries.size();
+        }
+        return total;
+    }
+
+    void clear() {
+        for (size_t i = 0; i <= m_shardMask; ++i) {
+            std::unique_lock<std::shared_mutex> lock(m_shards[i].mutex);
+            m_shards[i].entries.clear();
+        }
+    }
+
+    size_t getShardCount() const { return m_shardMask + 1; }
+
+private:
+    Shard& shardFor(const Key& key) const {
+        // Fold the high bits in so weak hashes (e.g. sequential IDs) still spread
+        uint64_t h = m_hash(key);
+        h ^= h >> 17;
+        h *= 0x9E3779B97F4A7C15ull;
+        return m_shards[static_cast<size_t>(h >> 32) & m_shardMask];
+    }
+};
+
+#endif // SHARDED_MAP_H
@@ -0,0 +1,156 @@
+#ifndef SMALL_SORTED_SET_H
+#define SMALL_SORTED_SET_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * @brief Sorted set of trivially copyable values with inline storage
+ *
+ * Up to InlineCapacity elements live inside the object itself, so a set
+ * that fits costs sizeof(SmallSortedSet) and no heap allocation, instead
+ * of an unordered_set's bucket array and one node per element. Elements
+ * are kept sorted: contains() is a binary search over one cache line or
+ * two, and iteration is a plain array walk. Growing past the inline
+ * capacity moves the elements to a heap array that doubles as needed.
+ */
+template <typename T, size_t InlineCapacity>
+class SmallSortedSet {
+    static_assert(std::is_trivially_copyable<T>::value, "SmallSortedSet holds trivially copyable values");
+    static_assert(InlineCapacity > 0, "InlineCapacity must be positive");
+
+private:
+    uint32_t m_size;
+    uint32_t m_capacity; // == InlineCapacity while the elements are inline
+    union {
+        T m_inline[InlineCapacity];
+        T* m_heap;
+    };
+
+public:
+    using const_iterator = const T*;
+
+    // Constructors and Destructor
+    SmallSortedSet() : m_size(0), m_capacity(InlineCapacity) {}
+
+    SmallSortedSet(const SmallSortedSet& other) : m_size(0), m_capacity(InlineCapacity) {
+        assign(other);
+    }
+
+    SmallSortedSet(SmallSortedSet&& other) noexcept : m_size(0), m_capacity(InlineCapacity) {
+        steal(other);
+    }
+
+    SmallSortedSet& operator=(const SmallSortedSet& other) {
+        if (this != &other) {
+            clear();
+            assign(other);
+        }
+        return *this;
+    }
+
+    SmallSortedSet& operator=(SmallSortedSet&& other) noexcept {
+        if (this != &other) {
+            release();
+            steal(other);
+        }
+        return *this;
+    }
+
+    ~SmallSortedSet() { release(); }
+
+    // Modifiers; insert() and erase() return whether the set changed
+    bool insert(const T& value) {
+        T* first = data();
+        T* position = std::lower_bound(first, first + m_size, value);
+        if (position != first + m_size && *position == value) {
+            return false;
+        }
+
+        size_t index = static_cast<size_t>(position - first);
+        if (m_size == m_capacity) {
+            grow();
+            first = data();
+        }
+        std::memmove(first + index + 1, first + index, (m_size - index) * sizeof(T));
+        first[index] = value;
+        ++m_size;
+        return true;
+    }
+
+    bool erase(const T& value) {
+        T* first = data();
+        T* position = std::lower_bound(first, first + m_size, value);
+        if (position == first + m_size || !(*position == value)) {
+            return false;
+        }
+        std::memmove(position, position + 1, (first + m_size - position - 1) * sizeof(T));
+        --m_size;
+        return true;
+    }
+
+    void clear() { m_size = 0; }
+
+    // Queries
+    bool contains(const T& value) const {
+        const T* first = data();
+        const T* position = std::lower_bound(first, first + m_size, value);
+        return position != first + m_size && *position == value;
+    }
+    size_t count(const T& value) const { return contains(value) ? 1 : 0; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    bool isInline() const { return m_capacity == InlineCapacity; }
+    size_t heapBytes() const { return isInline() ? 0 : m_capacity * sizeof(T); }
+
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + m_size; }
+
+private:
+    T* data() { return isInline() ? m_inline : m_heap; }
+    const T* data() const { return isInline() ? m_inline : m_heap; }
+
+    void grow() {
+        uint32_t capacity = m_capacity * 2;
+        T* heap = new T[capacity];
+        std::memcpy(heap, data(), m_size * sizeof(T));
+        release();
+        m_heap = heap;
+        m_capacity = capacity;
+    }
+
+    void release() {
+        if (!isInline()) {
+            delete[] m_heap;
+            m_capacity = InlineCapacity;
+        }
+    }
+
+    // Both helpers expect *this to be empty; steal() also expects it inline
+    void assign(const SmallSortedSet& other) {
+        if (other.m_size > m_capacity) {
+            release();
+            m_heap = new T[other.m_capacity];
+            m_capacity = other.m_capacity;
+        }
+        std::memcpy(data(), other.data(), other.m_size * sizeof(T));
+        m_size = other.m_size;
+    }
+
+    void steal(SmallSortedSet& other) {
+        if (other.isInline()) {
+            std::memcpy(m_inline, other.m_inline, sizeof(m_inline)); // Whole array: a fixed-size copy
+        } else {
+            m_heap = other.m_heap;
+            m_capacity = other.m_capacity;
+            other.m_capacity = InlineCapacity;
+        }
+        m_size = other.m_size;
+        other.m_size = 0;
+    }
+};
+
+#endif // SMALL_SORTED_SET_H
@@ -0,0 +1,71 @@
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include "Driver.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <cstdint>
+
+/**
+ * @brief Uniform latitude/longitude grid over driver positions
+ *
+ * Drivers are bucketed into square-ish grid cells so that radius and
+ * k-nearest queries only visit the cells overlapping the search area
+ * instead of scanning every driver. When that area holds more cells than
+ * are occupied, queries filter the occupied cells instead, so their cost
+ * never grows past one pass over the occupied cells. The index is not synchronized on its
+ * own; callers (FavoriteDriverManager) guard it with their own lock.
+ */
+class SpatialIndex {
+public:
+    using DriverPtr = std::shared_ptr<Driver>;
+
+private:
+    struct Entry {
+        DriverPtr driver;
+        int64_t cellKey;
+        size_t slot; // Position inside the cell's bucket
+    };
+
+    // Cell key -> drivers currently inside that cell
+    std::unordered_map<int64_t, std::vector<DriverPtr>> m_cells;
+
+    // Driver ID -> cell membership
+    std::unordered_map<std::string, Entry> m_entries;
+
+    double m_cellSizeKm;
+    double m_cellSizeDegrees;
+
+public:
+    static constexpr double DEFAULT_CELL_SIZE_KM = 1.0;
+
+    // Constructor
+    explicit SpatialIndex(double cellSizeKm = DEFAULT_CELL_SIZE_KM);
+
+    // Index maintenance
+    bool insert(DriverPtr driver);
+    bool remove(const std::string& driverId);
+    bool update(const Driver& driver); // Re-bucket after a location change
+    void clear();
+
+    // Queries
+    std::vector<DriverPtr> queryRadius(const Driver::Location& center, double radiusKm) const;
+    std::vector<DriverPtr> findNearestAvailable(const Driver::Location& center, size_t count,
+                                                double maxRadiusKm) const;
+    bool contains(const std::string& driverId) const;
+    size_t size() const { return m_entries.size(); }
+    size_t getCellCount() const { return m_cells.size(); }
+    double getCellSizeKm() const { return m_cellSizeKm; }
+
+private:
+    // Helper methods
+    int32_t rowFor(double latitude) const;
+    int32_t columnFor(double longitude) const;
+    int64_t cellKeyFor(const Driver::Location& location) const;
+    static int64_t makeCellKey(int32_t row, int32_t column);
+    void detach(const Entry& entry);
+};
+
+#endif // SPATIAL_INDEX_H
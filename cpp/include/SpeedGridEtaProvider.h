@@ -0,0 +1,98 @@
+#ifndef SPEED_GRID_ETA_PROVIDER_H
+#define SPEED_GRID_ETA_PROVIDER_H
+
+#include "EtaProvider.h"
+#include "MappedFile.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief ETAs from a memory-mapped road-speed grid bucketed by hour of day
+ *
+ * File layout (little-endian): a fixed header (magic, version, grid origin,
+ * cell size, dimensions, UTC offset, checksum) followed by float km/h
+ * speeds indexed [hour][row][column]. Hours are the outer dimension so a
+ * batch at one departure time reads a single contiguous plane.
+ *
+ * A trip's speed is the mean of its origin and destination cell speeds at
+ * the departure hour; points outside the grid and cells without data
+ * (speed <= 0) use the fallback speed. As with BinarySnapshot, open() only
+ * validates the header and checksum and then reads the planes in place.
+ * Estimates are safe from many threads; open() and close() are not.
+ */
+class SpeedGridEtaProvider : public EtaProvider {
+public:
+    static constexpr uint32_t FORMAT_VERSION = 1;
+    static constexpr uint32_t HOURS_PER_DAY = 24;
+
+    struct GridSpec {
+        double minLatitude;
+        double minLongitude;
+        double cellSizeDegrees;
+        uint32_t rows;
+        uint32_t columns;
+        int32_t utcOffsetMinutes; // Picks the local hour of the city the grid covers
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t headerSize;
+        double minLatitude;
+        double minLongitude;
+        double cellSizeDegrees;
+        uint32_t rows;
+        uint32_t columns;
+        int32_t utcOffsetMinutes;
+        uint32_t reserved;
+        uint64_t fileSize;
+        uint64_t checksum; // Over the speed planes
+    };
+
+private:
+    MappedFile m_file;
+    const Header* m_header;
+    const float* m_speeds;
+    double m_inverseCellSize;
+    double m_fallbackSpeedKmh;
+    std::string m_lastError;
+
+public:
+    explicit SpeedGridEtaProvider(double fallbackSpeedKmh = ConstantSpeedEtaProvider::DEFAULT_SPEED_KMH);
+
+    SpeedGridEtaProvider(const SpeedGridEtaProvider&) = delete;
+    SpeedGridEtaProvider& operator=(const SpeedGridEtaProvider&) = delete;
+
+    // Writing; speedsKmh holds HOURS_PER_DAY * rows * columns entries
+    static bool write(const std::string& filename, const GridSpec& spec, const std::vector<float>& speedsKmh,
+                      std::string* error = nullptr);
+
+    // Reading
+    bool open(const std::string& filename, bool verifyChecksum = true);
+    void close();
+    bool isOpen() const { return m_header != nullptr; }
+    const std::string& getLastError() const { return m_lastError; }
+
+    // Lookups
+    double getSpeedKmh(const Driver::Location& location, TimePoint time) const;
+    int getHourOfDay(TimePoint time) const; // Local hour, using the grid's UTC offset
+    double getFallbackSpeedKmh() const { return m_fallbackSpeedKmh; }
+
+    // EtaProvider
+    double estimateMinutes(const Driver::Location& from, const Driver::Location& to,
+                           TimePoint departure) const override;
+    void estimateBatch(const Driver::Location& destination, const double* latitudes,
+                       const double* longitudes, const double* distancesKm, size_t count,
+                       TimePoint departure, double* etaMinutes) const override;
+    const char* getName() const override { return "speed-grid"; }
+    int64_t getDepartureHour(TimePoint departure) const override; // Local hours, as getHourOfDay
+
+private:
+    const float* plane(TimePoint time) const;
+    double speedAt(const float* plane, double latitude, double longitude) const;
+    bool fail(const std::string& message);
+};
+
+#endif // SPEED_GRID_ETA_PROVIDER_H
@@ -0,0 +1,102 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <chrono>
+#include <functional>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Hierarchical timing wheel for request timeouts
+ *
+ * Four levels of 64 slots each cover 2^24 ticks (about 46 hours at the
+ * default 10ms tick). Arming and cancelling are O(1): timers live in a
+ * slab of intrusive list nodes and handles carry a generation so stale
+ * handles are rejected. Time comes from an injectable clock; tests drive a
+ * virtual clock and call advance() themselves, production calls start()
+ * to advance from a background thread. Callbacks run without the wheel's
+ * lock held, so they may schedule or cancel other timers.
+ */
+class TimerWheel {
+public:
+    using TimerId = uint64_t;
+    using Callback = std::function<void()>;
+    using Clock = std::function<std::chrono::steady_clock::time_point()>;
+
+    static constexpr TimerId INVALID_TIMER = 0;
+
+private:
+    static constexpr int LEVELS = 4;
+    static constexpr int SLOT_BITS = 6;
+    static constexpr uint32_t SLOTS = 1u << SLOT_BITS;
+    static constexpr uint32_t SLOT_MASK = SLOTS - 1;
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+    struct Node {
+        Callback callback;
+        uint64_t expiryTick = 0;
+        uint32_t generation = 0;
+        uint32_t prev = NIL;
+        uint32_t next = NIL;
+        uint16_t level = 0;
+        uint16_t slot = 0;
+        bool armed = false;
+    };
+
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_freeNodes;
+    uint32_t m_slots[LEVELS][SLOTS];
+
+    Clock m_clock;
+    std::chrono::steady_clock::duration m_tickDuration;
+    std::chrono::steady_clock::time_point m_origin;
+    uint64_t m_currentTick;
+    size_t m_pending;
+
+    mutable std::mutex m_mutex;
+
+    // Background driver
+    std::thread m_thread;
+    std::condition_variable m_wakeup;
+    std::atomic<bool> m_running;
+
+public:
+    // Constructor and Destructor
+    explicit TimerWheel(std::chrono::milliseconds tickDuration = std::chrono::milliseconds(10),
+                        Clock clock = std::chrono::steady_clock::now);
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // Timer management
+    TimerId schedule(std::chrono::milliseconds delay, Callback callback);
+    bool cancel(TimerId id);
+
+    // Fires every timer that expired by clock(); returns how many fired
+    size_t advance();
+
+    // Background thread calling advance() once per tick
+    void start();
+    void stop();
+    bool isRunning() const { return m_running; }
+
+    size_t getPendingCount() const;
+    std::chrono::steady_clock::duration getTickDuration() const { return m_tickDuration; }
+
+private:
+    // Helper methods (m_mutex held)
+    void link(uint32_t index);
+    void unlink(uint32_t index);
+    void release(uint32_t index);
+    void cascade(int level);
+    uint64_t ticksUntil(std::chrono::steady_clock::time_point time) const;
+    static TimerId makeId(uint32_t index, uint32_t generation);
+};
+
+#endif // TIMER_WHEEL_H
@@ -0,0 +1,94 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include "BoundedMpmcQueue.h"
+#include <functional>
+#include <vector>
+#include <thread>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Fixed-size work-stealing thread pool with bounded queues
+ *
+ * Each worker owns a lock-free bounded queue. Producers spread tasks
+ * round-robin and fall through to the next queue when one is full; idle
+ * workers steal from their neighbours before sleeping. When every queue
+ * is full submit() returns QUEUE_FULL instead of blocking or growing, so a
+ * burst of requests is shed at the edge rather than spawning threads.
+ * shutdown() (also run by the destructor) stops intake, drains what is
+ * queued and joins the workers. A task that throws is counted in
+ * Stats::failedTasks and the worker moves on to the next one.
+ */
+class WorkerPool {
+public:
+    using Task = std::function<void()>;
+
+    enum class SubmitStatus {
+        ACCEPTED,
+        QUEUE_FULL,
+        SHUT_DOWN
+    };
+
+    struct Stats {
+        uint64_t submitted = 0;
+        uint64_t rejected = 0;
+        uint64_t completed = 0;
+        uint64_t failedTasks = 0; // Tasks that threw; also counted as completed
+        uint64_t stolen = 0;
+        size_t queued = 0;
+    };
+
+    static constexpr size_t DEFAULT_QUEUE_CAPACITY = 1024;
+
+private:
+    std::vector<std::unique_ptr<BoundedMpmcQueue<Task>>> m_queues;
+    std::vector<std::thread> m_workers;
+
+    std::atomic<size_t> m_nextQueue;
+    std::atomic<bool> m_accepting;
+    std::atomic<bool> m_stopping;
+    std::atomic<int> m_activeSubmitters; // submit() calls past the intake check
+
+    // Parking for idle workers
+    std::mutex m_idleMutex;
+    std::condition_variable m_idleCondition;
+    std::atomic<int> m_sleepingWorkers;
+
+    // Counters
+    std::atomic<uint64_t> m_submitted;
+    std::atomic<uint64_t> m_rejected;
+    std::atomic<uint64_t> m_completed;
+    std::atomic<uint64_t> m_failedTasks;
+    std::atomic<uint64_t> m_stolen;
+
+public:
+    // Constructor and Destructor
+    explicit WorkerPool(size_t threadCount = std::thread::hardware_concurrency(),
+                        size_t queueCapacity = DEFAULT_QUEUE_CAPACITY);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Task submission; never blocks
+    SubmitStatus submit(Task task);
+
+    // Stops intake, runs everything already queued, joins workers
+    void shutdown();
+
+    size_t getThreadCount() const { return m_workers.size(); }
+    size_t getCapacity() const;
+    Stats getStats() const;
+
+private:
+    void workerLoop(size_t self);
+    bool tryTakeTask(size_t self, Task& task);
+    bool allQueuesEmpty() const;
+};
+
+#endif // WORKER_POOL_H
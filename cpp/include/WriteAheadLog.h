@@ -0,0 +1,174 @@
+#ifndef WRITE_AHEAD_LOG_H
+#define WRITE_AHEAD_LOG_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Append-only mutation log with group commit and checkpoints
+ *
+ * Every state change in FavoriteDriverManager is appended as a Record with
+ * a monotonically increasing LSN. A flusher thread writes whatever has
+ * accumulated and issues one fsync per batch, so many concurrent durable
+ * appends share a single disk flush (group commit). checkpoint() rotates
+ * to a new segment, has the caller write its full state tagged with the
+ * cut-off LSN, fsyncs it and renames it into place, and only then deletes
+ * the segments the checkpoint covers; recovery is
+ * "load newest checkpoint, replay the records after it". Records must be
+ * idempotent (set-style), since a checkpoint may already contain some of
+ * the records replayed after it.
+ *
+ * On disk, a directory holds wal-<startLsn>.log segments and
+ * checkpoint-<lsn>.snap files. Each record is framed as
+ * [u32 length][u64 checksum][payload]; a torn tail is cut off on recovery.
+ *
+ * A failed write or fsync is not retried: the kernel may already have
+ * dropped the dirty pages, so a later successful fsync proves nothing. The
+ * segment is cut back to its last good frame, waiting appenders are failed
+ * and the log refuses further appends until it is closed and reopened.
+ */
+class WriteAheadLog {
+public:
+    enum class RecordType : uint8_t {
+        ADD_FAVORITE = 1,      // primaryId = user, secondaryId = driver
+        REMOVE_FAVORITE = 2,   // primaryId = user, secondaryId = driver
+        ADD_DRIVER = 3,        // primaryId = driver, payload = serialized driver
+        REMOVE_DRIVER = 4,     // primaryId = driver
+        DRIVER_STATUS = 5,     // primaryId = driver, value = Driver::Status
+        REQUEST_STATUS = 6     // primaryId = request, secondaryId = driver, value = RideRequest::Status, payload = request
+    };
+
+    struct Record {
+        uint64_t lsn = 0;
+        RecordType type = RecordType::ADD_FAVORITE;
+        std::string primaryId;
+        std::string secondaryId;
+        int64_t value = 0;
+        std::string payload;
+
+        Record() = default;
+        Record(RecordType type, const std::string& primary, const std::string& secondary = "",
+               int64_t value = 0, const std::string& payload = "")
+            : type(type), primaryId(primary), secondaryId(secondary), value(value), payload(payload) {}
+    };
+
+    struct Options {
+        std::chrono::microseconds groupCommitWindow{500}; // Extra wait to let a batch fill
+        size_t segmentBytes = 64 * 1024 * 1024;           // Rotate after this much log
+        bool syncOnCommit = true;                         // fsync each batch (off only for tests)
+    };
+
+    struct RecoveryStats {
+        bool loadedCheckpoint = false;
+        uint64_t checkpointLsn = 0;
+        uint64_t replayedRecords = 0;
+        uint64_t lastLsn = 0;
+        bool truncatedTail = false;
+        bool failed = false;     // The newest checkpoint did not load; nothing was replayed
+    };
+
+    struct Stats {
+        uint64_t appendedRecords = 0;
+        uint64_t flushedBatches = 0;
+        uint64_t syncs = 0;
+        uint64_t durableLsn = 0;
+        uint64_t checkpoints = 0;
+        bool failed = false;     // A write or fsync failed; appends are refused until reopened
+    };
+
+    // Writes the caller's full state to the given path; true on success
+    using CheckpointWriter = std::function<bool(const std::string& path, uint64_t lsn)>;
+    using CheckpointLoader = std::function<bool(const std::string& path)>;
+    using RecordHandler = std::function<void(const Record& record)>;
+
+private:
+    std::string m_directory;
+    Options m_options;
+
+    // Log state, guarded by m_mutex
+    mutable std::mutex m_mutex;
+    std::condition_variable m_flushNeeded;
+    std::condition_variable m_durableAdvanced;
+    std::string m_pending;          // Framed records not yet written
+    uint64_t m_nextLsn;
+    uint64_t m_pendingLastLsn;
+    uint64_t m_durableLsn;
+    uint64_t m_recoveredLsn;        // Highest LSN seen by recover(), 0 if not run
+    bool m_recovered;
+    bool m_recoveryFailed;          // open() refuses the directory until recover() succeeds
+    std::FILE* m_segment;
+    uint64_t m_segmentStartLsn;
+    size_t m_segmentBytes;
+    bool m_open;
+    bool m_stopping;
+    bool m_failed;                  // Set by failLog(); cleared by open()
+    Stats m_stats;
+
+    // Held while writing to or rotating the current segment; taken before m_mutex
+    std::mutex m_fileMutex;
+
+    // Serializes checkpoints with each other
+    std::mutex m_checkpointMutex;
+
+    std::thread m_flusher;
+    std::thread m_checkpointer;
+    std::condition_variable m_checkpointWakeup;
+
+public:
+    // Constructor and Destructor
+    WriteAheadLog();
+    ~WriteAheadLog();
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    // Lifecycle: recover() before open() so appends continue after the replayed LSN.
+    // A failed recovery (see RecoveryStats::failed) also makes open() fail.
+    RecoveryStats recover(const std::string& directory, const CheckpointLoader& loadCheckpoint,
+                          const RecordHandler& apply);
+    bool open(const std::string& directory, const Options& options);
+    bool open(const std::string& directory) { return open(directory, Options()); }
+    void close();
+    bool isOpen() const;
+
+    // Appending; returns the record's LSN, or 0 when the log is closed or has
+    // failed (for a durable append, also when the record never became durable)
+    uint64_t append(Record record, bool waitDurable = true);
+    bool waitDurable(uint64_t lsn);
+
+    // Checkpoints
+    bool checkpoint(const CheckpointWriter& writer);
+    void startBackgroundCheckpoints(std::chrono::milliseconds interval, CheckpointWriter writer);
+
+    Stats getStats() const;
+    uint64_t getDurableLsn() const;
+
+    // Record framing, exposed for tests and tools
+    static std::string encode(const Record& record);
+    static bool decode(const char* data, size_t size, Record& record, size_t& consumed);
+
+private:
+    void flusherLoop();
+    void recordFlush(); // m_mutex held
+    void failLog();     // m_fileMutex and m_mutex held
+    bool openSegment(uint64_t startLsn);
+    void closeSegment();
+    bool writeToSegment(const std::string& bytes);
+    static std::vector<std::pair<uint64_t, std::string>> listFiles(const std::string& directory,
+                                                                   const std::string& prefix,
+                                                                   const std::string& suffix);
+    std::string segmentPath(uint64_t startLsn) const;
+    std::string checkpointPath(uint64_t lsn) const;
+};
+
+#endif // WRITE_AHEAD_LOG_H
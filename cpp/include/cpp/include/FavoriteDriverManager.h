@@ -3,12 +3,29 @@
 
 #include "Driver.h"
 #include "RideRequest.h"
+#include "RideRequestPool.h"
+#include "SpatialIndex.h"
+#include "DriverPositionStore.h"
+#include "EtaProvider.h"
+#include "EtaCache.h"
+#include "PriorityScoreCache.h"
+#include "ShardedMap.h"
+#include "TimerWheel.h"
+#include "DispatchBatcher.h"
+#include "NotificationPipeline.h"
+#include "MetricsRegistry.h"
+#include "WorkerPool.h"
+#include "WriteAheadLog.h"
+#include "IdInterner.h"
+#include "SmallSortedSet.h"
+#include "FavoriteReverseIndex.h"
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 
 /**
  * @brief Manages favorite drivers for users and handles ride requests
@@ -22,30 +39,105 @@ public:
     using NotificationCallback = std::function<void(const std::string& userId, const std::string& message)>;
 
 private:
-    // User ID -> Set of favorite driver IDs
-    std::unordered_map<std::string, std::unordered_set<std::string>> m_userFavorites;
+    // String IDs are interned once at the API boundary; everything below
+    // is keyed by the 32-bit handles
+    IdInterner m_userIds;
+    IdInterner m_driverIds;
     
-    // Driver ID -> Driver object
-    std::unordered_map<std::string, std::shared_ptr<Driver>> m_drivers;
+    // Favorites are held inline up to the default MAX_FAVORITE_DRIVERS (10),
+    // 48 bytes per user; raising the limit spills larger sets to the heap
+    using FavoriteSet = SmallSortedSet<IdInterner::Handle, 10>;
     
-    // Active ride requests
-    std::unordered_map<std::string, std::shared_ptr<RideRequest>> m_activeRequests;
+    // User handle -> Set of favorite driver handles
+    ShardedMap<IdInterner::Handle, FavoriteSet> m_userFavorites;
     
-    // Callbacks for notifications
-    NotificationCallback m_notificationCallback;
+    // Driver handle -> users who favorited them; mirrors m_userFavorites and
+    // is updated in addFavoriteDriver/removeFavoriteDriver/removeDriver
+    FavoriteReverseIndex m_driverFollowers;
     
-    // Thread safety
-    mutable std::mutex m_mutex;
+    // Driver handle -> Driver object
+    ShardedMap<IdInterner::Handle, std::shared_ptr<Driver>> m_drivers;
+    
+    // Active ride requests (request IDs are short-lived, so they stay strings
+    // rather than growing the interner without bound)
+    ShardedMap<std::string, std::shared_ptr<RideRequest>> m_activeRequests;
+    
+    // Backing store for m_activeRequests: request* copies the caller's request
+    // into a recycled node, and it returns here once the last reference drops
+    RideRequestPool m_requestPool;
+    
+    // Grid over driver positions, kept in sync by addDriver/removeDriver and
+    // each driver's location listener
+    SpatialIndex m_spatialIndex;
+    
+    // Contiguous lat/lng/status/rating columns used by distance filtering and ETA ranking
+    DriverPositionStore m_positionStore;
+    
+    // Travel-time model behind getFastestAvailableDrivers and preference sorting;
+    // ConstantSpeedEtaProvider until setEtaProvider() installs another
+    std::shared_ptr<const EtaProvider> m_etaProvider;
+    
+    // Memoized driver-to-pickup distance/ETA shared by requestAnyFavoriteDriver,
+    // sortDriversByPreference and filterByDistance; cleared by setEtaProvider
+    mutable EtaCache m_etaCache;
+    
+    // Distance-free part of calculateDriverPriority per (user, driver);
+    // invalidated by rating/acceptance updates and favorite add/remove
+    mutable PriorityScoreCache m_priorityScores;
+    
+    // Favorite-request timeouts: one wheel timer per outstanding request,
+    // armed on dispatch and cancelled by accept/cancel
+    TimerWheel m_requestTimers;
+    ShardedMap<std::string, TimerWheel::TimerId> m_requestTimeouts;
+    
+    // Micro-batched requestAnyFavoriteDriver: null dispatches each request on
+    // its own; otherwise requests queue here (on m_requestTimers' window timer)
+    // and dispatchBatch() offers every rider a distinct driver at once
+    std::unique_ptr<DispatchBatcher> m_dispatchBatcher;
+    
+    // notifyUser/notifyDriver/notifyFollowers post here and return at once;
+    // the pipeline's thread batches per recipient and calls the callback.
+    // Lives as long as the manager; setNotificationCallback() only swaps its
+    // sink, and messages posted before any callback is set are discarded.
+    NotificationPipeline m_notifications{nullptr};
+    
+    // Thread safety: the three maps above lock per shard; m_mutex guards the
+    // spatial structures (shared for queries, exclusive for moves) and the
+    // configuration. When both are needed, take m_mutex first.
+    mutable std::shared_mutex m_mutex;
+    
+    // Instrumentation: latency of the hot entry points and wait time on
+    // m_mutex (taken through m_metrics.lockExclusive/lockShared). Ids index
+    // the name lists below; all of it compiles out without ENABLE_METRICS.
+    static constexpr MetricsRegistry::OperationId OP_REQUEST_FAVORITE_DRIVER = 0;
+    static constexpr MetricsRegistry::OperationId OP_ACCEPT_RIDE_REQUEST = 1;
+    static constexpr MetricsRegistry::OperationId OP_GET_NEARBY_DRIVERS = 2;
+    static constexpr MetricsRegistry::OperationId OP_SAVE_TO_FILE = 3;
+    static constexpr MetricsRegistry::LockId LOCK_MANAGER = 0;
+    mutable MetricsRegistry m_metrics{
+        {"requestFavoriteDriver", "acceptRideRequest", "getNearbyDrivers", "saveToFile"}, {"m_mutex"}};
+    
+    // Durability: every mutation is appended here once enableDurability() has
+    // run; null means in-memory only
+    std::unique_ptr<WriteAheadLog> m_wal;
     
     // Configuration
     static constexpr int MAX_FAVORITE_DRIVERS = 10;
     static constexpr int FAVORITE_REQUEST_TIMEOUT_SECONDS = 30;
     static constexpr double MAX_PICKUP_DISTANCE_KM = 15.0;
+    static constexpr size_t DISPATCH_QUEUE_CAPACITY = 4096;
+    
+    // Runs driver notifications and DriverRequestCallbacks off the caller's
+    // thread. Declared last so it is drained and joined before any state its
+    // tasks touch is destroyed.
+    WorkerPool m_dispatchPool;
 
 public:
     // Constructor and Destructor
     FavoriteDriverManager();
-    virtual ~FavoriteDriverManager() = default;
+    explicit FavoriteDriverManager(TimerWheel::Clock clock); // Virtual time for tests
+    FavoriteDriverManager(size_t dispatchThreads, size_t dispatchQueueCapacity = DISPATCH_QUEUE_CAPACITY);
+    virtual ~FavoriteDriverManager(); // Stops the timer wheel before any member it calls into
     
     // Delete copy constructor and assignment operator
     FavoriteDriverManager(const FavoriteDriverManager&) = delete;
@@ -58,6 +150,8 @@ public:
     std::vector<std::shared_ptr<Driver>> getAvailableFavoriteDrivers(const std::string& userId) const;
     bool isFavoriteDriver(const std::string& userId, const std::string& driverId) const;
     int getFavoriteDriverCount(const std::string& userId) const;
+    std::vector<std::string> getUsersWhoFavorited(const std::string& driverId) const;
+    int getFollowerCount(const std::string& driverId) const; // Users who favorited this driver
     
     // Driver management
     bool addDriver(std::shared_ptr<Driver> driver);
@@ -65,6 +159,17 @@ public:
     std::shared_ptr<Driver> getDriver(const std::string& driverId) const;
     std::vector<std::shared_ptr<Driver>> getAllDrivers() const;
     std::vector<std::shared_ptr<Driver>> getNearbyDrivers(const Driver::Location& location, double radiusKm = 10.0) const;
+    std::vector<std::shared_ptr<Driver>> getNearestAvailableDrivers(const Driver::Location& location, size_t count,
+                                                                    double maxRadiusKm = MAX_PICKUP_DISTANCE_KM) const;
+    std::vector<std::shared_ptr<Driver>> getFastestAvailableDrivers(const Driver::Location& location, size_t count) const;
+    
+    // Bulk GPS ingestion: resolves every ping, stamps untimed ones with a single
+    // clock read, then re-indexes all moved drivers under one exclusive lock.
+    // Unknown driver IDs are skipped; returns the number of updates applied.
+    size_t updateDriverLocations(const Driver::LocationUpdate* updates, size_t count);
+    size_t updateDriverLocations(const std::vector<Driver::LocationUpdate>& updates) {
+        return updateDriverLocations(updates.data(), updates.size());
+    }
     
     // Ride request handling
     std::string requestFavoriteDriver(const std::string& userId, const std::string& driverId, 
@@ -81,13 +186,46 @@ public:
     bool acceptRideRequest(const std::string& driverId, const std::string& requestId);
     bool rejectRideRequest(const std::string& driverId, const std::string& requestId, const std::string& reason = "");
     
+    // Batched dispatch: requestAnyFavoriteDriver collects riders for `window`
+    // and assigns them all at once over favorites-first costs (ETA less the
+    // calculateDriverPriority bonus); a zero window restores per-request dispatch
+    void setBatchedDispatch(std::chrono::milliseconds window, size_t maxBatchSize = 256);
+    DispatchBatcher::Stats getBatchedDispatchStats() const;
+    
+    // Fires due request timeouts now (the wheel's own thread does this in production)
+    size_t processExpiredRequests() { return m_requestTimers.advance(); }
+    
+    // Dispatch pool health (submitted/rejected/queued); request* methods return an
+    // empty request ID when the pool reports QUEUE_FULL
+    WorkerPool::Stats getDispatchStats() const { return m_dispatchPool.getStats(); }
+    
+    // ETA cache effectiveness (hits, misses, invalidations on cell changes, evictions)
+    EtaCache::Stats getEtaCacheStats() const { return m_etaCache.getStats(); }
+    
+    // Ride request slab usage (capacity, live requests, recycled acquisitions)
+    RideRequestPool::Stats getRequestPoolStats() const { return m_requestPool.getStats(); }
+    
     // Statistics and analytics
     std::vector<std::shared_ptr<Driver>> getMostPopularFavoriteDrivers(int limit = 10) const;
     double getFavoriteDriverAcceptanceRate(const std::string& driverId) const;
     std::unordered_map<std::string, int> getFavoriteDriverStats() const;
     
     // Notifications
-    void setNotificationCallback(NotificationCallback callback) { m_notificationCallback = callback; }
+    void setNotificationCallback(NotificationCallback callback);
+    NotificationPipeline::Stats getNotificationStats() const { return m_notifications.getStats(); }
+    
+    // Instrumentation: merged latency histograms, m_mutex contention and
+    // current queue depths, as a snapshot or a text table
+    MetricsRegistry::Snapshot getMetricsSnapshot() const {
+        MetricsRegistry::Snapshot snapshot = m_metrics.snapshot();
+        snapshot.gauges.push_back({"dispatch_pool.queued", static_cast<int64_t>(m_dispatchPool.getStats().queued)});
+        snapshot.gauges.push_back({"notifications.queued", static_cast<int64_t>(getNotificationStats().queued)});
+        snapshot.gauges.push_back({"notifications.dropped", static_cast<int64_t>(getNotificationStats().dropped)});
+        snapshot.gauges.push_back({"batched_dispatch.queued", static_cast<int64_t>(
+            m_dispatchBatcher ? m_dispatchBatcher->getStats().queued : 0)});
+        return snapshot;
+    }
+    std::string dumpMetrics() const { return MetricsRegistry::format(getMetricsSnapshot()); }
     
     // Utility methods
     std::vector<std::shared_ptr<Driver>> sortDriversByPreference(const std::string& userId, 
@@ -100,26 +238,46 @@ public:
     void setMaxFavoriteDrivers(int maxDrivers);
     void setRequestTimeout(int timeoutSeconds);
     void setMaxPickupDistance(double distanceKm);
+    void setEtaProvider(std::shared_ptr<const EtaProvider> provider); // Null restores the constant-speed model
     
     // Data persistence
     bool saveToFile(const std::string& filename) const;
     bool loadFromFile(const std::string& filename);
     std::string toJson() const;
     bool fromJson(const std::string& json);
+    bool saveSnapshot(const std::string& filename) const;  // BinarySnapshot format
+    bool loadSnapshot(const std::string& filename);
+    
+    // Durability: replays the newest checkpoint plus the log in `directory`,
+    // then logs every later mutation there (group-committed, fsync'd)
+    bool enableDurability(const std::string& directory,
+                          const WriteAheadLog::Options& options = WriteAheadLog::Options());
+    bool checkpoint();  // Snapshot current state and drop the log it covers
+    WriteAheadLog::Stats getDurabilityStats() const;
 
 private:
     // Internal helper methods
-    std::string generateRequestId() const;
+    std::string generateRequestId() const; // RequestIdGenerator::next(), as RideRequest uses
     void notifyUser(const std::string& userId, const std::string& message);
     void notifyDriver(const std::string& driverId, const std::string& message);
+    void notifyFollowers(IdInterner::Handle driver, const std::string& message); // e.g. "favorite is online"
     void handleRequestTimeout(const std::string& requestId);
+    void armRequestTimeout(const std::string& requestId);
+    bool disarmRequestTimeout(const std::string& requestId);
     std::shared_ptr<Driver> findBestAlternativeDriver(const RideRequest& request) const;
+    void dispatchBatch(std::vector<DispatchBatcher::Assignment>& assignments); // DispatchBatcher callback
     void updateDriverStatistics(const std::string& driverId, bool accepted);
+    void logMutation(WriteAheadLog::Record record);
+    void applyLogRecord(const WriteAheadLog::Record& record);
     
     // Request prioritization
     int calculateDriverPriority(const std::string& userId, const std::shared_ptr<Driver>& driver) const;
     std::vector<std::shared_ptr<Driver>> prioritizeDrivers(const std::string& userId, 
                                                           const std::vector<std::shared_ptr<Driver>>& drivers) const;
+    // Best `limit` only: cached static scores, distance term recomputed, nth_element selection
+    std::vector<std::shared_ptr<Driver>> prioritizeDrivers(const std::string& userId,
+                                                          const std::vector<std::shared_ptr<Driver>>& drivers,
+                                                          size_t limit) const;
 };
 
 #endif // FAVORITE_DRIVER_MANAGER_H
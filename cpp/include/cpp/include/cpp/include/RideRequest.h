@@ -6,6 +6,9 @@
 #include <chrono>
 #include <memory>
 
+class JsonWriter;
+class JsonReader;
+
 /**
  * @brief Represents a ride request in the Uber system
  * 
@@ -109,6 +112,12 @@ public:
     void setEstimatedDuration(int minutes) { m_estimatedDurationMinutes = minutes; }
     void setEstimatedDistance(double km) { m_estimatedDistanceKm = km; }
 
+    // Reuse (RideRequestPool): clear() empties every field, keeping string
+    // buffers; reset() then reinitializes as the matching constructor would
+    void clear();
+    void reset(const std::string& userId, const Driver::Location& pickup,
+               const Driver::Location& dropoff, RideType type = RideType::STANDARD);
+
     // Status management
     void setStatus(Status status);
     void assignDriver(const std::string& driverId);
@@ -150,6 +159,8 @@ public:
     // Serialization
     std::string toJson() const;
     static RideRequest fromJson(const std::string& json);
+    void writeJson(JsonWriter& writer) const;  // Appends to the writer's buffer
+    static bool readJson(JsonReader& reader, RideRequest& request);
     
     // Comparison operators
     bool operator==(const RideRequest& other) const;
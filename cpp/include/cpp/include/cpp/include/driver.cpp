@@ -1,24 +1,35 @@
 #include "Driver.h"
-#include <cmath>
+#include "JsonWriter.h"
+#include "JsonReader.h"
+#include "EtaProvider.h"
+#include "DistanceKernel.h"
 #include <random>
-#include <sstream>
-#include <iomanip>
 #include <algorithm>
 
+namespace {
+    const char* statusName(Driver::Status status) {
+        switch (status) {
+            case Driver::Status::OFFLINE: return "Offline";
+            case Driver::Status::ONLINE: return "Online";
+            case Driver::Status::BUSY: return "Busy";
+            case Driver::Status::ON_TRIP: return "On Trip";
+            default: return "Unknown";
+        }
+    }
+}
+
 // Default constructor
 Driver::Driver() 
     : m_id(""), m_name(""), m_phoneNumber(""), m_email(""), m_profilePhoto(""),
-      m_rating(0.0), m_completedTrips(0), m_status(Status::OFFLINE),
-      m_currentLocation(0.0, 0.0), m_vehicle(), 
-      m_lastActiveTime(std::chrono::system_clock::now()), m_isVerified(false) {
+      m_rating(0.0), m_completedTrips(0), m_liveState(LiveState(Location(0.0, 0.0), Status::OFFLINE)),
+      m_vehicle(), m_isVerified(false) {
 }
 
 // Parameterized constructor
 Driver::Driver(const std::string& id, const std::string& name, const std::string& phone)
     : m_id(id), m_name(name), m_phoneNumber(phone), m_email(""), m_profilePhoto(""),
-      m_rating(5.0), m_completedTrips(0), m_status(Status::OFFLINE),
-      m_currentLocation(0.0, 0.0), m_vehicle(),
-      m_lastActiveTime(std::chrono::system_clock::now()), m_isVerified(false) {
+      m_rating(5.0), m_completedTrips(0), m_liveState(LiveState(Location(0.0, 0.0), Status::OFFLINE)),
+      m_vehicle(), m_isVerified(false) {
 }
 
 // Copy constructor
@@ -26,8 +37,7 @@ Driver::Driver(const Driver& other)
     : m_id(other.m_id), m_name(other.m_name), m_phoneNumber(other.m_phoneNumber),
       m_email(other.m_email), m_profilePhoto(other.m_profilePhoto),
       m_rating(other.m_rating), m_completedTrips(other.m_completedTrips),
-      m_status(other.m_status), m_currentLocation(other.m_currentLocation),
-      m_vehicle(other.m_vehicle), m_lastActiveTime(other.m_lastActiveTime),
+      m_liveState(other.m_liveState.load()), m_vehicle(other.m_vehicle),
       m_isVerified(other.m_isVerified) {
 }
 
@@ -41,10 +51,8 @@ Driver& Driver::operator=(const Driver& other) {
         m_profilePhoto = other.m_profilePhoto;
         m_rating = other.m_rating;
         m_completedTrips = other.m_completedTrips;
-        m_status = other.m_status;
-        m_currentLocation = other.m_currentLocation;
+        m_liveState.store(other.m_liveState.load());
         m_vehicle = other.m_vehicle;
-        m_lastActiveTime = other.m_lastActiveTime;
         m_isVerified = other.m_isVerified;
     }
     return *this;
@@ -55,9 +63,8 @@ Driver::Driver(Driver&& other) noexcept
     : m_id(std::move(other.m_id)), m_name(std::move(other.m_name)),
       m_phoneNumber(std::move(other.m_phoneNumber)), m_email(std::move(other.m_email)),
       m_profilePhoto(std::move(other.m_profilePhoto)), m_rating(other.m_rating),
-      m_completedTrips(other.m_completedTrips), m_status(other.m_status),
-      m_currentLocation(std::move(other.m_currentLocation)), m_vehicle(std::move(other.m_vehicle)),
-      m_lastActiveTime(other.m_lastActiveTime), m_isVerified(other.m_isVerified) {
+      m_completedTrips(other.m_completedTrips), m_liveState(other.m_liveState.load()),
+      m_vehicle(std::move(other.m_vehicle)), m_isVerified(other.m_isVerified) {
 }
 
 // Move assignment operator
@@ -70,10 +77,8 @@ Driver& Driver::operator=(Driver&& other) noexcept {
         m_profilePhoto = std::move(other.m_profilePhoto);
         m_rating = other.m_rating;
         m_completedTrips = other.m_completedTrips;
-        m_status = other.m_status;
-        m_currentLocation = std::move(other.m_currentLocation);
+        m_liveState.store(other.m_liveState.load());
         m_vehicle = std::move(other.m_vehicle);
-        m_lastActiveTime = other.m_lastActiveTime;
         m_isVerified = other.m_isVerified;
     }
     return *this;
@@ -84,9 +89,19 @@ void Driver::setRating(double rating) {
     m_rating = std::max(0.0, std::min(5.0, rating));
 }
 
+void Driver::setCurrentLocation(const Location& location) {
+    m_liveState.update([&location](LiveState& state) { state.location = location; });
+    if (m_locationListener) {
+        m_locationListener(*this);
+    }
+}
+
 void Driver::setStatus(Status status) {
-    m_status = status;
-    updateLastActiveTime();
+    auto now = std::chrono::system_clock::now();
+    m_liveState.update([status, now](LiveState& state) {
+        state.status = status;
+        state.lastActiveTime = now;
+    });
 }
 
 // Business logic methods
@@ -106,56 +121,50 @@ void Driver::incrementCompletedTrips() {
 }
 
 void Driver::goOnline() {
-    m_status = Status::ONLINE;
-    updateLastActiveTime();
+    setStatus(Status::ONLINE);
 }
 
 void Driver::goOffline() {
-    m_status = Status::OFFLINE;
-    updateLastActiveTime();
+    setStatus(Status::OFFLINE);
 }
 
 void Driver::updateLocation(double latitude, double longitude) {
-    m_currentLocation = Location(latitude, longitude);
-    updateLastActiveTime();
+    updateLocation(latitude, longitude, std::chrono::system_clock::now(), true);
+}
+
+void Driver::updateLocation(double latitude, double longitude, std::chrono::system_clock::time_point timestamp,
+                            bool notifyListener) {
+    // Position and last-active time change in one write: readers never see one without the other
+    m_liveState.update([latitude, longitude, timestamp](LiveState& state) {
+        state.location = Location(latitude, longitude, timestamp);
+        state.lastActiveTime = timestamp;
+    });
+    if (notifyListener && m_locationListener) {
+        m_locationListener(*this);
+    }
 }
 
 double Driver::calculateDistanceFrom(const Location& otherLocation) const {
-    // Haversine formula for calculating distance between two points on Earth
-    const double R = 6371.0; // Earth's radius in kilometers
-    
-    double lat1 = m_currentLocation.latitude * M_PI / 180.0;
-    double lat2 = otherLocation.latitude * M_PI / 180.0;
-    double deltaLat = (otherLocation.latitude - m_currentLocation.latitude) * M_PI / 180.0;
-    double deltaLng = (otherLocation.longitude - m_currentLocation.longitude) * M_PI / 180.0;
-    
-    double a = sin(deltaLat / 2) * sin(deltaLat / 2) +
-               cos(lat1) * cos(lat2) * sin(deltaLng / 2) * sin(deltaLng / 2);
-    double c = 2 * atan2(sqrt(a), sqrt(1 - a));
-    
-    return R * c;
+    return DistanceKernel::haversine(getCurrentLocation(), otherLocation);
 }
 
 int Driver::getEstimatedArrivalTime(const Location& destination) const {
-    double distance = calculateDistanceFrom(destination);
-    // Assume average speed of 30 km/h in city traffic
-    double timeInHours = distance / 30.0;
-    return static_cast<int>(timeInHours * 60); // Convert to minutes
+    static const ConstantSpeedEtaProvider cityTraffic;
+    return getEstimatedArrivalTime(destination, cityTraffic);
+}
+
+int Driver::getEstimatedArrivalTime(const Location& destination, const EtaProvider& provider) const {
+    return static_cast<int>(provider.estimateMinutes(getCurrentLocation(), destination,
+                                                     std::chrono::system_clock::now()));
 }
 
 std::string Driver::getStatusString() const {
-    switch (m_status) {
-        case Status::OFFLINE: return "Offline";
-        case Status::ONLINE: return "Online";
-        case Status::BUSY: return "Busy";
-        case Status::ON_TRIP: return "On Trip";
-        default: return "Unknown";
-    }
+    return statusName(getStatus());
 }
 
 std::string Driver::getLastSeenString() const {
     auto now = std::chrono::system_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::minutes>(now - m_lastActiveTime);
+    auto duration = std::chrono::duration_cast<std::chrono::minutes>(now - getLastActiveTime());
     
     if (duration.count() < 60) {
         return std::to_string(duration.count()) + " minutes ago";
@@ -182,41 +191,116 @@ bool Driver::operator<(const Driver& other) const {
 
 // Utility methods
 bool Driver::isNearby(const Location& userLocation, double radiusKm) const {
-    return calculateDistanceFrom(userLocation) <= radiusKm;
+    return DistanceKernel::withinDistance(getCurrentLocation(), userLocation, radiusKm);
 }
 
 void Driver::updateLastActiveTime() {
-    m_lastActiveTime = std::chrono::system_clock::now();
+    auto now = std::chrono::system_clock::now();
+    m_liveState.update([now](LiveState& state) { state.lastActiveTime = now; });
 }
 
 std::chrono::minutes Driver::getTimeSinceLastActive() const {
     auto now = std::chrono::system_clock::now();
-    return std::chrono::duration_cast<std::chrono::minutes>(now - m_lastActiveTime);
+    return std::chrono::duration_cast<std::chrono::minutes>(now - getLastActiveTime());
 }
 
 // Serialization methods
 std::string Driver::toJson() const {
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(6);
-    
-    oss << "{\n";
-    oss << "  \"id\": \"" << m_id << "\",\n";
-    oss << "  \"name\": \"" << m_name << "\",\n";
-    oss << "  \"phoneNumber\": \"" << m_phoneNumber << "\",\n";
-    oss << "  \"email\": \"" << m_email << "\",\n";
-    oss << "  \"profilePhoto\": \"" << m_profilePhoto << "\",\n";
-    oss << "  \"rating\": " << m_rating << ",\n";
-    oss << "  \"completedTrips\": " << m_completedTrips << ",\n";
-    oss << "  \"status\": \"" << getStatusString() << "\",\n";
-    oss << "  \"currentLocation\": {\n";
-    oss << "    \"latitude\": " << m_currentLocation.latitude << ",\n";
-    oss << "    \"longitude\": " << m_currentLocation.longitude << "\n";
-    oss << "  },\n";
-    oss << "  \"vehicle\": {\n";
-    oss << "    \"make\": \"" << m_vehicle.make << "\",\n";
-    oss << "    \"model\": \"" << m_vehicle.model << "\",\n";
-    oss << "    \"color\": \"" << m_vehicle.color << "\",\n";
-    oss << "    \"plateNumber\": \"" << m_vehicle.plateNumber << "\",\n";
-    oss << "    \"year\": " << m_vehicle.year << "\n";
-    oss << "  },\n";
-    oss << "  \"isVerified\": " << (m_isVerified ? "true" : "false")
+    std::string json;
+    json.reserve(384);
+    JsonWriter writer(json);
+    writeJson(writer);
+    return json;
+}
+
+void Driver::writeJson(JsonWriter& writer) const {
+    const LiveState state = m_liveState.load();
+    writer.beginObject();
+    writer.field("id", m_id);
+    writer.field("name", m_name);
+    writer.field("phoneNumber", m_phoneNumber);
+    writer.field("email", m_email);
+    writer.field("profilePhoto", m_profilePhoto);
+    writer.field("rating", m_rating);
+    writer.field("completedTrips", m_completedTrips);
+    writer.field("status", statusName(state.status));
+    writer.key("currentLocation");
+    writer.beginObject();
+    writer.field("latitude", state.location.latitude);
+    writer.field("longitude", state.location.longitude);
+    writer.endObject();
+    writer.key("vehicle");
+    writer.beginObject();
+    writer.field("make", m_vehicle.make);
+    writer.field("model", m_vehicle.model);
+    writer.field("color", m_vehicle.color);
+    writer.field("plateNumber", m_vehicle.plateNumber);
+    writer.field("year", m_vehicle.year);
+    writer.endObject();
+    writer.field("isVerified", m_isVerified);
+    writer.field("lastActiveTime", static_cast<int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                       state.lastActiveTime.time_since_epoch()).count()));
+    writer.endObject();
+}
+
+Driver Driver::fromJson(const std::string& json) {
+    Driver driver;
+    JsonReader reader(json);
+    readJson(reader, driver);
+    return driver;
+}
+
+bool Driver::readJson(JsonReader& reader, Driver& driver) {
+    // Unknown members are skipped so older readers accept newer documents
+    LiveState state = driver.m_liveState.load();
+    bool parsed = reader.readObject([&](std::string_view name) {
+        if (name == "id") return reader.readString(driver.m_id);
+        if (name == "name") return reader.readString(driver.m_name);
+        if (name == "phoneNumber") return reader.readString(driver.m_phoneNumber);
+        if (name == "email") return reader.readString(driver.m_email);
+        if (name == "profilePhoto") return reader.readString(driver.m_profilePhoto);
+        if (name == "rating") return reader.readDouble(driver.m_rating);
+        if (name == "completedTrips") return reader.readInt(driver.m_completedTrips);
+        if (name == "isVerified") return reader.readBool(driver.m_isVerified);
+        if (name == "status") {
+            if (reader.next() != JsonReader::Token::STRING) {
+                return false;
+            }
+            std::string_view status = reader.getString();
+            if (status == "Online") state.status = Status::ONLINE;
+            else if (status == "Busy") state.status = Status::BUSY;
+            else if (status == "On Trip") state.status = Status::ON_TRIP;
+            else state.status = Status::OFFLINE;
+            return true;
+        }
+        if (name == "currentLocation") {
+            return reader.readObject([&](std::string_view member) {
+                if (member == "latitude") return reader.readDouble(state.location.latitude);
+                if (member == "longitude") return reader.readDouble(state.location.longitude);
+                return reader.skipValue();
+            });
+        }
+        if (name == "vehicle") {
+            return reader.readObject([&](std::string_view member) {
+                if (member == "make") return reader.readString(driver.m_vehicle.make);
+                if (member == "model") return reader.readString(driver.m_vehicle.model);
+                if (member == "color") return reader.readString(driver.m_vehicle.color);
+                if (member == "plateNumber") return reader.readString(driver.m_vehicle.plateNumber);
+                if (member == "year") return reader.readInt(driver.m_vehicle.year);
+                return reader.skipValue();
+            });
+        }
+        if (name == "lastActiveTime") {
+            int64_t millis;
+            if (!reader.readInt64(millis)) {
+                return false;
+            }
+            state.lastActiveTime = std::chrono::system_clock::time_point(
+                std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::milliseconds(millis)));
+            return true;
+        }
+        return reader.skipValue();
+    });
+    driver.m_liveState.store(state);
+    return parsed;
+}
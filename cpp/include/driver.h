@@ -4,6 +4,12 @@
 #include <string>
 #include <chrono>
 #include <memory>
+#include <functional>
+#include "SeqLock.h"
+
+class JsonWriter;
+class JsonReader;
+class EtaProvider;
 
 /**
  * @brief Represents a driver in the Uber system
@@ -27,6 +33,8 @@ public:
         
         Location(double lat = 0.0, double lng = 0.0) 
             : latitude(lat), longitude(lng), timestamp(std::chrono::system_clock::now()) {}
+        Location(double lat, double lng, std::chrono::system_clock::time_point time)
+            : latitude(lat), longitude(lng), timestamp(time) {}
     };
 
     struct Vehicle {
@@ -41,6 +49,28 @@ public:
             : make(make), model(model), color(color), plateNumber(plate), year(year) {}
     };
 
+    // One GPS ping, as delivered in bulk to FavoriteDriverManager::updateDriverLocations
+    struct LocationUpdate {
+        std::string driverId;
+        double latitude;
+        double longitude;
+        std::chrono::system_clock::time_point timestamp; // Left default: stamped once per batch
+    };
+
+    // Location, status and last-active time, read and written as one unit
+    struct LiveState {
+        Location location;
+        Status status;
+        std::chrono::system_clock::time_point lastActiveTime;
+
+        LiveState(const Location& location = Location(), Status status = Status::OFFLINE,
+                  std::chrono::system_clock::time_point lastActiveTime = std::chrono::system_clock::now())
+            : location(location), status(status), lastActiveTime(lastActiveTime) {}
+    };
+
+    // Invoked after the driver's position changes (used to keep spatial indexes current)
+    using LocationListener = std::function<void(const Driver& driver)>;
+
 private:
     std::string m_id;
     std::string m_name;
@@ -49,11 +79,10 @@ private:
     std::string m_profilePhoto;
     double m_rating;
     int m_completedTrips;
-    Status m_status;
-    Location m_currentLocation;
+    SeqLock<LiveState> m_liveState; // Updated by GPS ingestion while matching threads read it
     Vehicle m_vehicle;
-    std::chrono::system_clock::time_point m_lastActiveTime;
     bool m_isVerified;
+    LocationListener m_locationListener; // Not copied: copies are not indexed
 
 public:
     // Constructors
@@ -79,13 +108,14 @@ public:
     const std::string& getProfilePhoto() const { return m_profilePhoto; }
     double getRating() const { return m_rating; }
     int getCompletedTrips() const { return m_completedTrips; }
-    Status getStatus() const { return m_status; }
-    const Location& getCurrentLocation() const { return m_currentLocation; }
+    Status getStatus() const { return m_liveState.load().status; }
+    Location getCurrentLocation() const { return m_liveState.load().location; } // By value: a consistent snapshot
+    LiveState getLiveState() const { return m_liveState.load(); } // All three fields from the same write
     const Vehicle& getVehicle() const { return m_vehicle; }
-    std::chrono::system_clock::time_point getLastActiveTime() const { return m_lastActiveTime; }
+    std::chrono::system_clock::time_point getLastActiveTime() const { return m_liveState.load().lastActiveTime; }
     bool isVerified() const { return m_isVerified; }
-    bool isOnline() const { return m_status == Status::ONLINE; }
-    bool isAvailable() const { return m_status == Status::ONLINE; }
+    bool isOnline() const { return getStatus() == Status::ONLINE; }
+    bool isAvailable() const { return getStatus() == Status::ONLINE; }
 
     // Setters
     void setName(const std::string& name) { m_name = name; }
@@ -93,10 +123,12 @@ public:
     void setEmail(const std::string& email) { m_email = email; }
     void setProfilePhoto(const std::string& photo) { m_profilePhoto = photo; }
     void setRating(double rating);
+    void setCompletedTrips(int trips) { m_completedTrips = trips; }
     void setStatus(Status status);
-    void setCurrentLocation(const Location& location) { m_currentLocation = location; }
+    void setCurrentLocation(const Location& location);
     void setVehicle(const Vehicle& vehicle) { m_vehicle = vehicle; }
     void setVerified(bool verified) { m_isVerified = verified; }
+    void setLocationListener(LocationListener listener) { m_locationListener = std::move(listener); }
 
     // Business logic methods
     void updateRating(double newRating);
@@ -104,8 +136,11 @@ public:
     void goOnline();
     void goOffline();
     void updateLocation(double latitude, double longitude);
+    void updateLocation(double latitude, double longitude, std::chrono::system_clock::time_point timestamp,
+                        bool notifyListener = true); // No clock read; bulk callers re-index themselves
     double calculateDistanceFrom(const Location& otherLocation) const;
-    int getEstimatedArrivalTime(const Location& destination) const;
+    int getEstimatedArrivalTime(const Location& destination) const; // ConstantSpeedEtaProvider defaults
+    int getEstimatedArrivalTime(const Location& destination, const EtaProvider& provider) const;
     std::string getStatusString() const;
     std::string getLastSeenString() const;
     
@@ -117,6 +152,8 @@ public:
     // Serialization
     std::string toJson() const;
     static Driver fromJson(const std::string& json);
+    void writeJson(JsonWriter& writer) const;  // Appends to the writer's buffer
+    static bool readJson(JsonReader& reader, Driver& driver);
     
     // Utility methods
     bool isNearby(const Location& userLocation, double radiusKm = 10.0) const;
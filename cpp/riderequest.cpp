@@ -1,5 +1,9 @@
 #include "RideRequest.h"
-#include <random>
+#include "JsonWriter.h"
+#include "JsonReader.h"
+#include "DistanceKernel.h"
+#include "EtaProvider.h"
+#include "RequestIdGenerator.h"
 #include <sstream>
 #include <iomanip>
 #include <cmath>
@@ -102,6 +106,58 @@ RideRequest& RideRequest::operator=(RideRequest&& other) noexcept {
     return *this;
 }
 
+// Reuse
+namespace {
+    // Buffers up to this size survive clear(); larger ones are released so one
+    // long address cannot pin memory in a pooled request
+    constexpr size_t RETAINED_STRING_CAPACITY = 256;
+
+    void clearString(std::string& value) {
+        if (value.capacity() > RETAINED_STRING_CAPACITY) {
+            std::string().swap(value);
+        } else {
+            value.clear();
+        }
+    }
+}
+
+void RideRequest::clear() {
+    clearString(m_requestId);
+    clearString(m_userId);
+    clearString(m_assignedDriverId);
+    m_pickupLocation = Driver::Location(0.0, 0.0, {});
+    m_dropoffLocation = Driver::Location(0.0, 0.0, {});
+    clearString(m_pickupAddress);
+    clearString(m_dropoffAddress);
+    m_status = Status::PENDING;
+    m_rideType = RideType::STANDARD;
+    m_paymentInfo.estimatedFare = 0.0;
+    m_paymentInfo.actualFare = 0.0;
+    clearString(m_paymentInfo.paymentMethod);
+    m_paymentInfo.paymentMethod.assign("card");
+    m_paymentInfo.isPaid = false;
+    m_requestTime = std::chrono::system_clock::time_point();
+    m_acceptedTime = std::chrono::system_clock::time_point();
+    m_completedTime = std::chrono::system_clock::time_point();
+    clearString(m_specialInstructions);
+    m_isFavoriteDriverRequest = false;
+    clearString(m_rejectionReason);
+    m_estimatedDurationMinutes = 0;
+    m_estimatedDistanceKm = 0.0;
+}
+
+void RideRequest::reset(const std::string& userId, const Driver::Location& pickup,
+                        const Driver::Location& dropoff, RideType type) {
+    clear();
+    m_requestId = generateRequestId();
+    m_userId.assign(userId);
+    m_pickupLocation = pickup;
+    m_dropoffLocation = dropoff;
+    m_rideType = type;
+    m_requestTime = std::chrono::system_clock::now();
+    calculateEstimates();
+}
+
 // Status management
 void RideRequest::setStatus(Status status) {
     m_status = status;
@@ -183,19 +239,7 @@ bool RideRequest::isCancelled() const {
 }
 
 double RideRequest::calculateDistance() const {
-    // Haversine formula for calculating distance between two points on Earth
-    const double R = 6371.0; // Earth's radius in kilometers
-    
-    double lat1 = m_pickupLocation.latitude * M_PI / 180.0;
-    double lat2 = m_dropoffLocation.latitude * M_PI / 180.0;
-    double deltaLat = (m_dropoffLocation.latitude - m_pickupLocation.latitude) * M_PI / 180.0;
-    double deltaLng = (m_dropoffLocation.longitude - m_pickupLocation.longitude) * M_PI / 180.0;
-    
-    double a = sin(deltaLat / 2) * sin(deltaLat / 2) +
-               cos(lat1) * cos(lat2) * sin(deltaLng / 2) * sin(deltaLng / 2);
-    double c = 2 * atan2(sqrt(a), sqrt(1 - a));
-    
-    return R * c;
+    return DistanceKernel::haversine(m_pickupLocation, m_dropoffLocation);
 }
 
 std::chrono::minutes RideRequest::getWaitTime() const {
@@ -255,4 +299,147 @@ double RideRequest::getMultiplier() const {
 }
 
 void RideRequest::calculateEstimates() {
-    m_estimatedDistanceKm = calculate
+    m_estimatedDistanceKm = calculateDistance();
+    static const ConstantSpeedEtaProvider cityTraffic;
+    m_estimatedDurationMinutes = static_cast<int>(
+        std::ceil(cityTraffic.estimateMinutes(m_pickupLocation, m_dropoffLocation, m_requestTime)));
+}
+
+// Helper methods
+std::string RideRequest::generateRequestId() const {
+    return RequestIdGenerator::next();
+}
+
+// Serialization
+namespace {
+    int64_t toEpochMillis(std::chrono::system_clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+    }
+
+    std::chrono::system_clock::time_point fromEpochMillis(int64_t millis) {
+        return std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::milliseconds(millis)));
+    }
+
+    void writeLocation(JsonWriter& writer, const Driver::Location& location) {
+        writer.beginObject();
+        writer.field("latitude", location.latitude);
+        writer.field("longitude", location.longitude);
+        writer.endObject();
+    }
+
+    bool readLocation(JsonReader& reader, Driver::Location& location) {
+        return reader.readObject([&](std::string_view member) {
+            if (member == "latitude") return reader.readDouble(location.latitude);
+            if (member == "longitude") return reader.readDouble(location.longitude);
+            return reader.skipValue();
+        });
+    }
+
+    bool readTime(JsonReader& reader, std::chrono::system_clock::time_point& time) {
+        int64_t millis;
+        if (!reader.readInt64(millis)) {
+            return false;
+        }
+        time = fromEpochMillis(millis);
+        return true;
+    }
+}
+
+std::string RideRequest::toJson() const {
+    std::string json;
+    json.reserve(512);
+    JsonWriter writer(json);
+    writeJson(writer);
+    return json;
+}
+
+void RideRequest::writeJson(JsonWriter& writer) const {
+    writer.beginObject();
+    writer.field("requestId", m_requestId);
+    writer.field("userId", m_userId);
+    writer.field("assignedDriverId", m_assignedDriverId);
+    writer.key("pickupLocation");
+    writeLocation(writer, m_pickupLocation);
+    writer.key("dropoffLocation");
+    writeLocation(writer, m_dropoffLocation);
+    writer.field("pickupAddress", m_pickupAddress);
+    writer.field("dropoffAddress", m_dropoffAddress);
+    writer.field("status", getStatusString());
+    writer.field("rideType", getRideTypeString());
+    writer.key("payment");
+    writer.beginObject();
+    writer.field("estimatedFare", m_paymentInfo.estimatedFare);
+    writer.field("actualFare", m_paymentInfo.actualFare);
+    writer.field("paymentMethod", m_paymentInfo.paymentMethod);
+    writer.field("isPaid", m_paymentInfo.isPaid);
+    writer.endObject();
+    writer.field("requestTime", toEpochMillis(m_requestTime));
+    writer.field("acceptedTime", toEpochMillis(m_acceptedTime));
+    writer.field("completedTime", toEpochMillis(m_completedTime));
+    writer.field("specialInstructions", m_specialInstructions);
+    writer.field("isFavoriteDriverRequest", m_isFavoriteDriverRequest);
+    writer.field("rejectionReason", m_rejectionReason);
+    writer.field("estimatedDurationMinutes", m_estimatedDurationMinutes);
+    writer.field("estimatedDistanceKm", m_estimatedDistanceKm);
+    writer.endObject();
+}
+
+RideRequest RideRequest::fromJson(const std::string& json) {
+    RideRequest request;
+    JsonReader reader(json);
+    readJson(reader, request);
+    return request;
+}
+
+bool RideRequest::readJson(JsonReader& reader, RideRequest& request) {
+    static const char* const STATUS_NAMES[] = {"Pending", "Driver Notified", "Accepted", "Rejected",
+                                               "Cancelled", "In Progress", "Completed", "Failed"};
+    static const char* const RIDE_TYPE_NAMES[] = {"Standard", "Premium", "Shared", "XL"};
+
+    // Unknown members are skipped so older readers accept newer documents
+    return reader.readObject([&](std::string_view name) {
+        if (name == "requestId") return reader.readString(request.m_requestId);
+        if (name == "userId") return reader.readString(request.m_userId);
+        if (name == "assignedDriverId") return reader.readString(request.m_assignedDriverId);
+        if (name == "pickupLocation") return readLocation(reader, request.m_pickupLocation);
+        if (name == "dropoffLocation") return readLocation(reader, request.m_dropoffLocation);
+        if (name == "pickupAddress") return reader.readString(request.m_pickupAddress);
+        if (name == "dropoffAddress") return reader.readString(request.m_dropoffAddress);
+        if (name == "requestTime") return readTime(reader, request.m_requestTime);
+        if (name == "acceptedTime") return readTime(reader, request.m_acceptedTime);
+        if (name == "completedTime") return readTime(reader, request.m_completedTime);
+        if (name == "specialInstructions") return reader.readString(request.m_specialInstructions);
+        if (name == "isFavoriteDriverRequest") return reader.readBool(request.m_isFavoriteDriverRequest);
+        if (name == "rejectionReason") return reader.readString(request.m_rejectionReason);
+        if (name == "estimatedDurationMinutes") return reader.readInt(request.m_estimatedDurationMinutes);
+        if (name == "estimatedDistanceKm") return reader.readDouble(request.m_estimatedDistanceKm);
+        if (name == "status" || name == "rideType") {
+            bool isStatus = name == "status";
+            if (reader.next() != JsonReader::Token::STRING) {
+                return false;
+            }
+            std::string_view value = reader.getString();
+            if (isStatus) {
+                for (size_t i = 0; i < sizeof(STATUS_NAMES) / sizeof(STATUS_NAMES[0]); ++i) {
+                    if (value == STATUS_NAMES[i]) request.m_status = static_cast<Status>(i);
+                }
+            } else {
+                for (size_t i = 0; i < sizeof(RIDE_TYPE_NAMES) / sizeof(RIDE_TYPE_NAMES[0]); ++i) {
+                    if (value == RIDE_TYPE_NAMES[i]) request.m_rideType = static_cast<RideType>(i);
+                }
+            }
+            return true;
+        }
+        if (name == "payment") {
+            return reader.readObject([&](std::string_view member) {
+                if (member == "estimatedFare") return reader.readDouble(request.m_paymentInfo.estimatedFare);
+                if (member == "actualFare") return reader.readDouble(request.m_paymentInfo.actualFare);
+                if (member == "paymentMethod") return reader.readString(request.m_paymentInfo.paymentMethod);
+                if (member == "isPaid") return reader.readBool(request.m_paymentInfo.isPaid);
+                return reader.skipValue();
+            });
+        }
+        return reader.skipValue();
+    });
+}
@@ -0,0 +1,353 @@
+#include "CitySimulator.h"
+#include "RideRequest.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+    // San Francisco, roughly 13 x 13 km
+    constexpr double MIN_LATITUDE = 37.70;
+    constexpr double MAX_LATITUDE = 37.82;
+    constexpr double MIN_LONGITUDE = -122.52;
+    constexpr double MAX_LONGITUDE = -122.37;
+
+    constexpr double KM_PER_DEGREE = 111.195;
+    constexpr double FAVORITE_RADIUS_KM = 5.0;   // Favorites come from around the rider's home
+    constexpr double POPULARITY_EXPONENT = 0.8;  // Zipf skew of driver popularity
+    constexpr double NO_FAVORITES_SHARE = 0.3;
+
+    // Relative demand per hour of day: night trough, 8:00 and 18:00 peaks
+    constexpr double HOURLY_DEMAND[24] = {
+        0.15, 0.08, 0.05, 0.04, 0.06, 0.15, 0.45, 0.85, 1.00, 0.70, 0.50, 0.50,
+        0.55, 0.50, 0.50, 0.55, 0.70, 0.90, 1.00, 0.85, 0.65, 0.50, 0.40, 0.25
+    };
+
+    constexpr int64_t MILLIS_PER_HOUR = 3600000;
+
+    // Fixed origin for Location timestamps so reruns produce identical state
+    const std::chrono::system_clock::time_point SIMULATION_EPOCH =
+        std::chrono::system_clock::time_point(std::chrono::seconds(1704067200)); // 2024-01-01T00:00:00Z
+}
+
+// Constructor and Destructor
+CitySimulator::CitySimulator(const Options& options)
+    : m_options(options), m_rng(options.seed), m_virtualMillis(0), m_nextSequence(0) {
+    m_options.tickMillis = std::max(1, m_options.tickMillis);
+    m_options.locationIntervalSeconds = std::max(1, m_options.locationIntervalSeconds);
+    m_options.maxResponseSeconds = std::max(m_options.minResponseSeconds, m_options.maxResponseSeconds);
+
+    m_manager = std::make_unique<FavoriteDriverManager>([this]() {
+        return std::chrono::steady_clock::time_point() +
+               std::chrono::milliseconds(m_virtualMillis.load(std::memory_order_acquire));
+    });
+    m_manager->setRequestTimeout(m_options.requestTimeoutSeconds);
+    m_report.hours.resize(24);
+    buildCity();
+}
+
+CitySimulator::~CitySimulator() = default;
+
+// City generation
+void CitySimulator::buildCity() {
+    m_drivers.reserve(m_options.drivers);
+    for (size_t i = 0; i < m_options.drivers; ++i) {
+        std::string id = "sim_driver_" + std::to_string(i);
+        auto driver = std::make_shared<Driver>(id, "Driver " + std::to_string(i), "+1555" + std::to_string(1000000 + i));
+        Driver::Location start = randomLocation();
+        Driver::Location target = randomLocation();
+        driver->updateLocation(start.latitude, start.longitude, virtualTimestamp(0));
+        driver->setRating(uniform(4.0, 5.0));
+        driver->goOnline();
+        m_manager->addDriver(driver);
+        m_driverIndex.emplace(id, static_cast<uint32_t>(i));
+        m_drivers.push_back(SimDriver{driver, start.latitude, start.longitude, target.latitude, target.longitude,
+                                      Phase::CRUISING, 0.0, 0.0});
+    }
+
+    // A few drivers are everyone's favorite; most are nobody's
+    std::vector<uint32_t> ranks(m_drivers.size());
+    for (size_t i = 0; i < ranks.size(); ++i) {
+        ranks[i] = static_cast<uint32_t>(i);
+    }
+    std::shuffle(ranks.begin(), ranks.end(), m_rng);
+    std::vector<double> popularity(m_drivers.size());
+    for (size_t i = 0; i < popularity.size(); ++i) {
+        popularity[i] = 1.0 / std::pow(ranks[i] + 1.0, POPULARITY_EXPONENT);
+    }
+
+    m_riders.reserve(m_options.riders);
+    std::vector<uint32_t> candidates;
+    std::vector<double> weights;
+    for (size_t i = 0; i < m_options.riders; ++i) {
+        Rider rider{"sim_rider_" + std::to_string(i), randomLocation(), randomLocation(), {}};
+        size_t wanted = 0;
+        if (uniform(0.0, 1.0) >= NO_FAVORITES_SHARE && m_options.maxFavoritesPerRider > 0) {
+            wanted = 1 + static_cast<size_t>(m_rng() % m_options.maxFavoritesPerRider);
+        }
+
+        candidates.clear();
+        if (wanted > 0) {
+            for (const auto& driver : m_manager->getNearbyDrivers(rider.home, FAVORITE_RADIUS_KM)) {
+                candidates.push_back(m_driverIndex.at(driver->getId()));
+            }
+            std::sort(candidates.begin(), candidates.end()); // Query order is not part of the contract
+        }
+        if (!candidates.empty()) {
+            weights.clear();
+            for (uint32_t candidate : candidates) {
+                weights.push_back(popularity[candidate]);
+            }
+            std::discrete_distribution<size_t> pick(weights.begin(), weights.end());
+            for (size_t attempt = 0; attempt < wanted * 4 && rider.favorites.size() < wanted; ++attempt) {
+                uint32_t chosen = candidates[pick(m_rng)];
+                if (std::find(rider.favorites.begin(), rider.favorites.end(), chosen) == rider.favorites.end()) {
+                    rider.favorites.push_back(chosen);
+                    m_manager->addFavoriteDriver(rider.id, m_drivers[chosen].driver->getId());
+                }
+            }
+            std::sort(rider.favorites.begin(), rider.favorites.end());
+        }
+        m_riders.push_back(std::move(rider));
+    }
+}
+
+Driver::Location CitySimulator::randomLocation() {
+    double latitude = uniform(MIN_LATITUDE, MAX_LATITUDE);
+    double longitude = uniform(MIN_LONGITUDE, MAX_LONGITUDE);
+    return Driver::Location(latitude, longitude, SIMULATION_EPOCH);
+}
+
+double CitySimulator::arrivalWeight(double hourOfDay) {
+    hourOfDay = std::fmod(std::max(0.0, hourOfDay), 24.0);
+    size_t hour = static_cast<size_t>(hourOfDay);
+    double fraction = hourOfDay - hour;
+    return HOURLY_DEMAND[hour] * (1.0 - fraction) + HOURLY_DEMAND[(hour + 1) % 24] * fraction;
+}
+
+// Main loop
+CitySimulator::Report CitySimulator::run() {
+    auto wallStart = std::chrono::steady_clock::now();
+    const int64_t tickMs = m_options.tickMillis;
+    const int64_t endMs = static_cast<int64_t>(m_options.hours * MILLIS_PER_HOUR);
+    const int64_t drainEndMs = endMs + (m_options.riderPatienceSeconds + 1) * int64_t(1000);
+    const int64_t locationMs = m_options.locationIntervalSeconds * int64_t(1000);
+
+    // Arrivals stop at endMs; requests still open then run to an outcome
+    int64_t nowMs = 0;
+    for (; nowMs < endMs || (!m_open.empty() && nowMs < drainEndMs); nowMs += tickMs) {
+        m_virtualMillis.store(nowMs, std::memory_order_release);
+        if (nowMs < endMs) {
+            generateArrivals(nowMs);
+        }
+        runDueEvents(nowMs);
+        if (nowMs % locationMs < tickMs) {
+            moveDrivers(nowMs);
+        }
+        m_manager->processExpiredRequests();
+        pollOpenRequests(nowMs);
+    }
+
+    m_report.virtualSeconds = nowMs / 1000.0;
+    m_report.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    return m_report;
+}
+
+// Requests
+void CitySimulator::generateArrivals(int64_t nowMs) {
+    double hourOfDay = static_cast<double>(nowMs % (24 * MILLIS_PER_HOUR)) / MILLIS_PER_HOUR;
+    double expected = m_options.peakRequestsPerHour * arrivalWeight(hourOfDay) * m_options.tickMillis / MILLIS_PER_HOUR;
+    if (expected <= 0.0 || m_riders.empty()) {
+        return;
+    }
+    std::poisson_distribution<int> arrivals(expected);
+    int count = arrivals(m_rng);
+    for (int i = 0; i < count; ++i) {
+        submitRequest(static_cast<uint32_t>(m_rng() % m_riders.size()), nowMs);
+    }
+}
+
+void CitySimulator::submitRequest(uint32_t riderIndex, int64_t nowMs) {
+    const Rider& rider = m_riders[riderIndex];
+    size_t hour = static_cast<size_t>((nowMs / MILLIS_PER_HOUR) % 24);
+    bool commuting = hour < 12; // Home to work in the morning, back in the afternoon
+    const Driver::Location& from = commuting ? rider.home : rider.work;
+    const Driver::Location& to = commuting ? rider.work : rider.home;
+    Driver::Location pickup(from.latitude, from.longitude, virtualTimestamp(nowMs));
+    Driver::Location dropoff(to.latitude, to.longitude, virtualTimestamp(nowMs));
+
+    bool favoriteFirst = !rider.favorites.empty() && uniform(0.0, 1.0) < m_options.favoriteRequestShare;
+    RideRequest request(rider.id, pickup, dropoff);
+    // Outcomes are read back by polling; the callback runs on the dispatch pool
+    auto ignored = [](bool, const std::string&) {};
+    std::string requestId = favoriteFirst ? m_manager->requestAnyFavoriteDriver(rider.id, request, ignored)
+                                          : m_manager->requestRegularDriver(rider.id, request, ignored);
+
+    m_report.requests++;
+    m_report.hours[hour].requests++;
+    if (favoriteFirst) {
+        m_report.favoriteRequests++;
+    }
+    if (requestId.empty()) {
+        m_report.noDriver++;
+        return;
+    }
+    m_open.emplace(requestId, OpenRequest{riderIndex, nowMs, hour, favoriteFirst, pickup, dropoff, std::string()});
+    m_openOrder.push_back(requestId);
+    schedule(nowMs + m_options.riderPatienceSeconds * int64_t(1000), EventType::RIDER_GIVES_UP, requestId,
+             std::string());
+}
+
+void CitySimulator::runDueEvents(int64_t nowMs) {
+    while (!m_events.empty() && m_events.top().atMs <= nowMs) {
+        Event event = m_events.top();
+        m_events.pop();
+        auto it = m_open.find(event.requestId);
+        if (it == m_open.end()) {
+            continue; // Already resolved
+        }
+        if (event.type == EventType::DRIVER_RESPONSE) {
+            handleResponse(event, nowMs);
+        } else {
+            m_manager->cancelRideRequest(event.requestId);
+            m_report.abandoned++;
+            m_report.hours[it->second.hour].timedOut++;
+            closeRequest(event.requestId);
+        }
+    }
+}
+
+void CitySimulator::handleResponse(const Event& event, int64_t nowMs) {
+    OpenRequest& open = m_open.at(event.requestId);
+    if (open.offeredDriver != event.driverId) {
+        return; // Reassigned since this offer was made
+    }
+
+    double roll = uniform(0.0, 1.0);
+    if (roll < m_options.acceptProbability) {
+        if (!m_manager->acceptRideRequest(event.driverId, event.requestId)) {
+            return; // Timed out first; polling records the outcome
+        }
+        uint32_t driverIndex = m_driverIndex.at(event.driverId);
+        uint64_t latencyMs = static_cast<uint64_t>(nowMs - open.requestedAtMs);
+        m_report.matched++;
+        m_report.matchLatencyMs.record(latencyMs);
+        m_report.hours[open.hour].matched++;
+        m_report.hours[open.hour].matchLatencyMs.record(latencyMs);
+        const std::vector<uint32_t>& favorites = m_riders[open.rider].favorites;
+        if (open.favoriteFirst && std::binary_search(favorites.begin(), favorites.end(), driverIndex)) {
+            m_report.favoriteMatches++;
+        }
+
+        SimDriver& driver = m_drivers[driverIndex];
+        driver.phase = Phase::TO_PICKUP;
+        driver.targetLatitude = open.pickup.latitude;
+        driver.targetLongitude = open.pickup.longitude;
+        driver.tripLatitude = open.dropoff.latitude;
+        driver.tripLongitude = open.dropoff.longitude;
+        driver.driver->setStatus(Driver::Status::BUSY);
+        closeRequest(event.requestId);
+    } else if (roll < m_options.acceptProbability + m_options.rejectProbability) {
+        m_manager->rejectRideRequest(event.driverId, event.requestId, "busy");
+        m_report.rejections++;
+    }
+    // Otherwise the driver never answers and the manager's timeout decides
+}
+
+void CitySimulator::pollOpenRequests(int64_t nowMs) {
+    for (const std::string& requestId : m_openOrder) {
+        auto it = m_open.find(requestId);
+        if (it == m_open.end()) {
+            continue;
+        }
+        OpenRequest& open = it->second;
+        std::shared_ptr<RideRequest> request = m_manager->getRideRequest(requestId);
+        RideRequest::Status status = request ? request->getStatus() : RideRequest::Status::FAILED;
+
+        if (status == RideRequest::Status::FAILED || status == RideRequest::Status::CANCELLED) {
+            m_report.timeouts++;
+            m_report.hours[open.hour].timedOut++;
+            m_open.erase(it);
+            continue;
+        }
+        if (status == RideRequest::Status::REJECTED) {
+            m_report.unmatchedOther++;
+            m_open.erase(it);
+            continue;
+        }
+        if (status != RideRequest::Status::PENDING && status != RideRequest::Status::DRIVER_NOTIFIED) {
+            continue;
+        }
+
+        const std::string& assigned = request->getAssignedDriverId();
+        if (!assigned.empty() && assigned != open.offeredDriver && m_driverIndex.count(assigned)) {
+            open.offeredDriver = assigned;
+            int64_t delaySeconds = m_options.minResponseSeconds +
+                static_cast<int64_t>(m_rng() % (m_options.maxResponseSeconds - m_options.minResponseSeconds + 1));
+            schedule(nowMs + delaySeconds * 1000, EventType::DRIVER_RESPONSE, requestId, assigned);
+        }
+    }
+
+    m_openOrder.erase(std::remove_if(m_openOrder.begin(), m_openOrder.end(),
+                                     [this](const std::string& requestId) { return !m_open.count(requestId); }),
+                      m_openOrder.end());
+}
+
+void CitySimulator::closeRequest(const std::string& requestId) {
+    m_open.erase(requestId); // m_openOrder is compacted by the next poll
+}
+
+// Drivers
+void CitySimulator::moveDrivers(int64_t nowMs) {
+    const double stepKm = m_options.driverSpeedKmh * m_options.locationIntervalSeconds / 3600.0;
+    std::vector<Driver::LocationUpdate> updates;
+    updates.reserve(m_drivers.size());
+
+    for (SimDriver& driver : m_drivers) {
+        double cosLatitude = std::cos(driver.latitude * M_PI / 180.0);
+        double northKm = (driver.targetLatitude - driver.latitude) * KM_PER_DEGREE;
+        double eastKm = (driver.targetLongitude - driver.longitude) * KM_PER_DEGREE * cosLatitude;
+        double remainingKm = std::sqrt(northKm * northKm + eastKm * eastKm);
+
+        if (remainingKm > stepKm) {
+            double fraction = stepKm / remainingKm;
+            driver.latitude += (driver.targetLatitude - driver.latitude) * fraction;
+            driver.longitude += (driver.targetLongitude - driver.longitude) * fraction;
+        } else {
+            driver.latitude = driver.targetLatitude;
+            driver.longitude = driver.targetLongitude;
+            if (driver.phase == Phase::TO_PICKUP) {
+                driver.phase = Phase::ON_TRIP;
+                driver.targetLatitude = driver.tripLatitude;
+                driver.targetLongitude = driver.tripLongitude;
+                driver.driver->setStatus(Driver::Status::ON_TRIP);
+            } else {
+                if (driver.phase == Phase::ON_TRIP) {
+                    driver.phase = Phase::CRUISING;
+                    driver.driver->goOnline();
+                    m_report.tripsCompleted++;
+                }
+                Driver::Location next = randomLocation();
+                driver.targetLatitude = next.latitude;
+                driver.targetLongitude = next.longitude;
+            }
+        }
+        updates.push_back(Driver::LocationUpdate{driver.driver->getId(), driver.latitude, driver.longitude,
+                                                 virtualTimestamp(nowMs)});
+    }
+
+    m_report.locationUpdates += m_manager->updateDriverLocations(updates);
+}
+
+// Helpers
+void CitySimulator::schedule(int64_t atMs, EventType type, const std::string& requestId,
+                             const std::string& driverId) {
+    m_events.push(Event{atMs, m_nextSequence++, type, requestId, driverId});
+}
+
+double CitySimulator::uniform(double low, double high) {
+    return std::uniform_real_distribution<double>(low, high)(m_rng);
+}
+
+std::chrono::system_clock::time_point CitySimulator::virtualTimestamp(int64_t nowMs) const {
+    return SIMULATION_EPOCH + std::chrono::milliseconds(nowMs);
+}
@@ -0,0 +1,185 @@
+#ifndef CITY_SIMULATOR_H
+#define CITY_SIMULATOR_H
+
+#include "Driver.h"
+#include "FavoriteDriverManager.h"
+#include "LatencyHistogram.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <queue>
+#include <random>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Deterministic, virtual-time city simulation over FavoriteDriverManager
+ *
+ * Builds a synthetic city from a seed. Drivers cruise between random
+ * waypoints and report GPS through updateDriverLocations. Each rider has a
+ * home, a workplace and a favorite set skewed toward popular nearby
+ * drivers. Requests arrive as a Poisson process shaped by a time-of-day
+ * curve with morning and evening peaks. A request either asks for any
+ * favorite or for a regular driver. The offered driver then answers after a
+ * random delay through acceptRideRequest or rejectRideRequest, or never
+ * answers and is left to the manager's timeout. Accepted drivers drive to
+ * the pickup and then the dropoff before going online again.
+ *
+ * Time is virtual. The manager's timer wheel reads the simulator's clock,
+ * and each tick advances it, so a day runs in seconds. The simulator drives
+ * the lifecycle from its own event queue by polling request status, never
+ * from the asynchronous callbacks. The same seed and options therefore
+ * replay the same city.
+ */
+class CitySimulator {
+public:
+    struct Options {
+        uint32_t seed = 42;
+        size_t drivers = 2000;
+        size_t riders = 20000;
+        double hours = 24.0;                  // Virtual time simulated, starting at midnight
+        double peakRequestsPerHour = 6000.0;  // Arrival rate at the busiest point of the curve
+        double favoriteRequestShare = 0.6;    // Riders with favorites ask a favorite first this often
+        size_t maxFavoritesPerRider = 5;
+        double acceptProbability = 0.75;
+        double rejectProbability = 0.15;      // The rest never answer and time out
+        int minResponseSeconds = 2;
+        int maxResponseSeconds = 20;
+        int requestTimeoutSeconds = 30;       // FavoriteDriverManager::setRequestTimeout
+        int riderPatienceSeconds = 180;       // Riders cancel unmatched requests after this
+        double driverSpeedKmh = 30.0;
+        int locationIntervalSeconds = 4;      // GPS ping period
+        int tickMillis = 1000;
+    };
+
+    struct HourStats {
+        uint64_t requests = 0;
+        uint64_t matched = 0;
+        uint64_t timedOut = 0;                // Manager timeouts plus rider cancellations
+        LatencyHistogram matchLatencyMs;
+    };
+
+    struct Report {
+        double virtualSeconds = 0.0;
+        double wallSeconds = 0.0;
+        uint64_t requests = 0;
+        uint64_t favoriteRequests = 0;        // Sent through requestAnyFavoriteDriver
+        uint64_t matched = 0;
+        uint64_t favoriteMatches = 0;         // Favorite-first requests accepted by one of the rider's favorites
+        uint64_t rejections = 0;              // rejectRideRequest calls
+        uint64_t timeouts = 0;                // Requests the manager failed
+        uint64_t abandoned = 0;               // Cancelled by an impatient rider
+        uint64_t noDriver = 0;                // Request call returned no request ID
+        uint64_t unmatchedOther = 0;          // Rejected with no reassignment
+        uint64_t tripsCompleted = 0;
+        uint64_t locationUpdates = 0;
+        LatencyHistogram matchLatencyMs;      // Request to acceptance, virtual milliseconds
+        std::vector<HourStats> hours;         // By virtual hour of day
+
+        double timeoutRate() const { return requests ? static_cast<double>(timeouts + abandoned) / requests : 0.0; }
+        double favoriteHitRate() const {
+            return favoriteRequests ? static_cast<double>(favoriteMatches) / favoriteRequests : 0.0;
+        }
+    };
+
+private:
+    enum class Phase {
+        CRUISING,
+        TO_PICKUP,
+        ON_TRIP
+    };
+
+    struct SimDriver {
+        std::shared_ptr<Driver> driver;
+        double latitude;
+        double longitude;
+        double targetLatitude;
+        double targetLongitude;
+        Phase phase;
+        double tripLatitude;                  // Dropoff while heading to a pickup
+        double tripLongitude;
+    };
+
+    struct Rider {
+        std::string id;
+        Driver::Location home;
+        Driver::Location work;
+        std::vector<uint32_t> favorites;      // Driver indexes, sorted
+    };
+
+    struct OpenRequest {
+        uint32_t rider;
+        int64_t requestedAtMs;
+        size_t hour;
+        bool favoriteFirst;
+        Driver::Location pickup;
+        Driver::Location dropoff;
+        std::string offeredDriver;            // Latest assignment seen by polling
+    };
+
+    enum class EventType {
+        DRIVER_RESPONSE,
+        RIDER_GIVES_UP
+    };
+
+    struct Event {
+        int64_t atMs;
+        uint64_t sequence;                    // FIFO among equal times, for determinism
+        EventType type;
+        std::string requestId;
+        std::string driverId;
+
+        bool operator>(const Event& other) const {
+            return atMs != other.atMs ? atMs > other.atMs : sequence > other.sequence;
+        }
+    };
+
+    Options m_options;
+    std::mt19937_64 m_rng;
+    std::atomic<int64_t> m_virtualMillis;     // Read by the manager's timer wheel
+    std::unique_ptr<FavoriteDriverManager> m_manager;
+
+    std::vector<SimDriver> m_drivers;
+    std::unordered_map<std::string, uint32_t> m_driverIndex;
+    std::vector<Rider> m_riders;
+    std::unordered_map<std::string, OpenRequest> m_open;
+    std::vector<std::string> m_openOrder;     // Poll order; map iteration order is not portable
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> m_events;
+    uint64_t m_nextSequence;
+    Report m_report;
+
+public:
+    explicit CitySimulator(const Options& options);
+    ~CitySimulator();
+
+    CitySimulator(const CitySimulator&) = delete;
+    CitySimulator& operator=(const CitySimulator&) = delete;
+
+    // Runs the whole simulation; call once
+    Report run();
+
+    // Hourly arrival weight (peak = 1.0) at a virtual time of day, interpolated
+    static double arrivalWeight(double hourOfDay);
+
+private:
+    // City generation
+    void buildCity();
+    Driver::Location randomLocation();
+
+    // Simulation steps
+    void generateArrivals(int64_t nowMs);
+    void submitRequest(uint32_t rider, int64_t nowMs);
+    void runDueEvents(int64_t nowMs);
+    void handleResponse(const Event& event, int64_t nowMs);
+    void moveDrivers(int64_t nowMs);
+    void pollOpenRequests(int64_t nowMs);
+    void closeRequest(const std::string& requestId);
+
+    void schedule(int64_t atMs, EventType type, const std::string& requestId, const std::string& driverId);
+    double uniform(double low, double high);
+    std::chrono::system_clock::time_point virtualTimestamp(int64_t nowMs) const;
+};
+
+#endif // CITY_SIMULATOR_H
@@ -0,0 +1,201 @@
+#include "CitySimulator.h"
+#include "JsonWriter.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+namespace {
+    struct CommandLine {
+        CitySimulator::Options simulation;
+        std::string format = "text"; // text or json
+        std::string outPath;         // Report destination; stdout when empty
+    };
+
+    void printUsage(const char* program) {
+        std::cerr << "Usage: " << program << " [--seed=<n>] [--drivers=<n>] [--riders=<n>] [--hours=<h>]\n"
+                  << "       [--peak-rph=<n>] [--favorite-share=<p>] [--max-favorites=<n>]\n"
+                  << "       [--accept=<p>] [--reject=<p>] [--min-response=<s>] [--max-response=<s>]\n"
+                  << "       [--timeout=<s>] [--patience=<s>] [--speed=<kmh>] [--ping=<s>] [--tick-ms=<ms>]\n"
+                  << "       [--format=text|json] [--out=<file>]\n";
+    }
+
+    bool parseArguments(int argc, char** argv, CommandLine& commandLine) {
+        CitySimulator::Options& options = commandLine.simulation;
+        for (int i = 1; i < argc; ++i) {
+            std::string argument = argv[i];
+            size_t equals = argument.find('=');
+            std::string name = argument.substr(0, equals);
+            std::string value = equals == std::string::npos ? std::string() : argument.substr(equals + 1);
+            try {
+                if (name == "--seed") {
+                    options.seed = static_cast<uint32_t>(std::stoul(value));
+                } else if (name == "--drivers") {
+                    options.drivers = std::stoul(value);
+                } else if (name == "--riders") {
+                    options.riders = std::stoul(value);
+                } else if (name == "--hours") {
+                    options.hours = std::stod(value);
+                } else if (name == "--peak-rph") {
+                    options.peakRequestsPerHour = std::stod(value);
+                } else if (name == "--favorite-share") {
+                    options.favoriteRequestShare = std::stod(value);
+                } else if (name == "--max-favorites") {
+                    options.maxFavoritesPerRider = std::stoul(value);
+                } else if (name == "--accept") {
+                    options.acceptProbability = std::stod(value);
+                } else if (name == "--reject") {
+                    options.rejectProbability = std::stod(value);
+                } else if (name == "--min-response") {
+                    options.minResponseSeconds = std::stoi(value);
+                } else if (name == "--max-response") {
+                    options.maxResponseSeconds = std::stoi(value);
+                } else if (name == "--timeout") {
+                    options.requestTimeoutSeconds = std::stoi(value);
+                } else if (name == "--patience") {
+                    options.riderPatienceSeconds = std::stoi(value);
+                } else if (name == "--speed") {
+                    options.driverSpeedKmh = std::stod(value);
+                } else if (name == "--ping") {
+                    options.locationIntervalSeconds = std::stoi(value);
+                } else if (name == "--tick-ms") {
+                    options.tickMillis = std::stoi(value);
+                } else if (name == "--format" && (value == "text" || value == "json")) {
+                    commandLine.format = value;
+                } else if (name == "--out") {
+                    commandLine.outPath = value;
+                } else {
+                    return false;
+                }
+            } catch (const std::exception&) {
+                return false;
+            }
+        }
+        return options.acceptProbability >= 0.0 && options.rejectProbability >= 0.0 &&
+               options.acceptProbability + options.rejectProbability <= 1.0 && options.hours >= 0.0;
+    }
+
+    double percent(uint64_t part, uint64_t whole) {
+        return whole ? 100.0 * part / whole : 0.0;
+    }
+
+    double seconds(uint64_t millis) {
+        return millis / 1000.0;
+    }
+
+    std::string formatText(const CitySimulator::Report& report, const CitySimulator::Options& options) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(1);
+        out << "City simulation: seed " << options.seed << ", " << options.drivers << " drivers, " << options.riders
+            << " riders, " << report.virtualSeconds / 3600.0 << " virtual h in " << std::setprecision(2)
+            << report.wallSeconds << " s (" << std::setprecision(0)
+            << report.virtualSeconds / std::max(report.wallSeconds, 1e-9) << "x)\n";
+        out << std::setprecision(1);
+        out << "Requests:            " << report.requests << " (" << report.favoriteRequests << " favorite-first)\n";
+        out << "Matched:             " << report.matched << " (" << percent(report.matched, report.requests) << "%)\n";
+        out << "Throughput:          " << report.requests / std::max(report.wallSeconds, 1e-9)
+            << " requests/s wall, " << report.matched / std::max(report.virtualSeconds / 3600.0, 1e-9)
+            << " matches/virtual h\n";
+        out << std::setprecision(2);
+        out << "Match latency:       p50 " << seconds(report.matchLatencyMs.valueAtPercentile(50.0)) << " s, p99 "
+            << seconds(report.matchLatencyMs.valueAtPercentile(99.0)) << " s\n";
+        out << std::setprecision(1);
+        out << "Favorite hit rate:   " << 100.0 * report.favoriteHitRate() << "%\n";
+        out << "Timeout rate:        " << 100.0 * report.timeoutRate() << "% (" << report.timeouts << " timed out, "
+            << report.abandoned << " abandoned)\n";
+        out << "Rejections:          " << report.rejections << "\n";
+        out << "No driver:           " << report.noDriver << "\n";
+        out << "Trips completed:     " << report.tripsCompleted << "\n";
+        out << "Location updates:    " << report.locationUpdates << "\n";
+
+        out << "\n" << std::left << std::setw(6) << "Hour" << std::right << std::setw(10) << "Requests"
+            << std::setw(10) << "Matched" << std::setw(10) << "Timeout" << std::setw(10) << "p50 s" << std::setw(10)
+            << "p99 s" << "\n";
+        out << std::setprecision(2);
+        for (size_t hour = 0; hour < report.hours.size(); ++hour) {
+            const CitySimulator::HourStats& stats = report.hours[hour];
+            out << std::left << std::setw(6) << hour << std::right << std::setw(10) << stats.requests
+                << std::setw(10) << stats.matched << std::setw(10) << stats.timedOut << std::setw(10)
+                << seconds(stats.matchLatencyMs.valueAtPercentile(50.0)) << std::setw(10)
+                << seconds(stats.matchLatencyMs.valueAtPercentile(99.0)) << "\n";
+        }
+        return out.str();
+    }
+
+    // Virtual-time results only, besides wall_seconds, so seeded runs diff cleanly
+    std::string formatJson(const CitySimulator::Report& report, const CitySimulator::Options& options) {
+        std::string out;
+        JsonWriter writer(out);
+        writer.beginObject();
+        writer.key("options");
+        writer.beginObject();
+        writer.field("seed", static_cast<uint64_t>(options.seed));
+        writer.field("drivers", static_cast<uint64_t>(options.drivers));
+        writer.field("riders", static_cast<uint64_t>(options.riders));
+        writer.field("hours", options.hours);
+        writer.field("peak_requests_per_hour", options.peakRequestsPerHour);
+        writer.field("favorite_request_share", options.favoriteRequestShare);
+        writer.field("accept_probability", options.acceptProbability);
+        writer.field("reject_probability", options.rejectProbability);
+        writer.field("request_timeout_s", options.requestTimeoutSeconds);
+        writer.field("rider_patience_s", options.riderPatienceSeconds);
+        writer.endObject();
+        writer.field("virtual_seconds", report.virtualSeconds);
+        writer.field("wall_seconds", report.wallSeconds);
+        writer.field("requests", report.requests);
+        writer.field("favorite_requests", report.favoriteRequests);
+        writer.field("matched", report.matched);
+        writer.field("favorite_matches", report.favoriteMatches);
+        writer.field("favorite_hit_rate", report.favoriteHitRate());
+        writer.field("rejections", report.rejections);
+        writer.field("timeouts", report.timeouts);
+        writer.field("abandoned", report.abandoned);
+        writer.field("timeout_rate", report.timeoutRate());
+        writer.field("no_driver", report.noDriver);
+        writer.field("unmatched_other", report.unmatchedOther);
+        writer.field("trips_completed", report.tripsCompleted);
+        writer.field("location_updates", report.locationUpdates);
+        writer.field("match_latency_p50_ms", report.matchLatencyMs.valueAtPercentile(50.0));
+        writer.field("match_latency_p99_ms", report.matchLatencyMs.valueAtPercentile(99.0));
+        writer.key("hours");
+        writer.beginArray();
+        for (const CitySimulator::HourStats& stats : report.hours) {
+            writer.beginObject();
+            writer.field("requests", stats.requests);
+            writer.field("matched", stats.matched);
+            writer.field("timed_out", stats.timedOut);
+            writer.field("match_latency_p50_ms", stats.matchLatencyMs.valueAtPercentile(50.0));
+            writer.field("match_latency_p99_ms", stats.matchLatencyMs.valueAtPercentile(99.0));
+            writer.endObject();
+        }
+        writer.endArray();
+        writer.endObject();
+        out += "\n";
+        return out;
+    }
+}
+
+int main(int argc, char** argv) {
+    CommandLine commandLine;
+    if (!parseArguments(argc, argv, commandLine)) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    CitySimulator simulator(commandLine.simulation);
+    CitySimulator::Report report = simulator.run();
+    std::string text = commandLine.format == "json" ? formatJson(report, commandLine.simulation)
+                                                    : formatText(report, commandLine.simulation);
+
+    if (commandLine.outPath.empty()) {
+        std::cout << text;
+    } else {
+        std::ofstream file(commandLine.outPath, std::ios::binary);
+        if (!file || !(file << text)) {
+            std::cerr << "Failed to write " << commandLine.outPath << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
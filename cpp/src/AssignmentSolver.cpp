@@ -0,0 +1,206 @@
+#include "AssignmentSolver.h"
+#include <unordered_map>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Union-find over rows; rows sharing a column end up in one set
+    class RowSets {
+    private:
+        std::vector<uint32_t> m_parent;
+
+    public:
+        explicit RowSets(size_t count) : m_parent(count) {
+            for (size_t i = 0; i < count; ++i) {
+                m_parent[i] = static_cast<uint32_t>(i);
+            }
+        }
+
+        uint32_t find(uint32_t row) {
+            while (m_parent[row] != row) {
+                m_parent[row] = m_parent[m_parent[row]];
+                row = m_parent[row];
+            }
+            return row;
+        }
+
+        void unite(uint32_t a, uint32_t b) {
+            a = find(a);
+            b = find(b);
+            if (a != b) {
+                m_parent[std::max(a, b)] = std::min(a, b);
+            }
+        }
+    };
+
+    // Dense minimum-cost assignment of n rows to m >= n columns (row-major
+    // costs); shortest augmenting paths with row/column potentials
+    std::vector<size_t> hungarian(const std::vector<double>& costs, size_t n, size_t m) {
+        const double INF = std::numeric_limits<double>::infinity();
+        // 1-based; column 0 is the virtual start of each augmenting path
+        std::vector<double> rowPotential(n + 1, 0.0), columnPotential(m + 1, 0.0), minReduced(m + 1);
+        std::vector<size_t> columnOwner(m + 1, 0), previous(m + 1, 0);
+        std::vector<char> visited(m + 1);
+
+        for (size_t row = 1; row <= n; ++row) {
+            columnOwner[0] = row;
+            size_t column = 0;
+            std::fill(minReduced.begin(), minReduced.end(), INF);
+            std::fill(visited.begin(), visited.end(), 0);
+            do {
+                visited[column] = 1;
+                size_t owner = columnOwner[column];
+                const double* ownerCosts = &costs[(owner - 1) * m];
+                double delta = INF;
+                size_t nextColumn = 0;
+                for (size_t j = 1; j <= m; ++j) {
+                    if (visited[j]) {
+                        continue;
+                    }
+                    double reduced = ownerCosts[j - 1] - rowPotential[owner] - columnPotential[j];
+                    if (reduced < minReduced[j]) {
+                        minReduced[j] = reduced;
+                        previous[j] = column;
+                    }
+                    if (minReduced[j] < delta) {
+                        delta = minReduced[j];
+                        nextColumn = j;
+                    }
+                }
+                for (size_t j = 0; j <= m; ++j) {
+                    if (visited[j]) {
+                        rowPotential[columnOwner[j]] += delta;
+                        columnPotential[j] -= delta;
+                    } else {
+                        minReduced[j] -= delta;
+                    }
+                }
+                column = nextColumn;
+            } while (columnOwner[column] != 0);
+
+            // Flip the augmenting path back to the start
+            do {
+                size_t before = previous[column];
+                columnOwner[column] = columnOwner[before];
+                column = before;
+            } while (column != 0);
+        }
+
+        std::vector<size_t> rowToColumn(n);
+        for (size_t j = 1; j <= m; ++j) {
+            if (columnOwner[j] != 0) {
+                rowToColumn[columnOwner[j] - 1] = j - 1;
+            }
+        }
+        return rowToColumn;
+    }
+}
+
+// Solving
+std::vector<uint32_t> AssignmentSolver::solve(const std::vector<std::vector<Edge>>& rows, double unassignedCost) {
+    std::vector<uint32_t> assignment(rows.size(), UNASSIGNED);
+    auto usable = [unassignedCost](const Edge& edge) { return edge.cost < unassignedCost; };
+
+    // Components: rows joined through any column they could both take
+    RowSets sets(rows.size());
+    std::unordered_map<uint32_t, uint32_t> firstRowForColumn;
+    for (uint32_t row = 0; row < rows.size(); ++row) {
+        for (const Edge& edge : rows[row]) {
+            if (usable(edge)) {
+                auto inserted = firstRowForColumn.emplace(edge.column, row);
+                if (!inserted.second) {
+                    sets.unite(row, inserted.first->second);
+                }
+            }
+        }
+    }
+    std::unordered_map<uint32_t, std::vector<uint32_t>> components;
+    for (uint32_t row = 0; row < rows.size(); ++row) {
+        if (std::any_of(rows[row].begin(), rows[row].end(), usable)) {
+            components[sets.find(row)].push_back(row);
+        }
+    }
+
+    // Anything dearer than leaving the row unmatched; never chosen while a
+    // "no driver" column is free, and there is one per row
+    const double forbidden = unassignedCost + std::max(1.0, std::fabs(unassignedCost));
+    std::vector<double> costs;
+    std::unordered_map<uint32_t, size_t> localColumns;
+    std::vector<uint32_t> globalColumns;
+    for (const auto& component : components) {
+        const std::vector<uint32_t>& members = component.second;
+
+        // Lone rider: cheapest edge wins outright
+        if (members.size() == 1) {
+            const Edge* best = nullptr;
+            for (const Edge& edge : rows[members[0]]) {
+                if (usable(edge) && (!best || edge.cost < best->cost)) {
+                    best = &edge;
+                }
+            }
+            assignment[members[0]] = best->column;
+            continue;
+        }
+
+        localColumns.clear();
+        globalColumns.clear();
+        double lowest = unassignedCost;
+        double highest = -std::numeric_limits<double>::infinity();
+        for (uint32_t row : members) {
+            for (const Edge& edge : rows[row]) {
+                if (usable(edge)) {
+                    lowest = std::min(lowest, edge.cost);
+                    highest = std::max(highest, edge.cost);
+                    if (localColumns.emplace(edge.column, globalColumns.size()).second) {
+                        globalColumns.push_back(edge.column);
+                    }
+                }
+            }
+        }
+
+        // Every real edge gets the same bonus, larger than the spread of any
+        // total over n edges, so one more match always outweighs any saving
+        // in cost. Among assignments of equal size the bonus cancels out
+        size_t n = members.size();
+        const double bonus = static_cast<double>(n) * (highest - lowest) + 1.0;
+        size_t driverColumns = globalColumns.size();
+        size_t m = driverColumns + n;
+        costs.assign(n * m, forbidden);
+        for (size_t i = 0; i < n; ++i) {
+            double* rowCosts = &costs[i * m];
+            for (const Edge& edge : rows[members[i]]) {
+                if (usable(edge)) {
+                    double& cell = rowCosts[localColumns[edge.column]];
+                    cell = std::min(cell, edge.cost - bonus);
+                }
+            }
+            std::fill(rowCosts + driverColumns, rowCosts + m, unassignedCost);
+        }
+
+        std::vector<size_t> chosen = hungarian(costs, n, m);
+        for (size_t i = 0; i < n; ++i) {
+            if (chosen[i] < driverColumns && costs[i * m + chosen[i]] < unassignedCost) {
+                assignment[members[i]] = globalColumns[chosen[i]];
+            }
+        }
+    }
+    return assignment;
+}
+
+double AssignmentSolver::totalCost(const std::vector<std::vector<Edge>>& rows,
+                                   const std::vector<uint32_t>& assignment, double unassignedCost) {
+    double total = 0.0;
+    for (size_t row = 0; row < rows.size(); ++row) {
+        double cost = unassignedCost;
+        if (assignment[row] != UNASSIGNED) {
+            for (const Edge& edge : rows[row]) {
+                if (edge.column == assignment[row]) {
+                    cost = std::min(cost, edge.cost);
+                }
+            }
+        }
+        total += cost;
+    }
+    return total;
+}
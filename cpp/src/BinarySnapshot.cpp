@@ -0,0 +1,380 @@
+#include "BinarySnapshot.h"
+#include "FileSync.h"
+#include <unordered_map>
+#include <cstring>
+#include <cstdio>
+
+namespace {
+    constexpr char SNAPSHOT_MAGIC[8] = {'U', 'F', 'D', 'S', 'N', 'A', 'P', '\0'};
+    constexpr uint64_t SECTION_ALIGNMENT = 8;
+    constexpr int STRING_COLUMNS = 9;
+
+    uint64_t align(uint64_t offset) {
+        return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+    }
+
+    // Absolute file offsets of every column, derived from the counts alone so
+    // writer and reader cannot disagree about where a column starts
+    struct Layout {
+        uint64_t stringTable;
+        uint64_t stringColumns[STRING_COLUMNS];
+        uint64_t latitudes, longitudes, ratings;
+        uint64_t completedTrips, vehicleYears, statuses, verified;
+        uint64_t userIds, userOffsets;
+        uint64_t edges;
+        uint64_t fileSize;
+
+        Layout(uint32_t drivers, uint32_t users, uint64_t edgeCount, uint64_t stringBytes) {
+            uint64_t cursor = align(sizeof(BinarySnapshot::Header));
+            auto place = [&cursor](uint64_t bytes) {
+                uint64_t start = cursor;
+                cursor = align(cursor + bytes);
+                return start;
+            };
+
+            stringTable = place(stringBytes);
+            for (auto& column : stringColumns) {
+                column = place(uint64_t(drivers) * sizeof(BinarySnapshot::StringRef));
+            }
+            latitudes = place(uint64_t(drivers) * sizeof(double));
+            longitudes = place(uint64_t(drivers) * sizeof(double));
+            ratings = place(uint64_t(drivers) * sizeof(double));
+            completedTrips = place(uint64_t(drivers) * sizeof(int32_t));
+            vehicleYears = place(uint64_t(drivers) * sizeof(int32_t));
+            statuses = place(drivers);
+            verified = place(drivers);
+            userIds = place(uint64_t(users) * sizeof(BinarySnapshot::StringRef));
+            userOffsets = place((uint64_t(users) + 1) * sizeof(uint32_t));
+            edges = place(edgeCount * sizeof(uint32_t));
+            fileSize = cursor;
+        }
+    };
+
+    // Deduplicating string table builder
+    class StringTableBuilder {
+    private:
+        std::string m_bytes;
+        std::unordered_map<std::string, BinarySnapshot::StringRef> m_refs;
+
+    public:
+        bool add(const std::string& value, BinarySnapshot::StringRef& ref) {
+            auto it = m_refs.find(value);
+            if (it != m_refs.end()) {
+                ref = it->second;
+                return true;
+            }
+            if (m_bytes.size() + value.size() > UINT32_MAX) {
+                return false;
+            }
+            ref = BinarySnapshot::StringRef{static_cast<uint32_t>(m_bytes.size()), static_cast<uint32_t>(value.size())};
+            m_bytes += value;
+            m_refs.emplace(value, ref);
+            return true;
+        }
+
+        const std::string& bytes() const { return m_bytes; }
+    };
+
+    template <typename T>
+    void put(std::vector<char>& buffer, uint64_t offset, const std::vector<T>& column) {
+        if (!column.empty()) {
+            std::memcpy(buffer.data() + offset, column.data(), column.size() * sizeof(T));
+        }
+    }
+}
+
+// Constructor and Destructor
+BinarySnapshot::BinarySnapshot()
+    : m_file(), m_header(nullptr), m_strings(nullptr), m_columns(), m_lastError("") {
+}
+
+BinarySnapshot::~BinarySnapshot() = default;
+
+BinarySnapshot::BinarySnapshot(BinarySnapshot&& other) noexcept
+    : m_file(std::move(other.m_file)), m_header(other.m_header), m_strings(other.m_strings),
+      m_columns(other.m_columns), m_lastError(std::move(other.m_lastError)) {
+    other.m_header = nullptr;
+    other.m_strings = nullptr;
+    other.m_columns = Columns();
+}
+
+BinarySnapshot& BinarySnapshot::operator=(BinarySnapshot&& other) noexcept {
+    if (this != &other) {
+        m_file = std::move(other.m_file);
+        m_header = other.m_header;
+        m_strings = other.m_strings;
+        m_columns = other.m_columns;
+        m_lastError = std::move(other.m_lastError);
+        other.m_header = nullptr;
+        other.m_strings = nullptr;
+        other.m_columns = Columns();
+    }
+    return *this;
+}
+
+// Writing
+bool BinarySnapshot::write(const std::string& filename, const std::vector<std::shared_ptr<Driver>>& drivers,
+                           const std::vector<FavoriteList>& favorites, std::string* error) {
+    auto reportError = [error](const std::string& message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+
+    StringTableBuilder strings;
+    std::vector<StringRef> stringColumns[STRING_COLUMNS];
+    std::vector<double> latitudes, longitudes, ratings;
+    std::vector<int32_t> completedTrips, vehicleYears;
+    std::vector<uint8_t> statuses, verified;
+    std::unordered_map<std::string, uint32_t> driverIndex;
+
+    for (const auto& driver : drivers) {
+        if (!driver || driverIndex.count(driver->getId())) {
+            continue;
+        }
+        driverIndex.emplace(driver->getId(), static_cast<uint32_t>(latitudes.size()));
+
+        const auto& vehicle = driver->getVehicle();
+        const std::string* fields[STRING_COLUMNS] = {
+            &driver->getId(), &driver->getName(), &driver->getPhoneNumber(), &driver->getEmail(),
+            &driver->getProfilePhoto(), &vehicle.make, &vehicle.model, &vehicle.color, &vehicle.plateNumber
+        };
+        for (int column = 0; column < STRING_COLUMNS; ++column) {
+            StringRef ref;
+            if (!strings.add(*fields[column], ref)) {
+                return reportError("string table exceeds 4 GiB");
+            }
+            stringColumns[column].push_back(ref);
+        }
+
+        latitudes.push_back(driver->getCurrentLocation().latitude);
+        longitudes.push_back(driver->getCurrentLocation().longitude);
+        ratings.push_back(driver->getRating());
+        completedTrips.push_back(driver->getCompletedTrips());
+        vehicleYears.push_back(vehicle.year);
+        statuses.push_back(static_cast<uint8_t>(driver->getStatus()));
+        verified.push_back(driver->isVerified() ? 1 : 0);
+    }
+
+    // Favorites as CSR: row offsets per user, driver indexes as columns
+    std::vector<StringRef> userIds;
+    std::vector<uint32_t> userOffsets{0};
+    std::vector<uint32_t> edges;
+    for (const auto& favorite : favorites) {
+        StringRef ref;
+        if (!strings.add(favorite.first, ref)) {
+            return reportError("string table exceeds 4 GiB");
+        }
+        for (const auto& driverId : favorite.second) {
+            auto it = driverIndex.find(driverId);
+            if (it != driverIndex.end()) {
+                edges.push_back(it->second);
+            }
+        }
+        if (edges.size() > UINT32_MAX) {
+            return reportError("too many favorite edges");
+        }
+        userIds.push_back(ref);
+        userOffsets.push_back(static_cast<uint32_t>(edges.size()));
+    }
+
+    uint32_t driverCount = static_cast<uint32_t>(latitudes.size());
+    uint32_t userCount = static_cast<uint32_t>(userIds.size());
+    Layout layout(driverCount, userCount, edges.size(), strings.bytes().size());
+
+    std::vector<char> buffer(layout.fileSize, 0);
+    std::memcpy(buffer.data() + layout.stringTable, strings.bytes().data(), strings.bytes().size());
+    for (int column = 0; column < STRING_COLUMNS; ++column) {
+        put(buffer, layout.stringColumns[column], stringColumns[column]);
+    }
+    put(buffer, layout.latitudes, latitudes);
+    put(buffer, layout.longitudes, longitudes);
+    put(buffer, layout.ratings, ratings);
+    put(buffer, layout.completedTrips, completedTrips);
+    put(buffer, layout.vehicleYears, vehicleYears);
+    put(buffer, layout.statuses, statuses);
+    put(buffer, layout.verified, verified);
+    put(buffer, layout.userIds, userIds);
+    put(buffer, layout.userOffsets, userOffsets);
+    put(buffer, layout.edges, edges);
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = FORMAT_VERSION;
+    header.headerSize = sizeof(Header);
+    header.driverCount = driverCount;
+    header.userCount = userCount;
+    header.edgeCount = edges.size();
+    header.stringTableOffset = layout.stringTable;
+    header.stringTableSize = strings.bytes().size();
+    header.driverBlockOffset = layout.stringColumns[0];
+    header.userBlockOffset = layout.userIds;
+    header.edgeBlockOffset = layout.edges;
+    header.fileSize = layout.fileSize;
+    header.checksum = checksum(buffer.data() + sizeof(Header), buffer.size() - sizeof(Header));
+    std::memcpy(buffer.data(), &header, sizeof(header));
+
+    // Write and fsync a temporary file, then rename it and fsync the directory,
+    // so neither readers nor a crash can leave a torn snapshot in place
+    std::string tempName = filename + ".tmp";
+    std::FILE* file = std::fopen(tempName.c_str(), "wb");
+    if (!file) {
+        return reportError("failed to create " + tempName);
+    }
+    bool written = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size() && FileSync::syncFile(file);
+    written = std::fclose(file) == 0 && written;
+    if (!written) {
+        std::remove(tempName.c_str());
+        return reportError("failed to write " + tempName);
+    }
+    if (!FileSync::replaceFile(tempName, filename)) {
+        std::remove(tempName.c_str());
+        return reportError("failed to rename snapshot to " + filename);
+    }
+    return true;
+}
+
+// Reading
+bool BinarySnapshot::open(const std::string& filename, bool verifyChecksum) {
+    close();
+
+    auto file = std::make_unique<MappedFile>();
+    if (!file->open(filename)) {
+        return fail("cannot map " + filename);
+    }
+    if (file->size() < sizeof(Header)) {
+        return fail("file too small for a snapshot header");
+    }
+
+    const auto* header = reinterpret_cast<const Header*>(file->data());
+    if (std::memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        return fail("bad magic");
+    }
+    if (header->version != FORMAT_VERSION || header->headerSize != sizeof(Header)) {
+        return fail("unsupported snapshot version " + std::to_string(header->version));
+    }
+
+    if (header->edgeCount > UINT32_MAX || header->stringTableSize > UINT32_MAX) {
+        return fail("section sizes out of range");
+    }
+    Layout layout(header->driverCount, header->userCount, header->edgeCount, header->stringTableSize);
+    if (header->fileSize != file->size() || layout.fileSize != file->size() ||
+        header->stringTableOffset != layout.stringTable || header->driverBlockOffset != layout.stringColumns[0] ||
+        header->userBlockOffset != layout.userIds || header->edgeBlockOffset != layout.edges) {
+        return fail("section layout does not match header counts");
+    }
+
+    if (verifyChecksum &&
+        checksum(file->data() + sizeof(Header), file->size() - sizeof(Header)) != header->checksum) {
+        return fail("checksum mismatch");
+    }
+
+    const char* base = file->data();
+    Columns columns;
+    const StringRef** stringColumns[STRING_COLUMNS] = {
+        &columns.ids, &columns.names, &columns.phoneNumbers, &columns.emails, &columns.profilePhotos,
+        &columns.vehicleMakes, &columns.vehicleModels, &columns.vehicleColors, &columns.vehiclePlates
+    };
+    for (int column = 0; column < STRING_COLUMNS; ++column) {
+        *stringColumns[column] = reinterpret_cast<const StringRef*>(base + layout.stringColumns[column]);
+    }
+    columns.latitudes = reinterpret_cast<const double*>(base + layout.latitudes);
+    columns.longitudes = reinterpret_cast<const double*>(base + layout.longitudes);
+    columns.ratings = reinterpret_cast<const double*>(base + layout.ratings);
+    columns.completedTrips = reinterpret_cast<const int32_t*>(base + layout.completedTrips);
+    columns.vehicleYears = reinterpret_cast<const int32_t*>(base + layout.vehicleYears);
+    columns.statuses = reinterpret_cast<const uint8_t*>(base + layout.statuses);
+    columns.verified = reinterpret_cast<const uint8_t*>(base + layout.verified);
+    columns.userIds = reinterpret_cast<const StringRef*>(base + layout.userIds);
+    columns.userOffsets = reinterpret_cast<const uint32_t*>(base + layout.userOffsets);
+    columns.edges = reinterpret_cast<const uint32_t*>(base + layout.edges);
+
+    // The checksum pass already touched every page; bounds-check references too
+    if (verifyChecksum) {
+        auto validRef = [header](const StringRef& ref) {
+            return uint64_t(ref.offset) + ref.length <= header->stringTableSize;
+        };
+        for (uint32_t i = 0; i < header->driverCount; ++i) {
+            for (int column = 0; column < STRING_COLUMNS; ++column) {
+                if (!validRef((*stringColumns[column])[i])) {
+                    return fail("string reference out of range");
+                }
+            }
+        }
+        for (uint32_t user = 0; user < header->userCount; ++user) {
+            if (!validRef(columns.userIds[user]) || columns.userOffsets[user] > columns.userOffsets[user + 1]) {
+                return fail("user block is corrupt");
+            }
+        }
+        if (columns.userOffsets[0] != 0 || columns.userOffsets[header->userCount] != header->edgeCount) {
+            return fail("user block is corrupt");
+        }
+        for (uint64_t edge = 0; edge < header->edgeCount; ++edge) {
+            if (columns.edges[edge] >= header->driverCount) {
+                return fail("favorite edge references unknown driver");
+            }
+        }
+    }
+
+    m_file = std::move(file);
+    m_header = header;
+    m_strings = base + layout.stringTable;
+    m_columns = columns;
+    m_lastError.clear();
+    return true;
+}
+
+void BinarySnapshot::close() {
+    m_file.reset();
+    m_header = nullptr;
+    m_strings = nullptr;
+    m_columns = Columns();
+}
+
+Driver BinarySnapshot::materializeDriver(uint32_t index) const {
+    Driver driver(std::string(view(m_columns.ids[index])), std::string(view(m_columns.names[index])),
+                  std::string(view(m_columns.phoneNumbers[index])));
+    driver.setEmail(std::string(view(m_columns.emails[index])));
+    driver.setProfilePhoto(std::string(view(m_columns.profilePhotos[index])));
+    driver.setRating(m_columns.ratings[index]);
+    driver.setCompletedTrips(m_columns.completedTrips[index]);
+    driver.setStatus(static_cast<Driver::Status>(m_columns.statuses[index]));
+    driver.setCurrentLocation(Driver::Location(m_columns.latitudes[index], m_columns.longitudes[index]));
+    driver.setVehicle(Driver::Vehicle(std::string(view(m_columns.vehicleMakes[index])),
+                                      std::string(view(m_columns.vehicleModels[index])),
+                                      std::string(view(m_columns.vehicleColors[index])),
+                                      std::string(view(m_columns.vehiclePlates[index])),
+                                      m_columns.vehicleYears[index]));
+    driver.setVerified(m_columns.verified[index] != 0);
+    return driver;
+}
+
+std::pair<const uint32_t*, const uint32_t*> BinarySnapshot::getFavorites(uint32_t user) const {
+    const uint32_t* edges = m_columns.edges;
+    return {edges + m_columns.userOffsets[user], edges + m_columns.userOffsets[user + 1]};
+}
+
+uint64_t BinarySnapshot::checksum(const void* data, size_t size) {
+    // Word-at-a-time multiply/xor-shift hash; catches truncation and bit rot
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = 0x9E3779B97F4A7C15ull ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 32;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 0xC4CEB9FE1A85EC53ull;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+bool BinarySnapshot::fail(const std::string& message) {
+    m_lastError = message;
+    return false;
+}
@@ -0,0 +1,138 @@
+#include "DispatchBatcher.h"
+#include <unordered_map>
+#include <algorithm>
+
+namespace {
+    constexpr uint64_t ANY_GENERATION = UINT64_MAX;
+}
+
+// Constructors and Destructor
+DispatchBatcher::DispatchBatcher(TimerWheel& wheel, DispatchCallback dispatch)
+    : DispatchBatcher(wheel, std::move(dispatch), Options()) {
+}
+
+DispatchBatcher::DispatchBatcher(TimerWheel& wheel, DispatchCallback dispatch, const Options& options)
+    : m_wheel(wheel), m_dispatch(std::move(dispatch)), m_options(options),
+      m_windowTimer(TimerWheel::INVALID_TIMER), m_generation(0) {
+    m_options.maxBatchSize = std::max<size_t>(1, m_options.maxBatchSize);
+}
+
+DispatchBatcher::~DispatchBatcher() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_windowTimer != TimerWheel::INVALID_TIMER) {
+        m_wheel.cancel(m_windowTimer);
+    }
+}
+
+// Queueing
+void DispatchBatcher::submit(Request request) {
+    if (request.enqueuedAt == Clock::time_point()) {
+        request.enqueuedAt = Clock::now();
+    }
+
+    uint64_t fullGeneration = ANY_GENERATION;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.push_back(std::move(request));
+        if (m_pending.size() == 1) {
+            // The window opens with the first request of each batch
+            uint64_t generation = m_generation;
+            m_windowTimer = m_wheel.schedule(m_options.window, [this, generation]() {
+                flushGeneration(generation);
+            });
+        }
+        if (m_pending.size() >= m_options.maxBatchSize) {
+            fullGeneration = m_generation;
+        }
+    }
+    if (fullGeneration != ANY_GENERATION) {
+        flushGeneration(fullGeneration);
+    }
+}
+
+size_t DispatchBatcher::flush() {
+    return flushGeneration(ANY_GENERATION);
+}
+
+std::vector<DispatchBatcher::Request> DispatchBatcher::takeBatch(uint64_t generation) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<Request> batch;
+    if (m_pending.empty() || (generation != ANY_GENERATION && generation != m_generation)) {
+        return batch;
+    }
+    batch.swap(m_pending);
+    if (m_windowTimer != TimerWheel::INVALID_TIMER) {
+        m_wheel.cancel(m_windowTimer); // No-op when the timer is what called us
+        m_windowTimer = TimerWheel::INVALID_TIMER;
+    }
+    ++m_generation;
+    return batch;
+}
+
+// Solving
+size_t DispatchBatcher::flushGeneration(uint64_t generation) {
+    std::vector<Request> batch = takeBatch(generation);
+    if (batch.empty()) {
+        return 0;
+    }
+
+    // Driver handles -> dense solver columns
+    std::unordered_map<Handle, uint32_t> columns;
+    std::vector<Handle> drivers;
+    std::vector<std::vector<AssignmentSolver::Edge>> rows(batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+        rows[i].reserve(batch[i].candidates.size());
+        for (const Candidate& candidate : batch[i].candidates) {
+            auto inserted = columns.emplace(candidate.driver, static_cast<uint32_t>(drivers.size()));
+            if (inserted.second) {
+                drivers.push_back(candidate.driver);
+            }
+            rows[i].push_back(AssignmentSolver::Edge{inserted.first->second, candidate.cost});
+        }
+    }
+
+    auto start = Clock::now();
+    std::vector<uint32_t> chosen = AssignmentSolver::solve(rows, m_options.unassignedCost);
+    auto solveMicros = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+
+    std::vector<Assignment> assignments;
+    assignments.reserve(batch.size());
+    size_t assigned = 0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        Assignment assignment{std::move(batch[i].requestId), batch[i].user, NO_DRIVER, m_options.unassignedCost,
+                              batch[i].enqueuedAt};
+        if (chosen[i] != AssignmentSolver::UNASSIGNED) {
+            assignment.driver = drivers[chosen[i]];
+            assignment.cost = m_options.unassignedCost;
+            for (const AssignmentSolver::Edge& edge : rows[i]) {
+                if (edge.column == chosen[i]) {
+                    assignment.cost = std::min(assignment.cost, edge.cost);
+                }
+            }
+            ++assigned;
+        }
+        assignments.push_back(std::move(assignment));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.batches++;
+        m_stats.requests += batch.size();
+        m_stats.assigned += assigned;
+        m_stats.unassigned += batch.size() - assigned;
+        m_stats.largestBatch = std::max(m_stats.largestBatch, batch.size());
+        m_stats.solveMicros += static_cast<uint64_t>(solveMicros);
+    }
+
+    if (m_dispatch) {
+        m_dispatch(assignments);
+    }
+    return batch.size();
+}
+
+DispatchBatcher::Stats DispatchBatcher::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats = m_stats;
+    stats.queued = m_pending.size();
+    return stats;
+}
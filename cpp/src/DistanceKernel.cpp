@@ -0,0 +1,355 @@
+#include "DistanceKernel.h"
+#include <cmath>
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define DISTANCE_KERNEL_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DISTANCE_KERNEL_SSE2 1
+#endif
+
+namespace {
+    constexpr double DEG_TO_RAD = M_PI / 180.0;
+    constexpr double HALF_PI = M_PI / 2.0;
+
+    // Taylor coefficients for sin(y) = y + y * z * S(z), z = y^2, y in [0, pi/2]
+    constexpr double SIN_COEFFS[] = {
+        -1.0 / 6.0,
+        1.0 / 120.0,
+        -1.0 / 5040.0,
+        1.0 / 362880.0,
+        -1.0 / 39916800.0,
+        1.0 / 6227020800.0,
+        -1.0 / 1307674368000.0,
+        1.0 / 355687428096000.0
+    };
+    constexpr int SIN_TERMS = sizeof(SIN_COEFFS) / sizeof(SIN_COEFFS[0]);
+
+    // Cephes rational approximation asin(t) = t + t * z * P(z) / Q(z), z = t^2, |t| <= 0.625
+    constexpr double ASIN_P[] = {
+        4.253011369004428248960E-3,
+        -6.019598008014123785661E-1,
+        5.444622390564711410273E0,
+        -1.626247967210700244449E1,
+        1.956261983317594739197E1,
+        -8.198089802484824371615E0
+    };
+    constexpr double ASIN_Q[] = {
+        1.0,
+        -1.474091372988853791896E1,
+        7.049610280856842141659E1,
+        -1.471791292232726029859E2,
+        1.395105614657485689735E2,
+        -4.918853881490881290097E1
+    };
+    constexpr int ASIN_TERMS = sizeof(ASIN_P) / sizeof(ASIN_P[0]);
+
+    // Longitude difference folded into [-180, 180] degrees
+    inline double wrapLongitude(double deltaDegrees) {
+        return deltaDegrees > 180.0 ? deltaDegrees - 360.0 : (deltaDegrees < -180.0 ? deltaDegrees + 360.0 : deltaDegrees);
+    }
+
+    // Scalar lane, also used for the tail of the vector loops
+    inline double sinPoly(double y) {
+        double z = y * y;
+        double s = SIN_COEFFS[SIN_TERMS - 1];
+        for (int i = SIN_TERMS - 2; i >= 0; --i) {
+            s = s * z + SIN_COEFFS[i];
+        }
+        return y + y * z * s;
+    }
+
+    inline double asinPoly(double s) {
+        // Reduce s > 0.5 with asin(s) = pi/2 - 2 asin(sqrt((1 - s) / 2))
+        bool reduced = s > 0.5;
+        double t = reduced ? std::sqrt((1.0 - s) * 0.5) : s;
+        double z = t * t;
+        double p = ASIN_P[0];
+        double q = ASIN_Q[0];
+        for (int i = 1; i < ASIN_TERMS; ++i) {
+            p = p * z + ASIN_P[i];
+            q = q * z + ASIN_Q[i];
+        }
+        double r = t + t * z * p / q;
+        return reduced ? HALF_PI - 2.0 * r : r;
+    }
+
+    // Past a quarter circle (a > 0.5) asin(sqrt(a)) is ill-conditioned, so the
+    // arc is taken from the complement b = 1 - a instead. b is computed as a
+    // sum of squares, not by subtraction, which keeps it exact to the antipode
+    inline double haversineLane(double originLat, double originLng, double originCos,
+                                double lat, double lng, double cosLat) {
+        double halfDeltaLat = std::fabs((lat - originLat) * DEG_TO_RAD * 0.5);
+        double halfDeltaLng = std::fabs((lng - originLng) * DEG_TO_RAD * 0.5);
+        halfDeltaLng = std::min(halfDeltaLng, M_PI - halfDeltaLng); // sin(y) == sin(pi - y), |cos| likewise
+
+        double sinLat = sinPoly(halfDeltaLat);
+        double sinLng = sinPoly(halfDeltaLng);
+        double a = sinLat * sinLat + originCos * cosLat * sinLng * sinLng;
+        if (a <= 0.5) {
+            return 2.0 * DistanceKernel::EARTH_RADIUS_KM * asinPoly(std::sqrt(a));
+        }
+
+        double cosHalfLat = sinPoly(HALF_PI - halfDeltaLat);
+        double cosHalfLng = sinPoly(HALF_PI - halfDeltaLng);
+        double sinSumLat = sinPoly(std::fabs((lat + originLat) * DEG_TO_RAD * 0.5));
+        double b = cosHalfLat * cosHalfLat * cosHalfLng * cosHalfLng + sinSumLat * sinSumLat * sinLng * sinLng;
+        return DistanceKernel::EARTH_RADIUS_KM * (M_PI - 2.0 * asinPoly(std::sqrt(b)));
+    }
+
+#if defined(DISTANCE_KERNEL_AVX2)
+    inline __m256d sinPoly(__m256d y) {
+        __m256d z = _mm256_mul_pd(y, y);
+        __m256d s = _mm256_set1_pd(SIN_COEFFS[SIN_TERMS - 1]);
+        for (int i = SIN_TERMS - 2; i >= 0; --i) {
+            s = _mm256_add_pd(_mm256_mul_pd(s, z), _mm256_set1_pd(SIN_COEFFS[i]));
+        }
+        return _mm256_add_pd(y, _mm256_mul_pd(_mm256_mul_pd(y, z), s));
+    }
+
+    inline __m256d asinPoly(__m256d s) {
+        const __m256d half = _mm256_set1_pd(0.5);
+        __m256d reduced = _mm256_cmp_pd(s, half, _CMP_GT_OQ);
+        __m256d folded = _mm256_sqrt_pd(_mm256_mul_pd(_mm256_sub_pd(_mm256_set1_pd(1.0), s), half));
+        __m256d t = _mm256_blendv_pd(s, folded, reduced);
+        __m256d z = _mm256_mul_pd(t, t);
+        __m256d p = _mm256_set1_pd(ASIN_P[0]);
+        __m256d q = _mm256_set1_pd(ASIN_Q[0]);
+        for (int i = 1; i < ASIN_TERMS; ++i) {
+            p = _mm256_add_pd(_mm256_mul_pd(p, z), _mm256_set1_pd(ASIN_P[i]));
+            q = _mm256_add_pd(_mm256_mul_pd(q, z), _mm256_set1_pd(ASIN_Q[i]));
+        }
+        __m256d r = _mm256_add_pd(t, _mm256_div_pd(_mm256_mul_pd(_mm256_mul_pd(t, z), p), q));
+        __m256d unfolded = _mm256_sub_pd(_mm256_set1_pd(HALF_PI), _mm256_add_pd(r, r));
+        return _mm256_blendv_pd(r, unfolded, reduced);
+    }
+#elif defined(DISTANCE_KERNEL_SSE2)
+    inline __m128d select(__m128d mask, __m128d ifTrue, __m128d ifFalse) {
+        return _mm_or_pd(_mm_and_pd(mask, ifTrue), _mm_andnot_pd(mask, ifFalse));
+    }
+
+    inline __m128d sinPoly(__m128d y) {
+        __m128d z = _mm_mul_pd(y, y);
+        __m128d s = _mm_set1_pd(SIN_COEFFS[SIN_TERMS - 1]);
+        for (int i = SIN_TERMS - 2; i >= 0; --i) {
+            s = _mm_add_pd(_mm_mul_pd(s, z), _mm_set1_pd(SIN_COEFFS[i]));
+        }
+        return _mm_add_pd(y, _mm_mul_pd(_mm_mul_pd(y, z), s));
+    }
+
+    inline __m128d asinPoly(__m128d s) {
+        const __m128d half = _mm_set1_pd(0.5);
+        __m128d reduced = _mm_cmpgt_pd(s, half);
+        __m128d folded = _mm_sqrt_pd(_mm_mul_pd(_mm_sub_pd(_mm_set1_pd(1.0), s), half));
+        __m128d t = select(reduced, folded, s);
+        __m128d z = _mm_mul_pd(t, t);
+        __m128d p = _mm_set1_pd(ASIN_P[0]);
+        __m128d q = _mm_set1_pd(ASIN_Q[0]);
+        for (int i = 1; i < ASIN_TERMS; ++i) {
+            p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(ASIN_P[i]));
+            q = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(ASIN_Q[i]));
+        }
+        __m128d r = _mm_add_pd(t, _mm_div_pd(_mm_mul_pd(_mm_mul_pd(t, z), p), q));
+        __m128d unfolded = _mm_sub_pd(_mm_set1_pd(HALF_PI), _mm_add_pd(r, r));
+        return select(reduced, unfolded, r);
+    }
+#endif
+}
+
+double DistanceKernel::haversine(const Driver::Location& from, const Driver::Location& to) {
+    double lat1 = from.latitude * DEG_TO_RAD;
+    double lat2 = to.latitude * DEG_TO_RAD;
+    double deltaLat = (to.latitude - from.latitude) * DEG_TO_RAD;
+    double deltaLng = (to.longitude - from.longitude) * DEG_TO_RAD;
+
+    double a = std::sin(deltaLat / 2) * std::sin(deltaLat / 2) +
+               std::cos(lat1) * std::cos(lat2) * std::sin(deltaLng / 2) * std::sin(deltaLng / 2);
+    double c = 2 * std::atan2(std::sqrt(a), std::sqrt(1 - a));
+    return EARTH_RADIUS_KM * c;
+}
+
+double DistanceKernel::equirectangular(double fromLatitude, double fromLongitude, double fromCosLatitude,
+                                       double toLatitude, double toLongitude, double toCosLatitude) {
+    double x = wrapLongitude(toLongitude - fromLongitude) * (fromCosLatitude + toCosLatitude) * 0.5;
+    double y = toLatitude - fromLatitude;
+    return EARTH_RADIUS_KM * DEG_TO_RAD * std::sqrt(x * x + y * y);
+}
+
+bool DistanceKernel::withinDistance(const Driver::Location& from, const Driver::Location& to, double maxDistanceKm) {
+    // A pair needs no cosines to be rejected on latitude alone: the arc is at
+    // least as long as its north-south component
+    if (std::fabs(to.latitude - from.latitude) * DEG_TO_RAD * EARTH_RADIUS_KM > maxDistanceKm) {
+        return false;
+    }
+    return haversine(from, to) <= maxDistanceKm;
+}
+
+size_t DistanceKernel::prefilter(const Driver::Location& origin,
+                                 const double* latitudes, const double* longitudes, const double* cosLatitudes,
+                                 size_t count, double maxDistanceKm, uint32_t* survivors) {
+    if (maxDistanceKm < 0.0) {
+        return 0;
+    }
+    if (maxDistanceKm > PREFILTER_MAX_RADIUS_KM || std::fabs(origin.latitude) > PREFILTER_MAX_LATITUDE) {
+        for (size_t i = 0; i < count; ++i) {
+            survivors[i] = static_cast<uint32_t>(i);
+        }
+        return count;
+    }
+
+    // Compare in squared degrees so the loop has no sqrt, and append every
+    // index but only advance past the ones that pass (no branch to mispredict)
+    const double limitDegrees = maxDistanceKm * (1.0 + PREFILTER_TOLERANCE) / (EARTH_RADIUS_KM * DEG_TO_RAD);
+    const double limitSquared = limitDegrees * limitDegrees;
+    const double halfOriginCos = 0.5 * std::cos(origin.latitude * DEG_TO_RAD);
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+        double x = wrapLongitude(longitudes[i] - origin.longitude) * (halfOriginCos + 0.5 * cosLatitudes[i]);
+        double y = latitudes[i] - origin.latitude;
+        survivors[kept] = static_cast<uint32_t>(i);
+        kept += (x * x + y * y <= limitSquared) ? 1 : 0;
+    }
+    return kept;
+}
+
+void DistanceKernel::filterWithinDistance(const Driver::Location& origin,
+                                          const double* latitudes, const double* longitudes,
+                                          const double* cosLatitudes, size_t count, double maxDistanceKm,
+                                          std::vector<uint32_t>& indexes, std::vector<double>& distancesKm) {
+    indexes.resize(count);
+    size_t survivors = prefilter(origin, latitudes, longitudes, cosLatitudes, count, maxDistanceKm, indexes.data());
+
+    // Exact tier on the survivors, gathered into contiguous scratch for the vector kernel
+    std::vector<double> scratch(survivors * 3);
+    double* survivorLatitudes = scratch.data();
+    double* survivorLongitudes = survivorLatitudes + survivors;
+    double* survivorCosLatitudes = survivorLongitudes + survivors;
+    for (size_t i = 0; i < survivors; ++i) {
+        survivorLatitudes[i] = latitudes[indexes[i]];
+        survivorLongitudes[i] = longitudes[indexes[i]];
+        survivorCosLatitudes[i] = cosLatitudes[indexes[i]];
+    }
+    distancesKm.resize(survivors);
+    haversineBatch(origin, survivorLatitudes, survivorLongitudes, survivorCosLatitudes, survivors,
+                   distancesKm.data());
+
+    size_t kept = 0;
+    for (size_t i = 0; i < survivors; ++i) {
+        if (distancesKm[i] <= maxDistanceKm) {
+            indexes[kept] = indexes[i];
+            distancesKm[kept] = distancesKm[i];
+            ++kept;
+        }
+    }
+    indexes.resize(kept);
+    distancesKm.resize(kept);
+}
+
+void DistanceKernel::haversineBatch(const Driver::Location& origin,
+                                    const double* latitudes, const double* longitudes,
+                                    const double* cosLatitudes, size_t count, double* distancesKm) {
+    const double originCos = std::cos(origin.latitude * DEG_TO_RAD);
+    size_t i = 0;
+
+#if defined(DISTANCE_KERNEL_AVX2)
+    const __m256d originLat = _mm256_set1_pd(origin.latitude);
+    const __m256d originLng = _mm256_set1_pd(origin.longitude);
+    const __m256d originCosV = _mm256_set1_pd(originCos);
+    const __m256d halfDegToRad = _mm256_set1_pd(DEG_TO_RAD * 0.5);
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+    const __m256d pi = _mm256_set1_pd(M_PI);
+    const __m256d halfPi = _mm256_set1_pd(HALF_PI);
+    const __m256d half = _mm256_set1_pd(0.5);
+    const __m256d radius = _mm256_set1_pd(EARTH_RADIUS_KM);
+
+    for (; i + 4 <= count; i += 4) {
+        __m256d lat = _mm256_loadu_pd(latitudes + i);
+        __m256d lng = _mm256_loadu_pd(longitudes + i);
+        __m256d cosLat = _mm256_loadu_pd(cosLatitudes + i);
+
+        __m256d halfDeltaLat = _mm256_andnot_pd(signMask, _mm256_mul_pd(_mm256_sub_pd(lat, originLat), halfDegToRad));
+        __m256d halfDeltaLng = _mm256_andnot_pd(signMask, _mm256_mul_pd(_mm256_sub_pd(lng, originLng), halfDegToRad));
+        halfDeltaLng = _mm256_min_pd(halfDeltaLng, _mm256_sub_pd(pi, halfDeltaLng));
+
+        __m256d sinLat = sinPoly(halfDeltaLat);
+        __m256d sinLng = sinPoly(halfDeltaLng);
+        __m256d sinLngSquared = _mm256_mul_pd(sinLng, sinLng);
+        __m256d a = _mm256_add_pd(_mm256_mul_pd(sinLat, sinLat),
+                                  _mm256_mul_pd(_mm256_mul_pd(originCosV, cosLat), sinLngSquared));
+
+        // Lanes past a quarter circle switch to the complement (see haversineLane)
+        __m256d farSide = _mm256_cmp_pd(a, half, _CMP_GT_OQ);
+        if (_mm256_movemask_pd(farSide) != 0) {
+            __m256d cosHalfLat = sinPoly(_mm256_sub_pd(halfPi, halfDeltaLat));
+            __m256d cosHalfLng = sinPoly(_mm256_sub_pd(halfPi, halfDeltaLng));
+            __m256d sinSumLat = sinPoly(_mm256_andnot_pd(signMask,
+                                                         _mm256_mul_pd(_mm256_add_pd(lat, originLat), halfDegToRad)));
+            __m256d b = _mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(cosHalfLat, cosHalfLat), _mm256_mul_pd(cosHalfLng, cosHalfLng)),
+                                      _mm256_mul_pd(_mm256_mul_pd(sinSumLat, sinSumLat), sinLngSquared));
+            a = _mm256_blendv_pd(a, b, farSide);
+        }
+        __m256d arc = asinPoly(_mm256_sqrt_pd(a));
+        arc = _mm256_add_pd(arc, arc);
+        arc = _mm256_blendv_pd(arc, _mm256_sub_pd(pi, arc), farSide);
+        _mm256_storeu_pd(distancesKm + i, _mm256_mul_pd(radius, arc));
+    }
+#elif defined(DISTANCE_KERNEL_SSE2)
+    const __m128d originLat = _mm_set1_pd(origin.latitude);
+    const __m128d originLng = _mm_set1_pd(origin.longitude);
+    const __m128d originCosV = _mm_set1_pd(originCos);
+    const __m128d halfDegToRad = _mm_set1_pd(DEG_TO_RAD * 0.5);
+    const __m128d signMask = _mm_set1_pd(-0.0);
+    const __m128d pi = _mm_set1_pd(M_PI);
+    const __m128d halfPi = _mm_set1_pd(HALF_PI);
+    const __m128d half = _mm_set1_pd(0.5);
+    const __m128d radius = _mm_set1_pd(EARTH_RADIUS_KM);
+
+    for (; i + 2 <= count; i += 2) {
+        __m128d lat = _mm_loadu_pd(latitudes + i);
+        __m128d lng = _mm_loadu_pd(longitudes + i);
+        __m128d cosLat = _mm_loadu_pd(cosLatitudes + i);
+
+        __m128d halfDeltaLat = _mm_andnot_pd(signMask, _mm_mul_pd(_mm_sub_pd(lat, originLat), halfDegToRad));
+        __m128d halfDeltaLng = _mm_andnot_pd(signMask, _mm_mul_pd(_mm_sub_pd(lng, originLng), halfDegToRad));
+        halfDeltaLng = _mm_min_pd(halfDeltaLng, _mm_sub_pd(pi, halfDeltaLng));
+
+        __m128d sinLat = sinPoly(halfDeltaLat);
+        __m128d sinLng = sinPoly(halfDeltaLng);
+        __m128d sinLngSquared = _mm_mul_pd(sinLng, sinLng);
+        __m128d a = _mm_add_pd(_mm_mul_pd(sinLat, sinLat),
+                               _mm_mul_pd(_mm_mul_pd(originCosV, cosLat), sinLngSquared));
+
+        // Lanes past a quarter circle switch to the complement (see haversineLane)
+        __m128d farSide = _mm_cmpgt_pd(a, half);
+        if (_mm_movemask_pd(farSide) != 0) {
+            __m128d cosHalfLat = sinPoly(_mm_sub_pd(halfPi, halfDeltaLat));
+            __m128d cosHalfLng = sinPoly(_mm_sub_pd(halfPi, halfDeltaLng));
+            __m128d sinSumLat = sinPoly(_mm_andnot_pd(signMask, _mm_mul_pd(_mm_add_pd(lat, originLat), halfDegToRad)));
+            __m128d b = _mm_add_pd(_mm_mul_pd(_mm_mul_pd(cosHalfLat, cosHalfLat), _mm_mul_pd(cosHalfLng, cosHalfLng)),
+                                   _mm_mul_pd(_mm_mul_pd(sinSumLat, sinSumLat), sinLngSquared));
+            a = select(farSide, b, a);
+        }
+        __m128d arc = asinPoly(_mm_sqrt_pd(a));
+        arc = _mm_add_pd(arc, arc);
+        arc = select(farSide, _mm_sub_pd(pi, arc), arc);
+        _mm_storeu_pd(distancesKm + i, _mm_mul_pd(radius, arc));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        distancesKm[i] = haversineLane(origin.latitude, origin.longitude, originCos,
+                                       latitudes[i], longitudes[i], cosLatitudes[i]);
+    }
+}
+
+const char* DistanceKernel::getInstructionSet() {
+#if defined(DISTANCE_KERNEL_AVX2)
+    return "AVX2";
+#elif defined(DISTANCE_KERNEL_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
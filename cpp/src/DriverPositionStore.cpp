@@ -0,0 +1,277 @@
+#include "DriverPositionStore.h"
+#include "DistanceKernel.h"
+#include <cmath>
+#include <algorithm>
+
+// Maintenance
+size_t DriverPositionStore::add(const Driver& driver) {
+    auto it = m_indexById.find(driver.getId());
+    if (it != m_indexById.end()) {
+        update(driver);
+        return it->second;
+    }
+
+    const Driver::LiveState state = driver.getLiveState();
+    const Driver::Location& location = state.location;
+    size_t index = m_driverIds.size();
+    m_driverIds.push_back(driver.getId());
+    m_latitudes.push_back(location.latitude);
+    m_longitudes.push_back(location.longitude);
+    m_cosLatitudes.push_back(std::cos(location.latitude * M_PI / 180.0));
+    m_statuses.push_back(static_cast<uint8_t>(state.status));
+    m_ratings.push_back(driver.getRating());
+    m_indexById.emplace(driver.getId(), index);
+    return index;
+}
+
+bool DriverPositionStore::remove(const std::string& driverId) {
+    auto it = m_indexById.find(driverId);
+    if (it == m_indexById.end()) {
+        return false;
+    }
+
+    // Swap the last driver into the freed slot to keep the arrays dense
+    size_t index = it->second;
+    size_t last = m_driverIds.size() - 1;
+    m_indexById.erase(it);
+    if (index != last) {
+        m_driverIds[index] = std::move(m_driverIds[last]);
+        m_latitudes[index] = m_latitudes[last];
+        m_longitudes[index] = m_longitudes[last];
+        m_cosLatitudes[index] = m_cosLatitudes[last];
+        m_statuses[index] = m_statuses[last];
+        m_ratings[index] = m_ratings[last];
+        m_indexById[m_driverIds[index]] = index;
+    }
+
+    m_driverIds.pop_back();
+    m_latitudes.pop_back();
+    m_longitudes.pop_back();
+    m_cosLatitudes.pop_back();
+    m_statuses.pop_back();
+    m_ratings.pop_back();
+    return true;
+}
+
+bool DriverPositionStore::update(const Driver& driver) {
+    size_t index = indexOf(driver.getId());
+    if (index == npos) {
+        return false;
+    }
+
+    const Driver::LiveState state = driver.getLiveState();
+    const Driver::Location& location = state.location;
+    m_latitudes[index] = location.latitude;
+    m_longitudes[index] = location.longitude;
+    m_cosLatitudes[index] = std::cos(location.latitude * M_PI / 180.0);
+    m_statuses[index] = static_cast<uint8_t>(state.status);
+    m_ratings[index] = driver.getRating();
+    return true;
+}
+
+bool DriverPositionStore::updateLocation(const std::string& driverId, double latitude, double longitude) {
+    size_t index = indexOf(driverId);
+    if (index == npos) {
+        return false;
+    }
+
+    m_latitudes[index] = latitude;
+    m_longitudes[index] = longitude;
+    m_cosLatitudes[index] = std::cos(latitude * M_PI / 180.0);
+    return true;
+}
+
+size_t DriverPositionStore::updateLocations(const Driver::LocationUpdate* updates, size_t count) {
+    size_t applied = 0;
+    for (size_t i = 0; i < count; ++i) {
+        size_t index = indexOf(updates[i].driverId);
+        if (index == npos) {
+            continue;
+        }
+        m_latitudes[index] = updates[i].latitude;
+        m_longitudes[index] = updates[i].longitude;
+        m_cosLatitudes[index] = std::cos(updates[i].latitude * M_PI / 180.0);
+        ++applied;
+    }
+    return applied;
+}
+
+bool DriverPositionStore::updateStatus(const std::string& driverId, Driver::Status status) {
+    size_t index = indexOf(driverId);
+    if (index == npos) {
+        return false;
+    }
+
+    m_statuses[index] = static_cast<uint8_t>(status);
+    return true;
+}
+
+void DriverPositionStore::clear() {
+    m_driverIds.clear();
+    m_latitudes.clear();
+    m_longitudes.clear();
+    m_cosLatitudes.clear();
+    m_statuses.clear();
+    m_ratings.clear();
+    m_indexById.clear();
+}
+
+void DriverPositionStore::reserve(size_t capacity) {
+    m_driverIds.reserve(capacity);
+    m_latitudes.reserve(capacity);
+    m_longitudes.reserve(capacity);
+    m_cosLatitudes.reserve(capacity);
+    m_statuses.reserve(capacity);
+    m_ratings.reserve(capacity);
+    m_indexById.reserve(capacity);
+}
+
+// Lookup
+size_t DriverPositionStore::indexOf(const std::string& driverId) const {
+    auto it = m_indexById.find(driverId);
+    return it == m_indexById.end() ? npos : it->second;
+}
+
+// Batch queries
+void DriverPositionStore::computeDistances(const Driver::Location& origin, std::vector<double>& distancesKm) const {
+    distancesKm.resize(size());
+    DistanceKernel::haversineBatch(origin, m_latitudes.data(), m_longitudes.data(),
+                                   m_cosLatitudes.data(), size(), distancesKm.data());
+}
+
+void DriverPositionStore::computeEtas(const Driver::Location& pickup, const EtaProvider& provider,
+                                      EtaProvider::TimePoint departure, std::vector<double>& distancesKm,
+                                      std::vector<double>& etaMinutes) const {
+    computeDistances(pickup, distancesKm);
+    etaMinutes.resize(size());
+    provider.estimateBatch(pickup, m_latitudes.data(), m_longitudes.data(), distancesKm.data(), size(),
+                           departure, etaMinutes.data());
+}
+
+void DriverPositionStore::withinDistance(const Driver::Location& origin, double maxDistanceKm,
+                                         std::vector<uint32_t>& indexes, std::vector<double>& distancesKm) const {
+    DistanceKernel::filterWithinDistance(origin, m_latitudes.data(), m_longitudes.data(), m_cosLatitudes.data(),
+                                         size(), maxDistanceKm, indexes, distancesKm);
+}
+
+std::vector<size_t> DriverPositionStore::filterByDistance(const Driver::Location& origin, double maxDistanceKm,
+                                                          bool availableOnly) const {
+    std::vector<uint32_t> indexes;
+    std::vector<double> distances;
+    withinDistance(origin, maxDistanceKm, indexes, distances);
+
+    const auto online = static_cast<uint8_t>(Driver::Status::ONLINE);
+    std::vector<size_t> result;
+    result.reserve(indexes.size());
+    for (uint32_t index : indexes) {
+        if (!availableOnly || m_statuses[index] == online) {
+            result.push_back(index);
+        }
+    }
+    return result;
+}
+
+std::vector<size_t> DriverPositionStore::filterByDistance(const std::vector<size_t>& candidates,
+                                                          const Driver::Location& origin,
+                                                          double maxDistanceKm) const {
+    // Gather the candidates into contiguous scratch arrays for the kernel
+    std::vector<double> latitudes, longitudes, cosLatitudes;
+    latitudes.reserve(candidates.size());
+    longitudes.reserve(candidates.size());
+    cosLatitudes.reserve(candidates.size());
+    for (size_t index : candidates) {
+        latitudes.push_back(m_latitudes[index]);
+        longitudes.push_back(m_longitudes[index]);
+        cosLatitudes.push_back(m_cosLatitudes[index]);
+    }
+
+    std::vector<uint32_t> kept;
+    std::vector<double> distances;
+    DistanceKernel::filterWithinDistance(origin, latitudes.data(), longitudes.data(), cosLatitudes.data(),
+                                         candidates.size(), maxDistanceKm, kept, distances);
+
+    std::vector<size_t> result;
+    result.reserve(kept.size());
+    for (uint32_t position : kept) {
+        result.push_back(candidates[position]);
+    }
+    return result;
+}
+
+std::vector<DriverPositionStore::EtaEntry> DriverPositionStore::rankByEta(const Driver::Location& origin,
+                                                                          size_t count,
+                                                                          double maxDistanceKm) const {
+    std::vector<uint32_t> indexes;
+    std::vector<double> distances;
+    withinDistance(origin, maxDistanceKm, indexes, distances);
+
+    const auto online = static_cast<uint8_t>(Driver::Status::ONLINE);
+    std::vector<EtaEntry> ranked;
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        if (m_statuses[indexes[i]] == online) {
+            ranked.push_back(EtaEntry{indexes[i], distances[i], distanceToEtaMinutes(distances[i])});
+        }
+    }
+
+    // Shortest ETA first, higher rating breaks ties
+    auto byEta = [this](const EtaEntry& a, const EtaEntry& b) {
+        if (a.distanceKm != b.distanceKm) {
+            return a.distanceKm < b.distanceKm;
+        }
+        return m_ratings[a.index] > m_ratings[b.index];
+    };
+    size_t resultSize = std::min(count, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + resultSize, ranked.end(), byEta);
+    ranked.resize(resultSize);
+    return ranked;
+}
+
+std::vector<DriverPositionStore::EtaEntry> DriverPositionStore::rankByEta(const Driver::Location& origin,
+                                                                          size_t count, double maxDistanceKm,
+                                                                          const EtaProvider& provider,
+                                                                          EtaProvider::TimePoint departure) const {
+    std::vector<uint32_t> indexes;
+    std::vector<double> distances;
+    withinDistance(origin, maxDistanceKm, indexes, distances);
+
+    // ETAs only for the online drivers in range, gathered for one batch call
+    const auto online = static_cast<uint8_t>(Driver::Status::ONLINE);
+    std::vector<EtaEntry> ranked;
+    std::vector<double> latitudes, longitudes, rangedDistances;
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        if (m_statuses[indexes[i]] == online) {
+            ranked.push_back(EtaEntry{indexes[i], distances[i], 0});
+            latitudes.push_back(m_latitudes[indexes[i]]);
+            longitudes.push_back(m_longitudes[indexes[i]]);
+            rangedDistances.push_back(distances[i]);
+        }
+    }
+    std::vector<double> etas(ranked.size());
+    provider.estimateBatch(origin, latitudes.data(), longitudes.data(), rangedDistances.data(), ranked.size(),
+                           departure, etas.data());
+    std::vector<size_t> order(ranked.size());
+    for (size_t i = 0; i < ranked.size(); ++i) {
+        ranked[i].etaMinutes = static_cast<int>(etas[i]);
+        order[i] = i;
+    }
+
+    // Shortest ETA first (unrounded), higher rating breaks ties
+    auto byEta = [this, &etas, &ranked](size_t a, size_t b) {
+        if (etas[a] != etas[b]) {
+            return etas[a] < etas[b];
+        }
+        return m_ratings[ranked[a].index] > m_ratings[ranked[b].index];
+    };
+    size_t resultSize = std::min(count, ranked.size());
+    std::partial_sort(order.begin(), order.begin() + resultSize, order.end(), byEta);
+    std::vector<EtaEntry> result;
+    result.reserve(resultSize);
+    for (size_t i = 0; i < resultSize; ++i) {
+        result.push_back(ranked[order[i]]);
+    }
+    return result;
+}
+
+int DriverPositionStore::distanceToEtaMinutes(double distanceKm) {
+    return static_cast<int>(distanceKm / AVERAGE_SPEED_KMH * 60);
+}
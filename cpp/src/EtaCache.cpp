@@ -0,0 +1,154 @@
+#include "EtaCache.h"
+#include "DistanceKernel.h"
+#include <mutex>
+#include <cmath>
+#include <algorithm>
+
+namespace {
+    // Length of one degree of latitude, as in SpatialIndex
+    constexpr double KM_PER_DEGREE = 111.32;
+
+    // Floor for cos(latitude) so cells near the poles stay finite, as in SpatialIndex
+    constexpr double MIN_LONGITUDE_SCALE = 0.01;
+}
+
+// Constructors
+EtaCache::EtaCache() : EtaCache(Options()) {
+}
+
+EtaCache::EtaCache(const Options& options) {
+    size_t count = 1;
+    while (count < options.shardCount) {
+        count <<= 1;
+    }
+    m_shards.reset(new Shard[count]);
+    m_shardMask = count - 1;
+    m_inverseCellSize = KM_PER_DEGREE / (options.cellSizeKm > 0.0 ? options.cellSizeKm : Options().cellSizeKm);
+
+    size_t perShard = std::max<size_t>(1, options.capacity / count);
+    for (size_t i = 0; i < count; ++i) {
+        m_shards[i].slots.reset(new Slot[perShard]);
+        m_shards[i].index.reserve(perShard);
+        m_shards[i].capacity = perShard;
+    }
+}
+
+// Lookup and insertion
+EtaCache::Estimate EtaCache::estimate(const EtaProvider& provider, Handle driver,
+                                      const Driver::Location& driverLocation, const Driver::Location& pickup,
+                                      TimePoint departure) {
+    Estimate result;
+    if (lookup(provider, driver, driverLocation, pickup, departure, result)) {
+        return result;
+    }
+
+    double cosLatitude = std::cos(driverLocation.latitude * M_PI / 180.0);
+    DistanceKernel::haversineBatch(pickup, &driverLocation.latitude, &driverLocation.longitude, &cosLatitude, 1,
+                                   &result.distanceKm);
+    provider.estimateBatch(pickup, &driverLocation.latitude, &driverLocation.longitude, &result.distanceKm, 1,
+                           departure, &result.etaMinutes);
+    store(provider, driver, driverLocation, pickup, departure, result);
+    return result;
+}
+
+bool EtaCache::lookup(const EtaProvider& provider, Handle driver, const Driver::Location& driverLocation,
+                      const Driver::Location& pickup, TimePoint departure, Estimate& result) {
+    Shard& shard = shardFor(driver);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.index.find(Key{driver, cellFor(pickup)});
+    if (it == shard.index.end()) {
+        shard.misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    Slot& slot = shard.slots[it->second];
+    if (slot.driverCell != cellFor(driverLocation) || slot.hour != provider.getDepartureHour(departure)) {
+        shard.invalidations.fetch_add(1, std::memory_order_relaxed);
+        shard.misses.fetch_add(1, std::memory_order_relaxed);
+        return false; // The next store() overwrites this slot
+    }
+    slot.referenced.store(true, std::memory_order_relaxed);
+    result = slot.estimate;
+    shard.hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void EtaCache::store(const EtaProvider& provider, Handle driver, const Driver::Location& driverLocation,
+                     const Driver::Location& pickup, TimePoint departure, const Estimate& estimate) {
+    Key key{driver, cellFor(pickup)};
+    Shard& shard = shardFor(driver);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+    uint32_t position;
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        position = it->second;
+    } else if (shard.used < shard.capacity) {
+        position = static_cast<uint32_t>(shard.used++);
+        shard.index.emplace(key, position);
+    } else {
+        // CLOCK: give referenced slots a second chance, evict the first unreferenced one
+        while (shard.slots[shard.hand].referenced.exchange(false, std::memory_order_relaxed)) {
+            shard.hand = (shard.hand + 1) % shard.capacity;
+        }
+        position = static_cast<uint32_t>(shard.hand);
+        shard.hand = (shard.hand + 1) % shard.capacity;
+        shard.index.erase(shard.slots[position].key);
+        shard.index.emplace(key, position);
+        shard.evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Slot& slot = shard.slots[position];
+    slot.key = key;
+    slot.driverCell = cellFor(driverLocation);
+    slot.hour = provider.getDepartureHour(departure);
+    slot.estimate = estimate;
+    slot.referenced.store(false, std::memory_order_relaxed); // Earns its bit on the first hit
+}
+
+void EtaCache::clear() {
+    for (size_t i = 0; i <= m_shardMask; ++i) {
+        Shard& shard = m_shards[i];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.index.clear();
+        shard.used = 0;
+        shard.hand = 0;
+    }
+}
+
+// Statistics
+EtaCache::Stats EtaCache::getStats() const {
+    Stats stats;
+    for (size_t i = 0; i <= m_shardMask; ++i) {
+        const Shard& shard = m_shards[i];
+        stats.hits += shard.hits.load(std::memory_order_relaxed);
+        stats.misses += shard.misses.load(std::memory_order_relaxed);
+        stats.invalidations += shard.invalidations.load(std::memory_order_relaxed);
+        stats.evictions += shard.evictions.load(std::memory_order_relaxed);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        stats.size += shard.used;
+        stats.capacity += shard.capacity;
+    }
+    return stats;
+}
+
+void EtaCache::resetStats() {
+    for (size_t i = 0; i <= m_shardMask; ++i) {
+        m_shards[i].hits.store(0, std::memory_order_relaxed);
+        m_shards[i].misses.store(0, std::memory_order_relaxed);
+        m_shards[i].invalidations.store(0, std::memory_order_relaxed);
+        m_shards[i].evictions.store(0, std::memory_order_relaxed);
+    }
+}
+
+// Helpers
+int64_t EtaCache::cellFor(const Driver::Location& location) const {
+    int64_t row = static_cast<int64_t>(std::floor((location.latitude + 90.0) * m_inverseCellSize));
+
+    // Columns per degree grow as longitude degrees shrink; one scale per row
+    // keeps every point of a row on the same column boundaries
+    double rowLatitude = (row + 0.5) / m_inverseCellSize - 90.0;
+    double scale = std::max(MIN_LONGITUDE_SCALE, std::cos(rowLatitude * M_PI / 180.0));
+    int64_t column = static_cast<int64_t>(std::floor((location.longitude + 180.0) * m_inverseCellSize * scale));
+    return (row << 32) | static_cast<uint32_t>(column);
+}
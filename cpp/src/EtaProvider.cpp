@@ -0,0 +1,31 @@
+#include "EtaProvider.h"
+#include "DistanceKernel.h"
+#include <cmath>
+
+// EtaProvider
+int64_t EtaProvider::getDepartureHour(TimePoint departure) const {
+    auto hours = std::chrono::floor<std::chrono::hours>(departure).time_since_epoch();
+    return static_cast<int64_t>(hours.count());
+}
+
+// ConstantSpeedEtaProvider
+ConstantSpeedEtaProvider::ConstantSpeedEtaProvider(double speedKmh)
+    : m_speedKmh(speedKmh > 0.0 ? speedKmh : DEFAULT_SPEED_KMH) {
+}
+
+double ConstantSpeedEtaProvider::estimateMinutes(const Driver::Location& from, const Driver::Location& to,
+                                                 TimePoint) const {
+    double cosLatitude = std::cos(from.latitude * M_PI / 180.0);
+    double distanceKm;
+    DistanceKernel::haversineBatch(to, &from.latitude, &from.longitude, &cosLatitude, 1, &distanceKm);
+    return distanceKm / m_speedKmh * 60.0;
+}
+
+void ConstantSpeedEtaProvider::estimateBatch(const Driver::Location&, const double*, const double*,
+                                             const double* distancesKm, size_t count, TimePoint,
+                                             double* etaMinutes) const {
+    const double minutesPerKm = 60.0 / m_speedKmh;
+    for (size_t i = 0; i < count; ++i) {
+        etaMinutes[i] = distancesKm[i] * minutesPerKm;
+    }
+}
@@ -0,0 +1,27 @@
+#include "FavoriteDriverManager.h"
+
+// Destructor
+FavoriteDriverManager::~FavoriteDriverManager() {
+    // Member order alone is not enough: timeout and batch-window callbacks run
+    // on the wheel's thread and reach the batcher, the pools and the maps. Stop
+    // the wheel first, then drain everything downstream of it in order.
+    m_requestTimers.stop();
+    if (m_dispatchBatcher) {
+        m_dispatchBatcher->flush();
+    }
+    m_dispatchPool.shutdown();
+    m_notifications.shutdown();
+}
+
+// Notifications
+void FavoriteDriverManager::setNotificationCallback(NotificationCallback callback) {
+    if (!callback) {
+        m_notifications.setSink(nullptr);
+        return;
+    }
+    m_notifications.setSink([callback](const std::string& recipient, const std::vector<std::string>& messages) {
+        for (const std::string& message : messages) {
+            callback(recipient, message);
+        }
+    });
+}
@@ -0,0 +1,75 @@
+#include "FavoriteReverseIndex.h"
+
+// Constructor
+FavoriteReverseIndex::FavoriteReverseIndex() : m_edgeCount(0) {
+}
+
+// Edge maintenance
+bool FavoriteReverseIndex::add(Handle user, Handle driver) {
+    bool added = m_followers.upsert(driver, [this, user, driver](std::unordered_set<Handle>& users) {
+        if (!users.insert(user).second) {
+            return false;
+        }
+        m_leaderboard.increment(driver);
+        return true;
+    });
+    if (added) {
+        m_edgeCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    return added;
+}
+
+bool FavoriteReverseIndex::remove(Handle user, Handle driver) {
+    bool removed = false;
+    m_followers.modifyOrErase(driver, [this, user, driver, &removed](std::unordered_set<Handle>& users) {
+        removed = users.erase(user) > 0;
+        if (removed) {
+            m_leaderboard.decrement(driver);
+        }
+        return !users.empty();
+    });
+    if (removed) {
+        m_edgeCount.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return removed;
+}
+
+std::vector<FavoriteReverseIndex::Handle> FavoriteReverseIndex::removeDriver(Handle driver) {
+    std::vector<Handle> followers;
+    m_followers.modifyOrErase(driver, [this, driver, &followers](std::unordered_set<Handle>& users) {
+        followers.assign(users.begin(), users.end());
+        m_leaderboard.remove(driver);
+        return false;
+    });
+    m_edgeCount.fetch_sub(followers.size(), std::memory_order_relaxed);
+    return followers;
+}
+
+void FavoriteReverseIndex::clear() {
+    m_followers.clear();
+    m_leaderboard.clear();
+    m_edgeCount.store(0, std::memory_order_relaxed);
+}
+
+// Queries
+size_t FavoriteReverseIndex::getFavoriteCount(Handle driver) const {
+    size_t count = 0;
+    m_followers.read(driver, [&count](const std::unordered_set<Handle>& users) { count = users.size(); });
+    return count;
+}
+
+std::vector<FavoriteReverseIndex::Handle> FavoriteReverseIndex::getFollowers(Handle driver) const {
+    std::vector<Handle> followers;
+    m_followers.read(driver, [&followers](const std::unordered_set<Handle>& users) {
+        followers.assign(users.begin(), users.end());
+    });
+    return followers;
+}
+
+std::vector<FavoriteReverseIndex::DriverCount> FavoriteReverseIndex::getFavoriteCounts() const {
+    std::vector<DriverCount> counts;
+    m_followers.forEach([&counts](Handle driver, const std::unordered_set<Handle>& users) {
+        counts.emplace_back(driver, users.size());
+    });
+    return counts;
+}
@@ -0,0 +1,53 @@
+#include "IdInterner.h"
+#include <mutex>
+
+namespace {
+    const std::string EMPTY_ID;
+}
+
+// Interning
+IdInterner::Handle IdInterner::intern(std::string_view id) {
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        auto it = m_handles.find(id);
+        if (it != m_handles.end()) {
+            return it->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    auto it = m_handles.find(id); // Another writer may have won the race
+    if (it != m_handles.end()) {
+        return it->second;
+    }
+    if (m_ids.size() >= INVALID_HANDLE) {
+        return INVALID_HANDLE;
+    }
+
+    Handle handle = static_cast<Handle>(m_ids.size());
+    m_ids.emplace_back(id);
+    m_handles.emplace(std::string_view(m_ids.back()), handle);
+    return handle;
+}
+
+IdInterner::Handle IdInterner::find(std::string_view id) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    auto it = m_handles.find(id);
+    return it != m_handles.end() ? it->second : INVALID_HANDLE;
+}
+
+// Accessors
+const std::string& IdInterner::getId(Handle handle) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return handle < m_ids.size() ? m_ids[handle] : EMPTY_ID;
+}
+
+size_t IdInterner::size() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_ids.size();
+}
+
+void IdInterner::reserve(size_t count) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_handles.reserve(count);
+}
@@ -0,0 +1,396 @@
+#include "JsonReader.h"
+#include <charconv>
+
+namespace {
+    inline bool isDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    inline int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    void appendUtf8(std::string& out, uint32_t codePoint) {
+        if (codePoint < 0x80) {
+            out += static_cast<char>(codePoint);
+        } else if (codePoint < 0x800) {
+            out += static_cast<char>(0xC0 | (codePoint >> 6));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else if (codePoint < 0x10000) {
+            out += static_cast<char>(0xE0 | (codePoint >> 12));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (codePoint >> 18));
+            out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+}
+
+// Constructor
+JsonReader::JsonReader(std::string_view input)
+    : m_input(input), m_position(0), m_isObject(0), m_depth(0), m_expectKey(false), m_afterValue(false),
+      m_allowClose(false), m_done(false), m_failed(false), m_errorOffset(0), m_boolean(false) {
+}
+
+// Tokens
+JsonReader::Token JsonReader::next() {
+    if (m_failed) {
+        return Token::ERROR;
+    }
+
+    skipWhitespace();
+    if (m_done) {
+        return m_position == m_input.size() ? Token::END : fail(); // Trailing garbage
+    }
+    if (m_position == m_input.size()) {
+        return fail();
+    }
+
+    char c = m_input[m_position];
+    bool closing = false;
+    if (m_afterValue) {
+        if (c == ',') {
+            ++m_position;
+            m_afterValue = false;
+            m_expectKey = inObject();
+            skipWhitespace();
+            if (m_position == m_input.size()) {
+                return fail();
+            }
+            c = m_input[m_position];
+        } else if ((c == '}' && inObject()) || (c == ']' && !inObject())) {
+            closing = true;
+        } else {
+            return fail();
+        }
+    } else if (m_allowClose && ((c == '}' && inObject()) || (c == ']' && m_depth > 0 && !inObject()))) {
+        closing = true;
+    }
+
+    if (closing) {
+        bool wasObject = inObject();
+        ++m_position;
+        --m_depth;
+        m_expectKey = false;
+        m_allowClose = false;
+        m_afterValue = false;
+        valueCompleted();
+        return wasObject ? Token::END_OBJECT : Token::END_ARRAY;
+    }
+
+    if (m_expectKey) {
+        if (c != '"' || !parseString()) {
+            return fail();
+        }
+        skipWhitespace();
+        if (m_position == m_input.size() || m_input[m_position] != ':') {
+            return fail();
+        }
+        ++m_position;
+        m_expectKey = false;
+        m_allowClose = false;
+        return Token::KEY;
+    }
+
+    return parseValue();
+}
+
+double JsonReader::getDouble() const {
+    double result = 0.0;
+    std::from_chars(m_number.data(), m_number.data() + m_number.size(), result);
+    return result;
+}
+
+int64_t JsonReader::getInt() const {
+    int64_t result = 0;
+    auto parsed = std::from_chars(m_number.data(), m_number.data() + m_number.size(), result);
+    if (parsed.ec != std::errc() || parsed.ptr != m_number.data() + m_number.size()) {
+        return static_cast<int64_t>(getDouble()); // Fraction or exponent
+    }
+    return result;
+}
+
+bool JsonReader::skipValue() {
+    size_t depth = 0;
+    do {
+        switch (next()) {
+            case Token::BEGIN_OBJECT:
+            case Token::BEGIN_ARRAY:
+                ++depth;
+                break;
+            case Token::END_OBJECT:
+            case Token::END_ARRAY:
+                --depth;
+                break;
+            case Token::KEY:
+                break;
+            case Token::END:
+            case Token::ERROR:
+                return false;
+            default:
+                break;
+        }
+    } while (depth > 0);
+    return !m_failed;
+}
+
+bool JsonReader::readString(std::string& target) {
+    if (next() != Token::STRING) {
+        return false;
+    }
+    target.assign(m_string.data(), m_string.size());
+    return true;
+}
+
+bool JsonReader::readDouble(double& target) {
+    if (next() != Token::NUMBER) {
+        return false;
+    }
+    target = getDouble();
+    return true;
+}
+
+bool JsonReader::readInt(int& target) {
+    if (next() != Token::NUMBER) {
+        return false;
+    }
+    target = static_cast<int>(getInt());
+    return true;
+}
+
+bool JsonReader::readInt64(int64_t& target) {
+    if (next() != Token::NUMBER) {
+        return false;
+    }
+    target = getInt();
+    return true;
+}
+
+bool JsonReader::readBool(bool& target) {
+    if (next() != Token::BOOLEAN) {
+        return false;
+    }
+    target = m_boolean;
+    return true;
+}
+
+// Parsing helpers
+JsonReader::Token JsonReader::parseValue() {
+    m_allowClose = false;
+    switch (m_input[m_position]) {
+        case '{':
+        case '[': {
+            if (m_depth == MAX_DEPTH) {
+                return fail();
+            }
+            bool object = m_input[m_position] == '{';
+            uint64_t bit = uint64_t(1) << m_depth;
+            m_isObject = object ? (m_isObject | bit) : (m_isObject & ~bit);
+            ++m_depth;
+            ++m_position;
+            m_expectKey = object;
+            m_allowClose = true;
+            return object ? Token::BEGIN_OBJECT : Token::BEGIN_ARRAY;
+        }
+        case '"':
+            if (!parseString()) {
+                return fail();
+            }
+            valueCompleted();
+            return Token::STRING;
+        case 't':
+        case 'f':
+            m_boolean = m_input[m_position] == 't';
+            if (!parseLiteral(m_boolean ? "true" : "false")) {
+                return fail();
+            }
+            valueCompleted();
+            return Token::BOOLEAN;
+        case 'n':
+            if (!parseLiteral("null")) {
+                return fail();
+            }
+            valueCompleted();
+            return Token::NULL_VALUE;
+        default:
+            if (!parseNumber()) {
+                return fail();
+            }
+            valueCompleted();
+            return Token::NUMBER;
+    }
+}
+
+bool JsonReader::parseString() {
+    size_t start = ++m_position; // Skip the opening quote
+
+    // Fast path: no escapes, return a view into the input
+    size_t i = start;
+    while (i < m_input.size()) {
+        char c = m_input[i];
+        if (c == '"') {
+            m_string = m_input.substr(start, i - start);
+            m_position = i + 1;
+            return true;
+        }
+        if (c == '\\') {
+            break;
+        }
+        if (static_cast<unsigned char>(c) < 0x20) {
+            m_position = i;
+            return false;
+        }
+        ++i;
+    }
+    if (i == m_input.size()) {
+        m_position = i;
+        return false;
+    }
+
+    // Slow path: decode into the scratch buffer
+    m_scratch.assign(m_input.data() + start, i - start);
+    while (i < m_input.size()) {
+        char c = m_input[i];
+        if (c == '"') {
+            m_string = m_scratch;
+            m_position = i + 1;
+            return true;
+        }
+        if (static_cast<unsigned char>(c) < 0x20) {
+            break;
+        }
+        if (c != '\\') {
+            m_scratch += c;
+            ++i;
+            continue;
+        }
+
+        if (++i == m_input.size()) {
+            break;
+        }
+        switch (m_input[i++]) {
+            case '"': m_scratch += '"'; break;
+            case '\\': m_scratch += '\\'; break;
+            case '/': m_scratch += '/'; break;
+            case 'b': m_scratch += '\b'; break;
+            case 'f': m_scratch += '\f'; break;
+            case 'n': m_scratch += '\n'; break;
+            case 'r': m_scratch += '\r'; break;
+            case 't': m_scratch += '\t'; break;
+            case 'u': {
+                auto readHex4 = [this, &i](uint32_t& unit) {
+                    if (m_input.size() - i < 4) {
+                        return false;
+                    }
+                    unit = 0;
+                    for (int k = 0; k < 4; ++k) {
+                        int digit = hexValue(m_input[i + k]);
+                        if (digit < 0) {
+                            return false;
+                        }
+                        unit = (unit << 4) | static_cast<uint32_t>(digit);
+                    }
+                    i += 4;
+                    return true;
+                };
+
+                uint32_t codePoint;
+                if (!readHex4(codePoint) || (codePoint >= 0xDC00 && codePoint <= 0xDFFF)) {
+                    m_position = i;
+                    return false;
+                }
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+                    // Surrogate pair: a low surrogate escape must follow
+                    uint32_t low;
+                    if (m_input.size() - i < 2 || m_input[i] != '\\' || m_input[i + 1] != 'u') {
+                        m_position = i;
+                        return false;
+                    }
+                    i += 2;
+                    if (!readHex4(low) || low < 0xDC00 || low > 0xDFFF) {
+                        m_position = i;
+                        return false;
+                    }
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUtf8(m_scratch, codePoint);
+                break;
+            }
+            default:
+                m_position = i - 1;
+                return false;
+        }
+    }
+    m_position = i;
+    return false;
+}
+
+bool JsonReader::parseNumber() {
+    // -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+    size_t start = m_position;
+    size_t i = m_position;
+    size_t size = m_input.size();
+
+    if (i < size && m_input[i] == '-') ++i;
+    if (i < size && m_input[i] == '0') {
+        ++i;
+    } else if (i < size && isDigit(m_input[i])) {
+        while (i < size && isDigit(m_input[i])) ++i;
+    } else {
+        return false;
+    }
+    if (i < size && m_input[i] == '.') {
+        if (++i == size || !isDigit(m_input[i])) return false;
+        while (i < size && isDigit(m_input[i])) ++i;
+    }
+    if (i < size && (m_input[i] == 'e' || m_input[i] == 'E')) {
+        ++i;
+        if (i < size && (m_input[i] == '+' || m_input[i] == '-')) ++i;
+        if (i == size || !isDigit(m_input[i])) return false;
+        while (i < size && isDigit(m_input[i])) ++i;
+    }
+
+    m_number = m_input.substr(start, i - start);
+    m_position = i;
+    return true;
+}
+
+bool JsonReader::parseLiteral(std::string_view literal) {
+    if (m_input.compare(m_position, literal.size(), literal) != 0) {
+        return false;
+    }
+    m_position += literal.size();
+    return true;
+}
+
+void JsonReader::skipWhitespace() {
+    while (m_position < m_input.size()) {
+        char c = m_input[m_position];
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+            break;
+        }
+        ++m_position;
+    }
+}
+
+JsonReader::Token JsonReader::fail() {
+    if (!m_failed) {
+        m_failed = true;
+        m_errorOffset = m_position;
+    }
+    return Token::ERROR;
+}
+
+void JsonReader::valueCompleted() {
+    if (m_depth == 0) {
+        m_done = true;
+    } else {
+        m_afterValue = true;
+    }
+}
@@ -0,0 +1,117 @@
+#include "JsonWriter.h"
+#include <charconv>
+#include <cmath>
+
+namespace {
+    constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+    inline bool needsEscape(unsigned char c) {
+        return c < 0x20 || c == '"' || c == '\\';
+    }
+}
+
+// Structure
+void JsonWriter::key(std::string_view name) {
+    separate();
+    appendEscaped(m_out, name);
+    m_out += ':';
+    m_afterKey = true;
+}
+
+void JsonWriter::separate() {
+    if (m_afterKey) {
+        m_afterKey = false;
+        return;
+    }
+    if (m_depth == 0 || m_depth > MAX_DEPTH) {
+        return; // Top level, or past MAX_DEPTH where the output is already invalid
+    }
+
+    uint64_t bit = uint64_t(1) << (m_depth - 1);
+    if (m_hasElements & bit) {
+        m_out += ',';
+    } else {
+        m_hasElements |= bit;
+    }
+}
+
+void JsonWriter::push() {
+    if (m_depth >= MAX_DEPTH) {
+        m_failed = true; // No comma bit left for this level
+    } else {
+        m_hasElements &= ~(uint64_t(1) << m_depth);
+    }
+    ++m_depth;
+}
+
+void JsonWriter::pop() {
+    if (m_depth == 0) {
+        m_failed = true; // end*() without a matching begin*()
+        return;
+    }
+    --m_depth;
+}
+
+// Values
+void JsonWriter::value(std::string_view text) {
+    separate();
+    appendEscaped(m_out, text);
+}
+
+void JsonWriter::value(int64_t number) {
+    separate();
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    m_out.append(buffer, result.ptr);
+}
+
+void JsonWriter::value(uint64_t number) {
+    separate();
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    m_out.append(buffer, result.ptr);
+}
+
+void JsonWriter::value(double number) {
+    separate();
+    if (!std::isfinite(number)) {
+        m_out += "null"; // JSON has no NaN or infinity
+        return;
+    }
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    m_out.append(buffer, result.ptr);
+}
+
+void JsonWriter::appendEscaped(std::string& out, std::string_view text) {
+    out += '"';
+
+    // Copy clean runs in one append; only escape the bytes that need it
+    size_t runStart = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (!needsEscape(c)) {
+            continue;
+        }
+
+        out.append(text.data() + runStart, i - runStart);
+        runStart = i + 1;
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default: {
+                char escaped[6] = {'\\', 'u', '0', '0', HEX_DIGITS[c >> 4], HEX_DIGITS[c & 0xF]};
+                out.append(escaped, sizeof(escaped));
+                break;
+            }
+        }
+    }
+    out.append(text.data() + runStart, text.size() - runStart);
+
+    out += '"';
+}
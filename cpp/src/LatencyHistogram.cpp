@@ -0,0 +1,82 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+// Constructor
+LatencyHistogram::LatencyHistogram() : m_counts(BUCKET_COUNT, 0), m_count(0), m_sum(0), m_min(UINT64_MAX), m_max(0) {
+}
+
+// Recording
+void LatencyHistogram::record(uint64_t value) {
+    m_counts[bucketFor(value)]++;
+    addTotals(1, value, value, value);
+}
+
+void LatencyHistogram::addBucket(size_t bucket, uint64_t count) {
+    m_counts[bucket] += count;
+}
+
+void LatencyHistogram::addTotals(uint64_t count, uint64_t sum, uint64_t min, uint64_t max) {
+    if (count == 0) {
+        return;
+    }
+    m_count += count;
+    m_sum += sum;
+    m_min = std::min(m_min, min);
+    m_max = std::max(m_max, max);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        m_counts[i] += other.m_counts[i];
+    }
+    addTotals(other.m_count, other.m_sum, other.m_min, other.m_max);
+}
+
+void LatencyHistogram::clear() {
+    std::fill(m_counts.begin(), m_counts.end(), 0);
+    m_count = 0;
+    m_sum = 0;
+    m_min = UINT64_MAX;
+    m_max = 0;
+}
+
+// Queries
+uint64_t LatencyHistogram::valueAtPercentile(double percentile) const {
+    if (m_count == 0) {
+        return 0;
+    }
+    percentile = std::min(100.0, std::max(0.0, percentile));
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(percentile / 100.0 * m_count)));
+    if (rank >= m_count) {
+        return m_max;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        seen += m_counts[i];
+        if (seen >= rank) {
+            uint64_t midpoint = bucketLow(i) + bucketWidth(i) / 2;
+            return std::min(m_max, std::max(getMin(), midpoint));
+        }
+    }
+    return m_max;
+}
+
+// Bucketing
+uint64_t LatencyHistogram::bucketLow(size_t bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+    size_t offset = bucket - SUB_BUCKETS;
+    unsigned msb = SUB_BUCKET_BITS + static_cast<unsigned>(offset / (SUB_BUCKETS / 2));
+    uint64_t mantissa = SUB_BUCKETS / 2 + offset % (SUB_BUCKETS / 2);
+    return mantissa << (msb - (SUB_BUCKET_BITS - 1));
+}
+
+uint64_t LatencyHistogram::bucketWidth(size_t bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return 1;
+    }
+    unsigned msb = SUB_BUCKET_BITS + static_cast<unsigned>((bucket - SUB_BUCKETS) / (SUB_BUCKETS / 2));
+    return uint64_t(1) << (msb - (SUB_BUCKET_BITS - 1));
+}
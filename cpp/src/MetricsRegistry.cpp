@@ -0,0 +1,238 @@
+#include "MetricsRegistry.h"
+#include <atomic>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+
+namespace {
+    std::atomic<uint64_t> nextInstance{1};
+
+    // Each thread remembers its shard in the last few registries it used
+    struct CachedShard {
+        uint64_t instance;
+        void* shard;
+    };
+    constexpr size_t SHARD_CACHE_SIZE = 4;
+    thread_local CachedShard shardCache[SHARD_CACHE_SIZE] = {};
+    thread_local size_t shardCacheNext = 0;
+
+    // Counters are written only by the shard's own thread; readers merge
+    void bump(std::atomic<uint64_t>& counter, uint64_t delta) {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    double toMicros(uint64_t nanos) {
+        return nanos / 1000.0;
+    }
+}
+
+struct MetricsRegistry::Shard {
+    struct Histogram {
+        std::atomic<uint64_t> counts[LatencyHistogram::BUCKET_COUNT];
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> sum;
+        std::atomic<uint64_t> min;
+        std::atomic<uint64_t> max;
+
+        Histogram() : count(0), sum(0), min(UINT64_MAX), max(0) {
+            for (auto& bucket : counts) {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        void record(uint64_t value) {
+            bump(counts[LatencyHistogram::bucketFor(value)], 1);
+            bump(count, 1);
+            bump(sum, value);
+            if (value < min.load(std::memory_order_relaxed)) {
+                min.store(value, std::memory_order_relaxed);
+            }
+            if (value > max.load(std::memory_order_relaxed)) {
+                max.store(value, std::memory_order_relaxed);
+            }
+        }
+
+        void mergeInto(LatencyHistogram& merged) const {
+            for (size_t i = 0; i < LatencyHistogram::BUCKET_COUNT; ++i) {
+                uint64_t bucket = counts[i].load(std::memory_order_relaxed);
+                if (bucket) {
+                    merged.addBucket(i, bucket);
+                }
+            }
+            merged.addTotals(count.load(std::memory_order_relaxed), sum.load(std::memory_order_relaxed),
+                             min.load(std::memory_order_relaxed), max.load(std::memory_order_relaxed));
+        }
+    };
+
+    // Operations first, then one wait histogram per lock; allocated on first use
+    std::atomic<Histogram*> histograms[MAX_OPERATIONS + MAX_LOCKS];
+    std::atomic<uint64_t> acquisitions[MAX_LOCKS];
+    std::atomic<uint64_t> contended[MAX_LOCKS];
+
+    Shard() {
+        for (auto& histogram : histograms) {
+            histogram.store(nullptr, std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < MAX_LOCKS; ++i) {
+            acquisitions[i].store(0, std::memory_order_relaxed);
+            contended[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    ~Shard() {
+        for (auto& histogram : histograms) {
+            delete histogram.load(std::memory_order_relaxed);
+        }
+    }
+
+    Histogram& histogramAt(size_t slot) {
+        Histogram* histogram = histograms[slot].load(std::memory_order_relaxed);
+        if (!histogram) {
+            histogram = new Histogram();
+            histograms[slot].store(histogram, std::memory_order_release);
+        }
+        return *histogram;
+    }
+};
+
+// Constructor and Destructor
+MetricsRegistry::MetricsRegistry(std::vector<std::string> operations, std::vector<std::string> locks)
+    : m_operationNames(std::move(operations)), m_lockNames(std::move(locks)),
+      m_instance(nextInstance.fetch_add(1, std::memory_order_relaxed)) {
+    m_operationNames.resize(std::min(m_operationNames.size(), MAX_OPERATIONS));
+    m_lockNames.resize(std::min(m_lockNames.size(), MAX_LOCKS));
+}
+
+MetricsRegistry::~MetricsRegistry() = default;
+
+// Recording
+void MetricsRegistry::record(OperationId operation, uint64_t nanos) {
+    if (operation >= m_operationNames.size()) {
+        return;
+    }
+    localShard().histogramAt(operation).record(nanos);
+}
+
+void MetricsRegistry::recordLock(LockId lock, bool contended, uint64_t waitNanos) {
+    if (lock >= m_lockNames.size()) {
+        return;
+    }
+    Shard& shard = localShard();
+    bump(shard.acquisitions[lock], 1);
+    if (contended) {
+        bump(shard.contended[lock], 1);
+        shard.histogramAt(MAX_OPERATIONS + lock).record(waitNanos);
+    }
+}
+
+MetricsRegistry::Shard& MetricsRegistry::localShard() {
+    for (const CachedShard& cached : shardCache) {
+        if (cached.instance == m_instance) {
+            return *static_cast<Shard*>(cached.shard);
+        }
+    }
+
+    Shard* shard;
+    {
+        std::lock_guard<std::mutex> lock(m_shardMutex);
+        Shard*& owned = m_threadShards[std::this_thread::get_id()];
+        if (!owned) {
+            m_shards.push_back(std::make_unique<Shard>());
+            owned = m_shards.back().get();
+        }
+        shard = owned;
+    }
+    shardCache[shardCacheNext] = CachedShard{m_instance, shard};
+    shardCacheNext = (shardCacheNext + 1) % SHARD_CACHE_SIZE;
+    return *shard;
+}
+
+// Reading
+LatencyHistogram MetricsRegistry::mergeSlot(size_t slot) const {
+    LatencyHistogram merged;
+    for (const auto& shard : m_shards) {
+        const Shard::Histogram* histogram = shard->histograms[slot].load(std::memory_order_acquire);
+        if (histogram) {
+            histogram->mergeInto(merged);
+        }
+    }
+    return merged;
+}
+
+LatencyHistogram MetricsRegistry::getHistogram(OperationId operation) const {
+    if (operation >= m_operationNames.size()) {
+        return LatencyHistogram();
+    }
+    std::lock_guard<std::mutex> lock(m_shardMutex);
+    return mergeSlot(operation);
+}
+
+MetricsRegistry::Snapshot MetricsRegistry::snapshot() const {
+    Snapshot snapshot;
+    std::lock_guard<std::mutex> lock(m_shardMutex);
+    snapshot.threads = m_shards.size();
+
+    for (size_t i = 0; i < m_operationNames.size(); ++i) {
+        LatencyHistogram merged = mergeSlot(i);
+        OperationSnapshot operation;
+        operation.name = m_operationNames[i];
+        operation.count = merged.getCount();
+        operation.meanNs = merged.getMean();
+        operation.p50Ns = merged.valueAtPercentile(50.0);
+        operation.p90Ns = merged.valueAtPercentile(90.0);
+        operation.p99Ns = merged.valueAtPercentile(99.0);
+        operation.p999Ns = merged.valueAtPercentile(99.9);
+        operation.maxNs = merged.getMax();
+        snapshot.operations.push_back(std::move(operation));
+    }
+
+    for (size_t i = 0; i < m_lockNames.size(); ++i) {
+        LatencyHistogram waits = mergeSlot(MAX_OPERATIONS + i);
+        LockSnapshot lockStats;
+        lockStats.name = m_lockNames[i];
+        for (const auto& shard : m_shards) {
+            lockStats.acquisitions += shard->acquisitions[i].load(std::memory_order_relaxed);
+            lockStats.contended += shard->contended[i].load(std::memory_order_relaxed);
+        }
+        lockStats.waitNs = waits.getSum();
+        lockStats.p99WaitNs = waits.valueAtPercentile(99.0);
+        lockStats.maxWaitNs = waits.getMax();
+        snapshot.locks.push_back(std::move(lockStats));
+    }
+    return snapshot;
+}
+
+std::string MetricsRegistry::format(const Snapshot& snapshot) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+
+    out << std::left << std::setw(28) << "operation" << std::right << std::setw(10) << "count" << std::setw(11)
+        << "mean_us" << std::setw(11) << "p50_us" << std::setw(11) << "p90_us" << std::setw(11) << "p99_us"
+        << std::setw(11) << "p99.9_us" << std::setw(11) << "max_us" << "\n";
+    for (const OperationSnapshot& operation : snapshot.operations) {
+        out << std::left << std::setw(28) << operation.name << std::right << std::setw(10) << operation.count
+            << std::setw(11) << operation.meanNs / 1000.0 << std::setw(11) << toMicros(operation.p50Ns)
+            << std::setw(11) << toMicros(operation.p90Ns) << std::setw(11) << toMicros(operation.p99Ns)
+            << std::setw(11) << toMicros(operation.p999Ns) << std::setw(11) << toMicros(operation.maxNs) << "\n";
+    }
+
+    if (!snapshot.locks.empty()) {
+        out << std::left << std::setw(28) << "lock" << std::right << std::setw(10) << "acquired" << std::setw(11)
+            << "contended" << std::setw(11) << "wait_ms" << std::setw(11) << "p99_wait" << std::setw(11)
+            << "max_wait" << "\n";
+        for (const LockSnapshot& lockStats : snapshot.locks) {
+            out << std::left << std::setw(28) << lockStats.name << std::right << std::setw(10)
+                << lockStats.acquisitions << std::setw(11) << lockStats.contended << std::setw(11)
+                << lockStats.waitNs / 1.0e6 << std::setw(11) << toMicros(lockStats.p99WaitNs) << std::setw(11)
+                << toMicros(lockStats.maxWaitNs) << "\n";
+        }
+    }
+
+    if (!snapshot.gauges.empty()) {
+        out << std::left << std::setw(28) << "gauge" << std::right << std::setw(10) << "value" << "\n";
+        for (const GaugeSnapshot& gauge : snapshot.gauges) {
+            out << std::left << std::setw(28) << gauge.name << std::right << std::setw(10) << gauge.value << "\n";
+        }
+    }
+    return out.str();
+}
@@ -0,0 +1,222 @@
+#include "NotificationPipeline.h"
+#include <unordered_map>
+#include <string_view>
+#include <algorithm>
+#include <chrono>
+
+// Constructors and Destructor
+NotificationPipeline::NotificationPipeline(BatchSink sink) : NotificationPipeline(std::move(sink), Options()) {
+}
+
+NotificationPipeline::NotificationPipeline(BatchSink sink, const Options& options)
+    : m_sink(), m_options(options), m_queue(options.queueCapacity), m_accepting(true),
+      m_stopping(false), m_activePosters(0), m_sleeping(false), m_posted(0), m_dropped(0), m_rejected(0),
+      m_coalesced(0), m_delivered(0), m_sinkCalls(0), m_sinkFailures(0), m_discarded(0) {
+    m_options.maxBatch = std::max<size_t>(1, m_options.maxBatch);
+    setSink(std::move(sink));
+    m_deliveryThread = std::thread(&NotificationPipeline::deliveryLoop, this);
+}
+
+NotificationPipeline::~NotificationPipeline() {
+    shutdown();
+}
+
+// Sink
+void NotificationPipeline::setSink(BatchSink sink) {
+    std::shared_ptr<const BatchSink> next = sink ? std::make_shared<const BatchSink>(std::move(sink)) : nullptr;
+    std::lock_guard<std::mutex> lock(m_sinkMutex);
+    m_sink.swap(next);
+}
+
+// Posting
+bool NotificationPipeline::post(std::string recipient, std::string text) {
+    return post(std::move(recipient), std::move(text), std::string());
+}
+
+bool NotificationPipeline::post(std::string recipient, std::string text, std::string coalesceKey) {
+    // Registering before the check lets shutdown() wait out in-flight pushes
+    m_activePosters.fetch_add(1);
+    if (!m_accepting.load()) {
+        m_activePosters.fetch_sub(1);
+        m_rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    bool pushed = m_queue.tryPush(Message{std::move(recipient), std::move(text), std::move(coalesceKey)});
+    if (pushed) {
+        m_posted.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_activePosters.fetch_sub(1);
+    if (!pushed) {
+        return false;
+    }
+
+    // Pairs with the fence in deliveryLoop so a parking thread cannot miss this message
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_sleeping.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(m_idleMutex);
+        m_idleCondition.notify_one();
+    }
+    return true;
+}
+
+void NotificationPipeline::flush() {
+    uint64_t target = m_posted.load(std::memory_order_relaxed);
+    std::unique_lock<std::mutex> lock(m_progressMutex);
+    while (settled() < target) {
+        // Timed wait so a flush racing shutdown() cannot hang
+        m_progressCondition.wait_for(lock, std::chrono::milliseconds(50));
+    }
+}
+
+void NotificationPipeline::shutdown() {
+    m_accepting.store(false);
+    while (m_activePosters.load() > 0) {
+        std::this_thread::yield();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_idleMutex);
+        m_stopping.store(true, std::memory_order_release);
+    }
+    m_idleCondition.notify_all();
+
+    if (m_deliveryThread.joinable()) {
+        m_deliveryThread.join();
+    }
+}
+
+// Statistics
+NotificationPipeline::Stats NotificationPipeline::getStats() const {
+    Stats stats;
+    stats.posted = m_posted.load(std::memory_order_relaxed);
+    stats.dropped = m_dropped.load(std::memory_order_relaxed);
+    stats.rejected = m_rejected.load(std::memory_order_relaxed);
+    stats.coalesced = m_coalesced.load(std::memory_order_relaxed);
+    stats.delivered = m_delivered.load(std::memory_order_relaxed);
+    stats.sinkCalls = m_sinkCalls.load(std::memory_order_relaxed);
+    stats.sinkFailures = m_sinkFailures.load(std::memory_order_relaxed);
+    stats.discarded = m_discarded.load(std::memory_order_relaxed);
+    stats.queued = m_queue.sizeApprox();
+    return stats;
+}
+
+uint64_t NotificationPipeline::settled() const {
+    return m_delivered.load(std::memory_order_acquire) + m_coalesced.load(std::memory_order_acquire) +
+           m_discarded.load(std::memory_order_acquire);
+}
+
+// Delivery thread
+void NotificationPipeline::deliveryLoop() {
+    std::vector<Message> round;
+    round.reserve(m_options.maxBatch);
+    Message message;
+    while (true) {
+        while (round.size() < m_options.maxBatch && m_queue.tryPop(message)) {
+            round.push_back(std::move(message));
+        }
+        if (!round.empty()) {
+            deliver(round);
+            round.clear();
+            continue;
+        }
+
+        // Ring drained: exit if shutting down, otherwise park
+        if (m_stopping.load(std::memory_order_acquire)) {
+            if (m_queue.emptyApprox()) {
+                return;
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_idleMutex);
+        m_sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_queue.emptyApprox() && !m_stopping.load(std::memory_order_acquire)) {
+            // Timed wait as a safety net; post() notifies whenever we sleep
+            m_idleCondition.wait_for(lock, std::chrono::milliseconds(50));
+        }
+        m_sleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+void NotificationPipeline::deliver(std::vector<Message>& round) {
+    struct Group {
+        const std::string* recipient;
+        std::vector<std::string> messages;
+    };
+    struct Slot {
+        size_t group;
+        size_t index;
+    };
+
+    // Held for the whole round, so a sink replaced mid-round stays alive until it ends
+    std::shared_ptr<const BatchSink> sink;
+    {
+        std::lock_guard<std::mutex> lock(m_sinkMutex);
+        sink = m_sink;
+    }
+    if (!sink) {
+        m_discarded.fetch_add(round.size(), std::memory_order_release);
+        publishProgress();
+        return;
+    }
+
+    // Recipients in first-seen order; recipient strings stay put in `round`
+    std::vector<Group> groups;
+    std::unordered_map<std::string_view, size_t> groupOf;
+    // "k" + recipient + '\0' + key for keyed messages, "t" + ... + text for repeats
+    std::unordered_map<std::string, Slot> slots;
+    std::string slotKey;
+    uint64_t coalesced = 0;
+
+    for (Message& message : round) {
+        auto group = groupOf.emplace(message.recipient, groups.size());
+        if (group.second) {
+            groups.push_back(Group{&message.recipient, {}});
+        }
+        size_t groupIndex = group.first->second;
+
+        bool keyed = !message.coalesceKey.empty();
+        slotKey.assign(keyed ? "k" : "t");
+        slotKey += message.recipient;
+        slotKey += '\0';
+        slotKey += keyed ? message.coalesceKey : message.text;
+
+        auto slot = slots.emplace(slotKey, Slot{groupIndex, groups[groupIndex].messages.size()});
+        if (!slot.second) {
+            if (keyed) {
+                // Latest status wins, in the position of the first
+                groups[groupIndex].messages[slot.first->second.index] = std::move(message.text);
+            }
+            ++coalesced;
+            continue;
+        }
+        groups[groupIndex].messages.push_back(std::move(message.text));
+    }
+
+    uint64_t failures = 0;
+    for (const Group& group : groups) {
+        try {
+            (*sink)(*group.recipient, group.messages);
+        } catch (...) {
+            ++failures; // A throwing sink must not take the delivery thread down
+        }
+    }
+
+    m_sinkCalls.fetch_add(groups.size(), std::memory_order_relaxed);
+    m_sinkFailures.fetch_add(failures, std::memory_order_relaxed);
+    m_coalesced.fetch_add(coalesced, std::memory_order_release);
+    m_delivered.fetch_add(round.size() - coalesced, std::memory_order_release);
+    publishProgress();
+}
+
+// Wakes flush() waiters; the empty critical section orders the counter
+// updates before a waiter's next settled() check
+void NotificationPipeline::publishProgress() {
+    {
+        std::lock_guard<std::mutex> lock(m_progressMutex);
+    }
+    m_progressCondition.notify_all();
+}
@@ -0,0 +1,94 @@
+#include "PopularityLeaderboard.h"
+#include <mutex>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+
+// Updates
+void PopularityLeaderboard::adjust(Handle driver, long delta) {
+    Shard& shard = shardFor(driver);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto position = shard.positions.find(driver);
+    if (position == shard.positions.end()) {
+        if (delta > 0) {
+            auto inserted = shard.ranking.insert(Entry{static_cast<size_t>(delta), driver});
+            shard.positions.emplace(driver, inserted.first);
+        }
+        return;
+    }
+
+    // Re-key the existing node in place of erase + insert
+    auto node = shard.ranking.extract(position->second);
+    long count = static_cast<long>(node.value().count) + delta;
+    if (count <= 0) {
+        shard.positions.erase(position);
+        return;
+    }
+    node.value().count = static_cast<size_t>(count);
+    position->second = shard.ranking.insert(std::move(node)).position;
+}
+
+void PopularityLeaderboard::remove(Handle driver) {
+    Shard& shard = shardFor(driver);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto position = shard.positions.find(driver);
+    if (position != shard.positions.end()) {
+        shard.ranking.erase(position->second);
+        shard.positions.erase(position);
+    }
+}
+
+void PopularityLeaderboard::clear() {
+    for (size_t i = 0; i < SHARD_COUNT; ++i) {
+        std::unique_lock<std::shared_mutex> lock(m_shards[i].mutex);
+        m_shards[i].ranking.clear();
+        m_shards[i].positions.clear();
+    }
+}
+
+// Queries
+std::vector<PopularityLeaderboard::RankedDriver> PopularityLeaderboard::top(size_t limit) const {
+    // Every global top-`limit` entry is within the top `limit` of its own shard
+    std::vector<Entry> candidates;
+    for (size_t i = 0; i < SHARD_COUNT; ++i) {
+        std::shared_lock<std::shared_mutex> lock(m_shards[i].mutex);
+        const Ranking& ranking = m_shards[i].ranking;
+        size_t taken = 0;
+        for (auto it = ranking.begin(); it != ranking.end() && taken < limit; ++it, ++taken) {
+            candidates.push_back(*it);
+        }
+    }
+
+    size_t count = std::min(limit, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), MorePopular());
+    std::vector<RankedDriver> result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        result.emplace_back(candidates[i].driver, candidates[i].count);
+    }
+    return result;
+}
+
+size_t PopularityLeaderboard::getCount(Handle driver) const {
+    const Shard& shard = shardFor(driver);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto position = shard.positions.find(driver);
+    return position != shard.positions.end() ? position->second->count : 0;
+}
+
+size_t PopularityLeaderboard::size() const {
+    size_t total = 0;
+    for (size_t i = 0; i < SHARD_COUNT; ++i) {
+        std::shared_lock<std::shared_mutex> lock(m_shards[i].mutex);
+        total += m_shards[i].ranking.size();
+    }
+    return total;
+}
+
+PopularityLeaderboard::Shard& PopularityLeaderboard::shardFor(Handle driver) const {
+    // Same fold as ShardedMap::shardFor, so a handle lands in the matching shard
+    uint64_t h = std::hash<Handle>()(driver);
+    h ^= h >> 17;
+    h *= 0x9E3779B97F4A7C15ull;
+    return m_shards[static_cast<size_t>(h >> 32) & (SHARD_COUNT - 1)];
+}
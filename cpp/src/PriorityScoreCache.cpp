@@ -0,0 +1,106 @@
+#include "PriorityScoreCache.h"
+#include <algorithm>
+
+// Constructors
+PriorityScoreCache::PriorityScoreCache() : PriorityScoreCache(Options()) {
+}
+
+PriorityScoreCache::PriorityScoreCache(const Options& options)
+    : m_distancePenaltyPerKm(options.distancePenaltyPerKm),
+      m_driverVersions(new std::atomic<uint32_t>[VERSION_SLOTS]),
+      m_userVersions(new std::atomic<uint32_t>[VERSION_SLOTS]) {
+    size_t count = 1;
+    while (count < options.shardCount) {
+        count <<= 1;
+    }
+    m_shards.reset(new Shard[count]);
+    m_shardMask = count - 1;
+    m_shardCapacity = std::max<size_t>(1, options.capacity / count);
+    for (size_t i = 0; i < VERSION_SLOTS; ++i) {
+        m_driverVersions[i].store(0, std::memory_order_relaxed);
+        m_userVersions[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+// Lookup and storage
+void PriorityScoreCache::lookupAll(Shard& shard, Handle user, uint32_t userVersionNow, const Handle* drivers,
+                                   size_t count, double* scores, uint32_t* driverVersions,
+                                   std::vector<size_t>& missing) const {
+    uint64_t hits = 0;
+    uint64_t invalidations = 0;
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        for (size_t i = 0; i < count; ++i) {
+            driverVersions[i] = driverVersion(drivers[i]);
+            auto it = shard.entries.find(keyFor(user, drivers[i]));
+            if (it == shard.entries.end()) {
+                missing.push_back(i);
+            } else if (it->second.driverVersion != driverVersions[i] || it->second.userVersion != userVersionNow) {
+                missing.push_back(i);
+                ++invalidations;
+            } else {
+                scores[i] = it->second.score;
+                ++hits;
+            }
+        }
+    }
+    shard.hits.fetch_add(hits, std::memory_order_relaxed);
+    shard.misses.fetch_add(missing.size(), std::memory_order_relaxed);
+    shard.invalidations.fetch_add(invalidations, std::memory_order_relaxed);
+}
+
+void PriorityScoreCache::storeAll(Shard& shard, Handle user, uint32_t userVersionNow, const Handle* drivers,
+                                  const double* scores, const uint32_t* driverVersions,
+                                  const std::vector<size_t>& missing) {
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    if (shard.entries.size() + missing.size() > m_shardCapacity) {
+        shard.entries.clear();
+        shard.resets.fetch_add(1, std::memory_order_relaxed);
+    }
+    for (size_t i : missing) {
+        shard.entries[keyFor(user, drivers[i])] = Entry{scores[i], driverVersions[i], userVersionNow};
+    }
+}
+
+// Invalidation
+void PriorityScoreCache::invalidateDriver(Handle driver) {
+    m_driverVersions[driver & (VERSION_SLOTS - 1)].fetch_add(1, std::memory_order_acq_rel);
+}
+
+void PriorityScoreCache::invalidateUser(Handle user) {
+    m_userVersions[user & (VERSION_SLOTS - 1)].fetch_add(1, std::memory_order_acq_rel);
+}
+
+void PriorityScoreCache::clear() {
+    for (size_t i = 0; i <= m_shardMask; ++i) {
+        std::unique_lock<std::shared_mutex> lock(m_shards[i].mutex);
+        m_shards[i].entries.clear();
+    }
+}
+
+// Selection
+void PriorityScoreCache::selectTop(std::vector<Ranked>& candidates, size_t limit) {
+    auto better = [](const Ranked& a, const Ranked& b) {
+        return a.score != b.score ? a.score > b.score : a.driver < b.driver;
+    };
+    if (limit < candidates.size()) {
+        std::nth_element(candidates.begin(), candidates.begin() + limit, candidates.end(), better);
+        candidates.resize(limit);
+    }
+    std::sort(candidates.begin(), candidates.end(), better);
+}
+
+// Statistics
+PriorityScoreCache::Stats PriorityScoreCache::getStats() const {
+    Stats stats;
+    for (size_t i = 0; i <= m_shardMask; ++i) {
+        const Shard& shard = m_shards[i];
+        stats.hits += shard.hits.load(std::memory_order_relaxed);
+        stats.misses += shard.misses.load(std::memory_order_relaxed);
+        stats.invalidations += shard.invalidations.load(std::memory_order_relaxed);
+        stats.resets += shard.resets.load(std::memory_order_relaxed);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        stats.size += shard.entries.size();
+    }
+    return stats;
+}
@@ -0,0 +1,152 @@
+#include "RequestIdGenerator.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+namespace {
+    constexpr uint32_t SLOT_COUNT = 1u << RequestIdGenerator::SLOT_BITS;
+    constexpr uint32_t OVERFLOW_SLOT = SLOT_COUNT - 1; // Shared once every other slot is leased
+    constexpr uint32_t SEQUENCE_LIMIT = 1u << RequestIdGenerator::SEQUENCE_BITS;
+    constexpr uint64_t TIMESTAMP_MASK = (uint64_t(1) << RequestIdGenerator::TIMESTAMP_BITS) - 1;
+    constexpr uint32_t NODE_MASK = (1u << RequestIdGenerator::NODE_BITS) - 1;
+    constexpr unsigned LOW_BITS =
+        RequestIdGenerator::NODE_BITS + RequestIdGenerator::SLOT_BITS + RequestIdGenerator::SEQUENCE_BITS;
+
+    // Crockford base 32: no I, L, O or U, and ascending in ASCII so IDs sort by value
+    constexpr char ALPHABET[] = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";
+
+    // Only the leaseholder touches a slot; padded so neighbours do not share a line
+    struct alignas(64) SlotState {
+        int64_t lastMillis = 0; // Since EPOCH_MILLIS
+        uint32_t sequence = 0;
+    };
+
+    struct SlotTable {
+        std::mutex mutex; // Guards freeSlots, and the overflow slot's state
+        std::vector<uint32_t> freeSlots;
+        SlotState slots[SLOT_COUNT];
+
+        SlotTable() {
+            for (uint32_t slot = OVERFLOW_SLOT; slot > 0; --slot) {
+                freeSlots.push_back(slot - 1);
+            }
+        }
+    };
+
+    // Never destroyed, so threads that outlive static destruction can still
+    // return their lease
+    SlotTable& slotTable() {
+        static SlotTable* table = new SlotTable();
+        return *table;
+    }
+
+    std::atomic<uint32_t> nodeId{0};
+
+    struct SlotLease {
+        uint32_t slot;
+
+        SlotLease() : slot(OVERFLOW_SLOT) {
+            SlotTable& table = slotTable();
+            std::lock_guard<std::mutex> lock(table.mutex);
+            if (!table.freeSlots.empty()) {
+                slot = table.freeSlots.back();
+                table.freeSlots.pop_back();
+            }
+        }
+
+        ~SlotLease() {
+            if (slot != OVERFLOW_SLOT) {
+                SlotTable& table = slotTable();
+                std::lock_guard<std::mutex> lock(table.mutex);
+                table.freeSlots.push_back(slot);
+            }
+        }
+    };
+
+    thread_local SlotLease lease;
+
+    // Advances the slot's logical clock; returns the millisecond and sequence to use
+    void advance(SlotState& state, int64_t now, int64_t& millis, uint32_t& sequence) {
+        if (now > state.lastMillis) {
+            state.lastMillis = now;
+            state.sequence = 0;
+        } else if (++state.sequence == SEQUENCE_LIMIT) {
+            ++state.lastMillis;
+            state.sequence = 0;
+        }
+        millis = state.lastMillis;
+        sequence = state.sequence;
+    }
+
+    int decodeChar(char c) {
+        const char* end = ALPHABET + 32;
+        const char* found = std::find(ALPHABET, end, c);
+        return found != end ? static_cast<int>(found - ALPHABET) : -1;
+    }
+}
+
+// Generation
+std::string RequestIdGenerator::next() {
+    int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::system_clock::now().time_since_epoch()).count() - EPOCH_MILLIS;
+
+    uint32_t slot = lease.slot;
+    SlotTable& table = slotTable();
+    int64_t millis;
+    uint32_t sequence;
+    if (slot != OVERFLOW_SLOT) {
+        advance(table.slots[slot], now, millis, sequence);
+    } else {
+        std::lock_guard<std::mutex> lock(table.mutex);
+        advance(table.slots[slot], now, millis, sequence);
+    }
+
+    // 75 bits as a (high, low) pair: low holds bits 0-63, high bits 64-74
+    uint64_t timestamp = static_cast<uint64_t>(millis) & TIMESTAMP_MASK;
+    uint64_t tail = (static_cast<uint64_t>(nodeId.load(std::memory_order_relaxed)) << (SLOT_BITS + SEQUENCE_BITS)) |
+                    (static_cast<uint64_t>(slot) << SEQUENCE_BITS) | sequence;
+    uint64_t low = (timestamp << LOW_BITS) | tail;
+    uint64_t high = timestamp >> (64 - LOW_BITS);
+
+    char buffer[ID_LENGTH];
+    for (size_t i = ID_LENGTH; i > 0; --i) {
+        buffer[i - 1] = ALPHABET[low & 31];
+        low = (low >> 5) | (high << 59);
+        high >>= 5;
+    }
+    return std::string(buffer, ID_LENGTH);
+}
+
+bool RequestIdGenerator::decode(std::string_view id, Parts& parts) {
+    if (id.size() != ID_LENGTH) {
+        return false;
+    }
+    uint64_t low = 0;
+    uint64_t high = 0;
+    for (char c : id) {
+        int value = decodeChar(c);
+        if (value < 0) {
+            return false;
+        }
+        high = (high << 5) | (low >> 59);
+        low = (low << 5) | static_cast<uint64_t>(value);
+    }
+
+    uint64_t timestamp = (low >> LOW_BITS) | (high << (64 - LOW_BITS));
+    parts.unixMillis = static_cast<int64_t>(timestamp) + EPOCH_MILLIS;
+    parts.node = static_cast<uint32_t>(low >> (SLOT_BITS + SEQUENCE_BITS)) & NODE_MASK;
+    parts.slot = static_cast<uint32_t>(low >> SEQUENCE_BITS) & (SLOT_COUNT - 1);
+    parts.sequence = static_cast<uint32_t>(low) & (SEQUENCE_LIMIT - 1);
+    return true;
+}
+
+// Configuration
+void RequestIdGenerator::setNodeId(uint32_t node) {
+    nodeId.store(node & NODE_MASK, std::memory_order_relaxed);
+}
+
+uint32_t RequestIdGenerator::getNodeId() {
+    return nodeId.load(std::memory_order_relaxed);
+}
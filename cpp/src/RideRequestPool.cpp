@@ -0,0 +1,239 @@
+#include "RideRequestPool.h"
+#include <mutex>
+#include <vector>
+#include <new>
+#include <cstddef>
+#include <algorithm>
+
+namespace {
+    // Large enough for libstdc++/libc++ shared_ptr control blocks holding the
+    // recycler and allocator below; larger blocks fall back to operator new
+    constexpr size_t CONTROL_BLOCK_SIZE = 64;
+}
+
+// Shared slab state; kept alive by the pool and by every outstanding control block
+struct RideRequestPool::State {
+    struct alignas(RideRequest) RequestSlot {
+        unsigned char bytes[sizeof(RideRequest)];
+    };
+
+    union Block {
+        Block* next; // While on the free list
+        alignas(std::max_align_t) unsigned char bytes[CONTROL_BLOCK_SIZE];
+    };
+
+    std::mutex mutex;
+    size_t slabSize;
+
+    // Request slots are constructed on first use and stay constructed until
+    // the state is destroyed; freeRequests is reserved to full capacity so
+    // returning a request never allocates
+    std::vector<std::unique_ptr<RequestSlot[]>> requestSlabs;
+    std::vector<RequestSlot*> unusedSlots; // Never constructed
+    std::vector<RideRequest*> freeRequests;
+
+    std::vector<std::unique_ptr<Block[]>> blockSlabs;
+    Block* freeBlocks;
+
+    size_t inUse;
+    uint64_t acquired;
+    uint64_t reused;
+
+    explicit State(size_t slabSize)
+        : slabSize(std::max<size_t>(1, slabSize)), freeBlocks(nullptr),
+          inUse(0), acquired(0), reused(0) {
+    }
+
+    // Every constructed request is on the free list by the time the last
+    // control block has released its reference
+    ~State() {
+        for (RideRequest* request : freeRequests) {
+            request->~RideRequest();
+        }
+    }
+
+    // Caller holds mutex
+    void addRequestSlab() {
+        RequestSlot* slots = new RequestSlot[slabSize];
+        requestSlabs.emplace_back(slots);
+        size_t capacity = requestSlabs.size() * slabSize;
+        freeRequests.reserve(capacity);
+        unusedSlots.reserve(capacity);
+        for (size_t i = slabSize; i > 0; --i) {
+            unusedSlots.push_back(&slots[i - 1]);
+        }
+    }
+
+    void addBlockSlab() {
+        Block* blocks = new Block[slabSize];
+        blockSlabs.emplace_back(blocks);
+        for (size_t i = 0; i < slabSize; ++i) {
+            blocks[i].next = i + 1 < slabSize ? &blocks[i + 1] : freeBlocks;
+        }
+        freeBlocks = blocks;
+    }
+
+    // Pops a recycled request, or constructs one in a fresh slot with makeNew(void*)
+    template <typename MakeNew>
+    RideRequest* take(bool& recycled, MakeNew&& makeNew) {
+        std::lock_guard<std::mutex> lock(mutex);
+        RideRequest* request;
+        recycled = !freeRequests.empty();
+        if (recycled) {
+            request = freeRequests.back();
+            freeRequests.pop_back();
+            ++reused;
+        } else {
+            if (unusedSlots.empty()) {
+                addRequestSlab();
+            }
+            request = makeNew(unusedSlots.back()->bytes);
+            unusedSlots.pop_back();
+        }
+        ++inUse;
+        ++acquired;
+        return request;
+    }
+
+    void give(RideRequest* request) {
+        std::lock_guard<std::mutex> lock(mutex);
+        freeRequests.push_back(request);
+        --inUse;
+    }
+
+    void* allocateBlock() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!freeBlocks) {
+            addBlockSlab();
+        }
+        Block* block = freeBlocks;
+        freeBlocks = block->next;
+        return block;
+    }
+
+    void deallocateBlock(void* pointer) {
+        Block* block = static_cast<Block*>(pointer);
+        std::lock_guard<std::mutex> lock(mutex);
+        block->next = freeBlocks;
+        freeBlocks = block;
+    }
+
+    // shared_ptr deleter: wipes the request and puts it back on the free list.
+    // A raw pointer suffices because the control block's allocator holds the state.
+    struct Recycler {
+        State* state;
+
+        void operator()(RideRequest* request) const {
+            request->clear();
+            state->give(request);
+        }
+    };
+
+    // Serves the shared_ptr control block from the pool's block slabs
+    template <typename T>
+    struct ControlBlockAllocator {
+        using value_type = T;
+
+        std::shared_ptr<State> state;
+
+        explicit ControlBlockAllocator(std::shared_ptr<State> owner) : state(std::move(owner)) {}
+
+        template <typename U>
+        ControlBlockAllocator(const ControlBlockAllocator<U>& other) : state(other.state) {}
+
+        T* allocate(size_t count) {
+            if (fitsBlock(count)) {
+                return static_cast<T*>(state->allocateBlock());
+            }
+            return static_cast<T*>(::operator new(count * sizeof(T)));
+        }
+
+        void deallocate(T* pointer, size_t count) {
+            if (fitsBlock(count)) {
+                state->deallocateBlock(pointer);
+            } else {
+                ::operator delete(pointer);
+            }
+        }
+
+        static bool fitsBlock(size_t count) {
+            return count == 1 && sizeof(T) <= sizeof(State::Block) && alignof(T) <= alignof(State::Block);
+        }
+
+        template <typename U>
+        bool operator==(const ControlBlockAllocator<U>& other) const { return state == other.state; }
+
+        template <typename U>
+        bool operator!=(const ControlBlockAllocator<U>& other) const { return state != other.state; }
+    };
+
+    static std::shared_ptr<RideRequest> wrap(const std::shared_ptr<State>& state, RideRequest* request) {
+        // On failure the shared_ptr constructor hands the request to the recycler
+        return std::shared_ptr<RideRequest>(request, Recycler{state.get()},
+                                            ControlBlockAllocator<RideRequest>(state));
+    }
+};
+
+// Constructors
+RideRequestPool::RideRequestPool() : RideRequestPool(DEFAULT_SLAB_SIZE) {
+}
+
+RideRequestPool::RideRequestPool(size_t slabSize) : m_state(std::make_shared<State>(slabSize)) {
+}
+
+// Acquisition
+std::shared_ptr<RideRequest> RideRequestPool::acquire(const RideRequest& prototype) {
+    bool recycled;
+    RideRequest* request = m_state->take(recycled, [&prototype](void* slot) {
+        return new (slot) RideRequest(prototype);
+    });
+    if (recycled) {
+        try {
+            *request = prototype; // Assigns into the retained string buffers
+        } catch (...) {
+            m_state->give(request);
+            throw;
+        }
+    }
+    return State::wrap(m_state, request);
+}
+
+std::shared_ptr<RideRequest> RideRequestPool::acquire(const std::string& userId, const Driver::Location& pickup,
+                                                      const Driver::Location& dropoff, RideRequest::RideType type) {
+    bool recycled;
+    RideRequest* request = m_state->take(recycled, [&](void* slot) {
+        return new (slot) RideRequest(userId, pickup, dropoff, type);
+    });
+    if (recycled) {
+        try {
+            request->reset(userId, pickup, dropoff, type);
+        } catch (...) {
+            m_state->give(request);
+            throw;
+        }
+    }
+    return State::wrap(m_state, request);
+}
+
+// Capacity
+void RideRequestPool::reserve(size_t count) {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    size_t slabSize = m_state->slabSize;
+    while (m_state->requestSlabs.size() * slabSize < count) {
+        m_state->addRequestSlab();
+    }
+    while (m_state->blockSlabs.size() * slabSize < count) {
+        m_state->addBlockSlab();
+    }
+}
+
+RideRequestPool::Stats RideRequestPool::getStats() const {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    Stats stats;
+    stats.slabs = m_state->requestSlabs.size();
+    stats.capacity = stats.slabs * m_state->slabSize;
+    stats.inUse = m_state->inUse;
+    stats.acquired = m_state->acquired;
+    stats.reused = m_state->reused;
+    return stats;
+}
@@ -0,0 +1,231 @@
+#include "SpatialIndex.h"
+#include <cmath>
+#include <algorithm>
+#include <utility>
+
+namespace {
+    // Length of one degree of latitude (and of longitude at the equator)
+    constexpr double KM_PER_DEGREE = 111.32;
+
+    // Floor for cos(latitude) so boxes near the poles stay finite
+    constexpr double MIN_LONGITUDE_SCALE = 0.01;
+}
+
+// Constructor
+SpatialIndex::SpatialIndex(double cellSizeKm)
+    : m_cellSizeKm(cellSizeKm > 0.0 ? cellSizeKm : DEFAULT_CELL_SIZE_KM),
+      m_cellSizeDegrees(m_cellSizeKm / KM_PER_DEGREE) {
+}
+
+// Index maintenance
+bool SpatialIndex::insert(DriverPtr driver) {
+    if (!driver || m_entries.count(driver->getId())) {
+        return false;
+    }
+
+    int64_t key = cellKeyFor(driver->getCurrentLocation());
+    auto& bucket = m_cells[key];
+    m_entries.emplace(driver->getId(), Entry{driver, key, bucket.size()});
+    bucket.push_back(std::move(driver));
+    return true;
+}
+
+bool SpatialIndex::remove(const std::string& driverId) {
+    auto it = m_entries.find(driverId);
+    if (it == m_entries.end()) {
+        return false;
+    }
+
+    detach(it->second);
+    m_entries.erase(it);
+    return true;
+}
+
+bool SpatialIndex::update(const Driver& driver) {
+    auto it = m_entries.find(driver.getId());
+    if (it == m_entries.end()) {
+        return false;
+    }
+
+    Entry& entry = it->second;
+    int64_t key = cellKeyFor(driver.getCurrentLocation());
+    if (key == entry.cellKey) {
+        return true; // Still inside the same cell, nothing to move
+    }
+
+    detach(entry);
+    auto& bucket = m_cells[key];
+    entry.cellKey = key;
+    entry.slot = bucket.size();
+    bucket.push_back(entry.driver);
+    return true;
+}
+
+void SpatialIndex::clear() {
+    m_cells.clear();
+    m_entries.clear();
+}
+
+// Queries
+std::vector<SpatialIndex::DriverPtr> SpatialIndex::queryRadius(const Driver::Location& center,
+                                                               double radiusKm) const {
+    std::vector<DriverPtr> result;
+    if (radiusKm < 0.0 || m_entries.empty()) {
+        return result;
+    }
+
+    double latSpan = radiusKm / KM_PER_DEGREE;
+    double minLat = std::max(-90.0, center.latitude - latSpan);
+    double maxLat = std::min(90.0, center.latitude + latSpan);
+
+    // Longitude degrees shrink towards the poles; size the box for the worst row
+    double widestLat = std::max(std::fabs(minLat), std::fabs(maxLat));
+    double scale = std::max(MIN_LONGITUDE_SCALE, std::cos(widestLat * M_PI / 180.0));
+    double lngSpan = radiusKm / (KM_PER_DEGREE * scale);
+
+    // Split the longitude range where it crosses the antimeridian
+    std::vector<std::pair<double, double>> lngRanges;
+    if (lngSpan >= 180.0) {
+        lngRanges.emplace_back(-180.0, 180.0);
+    } else {
+        double minLng = center.longitude - lngSpan;
+        double maxLng = center.longitude + lngSpan;
+        if (minLng < -180.0) {
+            lngRanges.emplace_back(minLng + 360.0, 180.0);
+            minLng = -180.0;
+        }
+        if (maxLng > 180.0) {
+            lngRanges.emplace_back(-180.0, maxLng - 360.0);
+            maxLng = 180.0;
+        }
+        lngRanges.emplace_back(minLng, maxLng);
+    }
+
+    auto collect = [&](const std::vector<DriverPtr>& bucket) {
+        for (const auto& driver : bucket) {
+            if (driver->isNearby(center, radiusKm)) {
+                result.push_back(driver);
+            }
+        }
+    };
+
+    int32_t firstRow = rowFor(minLat);
+    int32_t lastRow = rowFor(maxLat);
+    std::vector<std::pair<int32_t, int32_t>> columnRanges;
+    double boxCells = 0.0;
+    for (const auto& range : lngRanges) {
+        columnRanges.emplace_back(columnFor(range.first), columnFor(range.second));
+        boxCells += static_cast<double>(lastRow - firstRow + 1) *
+                    (columnRanges.back().second - columnRanges.back().first + 1);
+    }
+
+    // A box wider than the occupied cells (large radius, or near the poles)
+    // costs less to answer by filtering the occupied cells than by probing
+    // every cell in it
+    if (boxCells > static_cast<double>(m_cells.size())) {
+        for (const auto& cell : m_cells) {
+            int32_t row = static_cast<int32_t>(cell.first >> 32);
+            int32_t column = static_cast<int32_t>(static_cast<uint32_t>(cell.first));
+            if (row < firstRow || row > lastRow) {
+                continue;
+            }
+            for (const auto& range : columnRanges) {
+                if (column >= range.first && column <= range.second) {
+                    collect(cell.second);
+                    break;
+                }
+            }
+        }
+        return result;
+    }
+
+    for (const auto& range : columnRanges) {
+        for (int32_t row = firstRow; row <= lastRow; ++row) {
+            for (int32_t column = range.first; column <= range.second; ++column) {
+                auto cell = m_cells.find(makeCellKey(row, column));
+                if (cell != m_cells.end()) {
+                    collect(cell->second);
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+std::vector<SpatialIndex::DriverPtr> SpatialIndex::findNearestAvailable(const Driver::Location& center,
+                                                                        size_t count,
+                                                                        double maxRadiusKm) const {
+    std::vector<std::pair<double, DriverPtr>> candidates;
+    if (count == 0 || maxRadiusKm < 0.0) {
+        return {};
+    }
+
+    // Grow the search radius until it holds enough available drivers. Every
+    // driver inside the radius is returned exactly, so once `count` of them
+    // are found the nearest `count` are guaranteed to be among them.
+    double radiusKm = std::min(m_cellSizeKm, maxRadiusKm);
+    while (true) {
+        candidates.clear();
+        for (const auto& driver : queryRadius(center, radiusKm)) {
+            if (driver->isAvailable()) {
+                candidates.emplace_back(driver->calculateDistanceFrom(center), driver);
+            }
+        }
+        if (candidates.size() >= count || radiusKm >= maxRadiusKm) {
+            break;
+        }
+        radiusKm = std::min(radiusKm * 2.0, maxRadiusKm);
+    }
+
+    size_t resultSize = std::min(count, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + resultSize, candidates.end(),
+                      [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    std::vector<DriverPtr> result;
+    result.reserve(resultSize);
+    for (size_t i = 0; i < resultSize; ++i) {
+        result.push_back(candidates[i].second);
+    }
+    return result;
+}
+
+bool SpatialIndex::contains(const std::string& driverId) const {
+    return m_entries.count(driverId) > 0;
+}
+
+// Helper methods
+int32_t SpatialIndex::rowFor(double latitude) const {
+    return static_cast<int32_t>(std::floor((latitude + 90.0) / m_cellSizeDegrees));
+}
+
+int32_t SpatialIndex::columnFor(double longitude) const {
+    return static_cast<int32_t>(std::floor((longitude + 180.0) / m_cellSizeDegrees));
+}
+
+int64_t SpatialIndex::cellKeyFor(const Driver::Location& location) const {
+    return makeCellKey(rowFor(location.latitude), columnFor(location.longitude));
+}
+
+int64_t SpatialIndex::makeCellKey(int32_t row, int32_t column) {
+    return (static_cast<int64_t>(row) << 32) | static_cast<uint32_t>(column);
+}
+
+void SpatialIndex::detach(const Entry& entry) {
+    auto cell = m_cells.find(entry.cellKey);
+    if (cell == m_cells.end()) {
+        return;
+    }
+
+    // Swap-and-pop, then fix up the slot of the driver that moved into the hole
+    auto& bucket = cell->second;
+    if (entry.slot + 1 != bucket.size()) {
+        bucket[entry.slot] = std::move(bucket.back());
+        m_entries[bucket[entry.slot]->getId()].slot = entry.slot;
+    }
+    bucket.pop_back();
+
+    if (bucket.empty()) {
+        m_cells.erase(cell);
+    }
+}
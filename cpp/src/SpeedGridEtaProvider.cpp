@@ -0,0 +1,186 @@
+#include "SpeedGridEtaProvider.h"
+#include "BinarySnapshot.h"
+#include "DistanceKernel.h"
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+
+namespace {
+    constexpr char SPEED_GRID_MAGIC[8] = {'U', 'F', 'D', 'S', 'P', 'E', 'E', 'D'};
+
+    uint64_t planeCells(uint32_t rows, uint32_t columns) {
+        return uint64_t(rows) * columns;
+    }
+}
+
+// Constructor
+SpeedGridEtaProvider::SpeedGridEtaProvider(double fallbackSpeedKmh)
+    : m_file(), m_header(nullptr), m_speeds(nullptr), m_inverseCellSize(0.0),
+      m_fallbackSpeedKmh(fallbackSpeedKmh > 0.0 ? fallbackSpeedKmh : ConstantSpeedEtaProvider::DEFAULT_SPEED_KMH),
+      m_lastError("") {
+}
+
+// Writing
+bool SpeedGridEtaProvider::write(const std::string& filename, const GridSpec& spec,
+                                 const std::vector<float>& speedsKmh, std::string* error) {
+    auto reportError = [error](const std::string& message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+
+    if (spec.rows == 0 || spec.columns == 0 || !(spec.cellSizeDegrees > 0.0)) {
+        return reportError("grid needs positive dimensions and cell size");
+    }
+    if (speedsKmh.size() != HOURS_PER_DAY * planeCells(spec.rows, spec.columns)) {
+        return reportError("expected " + std::to_string(HOURS_PER_DAY * planeCells(spec.rows, spec.columns)) +
+                           " speeds, got " + std::to_string(speedsKmh.size()));
+    }
+
+    size_t speedBytes = speedsKmh.size() * sizeof(float);
+    std::vector<char> buffer(sizeof(Header) + speedBytes);
+    std::memcpy(buffer.data() + sizeof(Header), speedsKmh.data(), speedBytes);
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SPEED_GRID_MAGIC, sizeof(header.magic));
+    header.version = FORMAT_VERSION;
+    header.headerSize = sizeof(Header);
+    header.minLatitude = spec.minLatitude;
+    header.minLongitude = spec.minLongitude;
+    header.cellSizeDegrees = spec.cellSizeDegrees;
+    header.rows = spec.rows;
+    header.columns = spec.columns;
+    header.utcOffsetMinutes = spec.utcOffsetMinutes;
+    header.fileSize = buffer.size();
+    header.checksum = BinarySnapshot::checksum(buffer.data() + sizeof(Header), speedBytes);
+    std::memcpy(buffer.data(), &header, sizeof(header));
+
+    // Temporary file and rename, so a provider never maps a half-written grid
+    std::string tempName = filename + ".tmp";
+    {
+        std::ofstream file(tempName, std::ios::binary | std::ios::trunc);
+        if (!file.write(buffer.data(), static_cast<std::streamsize>(buffer.size())) || !file.flush()) {
+            std::remove(tempName.c_str());
+            return reportError("failed to write " + tempName);
+        }
+    }
+    if (std::rename(tempName.c_str(), filename.c_str()) != 0) {
+        std::remove(tempName.c_str());
+        return reportError("failed to rename speed grid to " + filename);
+    }
+    return true;
+}
+
+// Reading
+bool SpeedGridEtaProvider::open(const std::string& filename, bool verifyChecksum) {
+    close();
+
+    if (!m_file.open(filename)) {
+        return fail("cannot map " + filename);
+    }
+    if (m_file.size() < sizeof(Header)) {
+        return fail("file too small for a speed grid header");
+    }
+
+    const auto* header = reinterpret_cast<const Header*>(m_file.data());
+    if (std::memcmp(header->magic, SPEED_GRID_MAGIC, sizeof(SPEED_GRID_MAGIC)) != 0) {
+        return fail("bad magic");
+    }
+    if (header->version != FORMAT_VERSION || header->headerSize != sizeof(Header)) {
+        return fail("unsupported speed grid version " + std::to_string(header->version));
+    }
+    if (header->rows == 0 || header->columns == 0 || !(header->cellSizeDegrees > 0.0)) {
+        return fail("grid dimensions are invalid");
+    }
+    uint64_t speedBytes = HOURS_PER_DAY * planeCells(header->rows, header->columns) * sizeof(float);
+    if (header->fileSize != m_file.size() || sizeof(Header) + speedBytes != m_file.size()) {
+        return fail("file size does not match grid dimensions");
+    }
+    if (verifyChecksum && BinarySnapshot::checksum(m_file.data() + sizeof(Header), speedBytes) != header->checksum) {
+        return fail("checksum mismatch");
+    }
+
+    m_header = header;
+    m_speeds = reinterpret_cast<const float*>(m_file.data() + sizeof(Header));
+    m_inverseCellSize = 1.0 / header->cellSizeDegrees;
+    m_lastError.clear();
+    return true;
+}
+
+void SpeedGridEtaProvider::close() {
+    m_file.close();
+    m_header = nullptr;
+    m_speeds = nullptr;
+    m_inverseCellSize = 0.0;
+}
+
+// Lookups
+double SpeedGridEtaProvider::getSpeedKmh(const Driver::Location& location, TimePoint time) const {
+    return speedAt(plane(time), location.latitude, location.longitude);
+}
+
+int SpeedGridEtaProvider::getHourOfDay(TimePoint time) const {
+    const int64_t hoursPerDay = HOURS_PER_DAY;
+    int64_t hour = getDepartureHour(time) % hoursPerDay;
+    return static_cast<int>(hour < 0 ? hour + hoursPerDay : hour);
+}
+
+int64_t SpeedGridEtaProvider::getDepartureHour(TimePoint departure) const {
+    int64_t minutes = std::chrono::floor<std::chrono::minutes>(departure).time_since_epoch().count();
+    if (m_header) {
+        minutes += m_header->utcOffsetMinutes;
+    }
+    return minutes / 60 - (minutes % 60 < 0 ? 1 : 0); // Floor division before the epoch
+}
+
+// EtaProvider
+double SpeedGridEtaProvider::estimateMinutes(const Driver::Location& from, const Driver::Location& to,
+                                             TimePoint departure) const {
+    double cosLatitude = std::cos(from.latitude * M_PI / 180.0);
+    double distanceKm;
+    DistanceKernel::haversineBatch(to, &from.latitude, &from.longitude, &cosLatitude, 1, &distanceKm);
+    estimateBatch(to, &from.latitude, &from.longitude, &distanceKm, 1, departure, &distanceKm);
+    return distanceKm;
+}
+
+void SpeedGridEtaProvider::estimateBatch(const Driver::Location& destination, const double* latitudes,
+                                         const double* longitudes, const double* distancesKm, size_t count,
+                                         TimePoint departure, double* etaMinutes) const {
+    // One plane for the whole batch; minutes = distance / mean(speeds) * 60
+    const float* speeds = plane(departure);
+    const double destinationSpeed = speedAt(speeds, destination.latitude, destination.longitude);
+    for (size_t i = 0; i < count; ++i) {
+        double originSpeed = speedAt(speeds, latitudes[i], longitudes[i]);
+        etaMinutes[i] = distancesKm[i] * 120.0 / (originSpeed + destinationSpeed);
+    }
+}
+
+// Helpers
+const float* SpeedGridEtaProvider::plane(TimePoint time) const {
+    if (!m_speeds) {
+        return nullptr;
+    }
+    return m_speeds + getHourOfDay(time) * planeCells(m_header->rows, m_header->columns);
+}
+
+double SpeedGridEtaProvider::speedAt(const float* plane, double latitude, double longitude) const {
+    if (!plane) {
+        return m_fallbackSpeedKmh;
+    }
+    double row = (latitude - m_header->minLatitude) * m_inverseCellSize;
+    double column = (longitude - m_header->minLongitude) * m_inverseCellSize;
+    // Written so NaN coordinates also take the fallback
+    if (!(row >= 0.0 && row < m_header->rows && column >= 0.0 && column < m_header->columns)) {
+        return m_fallbackSpeedKmh;
+    }
+    float speed = plane[static_cast<size_t>(row) * m_header->columns + static_cast<size_t>(column)];
+    return speed > 0.0f ? speed : m_fallbackSpeedKmh;
+}
+
+bool SpeedGridEtaProvider::fail(const std::string& message) {
+    m_lastError = message;
+    return false;
+}
@@ -0,0 +1,216 @@
+#include "TimerWheel.h"
+#include <algorithm>
+#include <utility>
+
+// Constructor
+TimerWheel::TimerWheel(std::chrono::milliseconds tickDuration, Clock clock)
+    : m_clock(clock ? std::move(clock) : Clock(std::chrono::steady_clock::now)),
+      m_tickDuration(std::max(tickDuration, std::chrono::milliseconds(1))),
+      m_origin(m_clock()), m_currentTick(0), m_pending(0), m_running(false) {
+    for (auto& level : m_slots) {
+        std::fill(std::begin(level), std::end(level), NIL);
+    }
+}
+
+// Destructor
+TimerWheel::~TimerWheel() {
+    stop();
+}
+
+// Timer management
+TimerWheel::TimerId TimerWheel::schedule(std::chrono::milliseconds delay, Callback callback) {
+    if (!callback) {
+        return INVALID_TIMER;
+    }
+
+    auto now = m_clock();
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Round up so a timer never fires before its delay has elapsed
+    uint64_t delayTicks = static_cast<uint64_t>((std::max(delay, std::chrono::milliseconds(0)) + m_tickDuration
+                                                 - std::chrono::steady_clock::duration(1)) / m_tickDuration);
+    uint64_t expiry = std::max(m_currentTick + 1, ticksUntil(now) + std::max<uint64_t>(delayTicks, 1));
+
+    // Clamp to the wheel's horizon
+    const uint64_t horizon = (uint64_t(1) << (SLOT_BITS * LEVELS)) - 1;
+    expiry = std::min(expiry, m_currentTick + horizon);
+
+    uint32_t index;
+    if (!m_freeNodes.empty()) {
+        index = m_freeNodes.back();
+        m_freeNodes.pop_back();
+    } else {
+        index = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+
+    Node& node = m_nodes[index];
+    node.callback = std::move(callback);
+    node.expiryTick = expiry;
+    node.generation++;
+    node.armed = true;
+    link(index);
+    m_pending++;
+
+    return makeId(index, node.generation);
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    uint32_t index = static_cast<uint32_t>(id & 0xFFFFFFFFu);
+    uint32_t generation = static_cast<uint32_t>(id >> 32);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (id == INVALID_TIMER || index >= m_nodes.size()) {
+        return false;
+    }
+
+    Node& node = m_nodes[index];
+    if (!node.armed || node.generation != generation) {
+        return false; // Already fired, cancelled or reused
+    }
+
+    unlink(index);
+    release(index);
+    m_pending--;
+    return true;
+}
+
+size_t TimerWheel::advance() {
+    std::vector<Callback> expired;
+    {
+        auto now = m_clock();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        uint64_t target = ticksUntil(now);
+
+        while (m_currentTick < target) {
+            if (m_pending == 0) {
+                m_currentTick = target; // Nothing armed, skip the idle ticks
+                break;
+            }
+
+            m_currentTick++;
+
+            // Pull timers down from the coarser levels whose slot boundary we crossed
+            for (int level = LEVELS - 1; level > 0; --level) {
+                if ((m_currentTick & ((uint64_t(1) << (SLOT_BITS * level)) - 1)) == 0) {
+                    cascade(level);
+                }
+            }
+
+            uint32_t& head = m_slots[0][m_currentTick & SLOT_MASK];
+            while (head != NIL) {
+                uint32_t index = head;
+                unlink(index);
+                expired.push_back(std::move(m_nodes[index].callback));
+                release(index);
+                m_pending--;
+            }
+        }
+    }
+
+    for (auto& callback : expired) {
+        callback();
+    }
+    return expired.size();
+}
+
+// Background driver
+void TimerWheel::start() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running) {
+        return;
+    }
+
+    m_running = true;
+    m_thread = std::thread([this]() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (m_running) {
+            m_wakeup.wait_for(lock, m_tickDuration);
+            lock.unlock();
+            advance();
+            lock.lock();
+        }
+    });
+}
+
+void TimerWheel::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) {
+            return;
+        }
+        m_running = false;
+    }
+    m_wakeup.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+size_t TimerWheel::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pending;
+}
+
+// Helper methods
+void TimerWheel::link(uint32_t index) {
+    Node& node = m_nodes[index];
+    uint64_t delta = node.expiryTick > m_currentTick ? node.expiryTick - m_currentTick : 0;
+
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (uint64_t(1) << (SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+
+    node.level = static_cast<uint16_t>(level);
+    node.slot = static_cast<uint16_t>((node.expiryTick >> (SLOT_BITS * level)) & SLOT_MASK);
+    node.prev = NIL;
+    node.next = m_slots[level][node.slot];
+    if (node.next != NIL) {
+        m_nodes[node.next].prev = index;
+    }
+    m_slots[level][node.slot] = index;
+}
+
+void TimerWheel::unlink(uint32_t index) {
+    Node& node = m_nodes[index];
+    if (node.prev != NIL) {
+        m_nodes[node.prev].next = node.next;
+    } else {
+        m_slots[node.level][node.slot] = node.next;
+    }
+    if (node.next != NIL) {
+        m_nodes[node.next].prev = node.prev;
+    }
+    node.prev = node.next = NIL;
+}
+
+void TimerWheel::release(uint32_t index) {
+    Node& node = m_nodes[index];
+    node.armed = false;
+    node.callback = nullptr;
+    m_freeNodes.push_back(index);
+}
+
+void TimerWheel::cascade(int level) {
+    uint32_t slot = static_cast<uint32_t>((m_currentTick >> (SLOT_BITS * level)) & SLOT_MASK);
+    uint32_t index = m_slots[level][slot];
+    m_slots[level][slot] = NIL;
+
+    while (index != NIL) {
+        uint32_t next = m_nodes[index].next;
+        link(index);
+        index = next;
+    }
+}
+
+uint64_t TimerWheel::ticksUntil(std::chrono::steady_clock::time_point time) const {
+    if (time <= m_origin) {
+        return 0;
+    }
+    return static_cast<uint64_t>((time - m_origin) / m_tickDuration);
+}
+
+TimerWheel::TimerId TimerWheel::makeId(uint32_t index, uint32_t generation) {
+    return (static_cast<uint64_t>(generation) << 32) | index;
+}
@@ -0,0 +1,155 @@
+#include "WorkerPool.h"
+#include <algorithm>
+#include <chrono>
+
+// Constructor
+WorkerPool::WorkerPool(size_t threadCount, size_t queueCapacity)
+    : m_nextQueue(0), m_accepting(true), m_stopping(false), m_activeSubmitters(0), m_sleepingWorkers(0),
+      m_submitted(0), m_rejected(0), m_completed(0), m_failedTasks(0), m_stolen(0) {
+    threadCount = std::max<size_t>(1, threadCount);
+    size_t perWorkerCapacity = std::max<size_t>(1, queueCapacity / threadCount);
+
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_queues.push_back(std::make_unique<BoundedMpmcQueue<Task>>(perWorkerCapacity));
+    }
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_workers.emplace_back(&WorkerPool::workerLoop, this, i);
+    }
+}
+
+// Destructor
+WorkerPool::~WorkerPool() {
+    shutdown();
+}
+
+// Task submission
+WorkerPool::SubmitStatus WorkerPool::submit(Task task) {
+    // Registering before the check lets shutdown() wait out in-flight pushes
+    m_activeSubmitters.fetch_add(1);
+    if (!m_accepting.load()) {
+        m_activeSubmitters.fetch_sub(1);
+        m_rejected.fetch_add(1, std::memory_order_relaxed);
+        return SubmitStatus::SHUT_DOWN;
+    }
+
+    // Start at the round-robin queue and fall through to the others when full
+    size_t start = m_nextQueue.fetch_add(1, std::memory_order_relaxed);
+    bool pushed = false;
+    for (size_t i = 0; i < m_queues.size() && !pushed; ++i) {
+        pushed = m_queues[(start + i) % m_queues.size()]->tryPush(std::move(task));
+    }
+
+    if (!pushed) {
+        m_activeSubmitters.fetch_sub(1);
+        m_rejected.fetch_add(1, std::memory_order_relaxed);
+        return SubmitStatus::QUEUE_FULL;
+    }
+    m_submitted.fetch_add(1, std::memory_order_relaxed);
+    m_activeSubmitters.fetch_sub(1);
+
+    // Pairs with the fence in workerLoop so a parking worker cannot miss this task
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_sleepingWorkers.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(m_idleMutex);
+        m_idleCondition.notify_one();
+    }
+    return SubmitStatus::ACCEPTED;
+}
+
+void WorkerPool::shutdown() {
+    m_accepting.store(false);
+    while (m_activeSubmitters.load() > 0) {
+        std::this_thread::yield();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_idleMutex);
+        m_stopping.store(true, std::memory_order_release);
+    }
+    m_idleCondition.notify_all();
+
+    for (auto& worker : m_workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+size_t WorkerPool::getCapacity() const {
+    size_t capacity = 0;
+    for (const auto& queue : m_queues) {
+        capacity += queue->capacity();
+    }
+    return capacity;
+}
+
+WorkerPool::Stats WorkerPool::getStats() const {
+    Stats stats;
+    stats.submitted = m_submitted.load(std::memory_order_relaxed);
+    stats.rejected = m_rejected.load(std::memory_order_relaxed);
+    stats.completed = m_completed.load(std::memory_order_relaxed);
+    stats.failedTasks = m_failedTasks.load(std::memory_order_relaxed);
+    stats.stolen = m_stolen.load(std::memory_order_relaxed);
+    for (const auto& queue : m_queues) {
+        stats.queued += queue->sizeApprox();
+    }
+    return stats;
+}
+
+// Worker internals
+void WorkerPool::workerLoop(size_t self) {
+    Task task;
+    while (true) {
+        if (tryTakeTask(self, task)) {
+            try {
+                task();
+            } catch (...) {
+                // A throwing callback must not take the worker down
+                m_failedTasks.fetch_add(1, std::memory_order_relaxed);
+            }
+            task = nullptr;
+            m_completed.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        // Queues drained: exit if shutting down, otherwise park
+        if (m_stopping.load(std::memory_order_acquire)) {
+            if (allQueuesEmpty()) {
+                return;
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_idleMutex);
+        m_sleepingWorkers.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (allQueuesEmpty() && !m_stopping.load(std::memory_order_acquire)) {
+            // Timed wait as a safety net; submit() notifies on every enqueue
+            m_idleCondition.wait_for(lock, std::chrono::milliseconds(50));
+        }
+        m_sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+bool WorkerPool::tryTakeTask(size_t self, Task& task) {
+    if (m_queues[self]->tryPop(task)) {
+        return true;
+    }
+
+    // Steal from the other workers, nearest neighbour first
+    for (size_t i = 1; i < m_queues.size(); ++i) {
+        if (m_queues[(self + i) % m_queues.size()]->tryPop(task)) {
+            m_stolen.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool WorkerPool::allQueuesEmpty() const {
+    for (const auto& queue : m_queues) {
+        if (!queue->emptyApprox()) {
+            return false;
+        }
+    }
+    return true;
+}
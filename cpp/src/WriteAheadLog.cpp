@@ -0,0 +1,524 @@
+#include "WriteAheadLog.h"
+#include "BinarySnapshot.h"
+#include "FileSync.h"
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    constexpr char SEGMENT_MAGIC[8] = {'U', 'F', 'D', 'W', 'A', 'L', '1', '\0'};
+    constexpr size_t SEGMENT_HEADER_SIZE = sizeof(SEGMENT_MAGIC) + sizeof(uint64_t);
+    constexpr size_t FRAME_HEADER_SIZE = sizeof(uint32_t) + sizeof(uint64_t);
+    constexpr uint32_t MAX_RECORD_BYTES = 64 * 1024 * 1024;
+
+    const std::string SEGMENT_PREFIX = "wal-";
+    const std::string SEGMENT_SUFFIX = ".log";
+    const std::string CHECKPOINT_PREFIX = "checkpoint-";
+    const std::string CHECKPOINT_SUFFIX = ".snap";
+
+    template <typename T>
+    void appendRaw(std::string& out, T value) {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        out.append(bytes, sizeof(T));
+    }
+
+    void appendString(std::string& out, const std::string& value) {
+        appendRaw<uint32_t>(out, static_cast<uint32_t>(value.size()));
+        out.append(value);
+    }
+
+    // Bounds-checked reader over one record payload
+    class PayloadReader {
+    private:
+        const char* m_data;
+        size_t m_size;
+        size_t m_offset = 0;
+
+    public:
+        PayloadReader(const char* data, size_t size) : m_data(data), m_size(size) {}
+
+        template <typename T>
+        bool read(T& value) {
+            if (m_size - m_offset < sizeof(T)) {
+                return false;
+            }
+            std::memcpy(&value, m_data + m_offset, sizeof(T));
+            m_offset += sizeof(T);
+            return true;
+        }
+
+        bool readString(std::string& value) {
+            uint32_t length;
+            if (!read(length) || m_size - m_offset < length) {
+                return false;
+            }
+            value.assign(m_data + m_offset, length);
+            m_offset += length;
+            return true;
+        }
+
+        bool atEnd() const { return m_offset == m_size; }
+    };
+
+    std::string formatLsn(uint64_t lsn) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%020llu", static_cast<unsigned long long>(lsn));
+        return buffer;
+    }
+}
+
+// Constructor and Destructor
+WriteAheadLog::WriteAheadLog()
+    : m_directory(""), m_options(), m_pending(), m_nextLsn(1), m_pendingLastLsn(0), m_durableLsn(0),
+      m_recoveredLsn(0), m_recovered(false), m_recoveryFailed(false), m_segment(nullptr), m_segmentStartLsn(0), m_segmentBytes(0),
+      m_open(false), m_stopping(false), m_failed(false), m_stats() {
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    close();
+}
+
+// Lifecycle
+WriteAheadLog::RecoveryStats WriteAheadLog::recover(const std::string& directory,
+                                                    const CheckpointLoader& loadCheckpoint,
+                                                    const RecordHandler& apply) {
+    RecoveryStats stats;
+    m_directory = directory;
+
+    // Only the newest checkpoint is usable: the segments an older one would need
+    // were deleted when the newer one was taken. If it does not load, replaying
+    // the remaining log would start from partial state, so recovery fails.
+    auto checkpoints = listFiles(directory, CHECKPOINT_PREFIX, CHECKPOINT_SUFFIX);
+    if (!checkpoints.empty()) {
+        if (loadCheckpoint && !loadCheckpoint(checkpoints.back().second)) {
+            stats.failed = true;
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_recovered = true;
+            m_recoveryFailed = true;
+            return stats;
+        }
+        stats.loadedCheckpoint = static_cast<bool>(loadCheckpoint);
+        stats.checkpointLsn = checkpoints.back().first;
+    }
+    stats.lastLsn = stats.checkpointLsn;
+
+    for (const auto& segment : listFiles(directory, SEGMENT_PREFIX, SEGMENT_SUFFIX)) {
+        std::ifstream file(segment.second, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (bytes.size() < SEGMENT_HEADER_SIZE || std::memcmp(bytes.data(), SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) != 0) {
+            stats.truncatedTail = true;
+            break;
+        }
+
+        size_t offset = SEGMENT_HEADER_SIZE;
+        while (offset < bytes.size()) {
+            Record record;
+            size_t consumed = 0;
+            if (!decode(bytes.data() + offset, bytes.size() - offset, record, consumed)) {
+                break;
+            }
+            offset += consumed;
+            if (record.lsn > stats.checkpointLsn && apply) {
+                apply(record);
+                stats.replayedRecords++;
+            }
+            stats.lastLsn = std::max(stats.lastLsn, record.lsn);
+        }
+
+        if (offset < bytes.size()) {
+            // Torn or corrupt tail: cut it off so the log stays appendable and stop here
+            std::error_code error;
+            std::filesystem::resize_file(segment.second, offset, error);
+            stats.truncatedTail = true;
+            break;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_recoveredLsn = stats.lastLsn;
+    m_recovered = true;
+    m_recoveryFailed = false;
+    return stats;
+}
+
+bool WriteAheadLog::open(const std::string& directory, const Options& options) {
+    if (isOpen()) {
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        return false;
+    }
+
+    if (!m_recovered || m_directory != directory) {
+        recover(directory, nullptr, nullptr); // Only to find the last LSN
+    }
+    if (m_recoveryFailed) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> fileLock(m_fileMutex);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_directory = directory;
+    m_options = options;
+    m_nextLsn = m_recoveredLsn + 1;
+    m_pendingLastLsn = m_recoveredLsn;
+    m_durableLsn = m_recoveredLsn;
+    m_failed = false;
+    m_stats = Stats();
+    m_stats.durableLsn = m_durableLsn;
+
+    // Always start a fresh segment rather than appending after a possibly torn tail
+    if (!openSegment(m_nextLsn)) {
+        return false;
+    }
+
+    m_open = true;
+    m_stopping = false;
+    m_flusher = std::thread(&WriteAheadLog::flusherLoop, this);
+    return true;
+}
+
+void WriteAheadLog::close() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_open) {
+            return;
+        }
+        m_stopping = true;
+    }
+    m_flushNeeded.notify_all();
+    m_checkpointWakeup.notify_all();
+
+    if (m_checkpointer.joinable()) {
+        m_checkpointer.join();
+    }
+    if (m_flusher.joinable()) {
+        m_flusher.join(); // Drains pending records first
+    }
+
+    std::lock_guard<std::mutex> fileLock(m_fileMutex);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    closeSegment();
+    m_open = false;
+    m_recovered = false;
+    m_durableAdvanced.notify_all();
+}
+
+bool WriteAheadLog::isOpen() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_open;
+}
+
+// Appending
+uint64_t WriteAheadLog::append(Record record, bool waitDurable) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_open || m_stopping || m_failed) {
+        return 0;
+    }
+
+    record.lsn = m_nextLsn++;
+    m_pending += encode(record);
+    m_pendingLastLsn = record.lsn;
+    m_stats.appendedRecords++;
+    m_flushNeeded.notify_one();
+
+    if (waitDurable) {
+        m_durableAdvanced.wait(lock, [this, &record]() { return m_durableLsn >= record.lsn || !m_open || m_failed; });
+        if (m_durableLsn < record.lsn) {
+            return 0;
+        }
+    }
+    return record.lsn;
+}
+
+bool WriteAheadLog::waitDurable(uint64_t lsn) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_durableAdvanced.wait(lock, [this, lsn]() { return m_durableLsn >= lsn || !m_open || m_failed; });
+    return m_durableLsn >= lsn;
+}
+
+// Checkpoints
+bool WriteAheadLog::checkpoint(const CheckpointWriter& writer) {
+    std::lock_guard<std::mutex> checkpointLock(m_checkpointMutex);
+    uint64_t cutoff;
+    {
+        // Flush everything logged so far into the old segment, then rotate
+        std::lock_guard<std::mutex> fileLock(m_fileMutex);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_open || m_failed) {
+            return false;
+        }
+        if (!m_pending.empty()) {
+            if (!writeToSegment(m_pending)) {
+                failLog();
+                return false;
+            }
+            m_pending.clear();
+            recordFlush();
+            m_durableLsn = m_pendingLastLsn;
+            m_stats.durableLsn = m_durableLsn;
+            m_durableAdvanced.notify_all();
+        }
+        cutoff = m_nextLsn - 1;
+        closeSegment();
+        if (!openSegment(cutoff + 1)) {
+            failLog();
+            return false;
+        }
+    }
+
+    // The writer runs without log locks; appends continue into the new segment.
+    // The checkpoint must be durable under its final name before any log it
+    // replaces is deleted, or a crash could lose both.
+    std::string finalPath = checkpointPath(cutoff);
+    std::string tempPath = finalPath + ".tmp";
+    std::error_code error;
+    if (!writer(tempPath, cutoff) || !FileSync::syncPath(tempPath) || !FileSync::replaceFile(tempPath, finalPath)) {
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+
+    // Segments before the new one and older checkpoints are now redundant
+    for (const auto& segment : listFiles(m_directory, SEGMENT_PREFIX, SEGMENT_SUFFIX)) {
+        if (segment.first <= cutoff) {
+            std::filesystem::remove(segment.second, error);
+        }
+    }
+    for (const auto& checkpoint : listFiles(m_directory, CHECKPOINT_PREFIX, CHECKPOINT_SUFFIX)) {
+        if (checkpoint.first < cutoff) {
+            std::filesystem::remove(checkpoint.second, error);
+        }
+    }
+    if (!FileSync::syncDirectory(m_directory)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.checkpoints++;
+    return true;
+}
+
+void WriteAheadLog::startBackgroundCheckpoints(std::chrono::milliseconds interval, CheckpointWriter writer) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_open || m_checkpointer.joinable()) {
+        return;
+    }
+
+    m_checkpointer = std::thread([this, interval, writer]() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_stopping) {
+            if (m_checkpointWakeup.wait_for(lock, interval, [this]() { return m_stopping; })) {
+                break;
+            }
+            lock.unlock();
+            checkpoint(writer);
+            lock.lock();
+        }
+    });
+}
+
+WriteAheadLog::Stats WriteAheadLog::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+uint64_t WriteAheadLog::getDurableLsn() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_durableLsn;
+}
+
+// Record framing
+std::string WriteAheadLog::encode(const Record& record) {
+    std::string payload;
+    payload.reserve(32 + record.primaryId.size() + record.secondaryId.size() + record.payload.size());
+    appendRaw<uint64_t>(payload, record.lsn);
+    appendRaw<uint8_t>(payload, static_cast<uint8_t>(record.type));
+    appendString(payload, record.primaryId);
+    appendString(payload, record.secondaryId);
+    appendRaw<int64_t>(payload, record.value);
+    appendString(payload, record.payload);
+
+    std::string frame;
+    frame.reserve(FRAME_HEADER_SIZE + payload.size());
+    appendRaw<uint32_t>(frame, static_cast<uint32_t>(payload.size()));
+    appendRaw<uint64_t>(frame, BinarySnapshot::checksum(payload.data(), payload.size()));
+    frame += payload;
+    return frame;
+}
+
+bool WriteAheadLog::decode(const char* data, size_t size, Record& record, size_t& consumed) {
+    if (size < FRAME_HEADER_SIZE) {
+        return false;
+    }
+
+    uint32_t length;
+    uint64_t checksum;
+    std::memcpy(&length, data, sizeof(length));
+    std::memcpy(&checksum, data + sizeof(length), sizeof(checksum));
+    if (length > MAX_RECORD_BYTES || size - FRAME_HEADER_SIZE < length) {
+        return false;
+    }
+
+    const char* payload = data + FRAME_HEADER_SIZE;
+    if (BinarySnapshot::checksum(payload, length) != checksum) {
+        return false;
+    }
+
+    PayloadReader reader(payload, length);
+    uint8_t type;
+    if (!reader.read(record.lsn) || !reader.read(type) || !reader.readString(record.primaryId) ||
+        !reader.readString(record.secondaryId) || !reader.read(record.value) ||
+        !reader.readString(record.payload) || !reader.atEnd()) {
+        return false;
+    }
+    record.type = static_cast<RecordType>(type);
+    consumed = FRAME_HEADER_SIZE + length;
+    return true;
+}
+
+// Flusher
+void WriteAheadLog::flusherLoop() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_flushNeeded.wait(lock, [this]() { return !m_pending.empty() || m_stopping; });
+            if (m_pending.empty() && m_stopping) {
+                return;
+            }
+            // Group commit: give concurrent appenders a moment to join this batch
+            if (m_options.groupCommitWindow.count() > 0 && !m_stopping) {
+                m_flushNeeded.wait_for(lock, m_options.groupCommitWindow, [this]() { return m_stopping; });
+            }
+        }
+
+        std::lock_guard<std::mutex> fileLock(m_fileMutex);
+        std::string batch;
+        uint64_t batchLastLsn;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            batch.swap(m_pending);
+            batchLastLsn = m_pendingLastLsn;
+        }
+        if (batch.empty()) {
+            continue; // A checkpoint flushed it already
+        }
+
+        bool written = writeToSegment(batch);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (written) {
+            recordFlush();
+            m_durableLsn = batchLastLsn;
+            m_stats.durableLsn = batchLastLsn;
+            if (m_segmentBytes >= m_options.segmentBytes) {
+                closeSegment();
+                written = openSegment(batchLastLsn + 1);
+            }
+        }
+        if (!written) {
+            failLog();
+            return;
+        }
+        m_durableAdvanced.notify_all();
+    }
+}
+
+void WriteAheadLog::recordFlush() {
+    m_stats.flushedBatches++;
+    if (m_options.syncOnCommit) {
+        m_stats.syncs++;
+    }
+}
+
+void WriteAheadLog::failLog() {
+    // Cut the current segment back to its last complete frame so recovery
+    // replays everything before the failure instead of stopping at a torn
+    // batch; a segment without a whole header is removed outright
+    std::string path = segmentPath(m_segmentStartLsn);
+    closeSegment();
+    std::error_code error;
+    if (m_segmentBytes < SEGMENT_HEADER_SIZE) {
+        std::filesystem::remove(path, error);
+    } else {
+        std::filesystem::resize_file(path, m_segmentBytes, error);
+        FileSync::syncPath(path);
+    }
+
+    // Nothing past m_durableLsn reached the disk; its appenders get 0
+    m_pending.clear();
+    m_failed = true;
+    m_stats.failed = true;
+    m_durableAdvanced.notify_all();
+}
+
+// Segment helpers (m_fileMutex held)
+bool WriteAheadLog::openSegment(uint64_t startLsn) {
+    m_segmentStartLsn = startLsn;
+    m_segmentBytes = 0;
+    m_segment = std::fopen(segmentPath(startLsn).c_str(), "wb");
+    if (!m_segment) {
+        return false;
+    }
+
+    std::string header(SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+    appendRaw<uint64_t>(header, startLsn);
+    if (!writeToSegment(header)) {
+        return false;
+    }
+    // Records fsynced into a segment whose directory entry is not are still lost on a crash
+    return !m_options.syncOnCommit || FileSync::syncDirectory(m_directory);
+}
+
+void WriteAheadLog::closeSegment() {
+    if (m_segment) {
+        std::fclose(m_segment);
+        m_segment = nullptr;
+    }
+}
+
+bool WriteAheadLog::writeToSegment(const std::string& bytes) {
+    if (!m_segment || std::fwrite(bytes.data(), 1, bytes.size(), m_segment) != bytes.size() ||
+        std::fflush(m_segment) != 0) {
+        return false;
+    }
+    if (m_options.syncOnCommit && !FileSync::syncFile(m_segment)) {
+        return false;
+    }
+
+    m_segmentBytes += bytes.size();
+    return true;
+}
+
+std::vector<std::pair<uint64_t, std::string>> WriteAheadLog::listFiles(const std::string& directory,
+                                                                       const std::string& prefix,
+                                                                       const std::string& suffix) {
+    std::vector<std::pair<uint64_t, std::string>> files;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() <= prefix.size() + suffix.size() || name.compare(0, prefix.size(), prefix) != 0 ||
+            name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+            continue;
+        }
+        std::string number = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+        if (number.find_first_not_of("0123456789") != std::string::npos) {
+            continue;
+        }
+        files.emplace_back(std::stoull(number), entry.path().string());
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+std::string WriteAheadLog::segmentPath(uint64_t startLsn) const {
+    return (std::filesystem::path(m_directory) / (SEGMENT_PREFIX + formatLsn(startLsn) + SEGMENT_SUFFIX)).string();
+}
+
+std::string WriteAheadLog::checkpointPath(uint64_t lsn) const {
+    return (std::filesystem::path(m_directory) / (CHECKPOINT_PREFIX + formatLsn(lsn) + CHECKPOINT_SUFFIX)).string();
+}
@@ -1,10 +1,81 @@
 #include "Driver.h"
 #include "FavoriteDriverManager.h"
 #include "RideRequest.h"
+#include "SpatialIndex.h"
+#include "DriverPositionStore.h"
+#include "DistanceKernel.h"
+#include "ShardedMap.h"
+#include "TimerWheel.h"
+#include "WorkerPool.h"
+#include "BinarySnapshot.h"
+#include "WriteAheadLog.h"
+#include "JsonWriter.h"
+#include "JsonReader.h"
+#include "IdInterner.h"
+#include "SmallSortedSet.h"
+#include "FavoriteReverseIndex.h"
+#include "PopularityLeaderboard.h"
+#include "EtaProvider.h"
+#include "SpeedGridEtaProvider.h"
+#include "EtaCache.h"
+#include "RideRequestPool.h"
+#include "RequestIdGenerator.h"
+#include "AssignmentSolver.h"
+#include "DispatchBatcher.h"
+#include "PriorityScoreCache.h"
+#include "NotificationPipeline.h"
+#include "LatencyHistogram.h"
+#include "MetricsRegistry.h"
 #include <iostream>
 #include <cassert>
 #include <thread>
 #include <chrono>
+#include <random>
+#include <vector>
+#include <cmath>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <fstream>
+#include <cstdio>
+#include <filesystem>
+#include <shared_mutex>
+#include <queue>
+#include <condition_variable>
+#include <stdexcept>
+#include <functional>
+#include <cstdlib>
+#include <new>
+
+// Counts every global operator new so tests can report allocations per operation
+static std::atomic<size_t> heapAllocations{0};
+
+void* operator new(size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+// GCC flags the free() once these are inlined into std::allocator callers,
+// not seeing that the matching operator new above is malloc-based
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
 
 void testDriverBasicFunctionality() {
     std::cout << "Testing Driver basic functionality..." << std::endl;
@@ -72,6 +143,11 @@ void testRideRequestFunctionality() {
     assert(!request.isCompleted());
     assert(!request.isCancelled());
     
+    // Trip duration comes from the constant-speed ETA provider
+    ConstantSpeedEtaProvider cityTraffic;
+    assert(request.getEstimatedDurationMinutes() ==
+           static_cast<int>(std::ceil(cityTraffic.estimateMinutes(pickup, dropoff, request.getRequestTime()))));
+    
     // Test address setting
     request.setPickupAddress("123 Main St, San Francisco");
     request.setDropoffAddress("456 Market St, San Francisco");
@@ -217,6 +293,2613 @@ void testRideRequestFlow() {
     std::cout << "✓ Complete ride request flow tests passed" << std::endl;
 }
 
+void testSpatialIndex() {
+    std::cout << "Testing SpatialIndex functionality..." << std::endl;
+    
+    SpatialIndex index(1.0);
+    
+    auto near = std::make_shared<Driver>("driver_near", "Near Driver", "+1111111111");
+    near->goOnline();
+    near->updateLocation(37.7750, -122.4195);
+    
+    auto mid = std::make_shared<Driver>("driver_mid", "Mid Driver", "+2222222222");
+    mid->goOnline();
+    mid->updateLocation(37.8049, -122.4194); // ~3.3km north
+    
+    auto far = std::make_shared<Driver>("driver_far", "Far Driver", "+3333333333");
+    far->goOnline();
+    far->updateLocation(38.5816, -121.4944); // Sacramento
+    
+    auto offline = std::make_shared<Driver>("driver_offline", "Offline Driver", "+4444444444");
+    offline->updateLocation(37.7749, -122.4194);
+    
+    assert(index.insert(near));
+    assert(index.insert(mid));
+    assert(index.insert(far));
+    assert(index.insert(offline));
+    assert(!index.insert(near)); // Duplicate
+    assert(index.size() == 4);
+    
+    // Radius queries only return drivers within the radius
+    Driver::Location pickup(37.7749, -122.4194);
+    assert(index.queryRadius(pickup, 1.0).size() == 2);
+    assert(index.queryRadius(pickup, 5.0).size() == 3);
+    assert(index.queryRadius(pickup, 200.0).size() == 4);
+    
+    // k-nearest skips unavailable drivers and orders by distance
+    auto nearest = index.findNearestAvailable(pickup, 2, 15.0);
+    assert(nearest.size() == 2);
+    assert(nearest[0]->getId() == "driver_near");
+    assert(nearest[1]->getId() == "driver_mid");
+    
+    // Moving a driver re-buckets it through the location listener
+    mid->setLocationListener([&index](const Driver& driver) { index.update(driver); });
+    mid->updateLocation(38.5800, -121.4900);
+    assert(index.queryRadius(pickup, 5.0).size() == 2);
+    assert(index.findNearestAvailable(pickup, 5, 15.0).size() == 1);
+    
+    // Removal
+    assert(index.remove("driver_near"));
+    assert(!index.remove("driver_near"));
+    assert(!index.contains("driver_near"));
+    assert(index.queryRadius(pickup, 1.0).size() == 1);
+    
+    // Queries across the antimeridian
+    auto dateline = std::make_shared<Driver>("driver_dateline", "Dateline Driver", "+5555555555");
+    dateline->goOnline();
+    dateline->updateLocation(0.0, 179.999);
+    index.insert(dateline);
+    assert(index.queryRadius(Driver::Location(0.0, -179.999), 1.0).size() == 1);
+    
+    // Grid queries agree with a linear scan over a random fleet
+    {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<double> offset(-0.25, 0.25); // ~55km square
+        std::vector<std::shared_ptr<Driver>> fleet;
+        SpatialIndex grid;
+        for (int i = 0; i < 2000; ++i) {
+            auto driver = std::make_shared<Driver>("driver_" + std::to_string(i), "Driver", "+1000000000");
+            if (i % 2 == 0) driver->goOnline();
+            driver->updateLocation(pickup.latitude + offset(rng), pickup.longitude + offset(rng));
+            fleet.push_back(driver);
+            grid.insert(driver);
+        }
+        size_t scanFound = 0;
+        for (const auto& driver : fleet) {
+            if (driver->calculateDistanceFrom(pickup) <= 5.0) ++scanFound;
+        }
+        assert(grid.queryRadius(pickup, 5.0).size() == scanFound);
+        
+        auto closest = grid.findNearestAvailable(pickup, 10, 15.0);
+        assert(closest.size() == 10);
+        for (size_t i = 0; i < closest.size(); ++i) {
+            assert(closest[i]->isAvailable());
+            assert(i == 0 || closest[i - 1]->calculateDistanceFrom(pickup) <= closest[i]->calculateDistanceFrom(pickup));
+        }
+        
+        // Radii whose box holds far more cells than are occupied, including
+        // near the pole where the box spans every longitude, answer from the
+        // occupied cells and still match the scan
+        auto polar = std::make_shared<Driver>("driver_polar", "Polar Driver", "+1000000000");
+        polar->updateLocation(89.5, 10.0);
+        fleet.push_back(polar);
+        grid.insert(polar);
+        for (Driver::Location center : {pickup, Driver::Location(89.9, -170.0)}) {
+            for (double radiusKm : {500.0, 2000.0, 20000.0}) {
+                size_t expected = 0;
+                for (const auto& driver : fleet) {
+                    if (driver->isNearby(center, radiusKm)) ++expected;
+                }
+                assert(grid.queryRadius(center, radiusKm).size() == expected);
+            }
+        }
+        assert(grid.queryRadius(pickup, 2000.0).size() == fleet.size() - 1);
+    }
+    
+    std::cout << "✓ SpatialIndex functionality tests passed" << std::endl;
+}
+
+void testDriverPositionStore() {
+    std::cout << "Testing DriverPositionStore functionality..." << std::endl;
+    
+    DriverPositionStore store;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> latitude(-85.0, 85.0);
+    std::uniform_real_distribution<double> longitude(-180.0, 180.0);
+    
+    std::vector<Driver> drivers;
+    for (int i = 0; i < 257; ++i) { // Odd count exercises the scalar tail
+        Driver driver("driver_" + std::to_string(i), "Driver", "+1000000000");
+        driver.updateLocation(latitude(rng), longitude(rng));
+        if (i % 3 != 0) driver.goOnline();
+        drivers.push_back(driver);
+        assert(store.add(driver) == static_cast<size_t>(i));
+    }
+    assert(store.size() == drivers.size());
+    
+    // Batch kernel agrees with the scalar Haversine in Driver
+    Driver::Location origin(37.7749, -122.4194);
+    std::vector<double> distances;
+    store.computeDistances(origin, distances);
+    for (size_t i = 0; i < drivers.size(); ++i) {
+        assert(std::fabs(distances[i] - drivers[i].calculateDistanceFrom(origin)) < 1e-6);
+    }
+    
+    // Antipodal and identical points stay in range
+    Driver::Location antipode(-37.7749, 57.5806);
+    Driver same("driver_same", "Same", "+1"), opposite("driver_opposite", "Opposite", "+1");
+    same.updateLocation(origin.latitude, origin.longitude);
+    opposite.updateLocation(antipode.latitude, antipode.longitude);
+    store.add(same);
+    store.add(opposite);
+    store.computeDistances(origin, distances);
+    assert(distances[store.indexOf("driver_same")] < 1e-9);
+    assert(std::fabs(distances[store.indexOf("driver_opposite")] - M_PI * DistanceKernel::EARTH_RADIUS_KM) < 1e-6);
+    
+    // Filtering and ETA ranking
+    Driver close1("close_1", "Close", "+1"), close2("close_2", "Closer", "+1"), closeOffline("close_3", "Off", "+1");
+    close1.updateLocation(37.7849, -122.4194);
+    close1.goOnline();
+    close2.updateLocation(37.7760, -122.4194);
+    close2.goOnline();
+    closeOffline.updateLocation(37.7750, -122.4194);
+    store.add(close1);
+    store.add(close2);
+    store.add(closeOffline);
+    
+    auto within = store.filterByDistance(origin, 5.0);
+    assert(within.size() == 4); // Three close drivers plus driver_same
+    assert(store.filterByDistance(origin, 5.0, true).size() == 2);
+    assert(store.filterByDistance(within, origin, 0.5).size() == 3);
+    
+    auto ranked = store.rankByEta(origin, 2, 15.0);
+    assert(ranked.size() == 2);
+    assert(store.getDriverId(ranked[0].index) == "close_2");
+    assert(store.getDriverId(ranked[1].index) == "close_1");
+    assert(ranked[1].etaMinutes == close1.getEstimatedArrivalTime(origin));
+    
+    // Updates and swap-removal keep indexes consistent
+    close2.goOffline();
+    assert(store.update(close2));
+    assert(store.rankByEta(origin, 1, 15.0)[0].index == store.indexOf("close_1"));
+    assert(store.remove("driver_0"));
+    assert(!store.remove("driver_0"));
+    assert(store.indexOf("driver_0") == DriverPositionStore::npos);
+    assert(store.getDriverId(0) == "close_3");
+    assert(store.indexOf("close_3") == 0);
+    
+    std::cout << "✓ DriverPositionStore functionality tests passed (" 
+              << DistanceKernel::getInstructionSet() << " kernel)" << std::endl;
+}
+
+void testShardedMap() {
+    std::cout << "Testing ShardedMap functionality..." << std::endl;
+    
+    ShardedMap<std::string, std::unordered_set<std::string>> favorites(10);
+    assert(favorites.getShardCount() == 16); // Rounded up to a power of two
+    
+    // Upsert creates the set on first use
+    size_t count = favorites.upsert("user_001", [](std::unordered_set<std::string>& set) {
+        set.insert("driver_001");
+        set.insert("driver_002");
+        return set.size();
+    });
+    assert(count == 2);
+    assert(favorites.contains("user_001"));
+    assert(!favorites.contains("user_002"));
+    
+    bool isFavorite = false;
+    assert(favorites.read("user_001", [&isFavorite](const std::unordered_set<std::string>& set) {
+        isFavorite = set.count("driver_002") > 0;
+    }));
+    assert(isFavorite);
+    assert(!favorites.read("user_002", [](const std::unordered_set<std::string>&) {}));
+    
+    assert(favorites.modify("user_001", [](std::unordered_set<std::string>& set) { set.erase("driver_001"); }));
+    assert(favorites.find("user_001")->size() == 1);
+    assert(!favorites.find("user_002").has_value());
+    
+    assert(favorites.insert("user_002", {"driver_003"}));
+    assert(!favorites.insert("user_002", {}));
+    assert(favorites.size() == 2);
+    
+    size_t visited = 0;
+    favorites.forEach([&visited](const std::string&, const std::unordered_set<std::string>& set) {
+        visited += set.size();
+    });
+    assert(visited == 2);
+    
+    assert(favorites.erase("user_002"));
+    assert(!favorites.erase("user_002"));
+    favorites.clear();
+    assert(favorites.size() == 0);
+    
+    // Concurrent writers on disjoint and shared keys
+    ShardedMap<std::string, int> counters;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&counters, t]() {
+            for (int i = 0; i < 1000; ++i) {
+                counters.upsert("shared", [](int& value) { return ++value; });
+                counters.insertOrAssign("thread_" + std::to_string(t) + "_" + std::to_string(i), i);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    assert(*counters.find("shared") == 8000);
+    assert(counters.size() == 8001);
+    
+    // modifyOrErase drops entries the callback reports as finished; take hands the value back
+    assert(counters.modifyOrErase("shared", [](int& value) { return --value > 7998; }));
+    assert(*counters.find("shared") == 7999);
+    assert(counters.modifyOrErase("shared", [](int& value) { return --value > 7998; }));
+    assert(!counters.contains("shared"));
+    assert(*counters.take("thread_0_5") == 5);
+    assert(!counters.take("thread_0_5"));
+    
+    std::cout << "✓ ShardedMap functionality tests passed" << std::endl;
+}
+
+void testTimerWheel() {
+    std::cout << "Testing TimerWheel with a virtual clock..." << std::endl;
+    
+    using namespace std::chrono;
+    steady_clock::time_point now{};
+    TimerWheel wheel(milliseconds(10), [&now]() { return now; });
+    
+    std::vector<std::string> fired;
+    auto record = [&fired](const std::string& name) { return [&fired, name]() { fired.push_back(name); }; };
+    
+    auto timeout = wheel.schedule(seconds(30), record("timeout"));
+    auto cancelled = wheel.schedule(seconds(30), record("cancelled"));
+    wheel.schedule(milliseconds(5), record("short"));
+    wheel.schedule(hours(2), record("long")); // Lives in a coarse level until cascaded
+    assert(wheel.getPendingCount() == 4);
+    
+    // Nothing fires before its delay
+    now += milliseconds(9);
+    assert(wheel.advance() == 0);
+    now += milliseconds(1);
+    assert(wheel.advance() == 1);
+    assert(fired.back() == "short");
+    
+    // Cancel is O(1) and stale handles are rejected
+    assert(wheel.cancel(cancelled));
+    assert(!wheel.cancel(cancelled));
+    assert(!wheel.cancel(TimerWheel::INVALID_TIMER));
+    
+    now += seconds(29);
+    assert(wheel.advance() == 0);
+    now += seconds(1);
+    assert(wheel.advance() == 1);
+    assert(fired.back() == "timeout");
+    assert(!wheel.cancel(timeout)); // Already fired
+    
+    now += hours(2) - seconds(31);
+    assert(wheel.advance() == 0);
+    now += seconds(1);
+    assert(wheel.advance() == 1);
+    assert(fired.back() == "long");
+    assert(wheel.getPendingCount() == 0);
+    
+    // Callbacks may re-arm timers (timeout followed by fallback)
+    wheel.schedule(seconds(1), [&]() {
+        fired.push_back("first");
+        wheel.schedule(seconds(1), record("fallback"));
+    });
+    now += seconds(1);
+    wheel.advance();
+    now += seconds(1);
+    wheel.advance();
+    assert(fired.back() == "fallback");
+    
+    // Thousands of outstanding timers at scattered delays all fire in order of expiry
+    std::mt19937 rng(11);
+    std::vector<milliseconds> delays;
+    std::vector<milliseconds> firedAt;
+    auto base = now;
+    for (int i = 0; i < 5000; ++i) {
+        milliseconds delay(10 + rng() % 600000);
+        delays.push_back(delay);
+        wheel.schedule(delay, [&firedAt, &now, base]() { firedAt.push_back(duration_cast<milliseconds>(now - base)); });
+    }
+    for (int step = 0; step < 6100; ++step) {
+        now += milliseconds(100);
+        wheel.advance();
+    }
+    assert(firedAt.size() == delays.size());
+    std::sort(delays.begin(), delays.end());
+    for (size_t i = 0; i < delays.size(); ++i) {
+        assert(firedAt[i] >= delays[i] && firedAt[i] < delays[i] + milliseconds(110));
+    }
+    
+    // Background thread drives a real-clock wheel
+    TimerWheel realWheel(milliseconds(5));
+    std::atomic<bool> realFired{false};
+    realWheel.start();
+    realWheel.schedule(milliseconds(20), [&realFired]() { realFired = true; });
+    for (int i = 0; i < 200 && !realFired; ++i) {
+        std::this_thread::sleep_for(milliseconds(5));
+    }
+    realWheel.stop();
+    assert(realFired);
+    
+    std::cout << "✓ TimerWheel tests passed" << std::endl;
+}
+
+void testWorkerPool() {
+    std::cout << "Testing WorkerPool dispatch and backpressure..." << std::endl;
+    
+    // Lock-free queue basics
+    BoundedMpmcQueue<int> queue(3);
+    assert(queue.capacity() == 4);
+    for (int i = 0; i < 4; ++i) assert(queue.tryPush(int(i)));
+    assert(!queue.tryPush(4)); // Full
+    int value = -1;
+    assert(queue.tryPop(value) && value == 0);
+    assert(queue.tryPush(4));
+    for (int expected = 1; expected <= 4; ++expected) {
+        assert(queue.tryPop(value) && value == expected);
+    }
+    assert(!queue.tryPop(value));
+    
+    // A burst of 10k requests against a small pool: fixed thread count, excess rejected
+    std::atomic<int> executed{0};
+    std::atomic<bool> release{false};
+    int accepted = 0, rejected = 0;
+    {
+        WorkerPool pool(4, 256);
+        assert(pool.getThreadCount() == 4);
+        for (int i = 0; i < 10000; ++i) {
+            auto status = pool.submit([&executed, &release]() {
+                while (!release) std::this_thread::yield();
+                executed++;
+            });
+            if (status == WorkerPool::SubmitStatus::ACCEPTED) accepted++;
+            if (status == WorkerPool::SubmitStatus::QUEUE_FULL) rejected++;
+        }
+        assert(rejected > 0);
+        assert(accepted <= static_cast<int>(pool.getCapacity()) + 4); // Queued plus one in hand per worker
+        assert(pool.getStats().rejected == static_cast<uint64_t>(rejected));
+        release = true;
+        // Destructor drains the queue and joins
+    }
+    assert(executed == accepted);
+    
+    // Many producers, all accepted tasks run exactly once
+    std::atomic<int> sum{0};
+    WorkerPool pool(3, 1024);
+    std::vector<std::thread> producers;
+    std::atomic<int> acceptedTotal{0};
+    for (int p = 0; p < 4; ++p) {
+        producers.emplace_back([&pool, &sum, &acceptedTotal]() {
+            for (int i = 0; i < 2000; ++i) {
+                while (pool.submit([&sum]() { sum++; }) != WorkerPool::SubmitStatus::ACCEPTED) {
+                    std::this_thread::yield();
+                }
+                acceptedTotal++;
+            }
+        });
+    }
+    for (auto& producer : producers) producer.join();
+    pool.shutdown();
+    assert(sum == 8000);
+    assert(pool.getStats().completed == 8000);
+    assert(pool.submit([]() {}) == WorkerPool::SubmitStatus::SHUT_DOWN);
+    
+    // A throwing task is counted and the worker keeps running
+    std::atomic<int> afterThrow{0};
+    WorkerPool single(1, 16);
+    assert(single.submit([]() { throw std::runtime_error("callback failed"); }) == WorkerPool::SubmitStatus::ACCEPTED);
+    assert(single.submit([&afterThrow]() { afterThrow++; }) == WorkerPool::SubmitStatus::ACCEPTED);
+    single.shutdown();
+    assert(afterThrow == 1);
+    assert(single.getStats().failedTasks == 1);
+    assert(single.getStats().completed == 2);
+    
+    std::cout << "✓ WorkerPool tests passed" << std::endl;
+}
+
+void testBinarySnapshot() {
+    std::cout << "Testing BinarySnapshot round trip..." << std::endl;
+    
+    const std::string filename = "test_snapshot.bin";
+    
+    auto driver1 = std::make_shared<Driver>("driver_001", "Alice Smith", "+1111111111");
+    driver1->setEmail("alice@example.com");
+    driver1->setRating(4.8);
+    driver1->setCompletedTrips(120);
+    driver1->setVehicle(Driver::Vehicle("Toyota", "Camry", "Silver", "ABC-123", 2020));
+    driver1->setVerified(true);
+    driver1->goOnline();
+    driver1->updateLocation(37.7749, -122.4194);
+    
+    auto driver2 = std::make_shared<Driver>("driver_002", "Bob Johnson", "+2222222222");
+    driver2->setVehicle(Driver::Vehicle("Toyota", "Prius", "Silver", "XYZ-789", 2018));
+    driver2->updateLocation(37.7849, -122.4094);
+    
+    std::vector<BinarySnapshot::FavoriteList> favorites = {
+        {"user_001", {"driver_001", "driver_002"}},
+        {"user_002", {}},
+        {"user_003", {"driver_002", "driver_missing"}} // Unknown driver is dropped
+    };
+    assert(BinarySnapshot::write(filename, {driver1, driver2}, favorites));
+    
+    BinarySnapshot snapshot;
+    assert(snapshot.open(filename));
+    assert(snapshot.getDriverCount() == 2);
+    assert(snapshot.getUserCount() == 3);
+    assert(snapshot.getEdgeCount() == 3);
+    assert(snapshot.getDriverId(1) == "driver_002");
+    assert(snapshot.getLatitude(0) == 37.7749);
+    assert(snapshot.getStatus(0) == Driver::Status::ONLINE);
+    
+    Driver restored = snapshot.materializeDriver(0);
+    assert(restored.getId() == "driver_001");
+    assert(restored.getName() == "Alice Smith");
+    assert(restored.getEmail() == "alice@example.com");
+    assert(restored.getRating() == 4.8);
+    assert(restored.getCompletedTrips() == 120);
+    assert(restored.getVehicle().plateNumber == "ABC-123");
+    assert(restored.getVehicle().year == 2020);
+    assert(restored.isVerified());
+    assert(restored.isOnline());
+    assert(restored.getCurrentLocation().longitude == -122.4194);
+    
+    auto range = snapshot.getFavorites(0);
+    assert(range.second - range.first == 2);
+    assert(snapshot.getDriverId(range.first[1]) == "driver_002");
+    range = snapshot.getFavorites(1);
+    assert(range.first == range.second);
+    assert(snapshot.getUserId(2) == "user_003");
+    assert(snapshot.getFavorites(2).second - snapshot.getFavorites(2).first == 1);
+    snapshot.close();
+    
+    // Corruption is detected by the checksum
+    {
+        std::fstream file(filename, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(sizeof(BinarySnapshot::Header) + 3);
+        file.put('#');
+    }
+    assert(!snapshot.open(filename));
+    assert(snapshot.getLastError() == "checksum mismatch");
+    assert(!snapshot.open("missing_snapshot.bin"));
+    
+    // Every edge survives a larger round trip, with and without verification
+    {
+        std::mt19937 rng(3);
+        std::vector<std::shared_ptr<Driver>> fleet;
+        for (int i = 0; i < 1000; ++i) {
+            auto driver = std::make_shared<Driver>("driver_" + std::to_string(i), "Driver " + std::to_string(i), "+1000000000");
+            driver->updateLocation(37.0 + (rng() % 10000) / 10000.0, -122.0 - (rng() % 10000) / 10000.0);
+            fleet.push_back(driver);
+        }
+        std::vector<BinarySnapshot::FavoriteList> lists(1000);
+        for (int u = 0; u < 1000; ++u) {
+            lists[u].first = "user_" + std::to_string(u);
+            for (int k = 0; k < 10; ++k) {
+                lists[u].second.push_back("driver_" + std::to_string(rng() % 1000));
+            }
+        }
+        assert(BinarySnapshot::write(filename, fleet, lists));
+        for (bool verify : {false, true}) {
+            assert(snapshot.open(filename, verify));
+            uint64_t edges = 0;
+            for (uint32_t u = 0; u < snapshot.getUserCount(); ++u) {
+                auto favoritesOf = snapshot.getFavorites(u);
+                edges += favoritesOf.second - favoritesOf.first;
+            }
+            assert(edges == 10000);
+            snapshot.close();
+        }
+    }
+    
+    std::remove(filename.c_str());
+    std::cout << "✓ BinarySnapshot tests passed" << std::endl;
+}
+
+void testWriteAheadLog() {
+    std::cout << "Testing WriteAheadLog append, recovery and checkpoints..." << std::endl;
+    
+    const std::string directory = "test_wal";
+    std::filesystem::remove_all(directory);
+    
+    // Framing round trip
+    WriteAheadLog::Record record(WriteAheadLog::RecordType::DRIVER_STATUS, "driver_001", "", 2, "payload");
+    record.lsn = 42;
+    std::string frame = WriteAheadLog::encode(record);
+    WriteAheadLog::Record decoded;
+    size_t consumed = 0;
+    assert(WriteAheadLog::decode(frame.data(), frame.size(), decoded, consumed));
+    assert(consumed == frame.size());
+    assert(decoded.lsn == 42 && decoded.primaryId == "driver_001" && decoded.value == 2 && decoded.payload == "payload");
+    assert(!WriteAheadLog::decode(frame.data(), frame.size() - 1, decoded, consumed));
+    
+    WriteAheadLog::Options options;
+    options.syncOnCommit = false;
+    {
+        WriteAheadLog wal;
+        assert(wal.open(directory, options));
+        assert(wal.append(WriteAheadLog::Record(WriteAheadLog::RecordType::ADD_FAVORITE, "user_001", "driver_001")) == 1);
+        assert(wal.append(WriteAheadLog::Record(WriteAheadLog::RecordType::ADD_FAVORITE, "user_001", "driver_002")) == 2);
+        uint64_t lsn = wal.append(WriteAheadLog::Record(WriteAheadLog::RecordType::REMOVE_FAVORITE, "user_001", "driver_001"), false);
+        assert(wal.waitDurable(lsn));
+        assert(wal.getDurableLsn() == 3);
+    }
+    
+    // Replay everything in order
+    std::vector<WriteAheadLog::Record> replayed;
+    {
+        WriteAheadLog wal;
+        auto stats = wal.recover(directory, nullptr, [&](const WriteAheadLog::Record& r) { replayed.push_back(r); });
+        assert(stats.replayedRecords == 3 && stats.lastLsn == 3 && !stats.truncatedTail);
+        assert(replayed[2].type == WriteAheadLog::RecordType::REMOVE_FAVORITE);
+        
+        // LSNs continue after the recovered ones
+        assert(wal.open(directory, options));
+        assert(wal.append(WriteAheadLog::Record(WriteAheadLog::RecordType::REMOVE_DRIVER, "driver_003")) == 4);
+    }
+    
+    // A torn tail is cut off and the records before it survive
+    std::string newestSegment;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        std::string name = entry.path().string();
+        if (name > newestSegment) newestSegment = name;
+    }
+    {
+        std::ofstream file(newestSegment, std::ios::binary | std::ios::app);
+        file << "torn";
+    }
+    {
+        WriteAheadLog wal;
+        replayed.clear();
+        auto stats = wal.recover(directory, nullptr, [&](const WriteAheadLog::Record& r) { replayed.push_back(r); });
+        assert(stats.truncatedTail && stats.replayedRecords == 4 && stats.lastLsn == 4);
+        
+        // Checkpoint covers LSN 1-5; later records stay in the log
+        assert(wal.open(directory, options));
+        wal.append(WriteAheadLog::Record(WriteAheadLog::RecordType::ADD_DRIVER, "driver_004"));
+        uint64_t checkpointLsn = 0;
+        assert(wal.checkpoint([&](const std::string& path, uint64_t lsn) {
+            checkpointLsn = lsn;
+            std::ofstream(path) << "state@" << lsn;
+            return true;
+        }));
+        assert(checkpointLsn == 5);
+        wal.append(WriteAheadLog::Record(WriteAheadLog::RecordType::ADD_FAVORITE, "user_002", "driver_004"));
+        assert(wal.getStats().checkpoints == 1);
+    }
+    {
+        WriteAheadLog wal;
+        replayed.clear();
+        std::string loaded;
+        auto stats = wal.recover(directory,
+            [&](const std::string& path) { std::ifstream(path) >> loaded; return true; },
+            [&](const WriteAheadLog::Record& r) { replayed.push_back(r); });
+        assert(stats.loadedCheckpoint && stats.checkpointLsn == 5 && loaded == "state@5");
+        assert(replayed.size() == 1 && replayed[0].lsn == 6 && replayed[0].primaryId == "user_002");
+    }
+    {
+        // A checkpoint that does not load fails recovery rather than replaying onto partial state
+        WriteAheadLog wal;
+        replayed.clear();
+        auto stats = wal.recover(directory, [](const std::string&) { return false; },
+            [&](const WriteAheadLog::Record& r) { replayed.push_back(r); });
+        assert(stats.failed && !stats.loadedCheckpoint && replayed.empty());
+        assert(!wal.open(directory, options));
+    }
+    
+    // A failed write is not retried: the log stops accepting appends and the
+    // records made durable before it still replay
+    if (std::filesystem::exists("/dev/full")) {
+        std::filesystem::remove_all(directory);
+        WriteAheadLog::Options rotating = options;
+        rotating.segmentBytes = 1; // Rotate into the unwritable segment after the first batch
+        {
+            WriteAheadLog wal;
+            assert(wal.open(directory, rotating));
+            std::filesystem::create_symlink("/dev/full", directory + "/wal-00000000000000000002.log");
+            assert(wal.append(WriteAheadLog::Record(WriteAheadLog::RecordType::ADD_DRIVER, "driver_001")) == 1);
+            assert(wal.append(WriteAheadLog::Record(WriteAheadLog::RecordType::ADD_DRIVER, "driver_002")) == 0);
+            assert(wal.getStats().failed && wal.getDurableLsn() == 1);
+            assert(!wal.checkpoint([](const std::string&, uint64_t) { return true; }));
+        }
+        WriteAheadLog wal;
+        auto stats = wal.recover(directory, nullptr, [](const WriteAheadLog::Record&) {});
+        assert(stats.replayedRecords == 1 && stats.lastLsn == 1 && !stats.truncatedTail);
+    }
+    
+    // Concurrent durable appends share fsyncs and all replay
+    {
+        std::filesystem::remove_all(directory);
+        const int threads = 4, appendsPerThread = 50;
+        WriteAheadLog wal;
+        assert(wal.open(directory));
+        std::vector<std::thread> writers;
+        for (int t = 0; t < threads; ++t) {
+            writers.emplace_back([&wal, t]() {
+                for (int i = 0; i < appendsPerThread; ++i) {
+                    assert(wal.append(WriteAheadLog::Record(WriteAheadLog::RecordType::ADD_FAVORITE,
+                                                            "user_" + std::to_string(t), "driver_" + std::to_string(i))) > 0);
+                }
+            });
+        }
+        for (auto& writer : writers) writer.join();
+        auto walStats = wal.getStats();
+        wal.close();
+        assert(walStats.appendedRecords == threads * appendsPerThread);
+        assert(walStats.durableLsn == walStats.appendedRecords);
+        assert(walStats.syncs <= walStats.appendedRecords);
+        
+        WriteAheadLog replay;
+        auto recovery = replay.recover(directory, nullptr, [](const WriteAheadLog::Record&) {});
+        assert(recovery.replayedRecords == walStats.appendedRecords);
+    }
+    
+    std::filesystem::remove_all(directory);
+    std::cout << "✓ WriteAheadLog tests passed" << std::endl;
+}
+
+void testJsonSerialization() {
+    std::cout << "Testing JsonWriter/JsonReader..." << std::endl;
+    
+    // Writer: escaping, numbers and nesting
+    std::string json;
+    JsonWriter writer(json);
+    writer.beginObject();
+    writer.field("text", "quote\" slash\\ line\n tab\t \x01");
+    writer.field("pi", 3.141592653589793);
+    writer.field("count", -42);
+    writer.field("nan", std::nan(""));
+    writer.key("list");
+    writer.beginArray();
+    writer.value(true);
+    writer.nullValue();
+    writer.beginObject();
+    writer.endObject();
+    writer.endArray();
+    writer.endObject();
+    assert(json == "{\"text\":\"quote\\\" slash\\\\ line\\n tab\\t \\u0001\",\"pi\":3.141592653589793,"
+                   "\"count\":-42,\"nan\":null,\"list\":[true,null,{}]}");
+    
+    // Reader: tokens and decoded values round-trip
+    JsonReader reader(json);
+    using Token = JsonReader::Token;
+    assert(reader.next() == Token::BEGIN_OBJECT);
+    assert(reader.next() == Token::KEY && reader.getString() == "text");
+    assert(reader.next() == Token::STRING && reader.getString() == "quote\" slash\\ line\n tab\t \x01");
+    assert(reader.next() == Token::KEY && reader.getString() == "pi");
+    assert(reader.next() == Token::NUMBER && reader.getDouble() == 3.141592653589793);
+    assert(reader.next() == Token::KEY);
+    assert(reader.next() == Token::NUMBER && reader.getInt() == -42);
+    assert(reader.next() == Token::KEY);
+    assert(reader.next() == Token::NULL_VALUE);
+    assert(reader.next() == Token::KEY && reader.getString() == "list");
+    assert(reader.skipValue());
+    assert(reader.next() == Token::END_OBJECT);
+    assert(reader.next() == Token::END);
+    
+    JsonReader unicode("\"caf\\u00e9 \\ud83d\\ude95\"");
+    assert(unicode.next() == Token::STRING && unicode.getString() == "caf\xc3\xa9 \xf0\x9f\x9a\x95");
+    
+    // Malformed input is rejected with an offset
+    for (const char* bad : {"{\"a\":1,}", "[1 2]", "{\"a\" 1}", "01", "\"open", "[1]]", "{\"a\":tru}"}) {
+        JsonReader badReader(bad);
+        Token token;
+        do {
+            token = badReader.next();
+        } while (token != Token::END && token != Token::ERROR);
+        assert(token == Token::ERROR && badReader.failed());
+    }
+    
+    // Driver round trip, including characters the old serializer left unescaped
+    Driver driver("driver_001", "Ann \"The Driver\" O'Neil", "+1234567890");
+    driver.setEmail("ann@example.com");
+    driver.setRating(4.87);
+    driver.setCompletedTrips(512);
+    driver.setVehicle(Driver::Vehicle("Toyota", "Camry", "Silver", "ABC\\123", 2021));
+    driver.setVerified(true);
+    driver.goOnline();
+    driver.updateLocation(37.774929, -122.419416);
+    
+    Driver restored = Driver::fromJson(driver.toJson());
+    assert(restored.getId() == "driver_001");
+    assert(restored.getName() == driver.getName());
+    assert(restored.getRating() == 4.87);
+    assert(restored.getCompletedTrips() == 512);
+    assert(restored.getStatus() == Driver::Status::ONLINE);
+    assert(restored.getCurrentLocation().latitude == 37.774929);
+    assert(restored.getCurrentLocation().longitude == -122.419416);
+    assert(restored.getVehicle().plateNumber == "ABC\\123");
+    assert(restored.getVehicle().year == 2021);
+    assert(restored.isVerified());
+    
+    // Unknown members are skipped
+    Driver tolerant;
+    JsonReader extra("{\"id\":\"d9\",\"future\":{\"nested\":[1,2,{\"x\":null}]},\"rating\":3.5}");
+    assert(Driver::readJson(extra, tolerant));
+    assert(tolerant.getId() == "d9" && tolerant.getRating() == 3.5);
+    
+    // RideRequest round trip
+    RideRequest request("user_001", Driver::Location(37.7749, -122.4194), Driver::Location(37.7849, -122.4094),
+                        RideRequest::RideType::PREMIUM);
+    request.setPickupAddress("1 Market St");
+    request.setSpecialInstructions("Gate code \"42\"");
+    request.assignDriver("driver_001");
+    RideRequest restoredRequest = RideRequest::fromJson(request.toJson());
+    assert(restoredRequest.getRequestId() == request.getRequestId());
+    assert(restoredRequest.getRideType() == RideRequest::RideType::PREMIUM);
+    assert(restoredRequest.getStatus() == RideRequest::Status::DRIVER_NOTIFIED);
+    assert(restoredRequest.getSpecialInstructions() == "Gate code \"42\"");
+    assert(restoredRequest.getDropoffLocation().longitude == -122.4094);
+    
+    // Random drivers round-trip through a reused buffer and one Driver
+    {
+        std::mt19937 rng(11);
+        std::string buffer;
+        Driver parsed;
+        for (int i = 0; i < 200; ++i) {
+            Driver driver("driver_" + std::to_string(i), "Driver " + std::to_string(i), "+1555" + std::to_string(1000000 + i));
+            driver.setRating(4.0 + (rng() % 1000) / 1000.0);
+            driver.setVehicle(Driver::Vehicle("Toyota", "Camry", "Silver", "P-" + std::to_string(i), 2020));
+            driver.updateLocation(37.0 + (rng() % 100000) / 100000.0, -122.0 - (rng() % 100000) / 100000.0);
+            buffer.clear();
+            JsonWriter writer(buffer);
+            driver.writeJson(writer);
+            JsonReader reader(buffer);
+            assert(Driver::readJson(reader, parsed));
+            assert(parsed.getId() == driver.getId() && parsed.getRating() == driver.getRating());
+            assert(parsed.getVehicle().plateNumber == driver.getVehicle().plateNumber);
+            assert(parsed.getCurrentLocation().latitude == driver.getCurrentLocation().latitude);
+        }
+    }
+    
+    // Writing into a warm buffer allocates nothing, with strings too long
+    // for the small-string buffer
+    {
+        Driver longFields("drv-10000042-4c1a-9f3e-5b7d2e8a0c6f", "Alexandria Montgomery-Fitzgerald", "+15551234567890");
+        longFields.setEmail("alexandria.montgomery@example.com");
+        longFields.setVehicle(Driver::Vehicle("Mercedes-Benz Vans", "Sprinter Passenger", "Obsidian Black Metallic",
+                                              "PLATE-1234567890", 2022));
+        std::string buffer;
+        JsonWriter warmup(buffer);
+        longFields.writeJson(warmup);
+        size_t allocationsBefore = heapAllocations.load();
+        for (int i = 0; i < 100; ++i) {
+            buffer.clear();
+            JsonWriter writer(buffer);
+            longFields.writeJson(writer);
+            assert(!writer.failed());
+        }
+        assert(heapAllocations.load() == allocationsBefore);
+        assert(Driver::fromJson(buffer).getName() == "Alexandria Montgomery-Fitzgerald");
+    }
+    
+    // Nesting past MAX_DEPTH and unmatched closes fail instead of wrapping
+    {
+        std::string deep;
+        JsonWriter deepWriter(deep);
+        for (size_t i = 0; i < JsonWriter::MAX_DEPTH; ++i) {
+            deepWriter.beginArray();
+        }
+        assert(!deepWriter.failed());
+        deepWriter.beginArray();
+        assert(deepWriter.failed());
+        
+        std::string unbalanced;
+        JsonWriter unbalancedWriter(unbalanced);
+        unbalancedWriter.beginObject();
+        unbalancedWriter.endObject();
+        assert(!unbalancedWriter.failed());
+        unbalancedWriter.endObject();
+        assert(unbalancedWriter.failed());
+    }
+    
+    std::cout << "✓ JsonWriter/JsonReader tests passed" << std::endl;
+}
+
+void testIdInterner() {
+    std::cout << "Testing IdInterner..." << std::endl;
+    
+    IdInterner interner;
+    assert(interner.find("driver_001") == IdInterner::INVALID_HANDLE);
+    IdInterner::Handle first = interner.intern("driver_001");
+    IdInterner::Handle second = interner.intern("driver_002");
+    assert(first == 0 && second == 1);
+    assert(interner.intern("driver_001") == first);
+    assert(interner.find("driver_002") == second);
+    assert(interner.getId(second) == "driver_002");
+    assert(interner.getId(99).empty());
+    assert(interner.size() == 2);
+    
+    // References stay valid while the table grows
+    const std::string& name = interner.getId(first);
+    for (int i = 0; i < 10000; ++i) {
+        interner.intern("filler_" + std::to_string(i));
+    }
+    assert(name == "driver_001");
+    
+    // Concurrent interning of overlapping IDs hands out one handle per ID
+    IdInterner shared;
+    std::vector<std::vector<IdInterner::Handle>> seen(4);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&shared, &seen, t]() {
+            for (int i = 0; i < 5000; ++i) {
+                seen[t].push_back(shared.intern("user_" + std::to_string(i)));
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    assert(shared.size() == 5000);
+    for (int t = 1; t < 4; ++t) {
+        assert(seen[t] == seen[0]);
+    }
+    for (int i = 0; i < 5000; ++i) {
+        assert(shared.getId(seen[0][i]) == "user_" + std::to_string(i));
+    }
+    
+    std::cout << "✓ IdInterner tests passed" << std::endl;
+}
+
+// Live heap bytes requested through TrackingAllocator (memory comparisons only)
+size_t g_trackedBytes = 0;
+
+template <typename T>
+struct TrackingAllocator {
+    using value_type = T;
+    TrackingAllocator() = default;
+    template <typename U> TrackingAllocator(const TrackingAllocator<U>&) {}
+    T* allocate(size_t n) {
+        g_trackedBytes += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, size_t n) {
+        g_trackedBytes -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+    template <typename U> bool operator==(const TrackingAllocator<U>&) const { return true; }
+    template <typename U> bool operator!=(const TrackingAllocator<U>&) const { return false; }
+};
+
+void testInternedFavorites() {
+    std::cout << "Testing interned favorites against string favorites..." << std::endl;
+    
+    using TrackedString = std::basic_string<char, std::char_traits<char>, TrackingAllocator<char>>;
+    struct TrackedHash {
+        size_t operator()(const TrackedString& s) const { return std::hash<std::string_view>()(std::string_view(s.data(), s.size())); }
+    };
+    using StringSet = std::unordered_set<TrackedString, TrackedHash, std::equal_to<TrackedString>, TrackingAllocator<TrackedString>>;
+    using StringFavorites = std::unordered_map<TrackedString, StringSet, TrackedHash, std::equal_to<TrackedString>,
+                                               TrackingAllocator<std::pair<const TrackedString, StringSet>>>;
+    using HandleSet = std::unordered_set<uint32_t, std::hash<uint32_t>, std::equal_to<uint32_t>, TrackingAllocator<uint32_t>>;
+    using HandleFavorites = std::unordered_map<uint32_t, HandleSet, std::hash<uint32_t>, std::equal_to<uint32_t>,
+                                               TrackingAllocator<std::pair<const uint32_t, HandleSet>>>;
+    
+    // Production-style IDs (UUID length), long enough to defeat the small-string buffer
+    auto driverId = [](int i) { return "drv-" + std::to_string(10000000 + i) + "-4c1a-9f3e-5b7d2e8a0c6f"; };
+    auto userId = [](int i) { return "usr-" + std::to_string(10000000 + i) + "-8d2b-4e6f-a1c3-7f9e0b5d"; };
+    const int users = 2000, drivers = 2000, perUser = 10;
+    std::mt19937 rng(5);
+    std::vector<std::pair<int, int>> pairs;
+    for (int u = 0; u < users; ++u) {
+        for (int k = 0; k < perUser; ++k) {
+            pairs.emplace_back(u, static_cast<int>(rng() % drivers));
+        }
+    }
+    
+    size_t before = g_trackedBytes;
+    StringFavorites stringFavorites;
+    for (const auto& p : pairs) {
+        std::string u = userId(p.first), d = driverId(p.second);
+        stringFavorites[TrackedString(u.begin(), u.end())].emplace(d.begin(), d.end());
+    }
+    size_t stringBytes = g_trackedBytes - before;
+    
+    IdInterner userIds, driverIds;
+    for (int d = 0; d < drivers; ++d) driverIds.intern(driverId(d));
+    before = g_trackedBytes;
+    HandleFavorites handleFavorites;
+    for (const auto& p : pairs) {
+        handleFavorites[userIds.intern(userId(p.first))].insert(static_cast<uint32_t>(p.second));
+    }
+    size_t handleBytes = g_trackedBytes - before;
+    assert(handleBytes < stringBytes);
+    
+    // isFavoriteDriver and getFavoriteDrivers answer the same through either representation
+    size_t stringHits = 0, handleHits = 0, stringResolved = 0, handleResolved = 0;
+    for (int i = 0; i < 5000; ++i) {
+        std::string u = userId(rng() % users), d = driverId(rng() % drivers);
+        TrackedString user(u.begin(), u.end()), driver(d.begin(), d.end());
+        auto byString = stringFavorites.find(user);
+        auto byHandle = handleFavorites.find(userIds.find(u));
+        stringHits += byString != stringFavorites.end() && byString->second.count(driver);
+        handleHits += byHandle != handleFavorites.end() && byHandle->second.count(driverIds.find(d));
+        for (const auto& id : byString->second) {
+            stringResolved += driverIds.find(std::string_view(id.data(), id.size())) != IdInterner::INVALID_HANDLE;
+        }
+        for (uint32_t handle : byHandle->second) {
+            handleResolved += handle < static_cast<uint32_t>(drivers);
+        }
+    }
+    assert(stringHits == handleHits);
+    assert(stringResolved == handleResolved);
+    
+    std::cout << "✓ Interned favorites tests passed" << std::endl;
+}
+
+void testSmallSortedSet() {
+    std::cout << "Testing SmallSortedSet..." << std::endl;
+    
+    SmallSortedSet<uint32_t, 4> set;
+    assert(set.empty() && set.isInline());
+    assert(set.insert(30) && set.insert(10) && set.insert(20));
+    assert(!set.insert(20));
+    assert(set.size() == 3 && set.contains(10) && !set.contains(15));
+    assert(std::is_sorted(set.begin(), set.end()));
+    
+    // Spills to the heap past the inline capacity and keeps order
+    for (uint32_t v : {5u, 25u, 40u, 1u}) {
+        assert(set.insert(v));
+    }
+    assert(!set.isInline() && set.size() == 7);
+    assert(std::vector<uint32_t>(set.begin(), set.end()) == std::vector<uint32_t>({1, 5, 10, 20, 25, 30, 40}));
+    assert(set.erase(1) && set.erase(40) && !set.erase(99));
+    assert(*set.begin() == 5 && set.size() == 5);
+    
+    // Copies are deep, moves take the heap array
+    SmallSortedSet<uint32_t, 4> copy(set);
+    copy.erase(5);
+    assert(set.contains(5) && !copy.contains(5));
+    SmallSortedSet<uint32_t, 4> moved(std::move(set));
+    assert(moved.size() == 5 && set.empty() && set.isInline());
+    SmallSortedSet<uint32_t, 4> small;
+    small.insert(7);
+    moved = small;
+    assert(moved.size() == 1 && moved.contains(7));
+    
+    std::cout << "✓ SmallSortedSet tests passed" << std::endl;
+}
+
+void testFavoriteSetMemory() {
+    std::cout << "Testing favorites memory (0-10 favorites per user)..." << std::endl;
+    
+    using TrackedString = std::basic_string<char, std::char_traits<char>, TrackingAllocator<char>>;
+    struct TrackedHash {
+        size_t operator()(const TrackedString& s) const { return std::hash<std::string_view>()(std::string_view(s.data(), s.size())); }
+    };
+    using StringSet = std::unordered_set<TrackedString, TrackedHash, std::equal_to<TrackedString>, TrackingAllocator<TrackedString>>;
+    using HandleSet = std::unordered_set<uint32_t, std::hash<uint32_t>, std::equal_to<uint32_t>, TrackingAllocator<uint32_t>>;
+    using CompactSet = SmallSortedSet<uint32_t, 10>;
+    
+    const int users = 20000, drivers = 5000;
+    size_t edges = 0;
+    auto forEachFavorite = [&edges](auto&& fn) {
+        std::mt19937 rng(9);
+        edges = 0;
+        for (int u = 0; u < users; ++u) {
+            int count = static_cast<int>(rng() % 11);
+            for (int k = 0; k < count; ++k, ++edges) {
+                fn(static_cast<uint32_t>(u), static_cast<uint32_t>(rng() % drivers));
+            }
+        }
+    };
+    auto toTracked = [](const std::string& id) { return TrackedString(id.begin(), id.end()); };
+    
+    // Before: string IDs in node-based sets
+    size_t before = g_trackedBytes;
+    size_t stringBytes;
+    {
+        std::unordered_map<TrackedString, StringSet, TrackedHash, std::equal_to<TrackedString>,
+                           TrackingAllocator<std::pair<const TrackedString, StringSet>>> favorites;
+        forEachFavorite([&](uint32_t u, uint32_t d) {
+            favorites[toTracked("user_" + std::to_string(u))].insert(toTracked("driver_" + std::to_string(d)));
+        });
+        stringBytes = g_trackedBytes - before;
+    }
+    
+    // Interned handles in node-based sets
+    size_t handleBytes;
+    {
+        std::unordered_map<uint32_t, HandleSet, std::hash<uint32_t>, std::equal_to<uint32_t>,
+                           TrackingAllocator<std::pair<const uint32_t, HandleSet>>> favorites;
+        forEachFavorite([&](uint32_t u, uint32_t d) { favorites[u].insert(d); });
+        handleBytes = g_trackedBytes - before;
+    }
+    
+    // Interned handles in inline sorted sets
+    size_t compactBytes;
+    {
+        std::unordered_map<uint32_t, CompactSet, std::hash<uint32_t>, std::equal_to<uint32_t>,
+                           TrackingAllocator<std::pair<const uint32_t, CompactSet>>> favorites;
+        forEachFavorite([&](uint32_t u, uint32_t d) { favorites[u].insert(d); });
+        compactBytes = g_trackedBytes - before;
+        for (const auto& entry : favorites) {
+            compactBytes += entry.second.heapBytes(); // Zero unless a user exceeds the inline capacity
+        }
+    }
+    
+    assert(edges > 0);
+    assert(compactBytes < handleBytes && handleBytes < stringBytes);
+    
+    std::cout << "✓ Favorites memory tests passed" << std::endl;
+}
+
+void testFavoriteReverseIndex() {
+    std::cout << "Testing FavoriteReverseIndex..." << std::endl;
+    
+    FavoriteReverseIndex index;
+    assert(index.add(1, 100) && index.add(2, 100) && index.add(3, 100) && index.add(1, 200));
+    assert(!index.add(1, 100));
+    assert(index.getFavoriteCount(100) == 3);
+    assert(index.getFavoriteCount(300) == 0);
+    assert(index.getEdgeCount() == 4);
+    
+    auto followers = index.getFollowers(100);
+    std::sort(followers.begin(), followers.end());
+    assert(followers == std::vector<FavoriteReverseIndex::Handle>({1, 2, 3}));
+    
+    size_t notified = 0;
+    index.forEachFollower(200, [&notified](FavoriteReverseIndex::Handle user) { notified += user; });
+    assert(notified == 1);
+    
+    auto top = index.getMostFavorited(1);
+    assert(top.size() == 1 && top[0].first == 100 && top[0].second == 3);
+    assert(index.getMostFavorited(10).size() == 2);
+    
+    // The last follower leaving drops the driver's entry
+    assert(index.remove(1, 200) && !index.remove(1, 200));
+    assert(index.getFavoriteCounts().size() == 1);
+    
+    auto orphaned = index.removeDriver(100);
+    assert(orphaned.size() == 3);
+    assert(index.getEdgeCount() == 0 && index.getFavoriteCount(100) == 0);
+    assert(index.removeDriver(100).empty());
+    
+    // Concurrent add/remove keeps the counters exact
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&index, t]() {
+            for (uint32_t user = 0; user < 2000; ++user) {
+                index.add(user * 4 + t, user % 50);
+                if (user % 2) index.remove(user * 4 + t, user % 50);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    assert(index.getEdgeCount() == 4000);
+    size_t total = 0;
+    for (const auto& count : index.getFavoriteCounts()) total += count.second;
+    assert(total == 4000);
+    
+    // Top-K and follower fan-out agree with a scan of the forward sets
+    {
+        const uint32_t users = 2000, drivers = 500;
+        std::unordered_map<uint32_t, SmallSortedSet<uint32_t, 10>> forward;
+        FavoriteReverseIndex reverse;
+        std::mt19937 rng(17);
+        for (uint32_t u = 0; u < users; ++u) {
+            for (int k = 0; k < 10; ++k) {
+                uint32_t d = rng() % drivers;
+                if (forward[u].insert(d)) reverse.add(u, d);
+            }
+        }
+        std::unordered_map<uint32_t, size_t> scanCounts;
+        for (const auto& entry : forward) {
+            for (uint32_t d : entry.second) ++scanCounts[d];
+        }
+        std::vector<std::pair<uint32_t, size_t>> scanTop(scanCounts.begin(), scanCounts.end());
+        std::sort(scanTop.begin(), scanTop.end(), [](const auto& a, const auto& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+        auto indexTop = reverse.getMostFavorited(10);
+        for (size_t i = 0; i < 10; ++i) {
+            assert(indexTop[i].first == scanTop[i].first && indexTop[i].second == scanTop[i].second);
+        }
+        for (uint32_t d = 0; d < 20; ++d) {
+            size_t scanNotified = 0, indexNotified = 0;
+            for (const auto& entry : forward) scanNotified += entry.second.contains(d);
+            reverse.forEachFollower(d, [&indexNotified](uint32_t) { ++indexNotified; });
+            assert(scanNotified == indexNotified);
+        }
+    }
+    
+    std::cout << "✓ FavoriteReverseIndex tests passed" << std::endl;
+}
+
+void testPopularityLeaderboard() {
+    std::cout << "Testing PopularityLeaderboard..." << std::endl;
+    
+    PopularityLeaderboard board;
+    for (int i = 0; i < 3; ++i) board.increment(7);
+    board.increment(9);
+    board.increment(9);
+    board.increment(4);
+    board.increment(5);
+    assert(board.size() == 4);
+    
+    auto top = board.top(3);
+    assert(top.size() == 3);
+    assert(top[0] == PopularityLeaderboard::RankedDriver(7, 3));
+    assert(top[1] == PopularityLeaderboard::RankedDriver(9, 2));
+    assert(top[2] == PopularityLeaderboard::RankedDriver(4, 1)); // Tie with 5 broken by handle
+    
+    board.increment(5);
+    board.increment(5);
+    board.increment(5);
+    assert(board.top(1)[0] == PopularityLeaderboard::RankedDriver(5, 4));
+    board.decrement(4);
+    assert(board.getCount(4) == 0 && board.size() == 3);
+    board.decrement(4); // No-op for drivers not ranked
+    board.remove(5);
+    assert(board.top(10).size() == 2 && board.top(10)[0].first == 7);
+    assert(board.top(0).empty());
+    
+    // The reverse index keeps its leaderboard in step with the edges
+    FavoriteReverseIndex index;
+    index.add(1, 100);
+    index.add(2, 100);
+    index.add(1, 200);
+    assert(index.getMostFavorited(1)[0] == FavoriteReverseIndex::DriverCount(100, 2));
+    index.remove(1, 100);
+    index.remove(2, 100);
+    assert(index.getMostFavorited(5).size() == 1 && index.getMostFavorited(5)[0].first == 200);
+    index.removeDriver(200);
+    assert(index.getMostFavorited(5).empty());
+    
+    // Concurrent churn across shards: ranking, per-driver counts and edges agree
+    {
+        const uint32_t users = 2000, drivers = 300;
+        FavoriteReverseIndex churned;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&churned, t]() {
+                std::mt19937 rng(t);
+                for (int i = 0; i < 5000; ++i) {
+                    uint32_t user = rng() % users, driver = rng() % drivers;
+                    if (!churned.add(user, driver)) churned.remove(user, driver);
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        
+        auto counts = churned.getFavoriteCounts();
+        size_t edges = 0;
+        for (const auto& count : counts) edges += count.second;
+        assert(edges == churned.getEdgeCount());
+        std::sort(counts.begin(), counts.end(), [](const auto& a, const auto& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+        auto ranked = churned.getMostFavorited(20);
+        assert(ranked.size() == std::min<size_t>(20, counts.size()));
+        for (size_t i = 0; i < ranked.size(); ++i) {
+            assert(ranked[i] == counts[i]);
+        }
+    }
+    
+    std::cout << "✓ PopularityLeaderboard tests passed" << std::endl;
+}
+
+void testBatchLocationUpdates() {
+    std::cout << "Testing batch location updates..." << std::endl;
+    
+    auto stamp = std::chrono::system_clock::time_point(std::chrono::seconds(1700000000));
+    Driver driver("driver_001", "Alice Smith", "+1111111111");
+    int notifications = 0;
+    driver.setLocationListener([&notifications](const Driver&) { ++notifications; });
+    
+    // Timestamped updates take the caller's time and can skip the listener
+    driver.updateLocation(37.7749, -122.4194, stamp, false);
+    assert(notifications == 0);
+    assert(driver.getCurrentLocation().timestamp == stamp);
+    assert(driver.getLastActiveTime() == stamp);
+    driver.updateLocation(37.7750, -122.4195, stamp);
+    assert(notifications == 1);
+    
+    DriverPositionStore store;
+    Driver other("driver_002", "Bob Johnson", "+2222222222");
+    store.add(driver);
+    store.add(other);
+    std::vector<Driver::LocationUpdate> updates = {
+        {"driver_002", 40.7128, -74.0060, stamp},
+        {"driver_unknown", 1.0, 1.0, stamp},
+        {"driver_001", 37.8044, -122.2712, stamp}
+    };
+    assert(store.updateLocations(updates.data(), updates.size()) == 2);
+    assert(store.getLatitude(store.indexOf("driver_002")) == 40.7128);
+    assert(store.getLongitude(store.indexOf("driver_001")) == -122.2712);
+    
+    // Per-ping and batched ingestion, wired as in the manager, both leave the
+    // grid and the position store consistent with the drivers
+    {
+        const int driverCount = 2000;
+        const size_t batchSize = 100;
+        std::shared_mutex indexMutex;
+        SpatialIndex spatialIndex;
+        DriverPositionStore positionStore;
+        std::unordered_map<std::string, std::shared_ptr<Driver>> drivers;
+        std::mt19937 rng(29);
+        auto randomLat = [&rng]() { return 37.6 + (rng() % 40000) / 100000.0; };
+        auto randomLng = [&rng]() { return -122.5 - (rng() % 40000) / 100000.0; };
+        for (int i = 0; i < driverCount; ++i) {
+            auto fleetDriver = std::make_shared<Driver>("driver_" + std::to_string(i), "Driver", "+1000000000");
+            fleetDriver->updateLocation(randomLat(), randomLng());
+            spatialIndex.insert(fleetDriver);
+            positionStore.add(*fleetDriver);
+            fleetDriver->setLocationListener([&](const Driver& moved) {
+                std::unique_lock<std::shared_mutex> lock(indexMutex);
+                spatialIndex.update(moved);
+                positionStore.updateLocation(moved.getId(), moved.getCurrentLocation().latitude,
+                                             moved.getCurrentLocation().longitude);
+            });
+            drivers.emplace(fleetDriver->getId(), fleetDriver);
+        }
+        std::vector<Driver::LocationUpdate> pings;
+        for (int i = 0; i < 3 * driverCount; ++i) {
+            pings.push_back({"driver_" + std::to_string(rng() % driverCount), randomLat(), randomLng(), {}});
+        }
+        auto checkConsistent = [&]() {
+            for (int i = 0; i < driverCount; i += 97) {
+                const auto& fleetDriver = drivers["driver_" + std::to_string(i)];
+                size_t index = positionStore.indexOf(fleetDriver->getId());
+                assert(positionStore.getLatitude(index) == fleetDriver->getCurrentLocation().latitude);
+                auto nearby = spatialIndex.queryRadius(fleetDriver->getCurrentLocation(), 0.01);
+                assert(std::find(nearby.begin(), nearby.end(), fleetDriver) != nearby.end());
+            }
+        };
+        
+        for (size_t i = 0; i < pings.size() / 2; ++i) {
+            drivers[pings[i].driverId]->updateLocation(pings[i].latitude, pings[i].longitude);
+        }
+        checkConsistent();
+        
+        // Batched: one clock read and one lock per batch
+        std::vector<Driver*> moved;
+        size_t applied = 0;
+        for (size_t offset = pings.size() / 2; offset < pings.size(); offset += batchSize) {
+            size_t count = std::min(batchSize, pings.size() - offset);
+            const Driver::LocationUpdate* batch = pings.data() + offset;
+            auto now = std::chrono::system_clock::now();
+            moved.clear();
+            for (size_t i = 0; i < count; ++i) {
+                auto it = drivers.find(batch[i].driverId);
+                auto pingStamp = batch[i].timestamp == std::chrono::system_clock::time_point{} ? now : batch[i].timestamp;
+                it->second->updateLocation(batch[i].latitude, batch[i].longitude, pingStamp, false);
+                moved.push_back(it->second.get());
+            }
+            std::unique_lock<std::shared_mutex> lock(indexMutex);
+            for (Driver* movedDriver : moved) spatialIndex.update(*movedDriver);
+            applied += positionStore.updateLocations(batch, count);
+        }
+        assert(applied == pings.size() - pings.size() / 2);
+        checkConsistent();
+    }
+    
+    std::cout << "✓ Batch location update tests passed" << std::endl;
+}
+
+void testDriverLiveStateConcurrency() {
+    std::cout << "Testing concurrent driver location/status publication..." << std::endl;
+    
+    // Each write i puts the driver at (i, -i) stamped i seconds after the epoch, so
+    // any mix of two writes is visible to readers
+    const int writes = 200000;
+    Driver driver("driver_001", "Alice Smith", "+1111111111");
+    std::atomic<bool> done(false);
+    std::atomic<long long> snapshots(0);
+    
+    auto stampFor = [](double i) {
+        return std::chrono::system_clock::time_point(std::chrono::seconds(static_cast<long long>(i)));
+    };
+    driver.updateLocation(0.0, 0.0, stampFor(0), false);
+    
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&]() {
+            double lastLatitude = 0.0;
+            long long count = 0;
+            while (!done.load(std::memory_order_acquire)) {
+                Driver::LiveState state = driver.getLiveState();
+                assert(state.location.longitude == -state.location.latitude);
+                assert(state.location.timestamp == stampFor(state.location.latitude));
+                assert(state.lastActiveTime >= state.location.timestamp);
+                assert(state.location.latitude >= lastLatitude); // Never goes back in time
+                lastLatitude = state.location.latitude;
+                
+                Driver::Location location = driver.getCurrentLocation();
+                assert(location.longitude == -location.latitude);
+                assert(driver.calculateDistanceFrom(location) >= 0.0); // Reads its own snapshot
+                ++count;
+            }
+            snapshots.fetch_add(count);
+        });
+    }
+    
+    // Two writers: GPS pings and status flips must not lose each other's fields
+    std::thread statusWriter([&]() {
+        for (int i = 0; i < writes / 10; ++i) {
+            driver.setStatus(i % 2 == 0 ? Driver::Status::BUSY : Driver::Status::ONLINE);
+        }
+    });
+    for (int i = 1; i <= writes; ++i) {
+        driver.updateLocation(i, -i, stampFor(i), false);
+    }
+    statusWriter.join();
+    done.store(true, std::memory_order_release);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    
+    Driver::LiveState latest = driver.getLiveState();
+    assert(latest.location.latitude == writes);
+    assert(latest.status == Driver::Status::ONLINE);
+    
+    // Copies take a consistent snapshot too
+    Driver copy(driver);
+    assert(copy.getCurrentLocation().latitude == writes);
+    assert(copy.getStatus() == Driver::Status::ONLINE);
+    
+    std::cout << "  - " << snapshots.load() << " consistent snapshots read during " << writes << " writes" << std::endl;
+    std::cout << "✓ Driver live state concurrency tests passed" << std::endl;
+}
+
+void testSpeedGridEtaProvider() {
+    std::cout << "Testing EtaProvider implementations..." << std::endl;
+    
+    const std::string filename = "test_speed_grid.bin";
+    
+    // 10x10 cells of 0.01 degrees from (37.70, -122.50); hour h drives at 10 + h km/h,
+    // except cell (3, 4) which has no data
+    SpeedGridEtaProvider::GridSpec spec{37.70, -122.50, 0.01, 10, 10, -480};
+    std::vector<float> speeds(SpeedGridEtaProvider::HOURS_PER_DAY * 100);
+    for (uint32_t hour = 0; hour < SpeedGridEtaProvider::HOURS_PER_DAY; ++hour) {
+        for (uint32_t cell = 0; cell < 100; ++cell) {
+            speeds[hour * 100 + cell] = (cell == 3 * 10 + 4) ? 0.0f : 10.0f + hour;
+        }
+    }
+    assert(SpeedGridEtaProvider::write(filename, spec, speeds));
+    std::string error;
+    assert(!SpeedGridEtaProvider::write(filename, spec, std::vector<float>(5), &error));
+    assert(!error.empty());
+    
+    SpeedGridEtaProvider grid(25.0);
+    assert(grid.open(filename));
+    
+    // 2023-11-14 22:13:20 UTC is 14:13 at UTC-8
+    auto departure = std::chrono::system_clock::time_point(std::chrono::seconds(1700000000));
+    assert(grid.getHourOfDay(departure) == 14);
+    assert(grid.getSpeedKmh(Driver::Location(37.705, -122.495), departure) == 24.0);
+    assert(grid.getSpeedKmh(Driver::Location(37.735, -122.455), departure) == 25.0); // No data
+    assert(grid.getSpeedKmh(Driver::Location(40.0, -74.0), departure) == 25.0);      // Outside
+    
+    Driver::Location pickup(37.705, -122.495);
+    Driver::Location origin(37.785, -122.415);
+    Driver probe;
+    probe.setCurrentLocation(origin);
+    double distanceKm = probe.calculateDistanceFrom(pickup);
+    assert(std::abs(grid.estimateMinutes(origin, pickup, departure) - distanceKm / 24.0 * 60.0) < 1e-6);
+    
+    ConstantSpeedEtaProvider constant;
+    assert(std::abs(constant.estimateMinutes(origin, pickup, departure) - distanceKm / 30.0 * 60.0) < 1e-6);
+    assert(probe.getEstimatedArrivalTime(pickup, constant) == probe.getEstimatedArrivalTime(pickup));
+    
+    // Batch through the store agrees with single estimates; the grid reorders the
+    // ranking when the nearer driver sits in a slow cell
+    DriverPositionStore store;
+    Driver nearSlow("driver_slow", "Slow", "+1111111111");
+    nearSlow.goOnline();
+    nearSlow.updateLocation(37.735, -122.455); // Fallback 25 km/h cell, 4.8 km away
+    Driver farFast("driver_fast", "Fast", "+2222222222");
+    farFast.goOnline();
+    farFast.updateLocation(37.765, -122.405);
+    store.add(nearSlow);
+    store.add(farFast);
+    
+    std::vector<double> distances, etas;
+    store.computeEtas(pickup, grid, departure, distances, etas);
+    for (size_t i = 0; i < store.size(); ++i) {
+        Driver::Location location(store.getLatitude(i), store.getLongitude(i));
+        assert(std::abs(etas[i] - grid.estimateMinutes(location, pickup, departure)) < 1e-9);
+    }
+    auto byDistance = store.rankByEta(pickup, 2, 15.0);
+    assert(store.getDriverId(byDistance[0].index) == "driver_slow");
+    
+    std::vector<float> fastSpeeds = speeds;
+    for (uint32_t hour = 0; hour < SpeedGridEtaProvider::HOURS_PER_DAY; ++hour) {
+        fastSpeeds[hour * 100 + 6 * 10 + 9] = 120.0f; // Freeway under driver_fast
+    }
+    assert(SpeedGridEtaProvider::write(filename, spec, fastSpeeds));
+    assert(grid.open(filename));
+    auto byGrid = store.rankByEta(pickup, 2, 15.0, grid, departure);
+    assert(store.getDriverId(byGrid[0].index) == "driver_fast");
+    grid.close();
+    
+    // Without a grid every estimate uses the fallback speed
+    assert(grid.getSpeedKmh(pickup, departure) == 25.0);
+    
+    // Corruption is detected by the checksum
+    {
+        std::fstream file(filename, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(sizeof(SpeedGridEtaProvider::Header) + 3);
+        file.put('#');
+    }
+    assert(!grid.open(filename));
+    assert(grid.getLastError() == "checksum mismatch");
+    assert(!grid.open("missing_speed_grid.bin"));
+    
+    std::remove(filename.c_str());
+    std::cout << "✓ EtaProvider tests passed" << std::endl;
+}
+
+void testEtaCache() {
+    std::cout << "Testing EtaCache..." << std::endl;
+    
+    ConstantSpeedEtaProvider provider;
+    EtaCache::Options options;
+    options.cellSizeKm = 0.5;
+    options.capacity = 4;
+    options.shardCount = 1;
+    EtaCache cache(options);
+    
+    auto departure = std::chrono::system_clock::time_point(std::chrono::hours(480000));
+    Driver::Location pickup(37.7749, -122.4194);
+    Driver::Location driverLocation(37.7849, -122.4094);
+    
+    // First call computes, the second hits; a pickup a few metres away shares the cell
+    auto computed = cache.estimate(provider, 1, driverLocation, pickup, departure);
+    assert(std::abs(computed.etaMinutes - provider.estimateMinutes(driverLocation, pickup, departure)) < 1e-9);
+    auto cached = cache.estimate(provider, 1, driverLocation, Driver::Location(37.77491, -122.41941), departure);
+    assert(cached.distanceKm == computed.distanceKm);
+    EtaCache::Stats stats = cache.getStats();
+    assert(stats.hits == 1 && stats.misses == 1 && stats.size == 1);
+    
+    // Crossing into another cell or into the next hour invalidates the entry
+    EtaCache::Estimate result;
+    Driver::Location moved(37.7949, -122.4094);
+    assert(!cache.lookup(provider, 1, moved, pickup, departure, result));
+    assert(!cache.lookup(provider, 1, driverLocation, pickup, departure + std::chrono::hours(1), result));
+    assert(cache.getStats().invalidations == 2);
+    cache.estimate(provider, 1, moved, pickup, departure);
+    assert(cache.lookup(provider, 1, moved, pickup, departure, result));
+    assert(cache.getStats().size == 1); // Replaced in place
+    
+    // CLOCK: referenced entries survive, the unreferenced one is evicted
+    cache.clear();
+    for (EtaCache::Handle driver = 1; driver <= 4; ++driver) {
+        cache.store(provider, driver, driverLocation, pickup, departure, EtaCache::Estimate{1.0, 2.0});
+    }
+    for (EtaCache::Handle driver = 1; driver <= 3; ++driver) {
+        assert(cache.lookup(provider, driver, driverLocation, pickup, departure, result));
+    }
+    cache.store(provider, 5, driverLocation, pickup, departure, EtaCache::Estimate{1.0, 2.0});
+    assert(!cache.lookup(provider, 4, driverLocation, pickup, departure, result));
+    assert(cache.lookup(provider, 1, driverLocation, pickup, departure, result));
+    assert(cache.lookup(provider, 5, driverLocation, pickup, departure, result));
+    stats = cache.getStats();
+    assert(stats.evictions == 1 && stats.size == 4 && stats.capacity == 4);
+    
+    cache.resetStats();
+    assert(cache.getStats().hits == 0);
+    
+    // Cells stay about cellSizeKm wide away from the equator: a 10 km line
+    // running east at 60 degrees crosses ~20 cells of 0.5 km, not ~40
+    {
+        std::unordered_set<int64_t> crossed;
+        for (int metres = 0; metres <= 10000; metres += 10) {
+            crossed.insert(cache.cellFor(Driver::Location(60.0, 10.0 + metres / 1000.0 / (111.32 * 0.5))));
+        }
+        assert(crossed.size() >= 19 && crossed.size() <= 22);
+    }
+    
+    // Entries expire on the provider's local hour: with a +5:30 grid, UTC
+    // 10:40 is local 16:10, so an entry from UTC 10:00 (local 15:30) misses
+    {
+        const std::string filename = "test_cache_grid.bin";
+        SpeedGridEtaProvider::GridSpec spec{37.70, -122.50, 0.01, 10, 10, 330};
+        std::vector<float> speeds(SpeedGridEtaProvider::HOURS_PER_DAY * 100);
+        for (uint32_t hour = 0; hour < SpeedGridEtaProvider::HOURS_PER_DAY; ++hour) {
+            std::fill(speeds.begin() + hour * 100, speeds.begin() + (hour + 1) * 100, 10.0f + hour);
+        }
+        assert(SpeedGridEtaProvider::write(filename, spec, speeds));
+        SpeedGridEtaProvider grid;
+        assert(grid.open(filename));
+        EtaCache gridCache;
+        Driver::Location from(37.71, -122.49), to(37.75, -122.45);
+        auto utcTen = std::chrono::system_clock::time_point(std::chrono::hours(480010));
+        gridCache.estimate(grid, 1, from, to, utcTen);
+        assert(gridCache.lookup(grid, 1, from, to, utcTen + std::chrono::minutes(20), result));
+        assert(!gridCache.lookup(grid, 1, from, to, utcTen + std::chrono::minutes(40), result));
+        auto later = gridCache.estimate(grid, 1, from, to, utcTen + std::chrono::minutes(40));
+        assert(std::abs(later.etaMinutes - grid.estimateMinutes(from, to, utcTen + std::chrono::minutes(40))) < 1e-9);
+        grid.close();
+        std::remove(filename.c_str());
+    }
+    
+    // Concurrent lookups and evictions across shards
+    EtaCache shared;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&shared, &provider, &pickup, departure, t]() {
+            for (int i = 0; i < 20000; ++i) {
+                EtaCache::Handle driver = static_cast<EtaCache::Handle>((i * 7 + t) % 500);
+                Driver::Location location(37.70 + driver * 0.0001, -122.45);
+                auto estimate = shared.estimate(provider, driver, location, pickup, departure);
+                assert(estimate.etaMinutes >= 0.0);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    stats = shared.getStats();
+    assert(stats.hits + stats.misses == 80000);
+    assert(stats.size <= 500);
+    
+    // A dispatch cycle around hotspots: repeated candidates hit, and the
+    // cell quantization keeps the summed ETAs within 1% of the provider's
+    {
+        const int hotspots = 5, driversPerHotspot = 100, riders = 200, candidates = 50, passes = 3;
+        std::mt19937 rng(43);
+        std::uniform_int_distribution<int> spread(-1000, 1000), jitter(-50, 50); // 1e-5 degree steps
+        std::vector<Driver::Location> centers, fleet;
+        for (int h = 0; h < hotspots; ++h) {
+            centers.emplace_back(37.65 + (rng() % 30000) / 100000.0, -122.55 + (rng() % 30000) / 100000.0);
+            for (int d = 0; d < driversPerHotspot; ++d) {
+                fleet.emplace_back(centers.back().latitude + spread(rng) / 100000.0,
+                                   centers.back().longitude + spread(rng) / 100000.0);
+            }
+        }
+        EtaCache cycleCache;
+        double checksum = 0.0, cachedChecksum = 0.0;
+        for (int r = 0; r < riders; ++r) {
+            int h = rng() % hotspots;
+            Driver::Location riderPickup(centers[h].latitude + jitter(rng) / 100000.0,
+                                         centers[h].longitude + jitter(rng) / 100000.0);
+            std::vector<EtaCache::Handle> candidateHandles;
+            for (int c = 0; c < candidates; ++c) {
+                candidateHandles.push_back(h * driversPerHotspot + rng() % driversPerHotspot);
+            }
+            for (int pass = 0; pass < passes; ++pass) {
+                for (EtaCache::Handle driver : candidateHandles) {
+                    checksum += provider.estimateMinutes(fleet[driver], riderPickup, departure);
+                    cachedChecksum += cycleCache.estimate(provider, driver, fleet[driver], riderPickup, departure).etaMinutes;
+                }
+            }
+        }
+        stats = cycleCache.getStats();
+        uint64_t lookups = static_cast<uint64_t>(riders) * candidates * passes;
+        assert(stats.hits + stats.misses == lookups);
+        assert(stats.hits >= lookups / 2);
+        assert(std::abs(cachedChecksum - checksum) / checksum < 0.01);
+    }
+    
+    std::cout << "✓ EtaCache tests passed" << std::endl;
+}
+
+void testDistanceTiers() {
+    std::cout << "Testing two-tier distance filtering..." << std::endl;
+    
+    // Driver and RideRequest share DistanceKernel::haversine
+    Driver::Location pickup(37.7749, -122.4194);
+    Driver::Location dropoff(37.8044, -122.2712);
+    Driver driver("driver_001", "Alice Smith", "+1111111111");
+    driver.updateLocation(pickup.latitude, pickup.longitude);
+    RideRequest request("user_001", pickup, dropoff);
+    double exact = DistanceKernel::haversine(pickup, dropoff);
+    assert(driver.calculateDistanceFrom(dropoff) == exact);
+    assert(request.calculateDistance() == exact);
+    assert(std::fabs(exact - 13.43) < 0.01);
+    
+    auto cosOf = [](double latitude) { return std::cos(latitude * M_PI / 180.0); };
+    double approx = DistanceKernel::equirectangular(pickup.latitude, pickup.longitude, cosOf(pickup.latitude),
+                                                    dropoff.latitude, dropoff.longitude, cosOf(dropoff.latitude));
+    assert(std::fabs(approx - exact) / exact < 0.001);
+    
+    // Single-pair test rejects on latitude before any trig, and agrees with the exact tier
+    assert(!DistanceKernel::withinDistance(pickup, Driver::Location(37.9749, -122.4194), 15.0));
+    assert(DistanceKernel::withinDistance(pickup, dropoff, 13.45));
+    assert(!DistanceKernel::withinDistance(pickup, dropoff, 13.4));
+    assert(driver.isNearby(dropoff, 13.45) && !driver.isNearby(dropoff, 13.4));
+    
+    // The prefilter never drops a point the exact tier keeps, including across
+    // the antimeridian and at high latitude
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<double> offset(-0.4, 0.4);
+    for (Driver::Location origin : {pickup, Driver::Location(64.8378, -147.7164), Driver::Location(-16.5, 179.95)}) {
+        std::vector<double> latitudes, longitudes, cosLatitudes;
+        for (int i = 0; i < 20000; ++i) {
+            latitudes.push_back(origin.latitude + offset(rng));
+            double longitude = origin.longitude + offset(rng) * 2.0;
+            longitudes.push_back(longitude > 180.0 ? longitude - 360.0 : longitude);
+            cosLatitudes.push_back(cosOf(latitudes.back()));
+        }
+        std::vector<double> all(latitudes.size());
+        DistanceKernel::haversineBatch(origin, latitudes.data(), longitudes.data(), cosLatitudes.data(),
+                                       latitudes.size(), all.data());
+        
+        std::vector<uint32_t> indexes;
+        std::vector<double> distances;
+        DistanceKernel::filterWithinDistance(origin, latitudes.data(), longitudes.data(), cosLatitudes.data(),
+                                             latitudes.size(), 15.0, indexes, distances);
+        size_t expected = 0;
+        for (size_t i = 0, next = 0; i < all.size(); ++i) {
+            if (all[i] <= 15.0) {
+                ++expected;
+                assert(next < indexes.size() && indexes[next] == i && distances[next] == all[i]);
+                ++next;
+            }
+        }
+        assert(indexes.size() == expected && expected > 0);
+        
+        std::vector<uint32_t> survivors(latitudes.size());
+        size_t kept = DistanceKernel::prefilter(origin, latitudes.data(), longitudes.data(), cosLatitudes.data(),
+                                                latitudes.size(), 15.0, survivors.data());
+        assert(kept >= expected && kept < latitudes.size() / 4);
+        
+        // Radii beyond the validated range skip the cheap tier entirely
+        assert(DistanceKernel::prefilter(origin, latitudes.data(), longitudes.data(), cosLatitudes.data(),
+                                         latitudes.size(), 1000.0, survivors.data()) == latitudes.size());
+    }
+
+    // The batch kernel matches haversine() on global pairs (odd count, so the
+    // vector loop and the scalar tail both run), and stays within the looser
+    // bound next to the antipode
+    std::uniform_real_distribution<double> anyLatitude(-90.0, 90.0), anyLongitude(-180.0, 180.0), antipodal(-0.1, 0.1);
+    for (int o = 0; o < 50; ++o) {
+        Driver::Location origin(anyLatitude(rng), anyLongitude(rng));
+        std::vector<double> latitudes, longitudes, cosLatitudes;
+        for (int i = 0; i < 1001; ++i) {
+            if (i % 2 == 0) {
+                latitudes.push_back(anyLatitude(rng));
+                longitudes.push_back(anyLongitude(rng));
+            } else {
+                latitudes.push_back(std::max(-90.0, std::min(90.0, -origin.latitude + antipodal(rng))));
+                double longitude = origin.longitude + 180.0 + antipodal(rng);
+                longitudes.push_back(longitude > 180.0 ? longitude - 360.0 : longitude);
+            }
+            cosLatitudes.push_back(cosOf(latitudes.back()));
+        }
+        std::vector<double> distances(latitudes.size());
+        DistanceKernel::haversineBatch(origin, latitudes.data(), longitudes.data(), cosLatitudes.data(),
+                                       latitudes.size(), distances.data());
+        for (size_t i = 0; i < distances.size(); ++i) {
+            double error = std::fabs(distances[i] - DistanceKernel::haversine(origin, Driver::Location(latitudes[i], longitudes[i])));
+            assert(error < (i % 2 == 0 ? DistanceKernel::BATCH_TOLERANCE_KM : DistanceKernel::ANTIPODAL_TOLERANCE_KM));
+        }
+    }
+
+    std::cout << "✓ Two-tier distance tests passed" << std::endl;
+}
+
+void testRideRequestPool() {
+    std::cout << "Testing RideRequestPool..." << std::endl;
+    
+    RideRequest prototype("user_001", Driver::Location(37.7749, -122.4194), Driver::Location(37.8044, -122.2712),
+                          RideRequest::RideType::PREMIUM);
+    prototype.setPickupAddress("1 Market Street, San Francisco, CA");
+    prototype.setDropoffAddress("1 Broadway, Oakland, CA 94607");
+    prototype.setSpecialInstructions("Meet at the north entrance by the fountain");
+    prototype.setPaymentMethod("corporate_account_visa");
+    
+    RideRequestPool pool(4);
+    RideRequest* first;
+    {
+        auto request = pool.acquire(prototype);
+        first = request.get();
+        assert(request->getRequestId() == prototype.getRequestId());
+        assert(request->getPickupAddress() == prototype.getPickupAddress());
+        assert(request->getSpecialInstructions() == prototype.getSpecialInstructions());
+        assert(request->getPaymentInfo().paymentMethod == "corporate_account_visa");
+        assert(request->getRideType() == RideRequest::RideType::PREMIUM);
+        request->assignDriver("driver_001");
+        request->rejectRequest("Driver is too far from the pickup");
+        
+        auto stats = pool.getStats();
+        assert(stats.inUse == 1 && stats.capacity == 4 && stats.slabs == 1);
+        
+        std::shared_ptr<RideRequest> copy = request; // Shares the control block
+        request.reset();
+        assert(pool.getStats().inUse == 1);
+    }
+    assert(pool.getStats().inUse == 0);
+    
+    // The retired request is reused, wiped and reinitialized
+    auto fresh = pool.acquire("user_002", Driver::Location(37.7749, -122.4194), Driver::Location(37.7849, -122.4094));
+    assert(fresh.get() == first);
+    assert(fresh->getUserId() == "user_002");
+    assert(!fresh->getRequestId().empty() && fresh->getRequestId() != prototype.getRequestId());
+    assert(fresh->getStatus() == RideRequest::Status::PENDING);
+    assert(fresh->getRideType() == RideRequest::RideType::STANDARD);
+    assert(fresh->getAssignedDriverId().empty() && fresh->getRejectionReason().empty());
+    assert(fresh->getSpecialInstructions().empty() && fresh->getPickupAddress().empty());
+    assert(fresh->getPaymentInfo().paymentMethod == "card" && !fresh->getPaymentInfo().isPaid);
+    assert(std::fabs(fresh->getEstimatedDistanceKm() - fresh->calculateDistance()) < 1e-12);
+    assert(fresh->getEstimatedDurationMinutes() > 0);
+    assert(pool.getStats().reused == 1 && pool.getStats().acquired == 2);
+    
+    // Grows by whole slabs past the first
+    std::vector<std::shared_ptr<RideRequest>> held;
+    for (int i = 0; i < 9; ++i) {
+        held.push_back(pool.acquire(prototype));
+    }
+    assert(pool.getStats().slabs == 3 && pool.getStats().inUse == 10);
+    held.clear();
+    fresh.reset();
+    assert(pool.getStats().inUse == 0);
+    
+    // Requests may outlive the pool that made them
+    std::shared_ptr<RideRequest> survivor;
+    {
+        RideRequestPool shortLived;
+        shortLived.reserve(300);
+        assert(shortLived.getStats().capacity == 512);
+        survivor = shortLived.acquire(prototype);
+    }
+    survivor->acceptRequest();
+    assert(survivor->getStatus() == RideRequest::Status::ACCEPTED);
+    survivor.reset();
+    
+    // Concurrent churn: every request comes back and capacity tracks the peak
+    RideRequestPool shared(64);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&shared, &prototype, t]() {
+            std::vector<std::shared_ptr<RideRequest>> window(32);
+            for (int i = 0; i < 20000; ++i) {
+                auto& slot = window[(i * 7 + t) % window.size()];
+                slot = shared.acquire(prototype);
+                assert(slot->getPickupAddress() == prototype.getPickupAddress());
+                slot->assignDriver("driver_" + std::to_string(t));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto sharedStats = shared.getStats();
+    assert(sharedStats.inUse == 0 && sharedStats.acquired == 80000);
+    assert(sharedStats.capacity <= 4 * 64);
+    
+    // Steady-state churn, as requests are created, declined and replaced in the
+    // in-flight window: make_shared allocates every time, the pool never does
+    {
+        std::vector<RideRequest> prototypes;
+        for (int i = 0; i < 16; ++i) {
+            RideRequest churnPrototype("user_" + std::to_string(100000 + i), Driver::Location(37.77, -122.42),
+                                       Driver::Location(37.80, -122.27));
+            churnPrototype.setPickupAddress(std::to_string(100 + i) + " Market Street, San Francisco, CA 94105");
+            churnPrototype.setDropoffAddress(std::to_string(200 + i) + " Broadway, Oakland, CA 94607");
+            churnPrototype.setSpecialInstructions("Gate code " + std::to_string(4000 + i) + ", meet at the side entrance");
+            prototypes.push_back(churnPrototype);
+        }
+        const std::string driverId = "driver_0042";
+        const std::string reason = "Driver is too far from the pickup location";
+        const int requestCount = 2000;
+        auto allocationsPerRequest = [&](auto&& create) {
+            std::vector<std::shared_ptr<RideRequest>> window(64);
+            auto churn = [&]() {
+                for (int i = 0; i < requestCount; ++i) {
+                    std::shared_ptr<RideRequest> churned = create(prototypes[i % prototypes.size()]);
+                    churned->assignDriver(driverId);
+                    churned->rejectRequest(reason);
+                    window[i % window.size()] = std::move(churned);
+                }
+            };
+            churn(); // Warm-up fills the window (and the pool)
+            size_t allocationsBefore = heapAllocations.load();
+            churn();
+            return static_cast<double>(heapAllocations.load() - allocationsBefore) / requestCount;
+        };
+        
+        assert(allocationsPerRequest([](const RideRequest& from) { return std::make_shared<RideRequest>(from); }) >= 4.0);
+        RideRequestPool churnPool;
+        assert(allocationsPerRequest([&churnPool](const RideRequest& from) { return churnPool.acquire(from); }) == 0.0);
+    }
+    
+    std::cout << "✓ RideRequestPool tests passed" << std::endl;
+}
+
+void testRequestIdGenerator() {
+    std::cout << "Testing RequestIdGenerator..." << std::endl;
+    
+    // Fixed width, small-string sized, time-ordered and decodable
+    auto before = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::string first = RequestIdGenerator::next();
+    std::string second = RequestIdGenerator::next();
+    assert(first.size() == RequestIdGenerator::ID_LENGTH && first.size() <= std::string().capacity());
+    assert(first < second);
+    RequestIdGenerator::Parts parts;
+    assert(RequestIdGenerator::decode(first, parts));
+    assert(parts.unixMillis >= before && parts.unixMillis <= before + 1000);
+    assert(parts.node == RequestIdGenerator::getNodeId());
+    RequestIdGenerator::Parts secondParts;
+    assert(RequestIdGenerator::decode(second, secondParts) && secondParts.slot == parts.slot);
+    assert(!RequestIdGenerator::decode("req_123", parts));
+    assert(!RequestIdGenerator::decode("0123456789ABCDU", parts)); // U is not in the alphabet
+    
+    RequestIdGenerator::setNodeId(1000 + 1024); // Masked to 10 bits
+    assert(RequestIdGenerator::getNodeId() == 1000);
+    assert(RequestIdGenerator::decode(RequestIdGenerator::next(), parts) && parts.node == 1000);
+    RequestIdGenerator::setNodeId(0);
+    
+    // RideRequest IDs come from the generator
+    RideRequest request("user_001", Driver::Location(37.7749, -122.4194), Driver::Location(37.7849, -122.4094));
+    assert(RequestIdGenerator::decode(request.getRequestId(), parts));
+    
+    // More than 8192 IDs per millisecond per thread borrow the next millisecond
+    // rather than repeat; every thread's IDs are strictly increasing
+    const int threadCount = 8;
+    const int idsPerThread = 100000;
+    std::vector<std::vector<std::string>> perThread(threadCount);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&perThread, t, idsPerThread]() {
+            perThread[t].reserve(idsPerThread);
+            for (int i = 0; i < idsPerThread; ++i) {
+                perThread[t].push_back(RequestIdGenerator::next());
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::vector<std::string> all;
+    for (const auto& ids : perThread) {
+        assert(std::is_sorted(ids.begin(), ids.end()));
+        assert(std::adjacent_find(ids.begin(), ids.end()) == ids.end());
+        all.insert(all.end(), ids.begin(), ids.end());
+    }
+    
+    // Slot leases are recycled as threads come and go: 1500 short-lived
+    // threads, more than there are slots, still never collide
+    std::mutex churnMutex;
+    for (int batch = 0; batch < 30; ++batch) {
+        std::vector<std::thread> shortLived;
+        for (int t = 0; t < 50; ++t) {
+            shortLived.emplace_back([&all, &churnMutex]() {
+                std::string ids[20];
+                for (auto& id : ids) {
+                    id = RequestIdGenerator::next();
+                }
+                std::lock_guard<std::mutex> lock(churnMutex);
+                all.insert(all.end(), std::begin(ids), std::end(ids));
+            });
+        }
+        for (auto& thread : shortLived) {
+            thread.join();
+        }
+    }
+    
+    std::sort(all.begin(), all.end());
+    assert(std::adjacent_find(all.begin(), all.end()) == all.end());
+    assert(all.size() == static_cast<size_t>(threadCount) * idsPerThread + 30 * 50 * 20);
+    
+    // Once this thread holds a slot, generating an ID never allocates
+    RequestIdGenerator::next();
+    size_t allocationsBefore = heapAllocations.load();
+    size_t length = 0;
+    for (int i = 0; i < 1000; ++i) {
+        length += RequestIdGenerator::next().size();
+    }
+    assert(heapAllocations.load() == allocationsBefore);
+    assert(length == 1000 * RequestIdGenerator::ID_LENGTH);
+    
+    std::cout << "✓ RequestIdGenerator tests passed (" << all.size() << " unique IDs)" << std::endl;
+}
+
+void testAssignmentSolver() {
+    std::cout << "Testing AssignmentSolver..." << std::endl;
+    
+    using Edge = AssignmentSolver::Edge;
+    const double unassigned = 1000.0;
+    const uint32_t NONE = AssignmentSolver::UNASSIGNED;
+    
+    // Greedy would hand driver 0 to rider 0 and strand rider 1
+    std::vector<std::vector<Edge>> rows = {{{0, 1.0}, {1, 2.0}}, {{0, 1.5}}};
+    auto assignment = AssignmentSolver::solve(rows, unassigned);
+    assert(assignment[0] == 1 && assignment[1] == 0);
+    assert(AssignmentSolver::totalCost(rows, assignment, unassigned) == 3.5);
+    
+    // Riders without usable edges stay unassigned; edges at or above the
+    // unassigned cost are ignored; separate components are solved independently
+    rows = {{}, {{7, unassigned}}, {{3, 5.0}}, {{3, 4.0}}, {{9, 2.0}, {3, 1.0}}};
+    assignment = AssignmentSolver::solve(rows, unassigned);
+    assert(assignment[0] == NONE && assignment[1] == NONE);
+    assert(assignment[4] == 9 && assignment[3] == 3 && assignment[2] == NONE);
+    
+    // Matching both riders (1.8) beats the cheaper total that strands rider 1
+    // (0.1 + 1.0), even with the unassigned cost close to the real ones
+    rows = {{{0, 0.1}, {1, 0.9}}, {{0, 0.9}}};
+    assignment = AssignmentSolver::solve(rows, 1.0);
+    assert(assignment[0] == 1 && assignment[1] == 0);
+    assert(std::fabs(AssignmentSolver::totalCost(rows, assignment, 1.0) - 1.8) < 1e-12);
+    
+    // Optimal against brute force on small random instances: fewest unmatched
+    // rows first, then lowest total cost
+    using Outcome = std::pair<size_t, double>;
+    std::function<Outcome(const std::vector<std::vector<Edge>>&, size_t, std::vector<char>&)> best =
+        [&](const std::vector<std::vector<Edge>>& problem, size_t row, std::vector<char>& used) {
+            if (row == problem.size()) {
+                return Outcome(0, 0.0);
+            }
+            Outcome result = best(problem, row + 1, used);
+            result.first += 1;
+            result.second += unassigned;
+            for (const Edge& edge : problem[row]) {
+                if (!used[edge.column] && edge.cost < unassigned) {
+                    used[edge.column] = 1;
+                    Outcome taken = best(problem, row + 1, used);
+                    taken.second += edge.cost;
+                    result = std::min(result, taken);
+                    used[edge.column] = 0;
+                }
+            }
+            return result;
+        };
+    std::mt19937 rng(20);
+    std::uniform_int_distribution<int> size(1, 6);
+    std::uniform_real_distribution<double> cost(0.0, 900.0); // Close enough to the unassigned cost to matter
+    std::bernoulli_distribution hasEdge(0.45);
+    for (int trial = 0; trial < 2000; ++trial) {
+        int riders = size(rng);
+        int drivers = size(rng);
+        std::vector<std::vector<Edge>> problem(riders);
+        for (auto& row : problem) {
+            for (int driver = 0; driver < drivers; ++driver) {
+                if (hasEdge(rng)) {
+                    row.push_back(Edge{static_cast<uint32_t>(driver * 10), cost(rng)});
+                }
+            }
+        }
+        auto solved = AssignmentSolver::solve(problem, unassigned);
+        std::unordered_set<uint32_t> taken;
+        for (uint32_t column : solved) {
+            assert(column == NONE || taken.insert(column).second);
+        }
+        std::vector<char> used(drivers * 10, 0);
+        Outcome expected = best(problem, 0, used);
+        assert(static_cast<size_t>(std::count(solved.begin(), solved.end(), NONE)) == expected.first);
+        assert(std::fabs(AssignmentSolver::totalCost(problem, solved, unassigned) - expected.second) < 1e-9);
+    }
+    
+    std::cout << "✓ AssignmentSolver tests passed" << std::endl;
+}
+
+void testDispatchBatcher() {
+    std::cout << "Testing DispatchBatcher windows..." << std::endl;
+    
+    using namespace std::chrono;
+    steady_clock::time_point now{};
+    TimerWheel wheel(milliseconds(10), [&now]() { return now; });
+    
+    std::vector<std::vector<DispatchBatcher::Assignment>> dispatched;
+    DispatchBatcher::Options options;
+    options.window = milliseconds(200);
+    options.maxBatchSize = 4;
+    DispatchBatcher batcher(wheel, [&dispatched](std::vector<DispatchBatcher::Assignment>& assignments) {
+        dispatched.push_back(assignments);
+    }, options);
+    
+    // Three riders want the same popular driver 7; only one gets them
+    auto request = [](const std::string& id, DispatchBatcher::Handle user,
+                      std::vector<DispatchBatcher::Candidate> candidates) {
+        return DispatchBatcher::Request{id, user, std::move(candidates), steady_clock::time_point()};
+    };
+    batcher.submit(request("req_a", 1, {{7, 1.0}, {8, 6.0}}));
+    now += milliseconds(50);
+    batcher.submit(request("req_b", 2, {{7, 1.0}, {9, 3.0}}));
+    batcher.submit(request("req_c", 3, {{7, 2.0}}));
+    assert(batcher.getStats().queued == 3);
+    
+    // The window runs from the first request
+    now += milliseconds(140);
+    wheel.advance();
+    assert(dispatched.empty());
+    now += milliseconds(20);
+    wheel.advance();
+    assert(dispatched.size() == 1 && dispatched[0].size() == 3);
+    std::unordered_map<std::string, DispatchBatcher::Handle> drivers;
+    for (const auto& assignment : dispatched[0]) {
+        drivers[assignment.requestId] = assignment.driver;
+    }
+    assert(drivers["req_a"] == 8 && drivers["req_b"] == 9 && drivers["req_c"] == 7);
+    
+    // A full batch goes at once and its window timer is cancelled
+    for (int i = 0; i < 4; ++i) {
+        batcher.submit(request("req_" + std::to_string(i), 10 + i, {{static_cast<DispatchBatcher::Handle>(20 + i), 1.0}}));
+    }
+    assert(dispatched.size() == 2 && dispatched[1].size() == 4);
+    assert(wheel.getPendingCount() == 0);
+    
+    // Nobody left to take: dispatched with NO_DRIVER so the caller can retry
+    batcher.submit(request("req_none", 30, {}));
+    assert(batcher.flush() == 1);
+    assert(dispatched.back()[0].driver == DispatchBatcher::NO_DRIVER);
+    assert(batcher.flush() == 0);
+    
+    auto stats = batcher.getStats();
+    assert(stats.batches == 3 && stats.requests == 8 && stats.assigned == 7 && stats.unassigned == 1);
+    assert(stats.largestBatch == 4 && stats.queued == 0);
+    
+    std::cout << "✓ DispatchBatcher tests passed" << std::endl;
+}
+
+void testBatchedDispatchSimulation() {
+    std::cout << "Testing batched dispatch against per-request dispatch in a favorite-request rush..." << std::endl;
+    
+    // City: 15 x 15 km, positions in km. Riders favorite 5 drivers near them,
+    // drawn by popularity, so a few drivers are everyone's favorite.
+    const int driverCount = 1000;
+    const int riderCount = 1500;
+    const int arrivalWindowMs = 120000;  // 12.5 requests/s
+    const int responseMs = 4000;         // Offer until the driver answers
+    const int tripMs = 60000;
+    const int retryMs = 1000;            // Rider with no candidates asks again
+    const int giveUpMs = 30000;          // Rider cancels if still unmatched
+    const double radiusKm = 3.0;
+    const double favoritePenalty = 20.0; // Non-favorites cost 20 min more: favorites first
+    
+    std::mt19937 rng(2020);
+    std::uniform_real_distribution<double> coordinate(0.0, 15.0);
+    std::vector<double> driverX(driverCount), driverY(driverCount), popularity(driverCount);
+    for (int d = 0; d < driverCount; ++d) {
+        driverX[d] = coordinate(rng);
+        driverY[d] = coordinate(rng);
+        popularity[d] = 1.0 / std::pow(1.0 + d, 0.8); // Zipf-like
+    }
+    std::vector<double> riderX(riderCount), riderY(riderCount);
+    std::vector<int> arrivalMs(riderCount);
+    std::vector<std::unordered_set<int>> favorites(riderCount);
+    std::uniform_int_distribution<int> arrival(0, arrivalWindowMs);
+    for (int r = 0; r < riderCount; ++r) {
+        riderX[r] = coordinate(rng);
+        riderY[r] = coordinate(rng);
+        arrivalMs[r] = arrival(rng);
+        std::vector<int> nearby;
+        std::vector<double> weights;
+        for (int d = 0; d < driverCount; ++d) {
+            if (std::hypot(driverX[d] - riderX[r], driverY[d] - riderY[r]) <= 2.0 * radiusKm) {
+                nearby.push_back(d);
+                weights.push_back(popularity[d]);
+            }
+        }
+        std::discrete_distribution<int> pick(weights.begin(), weights.end());
+        for (int i = 0; i < 5 && !nearby.empty(); ++i) {
+            favorites[r].insert(nearby[pick(rng)]);
+        }
+    }
+    
+    // Pickup minutes at 30 km/h, plus the penalty for non-favorites
+    auto cost = [&](int rider, int driver) {
+        double minutes = std::hypot(driverX[driver] - riderX[rider], driverY[driver] - riderY[rider]) * 2.0;
+        return favorites[rider].count(driver) ? minutes : minutes + favoritePenalty;
+    };
+    auto inRange = [&](int rider, int driver) {
+        return std::hypot(driverX[driver] - riderX[rider], driverY[driver] - riderY[rider]) <= radiusKm;
+    };
+    
+    struct Event {
+        int timeMs;
+        int type; // 0 arrival/retry, 1 accepted, 2 rejected
+        int rider;
+        int driver;
+        bool operator>(const Event& other) const { return timeMs > other.timeMs; }
+    };
+    struct Outcome {
+        std::vector<int> latenciesMs;
+        int favoriteMatches = 0;
+        int offers = 0;
+        int rejections = 0;
+    };
+    
+    // Per-request: each rider takes their best driver that is not yet on a
+    // trip. Offers still awaiting an answer are invisible to other riders, so
+    // popular favorites are offered to several riders and all but one decline.
+    Outcome greedy;
+    {
+        std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+        std::vector<int> busyUntil(driverCount, 0);
+        std::vector<char> offerPending(driverCount, 0);
+        std::vector<std::unordered_set<int>> declinedBy(riderCount);
+        for (int r = 0; r < riderCount; ++r) {
+            events.push(Event{arrivalMs[r], 0, r, -1});
+        }
+        while (!events.empty()) {
+            Event event = events.top();
+            events.pop();
+            int r = event.rider;
+            if (event.type == 1) {
+                offerPending[event.driver] = 0;
+                busyUntil[event.driver] = event.timeMs + tripMs;
+                greedy.latenciesMs.push_back(event.timeMs - arrivalMs[r]);
+                greedy.favoriteMatches += favorites[r].count(event.driver) ? 1 : 0;
+                continue;
+            }
+            if (event.type == 2) {
+                greedy.rejections++;
+                declinedBy[r].insert(event.driver);
+            }
+            if (event.timeMs - arrivalMs[r] > giveUpMs) {
+                continue;
+            }
+            int bestDriver = -1;
+            double bestCost = 0.0;
+            for (int d = 0; d < driverCount; ++d) {
+                if (busyUntil[d] <= event.timeMs && inRange(r, d) && !declinedBy[r].count(d)) {
+                    double c = cost(r, d);
+                    if (bestDriver < 0 || c < bestCost) {
+                        bestDriver = d;
+                        bestCost = c;
+                    }
+                }
+            }
+            if (bestDriver < 0) {
+                events.push(Event{event.timeMs + retryMs, 0, r, -1});
+                continue;
+            }
+            greedy.offers++;
+            bool accepts = !offerPending[bestDriver];
+            offerPending[bestDriver] = 1;
+            events.push(Event{event.timeMs + responseMs, accepts ? 1 : 2, r, bestDriver});
+        }
+    }
+    
+    // Batched: requests gather for 200 ms and one assignment covers them all;
+    // offered drivers are reserved, so nobody is offered twice
+    Outcome batched;
+    {
+        using namespace std::chrono;
+        steady_clock::time_point now{};
+        int simulatedMs = 0;
+        TimerWheel wheel(milliseconds(10), [&now]() { return now; });
+        std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+        std::vector<int> busyUntil(driverCount, 0);
+        std::vector<char> reserved(driverCount, 0);
+        
+        DispatchBatcher::Options options;
+        options.window = milliseconds(200);
+        DispatchBatcher batcher(wheel, [&](std::vector<DispatchBatcher::Assignment>& assignments) {
+            for (const auto& assignment : assignments) {
+                int r = static_cast<int>(assignment.user);
+                if (assignment.driver == DispatchBatcher::NO_DRIVER) {
+                    events.push(Event{simulatedMs + retryMs, 0, r, -1});
+                    continue;
+                }
+                batched.offers++;
+                reserved[assignment.driver] = 1;
+                events.push(Event{simulatedMs + responseMs, 1, r, static_cast<int>(assignment.driver)});
+            }
+        }, options);
+        
+        for (int r = 0; r < riderCount; ++r) {
+            events.push(Event{arrivalMs[r], 0, r, -1});
+        }
+        std::vector<DispatchBatcher::Candidate> candidates;
+        while (!events.empty() || batcher.getStats().queued > 0) {
+            int nextMs = events.empty() ? simulatedMs + 10 : events.top().timeMs;
+            if (simulatedMs < nextMs) {
+                simulatedMs = std::min(nextMs, simulatedMs + 10);
+                now = steady_clock::time_point(milliseconds(simulatedMs));
+                wheel.advance();
+                continue;
+            }
+            Event event = events.top();
+            events.pop();
+            int r = event.rider;
+            if (event.type == 1) {
+                reserved[event.driver] = 0;
+                busyUntil[event.driver] = event.timeMs + tripMs;
+                batched.latenciesMs.push_back(event.timeMs - arrivalMs[r]);
+                batched.favoriteMatches += favorites[r].count(event.driver) ? 1 : 0;
+                continue;
+            }
+            if (event.timeMs - arrivalMs[r] > giveUpMs) {
+                continue;
+            }
+            candidates.clear();
+            for (int d = 0; d < driverCount; ++d) {
+                if (busyUntil[d] <= event.timeMs && !reserved[d] && inRange(r, d)) {
+                    candidates.push_back(DispatchBatcher::Candidate{static_cast<DispatchBatcher::Handle>(d), cost(r, d)});
+                }
+            }
+            if (candidates.empty()) {
+                events.push(Event{event.timeMs + retryMs, 0, r, -1});
+                continue;
+            }
+            batcher.submit(DispatchBatcher::Request{"r" + std::to_string(r), static_cast<DispatchBatcher::Handle>(r),
+                                                    candidates, now});
+        }
+        assert(batcher.getStats().batches > 0);
+    }
+    
+    // Worst case for the solver: a full batch all in one component
+    std::vector<std::vector<AssignmentSolver::Edge>> stadium(256);
+    std::uniform_int_distribution<uint32_t> nearbyDriver(0, 299);
+    std::uniform_real_distribution<double> pickupMinutes(1.0, 30.0);
+    for (auto& row : stadium) {
+        for (int i = 0; i < 30; ++i) {
+            row.push_back(AssignmentSolver::Edge{nearbyDriver(rng), pickupMinutes(rng)});
+        }
+    }
+    auto stadiumAssignment = AssignmentSolver::solve(stadium, 1.0e6);
+    size_t stadiumMatched = std::count_if(stadiumAssignment.begin(), stadiumAssignment.end(),
+                                          [](uint32_t column) { return column != AssignmentSolver::UNASSIGNED; });
+    
+    assert(batched.rejections == 0 && greedy.rejections > 0);
+    assert(batched.latenciesMs.size() >= greedy.latenciesMs.size());
+    assert(stadiumMatched == 256);
+    
+    std::cout << "✓ Batched dispatch simulation tests passed" << std::endl;
+}
+
+void testPriorityScoreCache() {
+    std::cout << "Testing PriorityScoreCache..." << std::endl;
+    
+    using Handle = PriorityScoreCache::Handle;
+    PriorityScoreCache cache;
+    const double penalty = cache.getDistancePenaltyPerKm();
+    
+    std::unordered_map<Handle, double> ratings = {{1, 4.9}, {2, 4.5}, {3, 4.8}, {4, 3.9}};
+    std::unordered_set<Handle> favorites = {2};
+    int computed = 0;
+    auto staticScore = [&](Handle driver) {
+        ++computed;
+        return (favorites.count(driver) ? 1000.0 : 0.0) + ratings[driver] * 100.0;
+    };
+    
+    // Favorite first, then rating less distance; ties broken by handle
+    std::vector<Handle> drivers = {1, 2, 3, 4};
+    std::vector<double> distances = {1.5, 4.0, 0.0, 0.5};
+    std::vector<PriorityScoreCache::Ranked> ranked;
+    cache.rank(7, drivers.data(), distances.data(), drivers.size(), 3, staticScore, ranked);
+    assert(ranked.size() == 3 && computed == 4);
+    assert(ranked[0].driver == 2 && ranked[1].driver == 3 && ranked[2].driver == 1);
+    assert(std::fabs(ranked[0].score - (1000.0 + 450.0 - 4.0 * penalty)) < 1e-9);
+    
+    // Static parts are reused; only distances change
+    distances = {0.0, 4.0, 9.0, 0.5};
+    cache.rank(7, drivers.data(), distances.data(), drivers.size(), 2, staticScore, ranked);
+    assert(computed == 4);
+    assert(ranked.size() == 2 && ranked[0].driver == 2 && ranked[1].driver == 1);
+    
+    // Rating change: only that driver is recomputed
+    ratings[4] = 5.0;
+    cache.invalidateDriver(4);
+    cache.rank(7, drivers.data(), distances.data(), drivers.size(), 2, staticScore, ranked);
+    assert(computed == 5);
+    assert(ranked[1].driver == 4);
+    
+    // Favorites change: the user's pairs are recomputed, other users keep theirs
+    cache.rank(8, drivers.data(), distances.data(), drivers.size(), 4, staticScore, ranked);
+    assert(computed == 9);
+    favorites = {3};
+    cache.invalidateUser(7);
+    cache.rank(7, drivers.data(), distances.data(), drivers.size(), 1, staticScore, ranked);
+    assert(computed == 13 && ranked[0].driver == 3);
+    cache.rank(8, drivers.data(), distances.data(), drivers.size(), 4, staticScore, ranked);
+    assert(computed == 13);
+    
+    // Handles sharing a version slot are invalidated together, never missed
+    Handle alias = 4 + PriorityScoreCache::VERSION_SLOTS;
+    ratings[alias] = 1.0;
+    assert(cache.getStaticScore(7, alias, staticScore) == 100.0);
+    cache.invalidateDriver(4);
+    int before = computed;
+    cache.getStaticScore(7, alias, staticScore);
+    assert(computed == before + 1);
+    
+    auto stats = cache.getStats();
+    assert(stats.hits > 0 && stats.invalidations >= 6 && stats.size == 9);
+    
+    // Concurrent ranking while ratings change
+    PriorityScoreCache shared;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&shared, t]() {
+            std::vector<Handle> candidates(64);
+            std::vector<double> km(64, 1.0);
+            std::vector<PriorityScoreCache::Ranked> top;
+            for (Handle i = 0; i < candidates.size(); ++i) {
+                candidates[i] = i;
+            }
+            for (int i = 0; i < 2000; ++i) {
+                if (t == 0 && i % 10 == 0) {
+                    shared.invalidateDriver(static_cast<Handle>(i % 64));
+                }
+                shared.rank(static_cast<Handle>(i % 8), candidates.data(), km.data(), candidates.size(), 3,
+                            [](Handle driver) { return static_cast<double>(driver); }, top);
+                assert(top.size() == 3 && top[0].driver == 63);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    // selectTop agrees with a full sort
+    std::mt19937 rng(21);
+    std::uniform_real_distribution<double> score(0.0, 100.0);
+    std::vector<PriorityScoreCache::Ranked> candidates;
+    for (Handle driver = 0; driver < 500; ++driver) {
+        candidates.push_back({driver, std::floor(score(rng)), 0.0}); // Plenty of ties
+    }
+    auto sorted = candidates;
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        return a.score != b.score ? a.score > b.score : a.driver < b.driver;
+    });
+    PriorityScoreCache::selectTop(candidates, 10);
+    assert(candidates.size() == 10);
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        assert(candidates[i].driver == sorted[i].driver);
+    }
+    
+    std::cout << "✓ PriorityScoreCache tests passed" << std::endl;
+}
+
+void testNotificationPipeline() {
+    std::cout << "Testing NotificationPipeline..." << std::endl;
+    
+    // A sink that can be held closed, so posts pile up into one delivery round
+    struct GatedSink {
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool open = false;
+        std::atomic<bool> entered{false};
+        std::vector<std::pair<std::string, std::vector<std::string>>> calls;
+        
+        void operator()(const std::string& recipient, const std::vector<std::string>& messages) {
+            std::unique_lock<std::mutex> lock(mutex);
+            entered = true;
+            condition.wait(lock, [this]() { return open; });
+            if (recipient == "bad") {
+                throw std::runtime_error("gateway down");
+            }
+            calls.emplace_back(recipient, messages);
+        }
+        void release() {
+            std::lock_guard<std::mutex> lock(mutex);
+            open = true;
+            condition.notify_all();
+        }
+        void waitEntered() {
+            while (!entered) {
+                std::this_thread::yield();
+            }
+        }
+    };
+    
+    // Batching per recipient, repeat and keyed coalescing
+    {
+        GatedSink sink;
+        NotificationPipeline pipeline([&sink](const std::string& r, const std::vector<std::string>& m) { sink(r, m); });
+        assert(pipeline.post("gate", "hold"));
+        sink.waitEntered();
+        assert(pipeline.post("rider1", "driver accepted"));
+        assert(pipeline.post("rider2", "x"));
+        assert(pipeline.post("rider1", "eta 5 min", "eta"));
+        assert(pipeline.post("rider1", "driver accepted")); // Exact repeat
+        assert(pipeline.post("rider1", "eta 3 min", "eta"));  // Supersedes "eta 5 min"
+        assert(pipeline.post("rider2", "y"));
+        assert(pipeline.post("bad", "lost"));
+        sink.release();
+        pipeline.flush();
+        
+        assert(sink.calls.size() == 3);
+        assert(sink.calls[0].first == "gate");
+        assert(sink.calls[1].first == "rider1");
+        assert((sink.calls[1].second == std::vector<std::string>{"driver accepted", "eta 3 min"}));
+        assert(sink.calls[2].first == "rider2");
+        assert((sink.calls[2].second == std::vector<std::string>{"x", "y"}));
+        
+        auto stats = pipeline.getStats();
+        assert(stats.posted == 8);
+        assert(stats.coalesced == 2);
+        assert(stats.delivered == 6);
+        assert(stats.sinkCalls == 4);
+        assert(stats.sinkFailures == 1);
+        assert(stats.dropped == 0);
+    }
+    
+    // A full ring drops instead of blocking
+    {
+        GatedSink sink;
+        NotificationPipeline::Options options;
+        options.queueCapacity = 4;
+        NotificationPipeline pipeline([&sink](const std::string& r, const std::vector<std::string>& m) { sink(r, m); },
+                                      options);
+        assert(pipeline.post("gate", "hold"));
+        sink.waitEntered();
+        int accepted = 0;
+        for (int i = 0; i < 10; ++i) {
+            accepted += pipeline.post("rider_" + std::to_string(i), "update") ? 1 : 0;
+        }
+        assert(accepted == 4);
+        assert(pipeline.getStats().dropped == 6);
+        assert(pipeline.getStats().queued == 4);
+        sink.release();
+        pipeline.flush();
+        assert(pipeline.getStats().delivered == 5);
+    }
+    
+    // Shutdown delivers what is queued, then rejects
+    {
+        std::atomic<int> delivered{0};
+        NotificationPipeline pipeline([&delivered](const std::string&, const std::vector<std::string>& messages) {
+            std::this_thread::sleep_for(std::chrono::microseconds(20));
+            delivered += static_cast<int>(messages.size());
+        });
+        for (int i = 0; i < 500; ++i) {
+            assert(pipeline.post("rider_" + std::to_string(i % 50), "update " + std::to_string(i)));
+        }
+        pipeline.shutdown();
+        assert(delivered == 500);
+        assert(!pipeline.post("rider_0", "late"));
+        assert(pipeline.getStats().rejected == 1);
+        pipeline.flush(); // Returns at once after shutdown
+    }
+    
+    // Concurrent producers: everything posted is delivered exactly once
+    {
+        std::mutex mutex;
+        std::unordered_map<std::string, int> received;
+        NotificationPipeline pipeline([&](const std::string& recipient, const std::vector<std::string>& messages) {
+            std::lock_guard<std::mutex> lock(mutex);
+            received[recipient] += static_cast<int>(messages.size());
+        });
+        std::vector<std::thread> producers;
+        for (int t = 0; t < 4; ++t) {
+            producers.emplace_back([&pipeline, t]() {
+                for (int i = 0; i < 5000; ++i) {
+                    while (!pipeline.post("rider_" + std::to_string(t), std::to_string(i))) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        pipeline.flush();
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int t = 0; t < 4; ++t) {
+            assert(received["rider_" + std::to_string(t)] == 5000);
+        }
+    }
+
+    // No sink discards; swapping the sink while producers post loses nothing
+    {
+        NotificationPipeline pipeline(nullptr);
+        assert(pipeline.post("rider_0", "unheard"));
+        pipeline.flush();
+        assert(pipeline.getStats().discarded == 1);
+
+        std::atomic<int> first{0};
+        std::atomic<int> second{0};
+        pipeline.setSink([&first](const std::string&, const std::vector<std::string>& messages) {
+            first += static_cast<int>(messages.size());
+        });
+        std::thread producer([&pipeline]() {
+            for (int i = 0; i < 5000; ++i) {
+                while (!pipeline.post("rider_" + std::to_string(i % 20), std::to_string(i))) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        for (int swap = 0; swap < 100; ++swap) {
+            pipeline.setSink([&second](const std::string&, const std::vector<std::string>& messages) {
+                second += static_cast<int>(messages.size());
+            });
+        }
+        producer.join();
+        pipeline.flush();
+        assert(first + second == 5000);
+        assert(pipeline.getStats().discarded == 1);
+    }
+
+    std::cout << "✓ NotificationPipeline tests passed" << std::endl;
+}
+
+void testMetricsRegistry() {
+    std::cout << "Testing LatencyHistogram and MetricsRegistry..." << std::endl;
+    
+    // Bucketing: exact below SUB_BUCKETS, within 1/32 above, contiguous
+    for (uint64_t value = 0; value < LatencyHistogram::SUB_BUCKETS; ++value) {
+        assert(LatencyHistogram::bucketFor(value) == value);
+    }
+    std::mt19937_64 rng(123);
+    for (int i = 0; i < 100000; ++i) {
+        uint64_t value = rng() >> (24 + rng() % 40);
+        size_t bucket = LatencyHistogram::bucketFor(value);
+        assert(bucket < LatencyHistogram::BUCKET_COUNT);
+        uint64_t low = LatencyHistogram::bucketLow(bucket);
+        uint64_t width = LatencyHistogram::bucketWidth(bucket);
+        assert(value >= low && value < low + width);
+        assert(width == 1 || width * 32 <= low);
+    }
+    for (size_t bucket = 1; bucket < LatencyHistogram::BUCKET_COUNT; ++bucket) {
+        assert(LatencyHistogram::bucketLow(bucket) ==
+               LatencyHistogram::bucketLow(bucket - 1) + LatencyHistogram::bucketWidth(bucket - 1));
+    }
+    assert(LatencyHistogram::bucketFor(UINT64_MAX) == LatencyHistogram::BUCKET_COUNT - 1);
+    
+    // Percentiles against the exact sorted sample
+    LatencyHistogram histogram;
+    std::vector<uint64_t> samples;
+    std::lognormal_distribution<double> latency(10.0, 1.0); // ~22 us median
+    for (int i = 0; i < 50000; ++i) {
+        samples.push_back(static_cast<uint64_t>(latency(rng)));
+        histogram.record(samples.back());
+    }
+    std::sort(samples.begin(), samples.end());
+    for (double percentile : {50.0, 90.0, 99.0, 99.9}) {
+        double exact = static_cast<double>(samples[static_cast<size_t>(std::ceil(percentile / 100.0 * samples.size())) - 1]);
+        assert(std::abs(histogram.valueAtPercentile(percentile) - exact) <= exact / 32.0 + 1.0);
+    }
+    assert(histogram.getCount() == samples.size());
+    assert(histogram.getMin() == samples.front());
+    assert(histogram.getMax() == samples.back());
+    assert(histogram.valueAtPercentile(100.0) == samples.back());
+    
+    // Per-thread recording, merged on read
+    MetricsRegistry registry({"request", "save"}, {"state"});
+    std::shared_mutex state;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&registry, &state, t]() {
+            for (int i = 0; i < 10000; ++i) {
+                registry.record(0, 1000 * (t + 1));
+                {
+                    auto reader = (i % 2) ? registry.lockShared(state, 0) : std::shared_lock<std::shared_mutex>(state);
+                }
+                if (i % 3 == 0) {
+                    auto writer = registry.lockExclusive(state, 0);
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    MetricsRegistry::Snapshot during = registry.snapshot(); // Reads while threads record
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    assert(during.operations.size() == 2);
+    
+    registry.record(1, 5000000);
+    registry.record(7, 1); // Unknown id: ignored
+    MetricsRegistry::Snapshot snapshot = registry.snapshot();
+    assert(snapshot.threads == 5);
+    assert(snapshot.operations[0].name == "request");
+    assert(snapshot.operations[0].count == 40000);
+    assert(snapshot.operations[0].p50Ns >= 1900 && snapshot.operations[0].p50Ns <= 2100);
+    assert(snapshot.operations[0].maxNs == 4000);
+    assert(snapshot.operations[1].count == 1);
+    assert(registry.getHistogram(0).getCount() == 40000);
+    assert(snapshot.locks.size() == 1);
+    if (MetricsRegistry::enabled()) {
+        // Odd iterations take it shared, every third takes it exclusive
+        assert(snapshot.locks[0].acquisitions == 4 * (5000 + 3334));
+        assert(snapshot.locks[0].contended <= snapshot.locks[0].acquisitions);
+    } else {
+        assert(snapshot.locks[0].acquisitions == 0);
+    }
+    
+    {
+        METRICS_SCOPE(registry, 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    assert(registry.getHistogram(1).getCount() == (MetricsRegistry::enabled() ? 2u : 1u));
+    
+    snapshot.gauges.push_back({"dispatch_pool.queued", 3});
+    std::string text = MetricsRegistry::format(snapshot);
+    assert(text.find("request") != std::string::npos);
+    assert(text.find("p99_us") != std::string::npos);
+    assert(text.find("state") != std::string::npos);
+    assert(text.find("dispatch_pool.queued") != std::string::npos);
+    
+    std::cout << "✓ LatencyHistogram and MetricsRegistry tests passed" << std::endl;
+}
+
 void testPerformance() {
     std::cout << "Testing performance with multiple drivers..." << std::endl;
     
@@ -261,6 +2944,7 @@ void testPerformance() {
     std::cout << "  - Found " << favoriteDrivers.size() << " favorite drivers" << std::endl;
     std::cout << "  - Found " << availableDrivers.size() << " available favorite drivers" << std::endl;
     std::cout << "  - Found " << nearbyDrivers.size() << " nearby drivers" << std::endl;
+    std::cout << manager.dumpMetrics();
 }
 
 int main() {
@@ -272,6 +2956,33 @@ int main() {
         testRideRequestFunctionality();
         testFavoriteDriverManager();
         testRideRequestFlow();
+        testSpatialIndex();
+        testDriverPositionStore();
+        testShardedMap();
+        testTimerWheel();
+        testWorkerPool();
+        testBinarySnapshot();
+        testWriteAheadLog();
+        testJsonSerialization();
+        testIdInterner();
+        testInternedFavorites();
+        testSmallSortedSet();
+        testFavoriteSetMemory();
+        testFavoriteReverseIndex();
+        testPopularityLeaderboard();
+        testBatchLocationUpdates();
+        testDriverLiveStateConcurrency();
+        testSpeedGridEtaProvider();
+        testEtaCache();
+        testDistanceTiers();
+        testRideRequestPool();
+        testRequestIdGenerator();
+        testAssignmentSolver();
+        testDispatchBatcher();
+        testBatchedDispatchSimulation();
+        testPriorityScoreCache();
+        testNotificationPipeline();
+        testMetricsRegistry();
         testPerformance();
         
         std::cout << std::endl;